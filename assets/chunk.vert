@@ -0,0 +1,16 @@
+#version 450
+
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec4 color;
+
+layout(location = 0) out vec3 fragColor;
+
+layout(push_constant) uniform DrawConstants
+{
+    mat4 view_proj;
+} constants;
+
+void main() {
+    gl_Position = constants.view_proj * vec4(position, 1.0);
+    fragColor = color.rgb;
+}
@@ -0,0 +1,81 @@
+#ifndef BENCH_H
+#define BENCH_H
+#include <platform/log.h>
+#include <platform/time.h>
+#include <utils/new.h>
+
+// Shared by the benchmarks. A case runs its body a fixed number of times per sample and keeps the fastest
+// sample, the one least disturbed by the rest of the machine.
+namespace LunaVoxelEngine::Bench
+{
+constexpr unsigned int DEFAULT_SAMPLES = 5;
+
+/// Stored to by keep(), so the compiler has to compute whatever is handed to it.
+inline volatile unsigned long long sink = 0;
+
+inline void keep(unsigned long long value) noexcept
+{
+    sink = value;
+}
+
+/**
+ * @brief Calls body(i) for i in [0, iterations), samples times over.
+ * @return The fastest sample, in nanoseconds per call.
+ */
+template<typename Body>
+double best_ns(unsigned int iterations, Body body, unsigned int samples = DEFAULT_SAMPLES) noexcept
+{
+    unsigned long long best = ~0ull;
+    for (unsigned int sample = 0; sample < samples; ++sample)
+    {
+        const unsigned long long start = Platform::time_now_ns();
+        for (unsigned int i = 0; i < iterations; ++i)
+        {
+            body(i);
+        }
+        const unsigned long long elapsed = Platform::time_now_ns() - start;
+        best = elapsed < best ? elapsed : best;
+    }
+    return static_cast<double>(best) / iterations;
+}
+
+/// Rounds to two decimals, so %f prints 3.21 rather than every digit of the double.
+inline float round2(double value) noexcept
+{
+    return static_cast<float>(static_cast<long long>(value * 100.0 + 0.5)) / 100.0f;
+}
+
+/**
+ * @brief xorshift64*, so every run generates the same inputs.
+ */
+struct Random
+{
+    unsigned long long state = 0x9E3779B97F4A7C15ull;
+
+    unsigned long long next() noexcept
+    {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 0x2545F4914F6CDD1Dull;
+    }
+    /// Uniform enough in [0, bound) for bound far below 2^32.
+    unsigned int below(unsigned int bound) noexcept
+    {
+        return static_cast<unsigned int>((next() >> 32) % bound);
+    }
+};
+
+/// The SIMD level the utils were compiled for, as ENABLE_AVX2 and the compiler's defaults leave it.
+constexpr const char *SIMD_LEVEL =
+#if defined(__AVX2__)
+    "AVX2";
+#elif defined(__SSSE3__)
+    "SSSE3";
+#elif defined(__SSE2__) || defined(_M_X64)
+    "SSE2";
+#else
+    "scalar";
+#endif
+} // namespace LunaVoxelEngine::Bench
+#endif
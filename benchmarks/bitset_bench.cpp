@@ -0,0 +1,164 @@
+// LunaBenchBitSet: BitSet, BitVector and PackedArray against one bool or unsigned short per entry.
+//
+//     LunaBenchBitSet
+//
+// Works on 32768 entries, one 32^3 chunk: an occupancy mask at about 50% density, a sparse mask of 200 set bits
+// to iterate, and 4-bit palette indices. Every case toggles one entry per call, so the compiler cannot hoist the
+// work out of the loop.
+#include "bench.h"
+#include <utils/bitset.h>
+#include <utils/packed_array.h>
+
+using namespace LunaVoxelEngine;
+
+constexpr unsigned long ENTRIES = 32768;
+constexpr unsigned int ITERATIONS = 2000;
+constexpr unsigned int SPARSE_BITS = 200;
+constexpr unsigned int RANDOM_GETS = 4096;
+
+using Mask = Utils::BitSet<ENTRIES>;
+using Palette = Utils::PackedArray<4>;
+
+// Static, since the masks are over-aligned for the vector kernels.
+static Mask occupied_mask;
+static Mask other_mask;
+static Mask sparse_mask;
+
+static void log_case(const char *name, const char *plain, double plain_ns, const char *packed, double packed_ns)
+{
+    Log::info("%s: %s %f us, %s %f us", name, plain, Bench::round2(plain_ns / 1000.0), packed,
+              Bench::round2(packed_ns / 1000.0));
+}
+
+int main()
+{
+    bool *occupied = new bool[ENTRIES];
+    bool *other = new bool[ENTRIES];
+    bool *sparse = new bool[ENTRIES];
+    unsigned short *indices = new unsigned short[ENTRIES];
+    Utils::BitVector occupied_vector(ENTRIES);
+    Palette palette(ENTRIES);
+    unsigned int *gets = new unsigned int[RANDOM_GETS];
+
+    Bench::Random random;
+    for (unsigned long i = 0; i < ENTRIES; ++i)
+    {
+        occupied[i] = random.below(2) != 0;
+        other[i] = random.below(2) != 0;
+        sparse[i] = false;
+        indices[i] = static_cast<unsigned short>(random.below(16));
+        occupied_mask.set(i, occupied[i]);
+        other_mask.set(i, other[i]);
+        occupied_vector.set(i, occupied[i]);
+        palette.set(i, indices[i]);
+    }
+    for (unsigned int i = 0; i < SPARSE_BITS; ++i)
+    {
+        const unsigned int index = random.below(ENTRIES);
+        sparse[index] = true;
+        sparse_mask.set(index);
+    }
+    for (unsigned int i = 0; i < RANDOM_GETS; ++i)
+    {
+        gets[i] = random.below(ENTRIES);
+    }
+
+    const double count_bool_ns = Bench::best_ns(ITERATIONS, [&](unsigned int i) {
+        occupied[i] = !occupied[i];
+        unsigned long count = 0;
+        for (unsigned long j = 0; j < ENTRIES; ++j)
+        {
+            count += occupied[j];
+        }
+        Bench::keep(count);
+    });
+    const double count_set_ns = Bench::best_ns(ITERATIONS, [&](unsigned int i) {
+        occupied_mask.flip(i);
+        Bench::keep(occupied_mask.count());
+    });
+    const double count_vector_ns = Bench::best_ns(ITERATIONS, [&](unsigned int i) {
+        occupied_vector.flip(i);
+        Bench::keep(occupied_vector.count());
+    });
+
+    // The visible cells of a chunk: occupied and not covered, or forced.
+    const double and_or_bool_ns = Bench::best_ns(ITERATIONS, [&](unsigned int i) {
+        other[i] = !other[i];
+        for (unsigned long j = 0; j < ENTRIES; ++j)
+        {
+            occupied[j] = (occupied[j] & other[j]) | sparse[j];
+        }
+        Bench::keep(occupied[i]);
+    });
+    const double and_or_set_ns = Bench::best_ns(ITERATIONS, [&](unsigned int i) {
+        other_mask.flip(i);
+        occupied_mask &= other_mask;
+        occupied_mask |= sparse_mask;
+        Bench::keep(occupied_mask.test(i));
+    });
+
+    const double iterate_bool_ns = Bench::best_ns(ITERATIONS, [&](unsigned int) {
+        unsigned long sum = 0;
+        for (unsigned long j = 0; j < ENTRIES; ++j)
+        {
+            if (sparse[j])
+            {
+                sum += j;
+            }
+        }
+        Bench::keep(sum);
+    });
+    const double iterate_set_ns = Bench::best_ns(ITERATIONS, [&](unsigned int) {
+        unsigned long sum = 0;
+        sparse_mask.for_each_set([&](unsigned long j) { sum += j; });
+        Bench::keep(sum);
+    });
+
+    const double count_value_short_ns = Bench::best_ns(ITERATIONS, [&](unsigned int i) {
+        indices[i] = static_cast<unsigned short>((indices[i] + 1) & 15);
+        unsigned long count = 0;
+        for (unsigned long j = 0; j < ENTRIES; ++j)
+        {
+            count += indices[j] == 7;
+        }
+        Bench::keep(count);
+    });
+    const double count_value_packed_ns = Bench::best_ns(ITERATIONS, [&](unsigned int i) {
+        palette.set(i, (palette.get(i) + 1) & 15);
+        Bench::keep(palette.count(7));
+    });
+
+    const double get_short_ns = Bench::best_ns(ITERATIONS, [&](unsigned int) {
+        unsigned long sum = 0;
+        for (unsigned int j = 0; j < RANDOM_GETS; ++j)
+        {
+            sum += indices[gets[j]];
+        }
+        Bench::keep(sum);
+    });
+    const double get_packed_ns = Bench::best_ns(ITERATIONS, [&](unsigned int) {
+        unsigned long sum = 0;
+        for (unsigned int j = 0; j < RANDOM_GETS; ++j)
+        {
+            sum += palette.get(gets[j]);
+        }
+        Bench::keep(sum);
+    });
+
+    Log::info("%lu entries (%s): masks of %lu bytes against %lu, palette of %lu bytes against %lu", ENTRIES,
+              Bench::SIMD_LEVEL, sizeof(Mask), ENTRIES * sizeof(bool), palette.word_count() * 8,
+              ENTRIES * sizeof(unsigned short));
+    log_case("count", "bool[]", count_bool_ns, "BitSet", count_set_ns);
+    Log::info("count: BitVector %f us", Bench::round2(count_vector_ns / 1000.0));
+    log_case("and + or", "bool[]", and_or_bool_ns, "BitSet", and_or_set_ns);
+    log_case("iterate 200 set", "bool[]", iterate_bool_ns, "BitSet", iterate_set_ns);
+    log_case("count == v", "ushort[]", count_value_short_ns, "PackedArray<4>", count_value_packed_ns);
+    log_case("4096 random gets", "ushort[]", get_short_ns, "PackedArray<4>", get_packed_ns);
+
+    delete[] gets;
+    delete[] indices;
+    delete[] sparse;
+    delete[] other;
+    delete[] occupied;
+    return 0;
+}
@@ -0,0 +1,43 @@
+// LunaBenchFormat: format_line per record, the formatting half of every log call.
+//
+//     LunaBenchFormat
+//
+// Formats into a stack line buffer without writing it anywhere, for four kinds of record: integers of each width,
+// hex and a pointer, doubles and floats.
+#include "bench.h"
+#include <platform/common_log.h>
+
+using namespace LunaVoxelEngine;
+
+constexpr unsigned int ITERATIONS = 200000;
+
+/**
+ * @brief Times format_line on format with args packed as a log call packs them.
+ */
+template<typename... Args>
+static double time_format(const Utils::FormatFor<Args...> &format, const Args &...args) noexcept
+{
+    const Utils::FormatView view = format.view();
+    const Utils::FormatArg packed[] = {Utils::make_format_arg(args)...};
+    return Bench::best_ns(ITERATIONS, [&](unsigned int) {
+        Log::LineBuffer line;
+        Log::format_line(line, Log::Level::LOG_INFO, view, packed);
+        Bench::keep(line.len + static_cast<unsigned char>(line.data[line.len / 2]));
+    });
+}
+
+int main()
+{
+    int local = 0;
+    const double integers_ns =
+        time_format("%d %u %llu %lld", -123456, 4000000000u, 18446744073709551615ull, -9000000000000000000ll);
+    const double hex_ns = time_format("%x %llx %p", 0xDEADBEEFu, 0x123456789ABCDEFull, static_cast<void *>(&local));
+    const double doubles_ns = time_format("%f %f %f %f", 16.6, 0.001, 1.0 / 3.0, 6.02214076e23);
+    const double floats_ns = time_format("%f %f %f", 16.6f, 0.1f, 1.0f / 3.0f);
+
+    Log::info("format_line per record, best of %u x %u:", Bench::DEFAULT_SAMPLES, ITERATIONS);
+    Log::info("4 integers (%%d %%u %%llu %%lld) %f ns", Bench::round2(integers_ns));
+    Log::info("%%x %%llx %%p %f ns", Bench::round2(hex_ns));
+    Log::info("4 doubles %f ns, 3 floats %f ns", Bench::round2(doubles_ns), Bench::round2(floats_ns));
+    return 0;
+}
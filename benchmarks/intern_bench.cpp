@@ -0,0 +1,133 @@
+// LunaBenchIntern: lookup-heavy workloads on the global intern pool.
+//
+//     LunaBenchIntern
+//
+// Uses 10000 asset-style paths of about 40 bytes. Times interning and finding names already in the pool, interning
+// new ones, a linear search by string against one by handle, and hashing a name against reading its handle's hash.
+#include "bench.h"
+#include <utils/hash.h>
+#include <utils/intern.h>
+#include <utils/to_chars.h>
+
+using namespace LunaVoxelEngine;
+
+constexpr unsigned int NAME_COUNT = 10000;
+constexpr unsigned int NAME_CAPACITY = 64;
+constexpr unsigned int SEARCH_COUNT = 256;
+
+static const char *const FOLDERS[] = {"textures/blocks", "textures/items", "models/entities", "sounds/ambient"};
+static const char *const STEMS[] = {"stone", "oak_planks", "iron_ore", "grass_side", "water_still", "creeper"};
+
+/**
+ * @brief Writes "assets/<folder>/<stem>_<index>.<extension>" into name, with round as the extension, so each
+ *        round gives names the pool has not seen.
+ */
+static Utils::StringView make_name(char *name, unsigned int index, const char *round) noexcept
+{
+    char *out = name;
+    const char *parts[] = {"assets/", FOLDERS[index % 4], "/", STEMS[index % 6], "_"};
+    for (const char *part : parts)
+    {
+        while (*part != '\0')
+        {
+            *out++ = *part++;
+        }
+    }
+    out = Utils::u64_to_chars(out, index);
+    *out++ = '.';
+    while (*round != '\0')
+    {
+        *out++ = *round++;
+    }
+    *out = '\0';
+    return Utils::StringView(name, static_cast<unsigned long>(out - name));
+}
+
+int main()
+{
+    // Names the pool holds, names it never sees, and a set of new names for each sample of the first intern.
+    constexpr unsigned int SETS = 2 + Bench::DEFAULT_SAMPLES;
+    const char *const extensions[SETS] = {"png", "tga", "a0", "a1", "a2", "a3", "a4"};
+    char *storage = new char[SETS * NAME_COUNT * NAME_CAPACITY];
+    Utils::StringView *names = new Utils::StringView[SETS * NAME_COUNT];
+    for (unsigned int set = 0; set < SETS; ++set)
+    {
+        for (unsigned int i = 0; i < NAME_COUNT; ++i)
+        {
+            const unsigned int slot = set * NAME_COUNT + i;
+            names[slot] = make_name(storage + slot * NAME_CAPACITY, i, extensions[set]);
+        }
+    }
+    const Utils::StringView *missing = names + NAME_COUNT;
+    Utils::InternedString *handles = new Utils::InternedString[NAME_COUNT];
+    unsigned long total_length = 0;
+    for (unsigned int i = 0; i < NAME_COUNT; ++i)
+    {
+        handles[i] = Utils::InternedString(names[i]);
+        total_length += names[i].size();
+    }
+
+    // Strides through the names, so consecutive lookups do not hit the same cache lines.
+    const double intern_existing_ns = Bench::best_ns(NAME_COUNT, [&](unsigned int i) {
+        Bench::keep(Utils::InternedString(names[i * 7919 % NAME_COUNT]).get_id());
+    });
+    const double find_existing_ns = Bench::best_ns(NAME_COUNT, [&](unsigned int i) {
+        Bench::keep(Utils::InternedString::find(names[i * 7919 % NAME_COUNT]).get_id());
+    });
+    const double find_missing_ns = Bench::best_ns(NAME_COUNT, [&](unsigned int i) {
+        Bench::keep(Utils::InternedString::find(missing[i * 7919 % NAME_COUNT]).get_id());
+    });
+
+    // Every sample needs names the pool has not seen, so each takes the next set.
+    const Utils::StringView *fresh = missing + NAME_COUNT;
+    const double first_intern_ns = Bench::best_ns(
+                                       1,
+                                       [&](unsigned int) {
+                                           for (unsigned int i = 0; i < NAME_COUNT; ++i)
+                                           {
+                                               Bench::keep(Utils::InternedString(fresh[i]).get_id());
+                                           }
+                                           fresh += NAME_COUNT;
+                                       }) /
+                                   NAME_COUNT;
+
+    // The search targets are spread over the last quarter, so every search walks most of the list.
+    const double search_view_ns = Bench::best_ns(SEARCH_COUNT, [&](unsigned int i) {
+        const Utils::StringView target = names[SEARCH_COUNT - 1 - i % (SEARCH_COUNT / 4)];
+        unsigned int found = 0;
+        while (!(names[found] == target))
+        {
+            ++found;
+        }
+        Bench::keep(found);
+    });
+    const double search_handle_ns = Bench::best_ns(SEARCH_COUNT, [&](unsigned int i) {
+        const Utils::InternedString target = handles[SEARCH_COUNT - 1 - i % (SEARCH_COUNT / 4)];
+        unsigned int found = 0;
+        while (handles[found] != target)
+        {
+            ++found;
+        }
+        Bench::keep(found);
+    });
+
+    const double hash_string_ns = Bench::best_ns(NAME_COUNT, [&](unsigned int i) {
+        Bench::keep(Utils::fold_hash32(Utils::xxhash64(names[i])));
+    });
+    const double hash_handle_ns =
+        Bench::best_ns(NAME_COUNT, [&](unsigned int i) { Bench::keep(handles[i].hash()); });
+
+    Log::info("%u names, %lu bytes on average, %u in the pool", NAME_COUNT, total_length / NAME_COUNT,
+              Utils::intern_pool_size());
+    Log::info("intern existing %f ns, find existing %f ns, find missing %f ns, first intern %f ns",
+              Bench::round2(intern_existing_ns), Bench::round2(find_existing_ns), Bench::round2(find_missing_ns),
+              Bench::round2(first_intern_ns));
+    Log::info("linear search of %u names: by string %f ns, by handle %f ns", SEARCH_COUNT,
+              Bench::round2(search_view_ns), Bench::round2(search_handle_ns));
+    Log::info("hash of a name: from the string %f ns, from the handle %f ns", Bench::round2(hash_string_ns),
+              Bench::round2(hash_handle_ns));
+    delete[] handles;
+    delete[] names;
+    delete[] storage;
+    return 0;
+}
@@ -0,0 +1,56 @@
+// LunaBenchLog: what a Log::info with three arguments costs the calling thread.
+//
+//     LunaBenchLog > log.txt && tail -n 5 log.txt
+//     LunaBenchLog | tail -n 5
+//
+// Records go to stdout like every other, so the sink under test is whatever stdout is redirected to; the results
+// are the last lines written. Each sample logs LINES records and is flushed outside the timed region, so every
+// sample starts with empty rings. In drop mode the time includes records dropped on a full ring, which the writer
+// reports in a WARN line.
+#include "bench.h"
+
+using namespace LunaVoxelEngine;
+
+constexpr unsigned int LINES = 30000;
+
+static double time_lines() noexcept
+{
+    unsigned long long best = ~0ull;
+    for (unsigned int sample = 0; sample < Bench::DEFAULT_SAMPLES; ++sample)
+    {
+        const unsigned long long start = Platform::time_now_ns();
+        for (unsigned int i = 0; i < LINES; ++i)
+        {
+            Log::info("chunk %u meshed in %f ms with %u quads", i, 0.25f * static_cast<float>(i & 7), i * 3);
+        }
+        const unsigned long long elapsed = Platform::time_now_ns() - start;
+        Log::flush();
+        best = elapsed < best ? elapsed : best;
+    }
+    return static_cast<double>(best) / LINES;
+}
+
+static double time_async(Log::OverflowPolicy overflow, Log::LogEncoding encoding) noexcept
+{
+    Log::AsyncConfig config;
+    config.overflow = overflow;
+    config.encoding = encoding;
+    Log::start_async(config);
+    const double ns = time_lines();
+    Log::stop_async();
+    return ns;
+}
+
+int main()
+{
+    const double sync_ns = time_lines();
+    const double drop_ns = time_async(Log::OverflowPolicy::OVERFLOW_DROP, Log::LogEncoding::ENCODING_TEXT);
+    const double block_ns = time_async(Log::OverflowPolicy::OVERFLOW_BLOCK, Log::LogEncoding::ENCODING_TEXT);
+    const double deferred_ns = time_async(Log::OverflowPolicy::OVERFLOW_BLOCK, Log::LogEncoding::ENCODING_DEFERRED);
+
+    Log::info("caller-side ns per line, best of %u x %u, 64 KiB rings:", Bench::DEFAULT_SAMPLES, LINES);
+    Log::info("sync %f ns", Bench::round2(sync_ns));
+    Log::info("async text: drop %f ns, block %f ns", Bench::round2(drop_ns), Bench::round2(block_ns));
+    Log::info("async deferred, block: %f ns", Bench::round2(deferred_ns));
+    return 0;
+}
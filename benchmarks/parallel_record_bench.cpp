@@ -0,0 +1,166 @@
+// LunaBenchParallelRecord: what ParallelRecorder::record() costs the calling thread for a frame's worth of draws.
+//
+//     LunaBenchParallelRecord
+//
+// volk's function pointers are pointed at a fake driver, so no device is needed. Its vkCmdDrawIndexed appends the
+// draw's 20 bytes to the command buffer's memory, about what a driver writes per draw, so the times are the
+// recorder's splitting, waking and joining plus a realistic stream of stores, not what a real driver costs. Each
+// case records 10k, 50k and 100k draws the way ChunkRenderer records its CPU-culled commands. Workers beyond the
+// machine's cores only add waking and joining.
+#include "bench.h"
+#include <renderer/vulkan/chunk_cull.h>
+#include <renderer/vulkan/parallel_recorder.h>
+#include <utils/atomic.h>
+
+using namespace LunaVoxelEngine;
+using namespace LunaVoxelEngine::Renderer;
+
+/// The recorder creates its command pools with these.
+VkAllocationCallbacks callbacks{};
+
+constexpr unsigned int FRAMES_IN_FLIGHT = 2;
+constexpr unsigned int RECORDS = 20;
+constexpr unsigned int DRAW_COUNTS[] = {10000, 50000, 100000};
+constexpr unsigned int WORKER_COUNTS[] = {0, 1, 3, 7};
+/// Every thread's buffers for every frame in flight, and the primary.
+constexpr unsigned int MAX_BUFFERS = (ParallelRecorder::MAX_WORKERS + 1) * FRAMES_IN_FLIGHT * 2 + 1;
+
+/**
+ * @brief A fake command buffer: the draws recorded into it since it was last begun.
+ */
+struct FakeCommandBuffer
+{
+    Utils::Vector<IndirectDrawCommand> draws;
+};
+
+static FakeCommandBuffer fake_buffers[MAX_BUFFERS];
+static Utils::Atomic<unsigned int> next_buffer{0};
+static Utils::Atomic<unsigned long long> next_pool{1};
+
+static FakeCommandBuffer &get_fake(VkCommandBuffer buffer) noexcept
+{
+    return *reinterpret_cast<FakeCommandBuffer *>(buffer);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL fake_create_command_pool(VkDevice, const VkCommandPoolCreateInfo *,
+                                                               const VkAllocationCallbacks *, VkCommandPool *pool)
+{
+    *pool = reinterpret_cast<VkCommandPool>(next_pool.fetch_add(1));
+    return VK_SUCCESS;
+}
+static VKAPI_ATTR void VKAPI_CALL fake_destroy_command_pool(VkDevice, VkCommandPool, const VkAllocationCallbacks *)
+{
+}
+static VKAPI_ATTR VkResult VKAPI_CALL fake_reset_command_pool(VkDevice, VkCommandPool, VkCommandPoolResetFlags)
+{
+    return VK_SUCCESS;
+}
+static VKAPI_ATTR VkResult VKAPI_CALL fake_allocate_command_buffers(VkDevice, const VkCommandBufferAllocateInfo *info,
+                                                                    VkCommandBuffer *buffers)
+{
+    for (uint32_t i = 0; i < info->commandBufferCount; ++i)
+    {
+        const unsigned int index = next_buffer.fetch_add(1);
+        if (index >= MAX_BUFFERS)
+        {
+            Log::fatal("LunaBenchParallelRecord: more than %u command buffers", MAX_BUFFERS);
+        }
+        buffers[i] = reinterpret_cast<VkCommandBuffer>(&fake_buffers[index]);
+    }
+    return VK_SUCCESS;
+}
+static VKAPI_ATTR void VKAPI_CALL fake_free_command_buffers(VkDevice, VkCommandPool, uint32_t,
+                                                            const VkCommandBuffer *)
+{
+}
+static VKAPI_ATTR VkResult VKAPI_CALL fake_begin_command_buffer(VkCommandBuffer buffer,
+                                                                const VkCommandBufferBeginInfo *)
+{
+    // Keeps the memory, as a driver keeps a pool's blocks across resets.
+    get_fake(buffer).draws.clear();
+    return VK_SUCCESS;
+}
+static VKAPI_ATTR VkResult VKAPI_CALL fake_end_command_buffer(VkCommandBuffer)
+{
+    return VK_SUCCESS;
+}
+static VKAPI_ATTR void VKAPI_CALL fake_set_viewport(VkCommandBuffer, uint32_t, uint32_t, const VkViewport *)
+{
+}
+static VKAPI_ATTR void VKAPI_CALL fake_set_scissor(VkCommandBuffer, uint32_t, uint32_t, const VkRect2D *)
+{
+}
+static VKAPI_ATTR void VKAPI_CALL fake_draw_indexed(VkCommandBuffer buffer, uint32_t index_count,
+                                                    uint32_t instance_count, uint32_t first_index,
+                                                    int32_t vertex_offset, uint32_t first_instance)
+{
+    get_fake(buffer).draws.push_back({index_count, instance_count, first_index, vertex_offset, first_instance});
+}
+static VKAPI_ATTR void VKAPI_CALL fake_execute_commands(VkCommandBuffer, uint32_t count, const VkCommandBuffer *buffers)
+{
+    unsigned long long draws = 0;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        draws += get_fake(buffers[i]).draws.size();
+    }
+    Bench::keep(draws);
+}
+
+static void install_fake_driver() noexcept
+{
+    vkCreateCommandPool = fake_create_command_pool;
+    vkDestroyCommandPool = fake_destroy_command_pool;
+    vkResetCommandPool = fake_reset_command_pool;
+    vkAllocateCommandBuffers = fake_allocate_command_buffers;
+    vkFreeCommandBuffers = fake_free_command_buffers;
+    vkBeginCommandBuffer = fake_begin_command_buffer;
+    vkEndCommandBuffer = fake_end_command_buffer;
+    vkCmdSetViewport = fake_set_viewport;
+    vkCmdSetScissor = fake_set_scissor;
+    vkCmdDrawIndexed = fake_draw_indexed;
+    vkCmdExecuteCommands = fake_execute_commands;
+}
+
+static void record_draws(CommandBuffer &command_buffer, unsigned int first, unsigned int count, void *user) noexcept
+{
+    const IndirectDrawCommand *commands = static_cast<const IndirectDrawCommand *>(user) + first;
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        command_buffer.drawIndexed(commands[i].index_count, commands[i].instance_count, commands[i].first_index,
+                                   commands[i].vertex_offset, commands[i].first_instance);
+    }
+}
+
+int main()
+{
+    install_fake_driver();
+    constexpr unsigned int MAX_DRAWS = DRAW_COUNTS[sizeof(DRAW_COUNTS) / sizeof(DRAW_COUNTS[0]) - 1];
+    Bench::Random random;
+    Utils::Vector<IndirectDrawCommand> commands;
+    for (unsigned int i = 0; i < MAX_DRAWS; ++i)
+    {
+        commands.push_back({36 + 6 * random.below(4000), 1, random.below(1 << 24),
+                            static_cast<int>(random.below(1 << 22)), i});
+    }
+    SecondaryTarget target;
+    target.extent = {1920, 1080};
+
+    for (const unsigned int worker_count : WORKER_COUNTS)
+    {
+        ParallelRecorder *recorder = new ParallelRecorder(0, worker_count, FRAMES_IN_FLIGHT);
+        CommandBuffer primary(reinterpret_cast<VkCommandPool>(next_pool.fetch_add(1)));
+        for (const unsigned int draw_count : DRAW_COUNTS)
+        {
+            // The first record of each frame in flight grows its buffers; the samples after it reuse them.
+            const double record_ns = Bench::best_ns(RECORDS, [&](unsigned int i) {
+                recorder->begin_frame(i % FRAMES_IN_FLIGHT);
+                recorder->record(primary, target, draw_count, record_draws, commands.data());
+            });
+            Log::info("%u workers, %u draws in %u batches: %f us per record, %f ns per draw", worker_count,
+                      draw_count, ParallelRecorder::get_batch_count(draw_count, worker_count + 1),
+                      Bench::round2(record_ns / 1000.0), Bench::round2(record_ns / draw_count));
+        }
+        delete recorder;
+    }
+    return 0;
+}
@@ -0,0 +1,34 @@
+// LunaBenchProfiler: what a profile scope costs the thread it times.
+//
+//     LunaBenchProfiler
+//
+// Times empty scopes with no capture running and while capturing, against one time_ticks() read on its own. A
+// captured scope reads the clock at each end, so what the profiler itself adds is the captured time less two
+// reads. Each sample starts a new capture and stays under PROFILER_EVENTS_PER_THREAD, so no event is dropped.
+#include "bench.h"
+#include <platform/profiler.h>
+
+using namespace LunaVoxelEngine;
+
+constexpr unsigned int SCOPES = Platform::PROFILER_EVENTS_PER_THREAD - 1;
+
+int main()
+{
+    const double ticks_ns = Bench::best_ns(SCOPES, [](unsigned int) { Bench::keep(Platform::time_ticks()); });
+    const double idle_ns = Bench::best_ns(SCOPES, [](unsigned int) {
+        const Platform::ProfileScope scope("idle");
+    });
+    const double capture_ns = Bench::best_ns(SCOPES, [](unsigned int i) {
+        if (i == 0)
+        {
+            Platform::profiler_begin_capture();
+        }
+        const Platform::ProfileScope scope("captured");
+    });
+    Platform::profiler_end_capture();
+
+    Log::info("time_ticks() %f ns; scope without a capture %f ns, capturing %f ns", Bench::round2(ticks_ns),
+              Bench::round2(idle_ns), Bench::round2(capture_ns));
+    Log::info("capturing, less two clock reads: %f ns per scope", Bench::round2(capture_ns - 2 * ticks_ns));
+    return 0;
+}
@@ -0,0 +1,75 @@
+// LunaBenchString: what handing a log call its format costs, before and after the logger took StringViews.
+//
+//     LunaBenchString
+//
+// Uses the ten formats Runtime::Update logs every FrameStats::WINDOW frames. Before, each literal was converted to
+// the UTF-16 Utils::String the logger took, then back to UTF-8 through throw_away(); now it is wrapped in a
+// StringView. Only that handoff is timed: formatting and writing the line are the same either way. Allocations are
+// counted by the memory manager that operator new goes through.
+#include "bench.h"
+#include <utils/string.h>
+#include <utils/string_view.h>
+
+using namespace LunaVoxelEngine;
+
+constexpr unsigned int REPORTS = 10000;
+
+static const char *const FORMATS[] = {
+    "Frame time over %u frames (us): min %llu, avg %llu, p99 %llu, max %llu",
+    "Frame wait (us, %u in flight): avg %llu, p99 %llu, max %llu",
+    "GPU heap %u (MB): %llu of %llu in blocks, usage %llu, budget %llu",
+    "Staging: %llu of %llu KB in use, last flush %llu KB in %u regions",
+    "Timeline: graphics at %llu, uploads at %llu, %lu deletions pending",
+    "Pipelines: %u of %u compiled, %llu requests reused, longest compile %llu us",
+    "Bindless: %u of %u textures, %u of %u buffers",
+    "Chunks: %u, culled on the %s, arenas %llu of %llu KB vertices, %llu of %llu KB indices",
+    "Culling: %u of %u chunks drawn, %u%% culled (%u by frustum, %u by occlusion), occlusion %s",
+    "Draw recording (us, %u threads, %u calls): avg %llu, p99 %llu, max %llu",
+};
+constexpr unsigned int FORMAT_COUNT = sizeof(FORMATS) / sizeof(FORMATS[0]);
+
+/// The old logger signature: the literal became a Utils::String at the call, and the logger converted it back.
+static unsigned long before(const Utils::String &format) noexcept
+{
+    const auto utf8 = format.throw_away();
+    return static_cast<unsigned long>(utf8.size()) + static_cast<unsigned char>(utf8.c_str()[0]);
+}
+
+static unsigned long after(Utils::StringView format) noexcept
+{
+    return format.size() + static_cast<unsigned char>(format[0]);
+}
+
+static size_t allocations() noexcept
+{
+    return Platform::MemoryManager::get_instance().get_allocation_count();
+}
+
+int main()
+{
+    const size_t before_start = allocations();
+    const double before_ns = Bench::best_ns(REPORTS, [](unsigned int) {
+        for (const char *format : FORMATS)
+        {
+            Bench::keep(before(format));
+        }
+    });
+    const double before_allocations =
+        static_cast<double>(allocations() - before_start) / (REPORTS * Bench::DEFAULT_SAMPLES);
+
+    const size_t after_start = allocations();
+    const double after_ns = Bench::best_ns(REPORTS, [](unsigned int) {
+        for (const char *format : FORMATS)
+        {
+            Bench::keep(after(format));
+        }
+    });
+    const double after_allocations =
+        static_cast<double>(allocations() - after_start) / (REPORTS * Bench::DEFAULT_SAMPLES);
+
+    Log::info("one stats report, %u formats:", FORMAT_COUNT);
+    Log::info("  Utils::String + throw_away(): %f ns, %f allocations", Bench::round2(before_ns),
+              Bench::round2(before_allocations));
+    Log::info("  StringView: %f ns, %f allocations", Bench::round2(after_ns), Bench::round2(after_allocations));
+    return 0;
+}
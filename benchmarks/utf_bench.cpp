@@ -0,0 +1,106 @@
+// LunaBenchUtf: UTF-8 validation and UTF-8 <-> UTF-16 transcoding throughput.
+//
+//     LunaBenchUtf
+//
+// Runs on a 4 MiB ASCII-heavy corpus (English-like text, about 1% two-byte letters) and a 4 MiB CJK-heavy one
+// (three-byte ideographs, about 10% ASCII spaces and punctuation). Throughput is in GB of UTF-8 per second for
+// every direction, so the numbers compare across directions.
+#include "bench.h"
+#include <utils/utf.h>
+
+using namespace LunaVoxelEngine;
+
+constexpr unsigned long CORPUS_BYTES = 4ul << 20;
+constexpr unsigned int ITERATIONS = 20;
+
+static unsigned long encode_utf8(unsigned int code_point, char *out) noexcept
+{
+    if (code_point < 0x80)
+    {
+        out[0] = static_cast<char>(code_point);
+        return 1;
+    }
+    if (code_point < 0x800)
+    {
+        out[0] = static_cast<char>(0xC0 | (code_point >> 6));
+        out[1] = static_cast<char>(0x80 | (code_point & 0x3F));
+        return 2;
+    }
+    out[0] = static_cast<char>(0xE0 | (code_point >> 12));
+    out[1] = static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+    out[2] = static_cast<char>(0x80 | (code_point & 0x3F));
+    return 3;
+}
+
+/**
+ * @brief Fills text with up to CORPUS_BYTES of UTF-8 and returns its length.
+ * @param cjk Whether most characters are ideographs rather than ASCII letters.
+ */
+static unsigned long build_corpus(char *text, bool cjk) noexcept
+{
+    Bench::Random random;
+    unsigned long length = 0;
+    while (length + 4 <= CORPUS_BYTES)
+    {
+        const unsigned int roll = random.below(100);
+        unsigned int code_point;
+        if (cjk)
+        {
+            code_point = roll < 10 ? (roll < 7 ? ' ' : '.') : 0x4E00 + random.below(0x5200);
+        }
+        else
+        {
+            code_point = roll == 0 ? 0xE0 + random.below(0x20) : roll < 16 ? ' ' : 'a' + random.below(26);
+        }
+        length += encode_utf8(code_point, text + length);
+    }
+    return length;
+}
+
+static void run_corpus(const char *name, bool cjk) noexcept
+{
+    char *utf8 = new char[CORPUS_BYTES];
+    const unsigned long utf8_length = build_corpus(utf8, cjk);
+    const long utf16_length = Utils::utf8_to_utf16_length(utf8, utf8_length);
+    if (utf16_length < 0)
+    {
+        Log::fatal("The %s corpus is not valid UTF-8", name);
+    }
+    unsigned short *utf16 = new unsigned short[utf16_length];
+    char *round_trip = new char[utf8_length];
+
+    const double validate_ns = Bench::best_ns(ITERATIONS, [&](unsigned int) {
+        Bench::keep(Utils::utf8_validate(utf8, utf8_length));
+    });
+    // Transcoding alone; callers size the output with the _length() functions first, which costs about as much
+    // as validate.
+    const double to_utf16_ns = Bench::best_ns(ITERATIONS, [&](unsigned int) {
+        Bench::keep(Utils::utf8_to_utf16(utf8, utf8_length, utf16));
+    });
+    const double to_utf8_ns = Bench::best_ns(ITERATIONS, [&](unsigned int) {
+        Bench::keep(Utils::utf16_to_utf8(utf16, utf16_length, round_trip));
+    });
+    for (unsigned long i = 0; i < utf8_length; ++i)
+    {
+        if (round_trip[i] != utf8[i])
+        {
+            Log::fatal("The %s corpus did not survive the round trip at byte %lu", name, i);
+        }
+    }
+
+    // Bytes per nanosecond is GB per second.
+    const double bytes = static_cast<double>(utf8_length);
+    Log::info("%s (%lu KiB, %s): validate %f GB/s, utf8->16 %f GB/s, utf16->8 %f GB/s", name, utf8_length >> 10,
+              Bench::SIMD_LEVEL, Bench::round2(bytes / validate_ns), Bench::round2(bytes / to_utf16_ns),
+              Bench::round2(bytes / to_utf8_ns));
+    delete[] round_trip;
+    delete[] utf16;
+    delete[] utf8;
+}
+
+int main()
+{
+    run_corpus("ascii", false);
+    run_corpus("cjk", true);
+    return 0;
+}
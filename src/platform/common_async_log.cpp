@@ -0,0 +1,448 @@
+#include <platform/common_binary_log.h>
+#include <platform/common_crash_log.h>
+#include <platform/common_log.h>
+#include <platform/log.h>
+#include <platform/thread.h>
+#include <utils/algorithm.h>
+#include <utils/atomic.h>
+#include <utils/new.h>
+
+namespace LunaVoxelEngine::Log
+{
+namespace
+{
+/**
+ * Single-producer/single-consumer byte ring owned by one logging thread. Records are stored as raw text with
+ * no framing (every record ends in '\n'), so the consumer can hand a whole readable region to the sink as at
+ * most two slices. head and tail are running byte counts; their difference is the fill level.
+ */
+struct ThreadRing
+{
+    char *data;
+    unsigned long mask;
+    ThreadRing *next;
+    alignas(64) Utils::Atomic<unsigned long> head;
+    unsigned long cached_tail; ///< Producer's last view of tail, so the fast path touches no shared line.
+    alignas(64) Utils::Atomic<unsigned long> tail;
+};
+
+constexpr unsigned int MAX_RINGS_PER_PASS = 32;
+constexpr size_t FATAL_DRAIN_TIMEOUT_MS = 100;
+
+Utils::Atomic<ThreadRing *> rings;
+Utils::Atomic<unsigned int> running;
+Utils::Atomic<unsigned int> stop_requested;
+Utils::Atomic<unsigned int> active_producers;
+Utils::Atomic<unsigned long> dropped;
+AsyncConfig config;
+Platform::Thread *writer = nullptr;
+// Serialises consumers: the writer thread, flush() and the fatal path.
+Platform::Mutex drain_mutex;
+
+thread_local ThreadRing *local_ring = nullptr;
+
+// Writer-side staging for the deferred and binary encodings, whose ring contents cannot go to the sink as-is.
+// Only touched with drain_mutex held.
+constexpr size_t OUTPUT_SIZE = 64 * 1024;
+char output[OUTPUT_SIZE];
+size_t output_len = 0;
+// Never destroyed, like the intern pool: static destructors in other files may run after the memory manager's.
+alignas(FormatDictionary) unsigned char dictionary_storage[sizeof(FormatDictionary)];
+FormatDictionary &dictionary = *new (dictionary_storage) FormatDictionary();
+
+unsigned long round_up_pow2(unsigned long value)
+{
+    unsigned long result = 4096;
+    while (result < value)
+    {
+        result <<= 1;
+    }
+    return result;
+}
+
+ThreadRing *register_ring()
+{
+    unsigned long size = round_up_pow2(config.ring_size);
+    ThreadRing *ring = new ThreadRing();
+    ring->data = new char[size];
+    ring->mask = size - 1;
+    ring->head.store(0, Utils::MemoryOrder::RELAXED);
+    ring->tail.store(0, Utils::MemoryOrder::RELAXED);
+    ring->cached_tail = 0;
+    // Rings are never unlinked: the engine has no thread-exit hook, and the consumer may be reading one.
+    ThreadRing *list_head = rings.load(Utils::MemoryOrder::RELAXED);
+    do
+    {
+        ring->next = list_head;
+    } while (!rings.compare_exchange(list_head, ring, Utils::MemoryOrder::RELEASE));
+    local_ring = ring;
+    return ring;
+}
+
+void write_sync(const LineBuffer &line)
+{
+    const LogSlice slice{line.data, line.len};
+    sink_write(&slice, 1);
+}
+
+void output_flush()
+{
+    if (output_len > 0)
+    {
+        const LogSlice slice{output, output_len};
+        sink_write(&slice, 1);
+        output_len = 0;
+    }
+}
+
+void output_append(const void *data, size_t len)
+{
+    if (output_len + len > OUTPUT_SIZE)
+    {
+        output_flush();
+        if (len > OUTPUT_SIZE)
+        {
+            const LogSlice slice{static_cast<const char *>(data), len};
+            sink_write(&slice, 1);
+            return;
+        }
+    }
+    Utils::memcpy(output + output_len, data, len);
+    output_len += len;
+}
+
+void ring_read(const ThreadRing *ring, unsigned long pos, void *dst, unsigned long len)
+{
+    const unsigned long capacity = ring->mask + 1;
+    const unsigned long offset = pos & ring->mask;
+    const unsigned long first = Utils::min(len, capacity - offset);
+    Utils::memcpy(dst, ring->data + offset, first);
+    Utils::memcpy(static_cast<char *>(dst) + first, ring->data, len - first);
+}
+
+/**
+ * Formats (deferred) or re-frames (binary) one ring record into the output buffer. The first record with a new
+ * format ID parses its text and, in binary mode, emits a FORMAT entry ahead of it.
+ */
+void emit_record(const unsigned char *record)
+{
+    RingRecord header;
+    Utils::memcpy(&header, record, sizeof(header));
+    const Utils::FormatView *format = dictionary.find(header.entry.format_id);
+    if (format == nullptr)
+    {
+        format = dictionary.insert(header.entry.format_id, header.format_text, header.format_length, false);
+        if (format == nullptr)
+        {
+            return;
+        }
+        if (config.encoding == LogEncoding::ENCODING_BINARY)
+        {
+            static constexpr char PADDING[8] = {};
+            const BinaryEntry entry{static_cast<unsigned int>(sizeof(BinaryEntry) + binary_align(format->length)),
+                                    BinaryEntryKind::ENTRY_FORMAT, Level::LOG_TRACE,
+                                    static_cast<unsigned short>(format->length), header.entry.format_id};
+            output_append(&entry, sizeof(entry));
+            output_append(format->text, format->length);
+            output_append(PADDING, binary_align(format->length) - format->length);
+        }
+    }
+
+    const unsigned char *payload = record + sizeof(RingRecord);
+    const size_t payload_size = header.entry.size - sizeof(RingRecord);
+    if (config.encoding == LogEncoding::ENCODING_DEFERRED)
+    {
+        Utils::FormatArg args[MAX_BINARY_SEGMENTS];
+        if (decode_args(payload, payload_size, *format, header.entry.info, args))
+        {
+            LineBuffer line;
+            format_line(line, header.entry.level, *format, args);
+            output_append(line.data, line.len);
+        }
+        return;
+    }
+    BinaryEntry entry = header.entry;
+    entry.size = static_cast<unsigned int>(sizeof(BinaryEntry) + payload_size);
+    output_append(&entry, sizeof(entry));
+    output_append(payload, payload_size);
+}
+
+/**
+ * Writes a record produced outside the rings (the dropped-record report, the fatal record) in the current
+ * encoding. The caller must hold drain_mutex.
+ */
+void write_direct(Level level, const Utils::FormatView &format, const Utils::FormatArg *args)
+{
+    if (config.encoding == LogEncoding::ENCODING_TEXT)
+    {
+        LineBuffer line;
+        format_line(line, level, format, args);
+        write_sync(line);
+        return;
+    }
+    alignas(8) unsigned char record[BUFFER_SIZE];
+    encode_record(record, sizeof(record), level, format, args);
+    emit_record(record);
+    output_flush();
+}
+
+// Text rings hold finished lines, so their readable regions go to the sink directly.
+bool drain_text()
+{
+    bool wrote = false;
+    LogSlice slices[MAX_RINGS_PER_PASS * 2];
+    ThreadRing *owners[MAX_RINGS_PER_PASS];
+    unsigned long heads[MAX_RINGS_PER_PASS];
+
+    ThreadRing *ring = rings.load(Utils::MemoryOrder::ACQUIRE);
+    while (ring != nullptr)
+    {
+        unsigned int slice_count = 0;
+        unsigned int owner_count = 0;
+        for (; ring != nullptr && owner_count < MAX_RINGS_PER_PASS; ring = ring->next)
+        {
+            unsigned long head = ring->head.load(Utils::MemoryOrder::ACQUIRE);
+            unsigned long tail = ring->tail.load(Utils::MemoryOrder::RELAXED);
+            if (head == tail)
+            {
+                continue;
+            }
+            unsigned long capacity = ring->mask + 1;
+            unsigned long offset = tail & ring->mask;
+            unsigned long available = head - tail;
+            unsigned long first = Utils::min(available, capacity - offset);
+            slices[slice_count++] = LogSlice{ring->data + offset, first};
+            if (first < available)
+            {
+                slices[slice_count++] = LogSlice{ring->data, available - first};
+            }
+            owners[owner_count] = ring;
+            heads[owner_count++] = head;
+        }
+        if (slice_count > 0)
+        {
+            sink_write(slices, slice_count);
+            for (unsigned int i = 0; i < owner_count; ++i)
+            {
+                owners[i]->tail.store(heads[i], Utils::MemoryOrder::RELEASE);
+            }
+            wrote = true;
+        }
+    }
+    return wrote;
+}
+
+// Deferred and binary rings hold framed records, which are copied out one at a time.
+bool drain_records()
+{
+    bool wrote = false;
+    alignas(8) unsigned char record[BUFFER_SIZE];
+    for (ThreadRing *ring = rings.load(Utils::MemoryOrder::ACQUIRE); ring != nullptr; ring = ring->next)
+    {
+        const unsigned long head = ring->head.load(Utils::MemoryOrder::ACQUIRE);
+        unsigned long tail = ring->tail.load(Utils::MemoryOrder::RELAXED);
+        if (head == tail)
+        {
+            continue;
+        }
+        while (tail != head)
+        {
+            unsigned int size;
+            ring_read(ring, tail, &size, sizeof(size));
+            ring_read(ring, tail, record, size);
+            emit_record(record);
+            tail += size;
+        }
+        // Everything up to tail has been copied into the output buffer, so the producer may reuse it.
+        ring->tail.store(tail, Utils::MemoryOrder::RELEASE);
+        wrote = true;
+    }
+    output_flush();
+    return wrote;
+}
+
+/**
+ * Writes out everything published to every ring so far. The caller must hold drain_mutex.
+ * Returns true if anything was written.
+ */
+bool drain_once()
+{
+    bool wrote = config.encoding == LogEncoding::ENCODING_TEXT ? drain_text() : drain_records();
+    unsigned long lost = dropped.exchange(0, Utils::MemoryOrder::RELAXED);
+    if (lost > 0)
+    {
+        static constexpr Utils::FormatString<unsigned long> DROPPED_FORMAT("dropped %lu log records (ring full)");
+        const Utils::FormatArg arg = Utils::make_format_arg(lost);
+        write_direct(Level::LOG_WARN, DROPPED_FORMAT.view(), &arg);
+        wrote = true;
+    }
+    return wrote;
+}
+
+bool push(ThreadRing *ring, const char *data, unsigned long len)
+{
+    const unsigned long capacity = ring->mask + 1;
+    const unsigned long head = ring->head.load(Utils::MemoryOrder::RELAXED);
+    while (capacity - (head - ring->cached_tail) < len)
+    {
+        ring->cached_tail = ring->tail.load(Utils::MemoryOrder::ACQUIRE);
+        if (capacity - (head - ring->cached_tail) >= len)
+        {
+            break;
+        }
+        if (config.overflow == OverflowPolicy::OVERFLOW_DROP)
+        {
+            return false;
+        }
+        // Blocking: help drain rather than wait on the writer thread, which might be mid-write or stopping.
+        if (drain_mutex.try_lock() == Platform::ThreadError::THREAD_SUCCESS)
+        {
+            drain_once();
+            drain_mutex.unlock();
+        }
+        else
+        {
+            Platform::Thread::yield();
+        }
+    }
+
+    const unsigned long offset = head & ring->mask;
+    const unsigned long first = Utils::min(len, capacity - offset);
+    Utils::memcpy(ring->data + offset, data, first);
+    Utils::memcpy(ring->data, data + first, len - first);
+    ring->head.store(head + len, Utils::MemoryOrder::RELEASE);
+    return true;
+}
+
+size_t writer_main(void *)
+{
+    while (stop_requested.load(Utils::MemoryOrder::ACQUIRE) == 0)
+    {
+        bool wrote;
+        {
+            Platform::GuardLock guard(drain_mutex);
+            wrote = drain_once();
+        }
+        if (!wrote)
+        {
+            Platform::Thread::sleep(config.idle_sleep_ms);
+        }
+    }
+    return 0;
+}
+} // namespace
+
+void start_async(const AsyncConfig &new_config) noexcept
+{
+    if (running.load(Utils::MemoryOrder::ACQUIRE) != 0)
+    {
+        return;
+    }
+    config = new_config;
+    {
+        Platform::GuardLock guard(drain_mutex);
+        // Restarting may switch encodings, so every format is re-announced in the new stream.
+        dictionary.clear();
+        if (config.encoding == LogEncoding::ENCODING_BINARY)
+        {
+            const LogSlice magic{BINARY_LOG_MAGIC, sizeof(BINARY_LOG_MAGIC)};
+            sink_write(&magic, 1);
+        }
+    }
+    stop_requested.store(0, Utils::MemoryOrder::RELAXED);
+    writer = new Platform::Thread(writer_main, nullptr);
+    running.store(1, Utils::MemoryOrder::RELEASE);
+}
+
+void stop_async() noexcept
+{
+    if (running.exchange(0) == 0)
+    {
+        return;
+    }
+    // Producers that saw running == 1 may still be copying into their rings; let them finish.
+    while (active_producers.load(Utils::MemoryOrder::ACQUIRE) != 0)
+    {
+        Platform::Thread::yield();
+    }
+    stop_requested.store(1, Utils::MemoryOrder::RELEASE);
+    writer->wait();
+    delete writer;
+    writer = nullptr;
+    Platform::GuardLock guard(drain_mutex);
+    drain_once();
+    // Later records are written synchronously, which is always text.
+    config.encoding = LogEncoding::ENCODING_TEXT;
+}
+
+void flush() noexcept
+{
+    if (running.load(Utils::MemoryOrder::ACQUIRE) == 0)
+    {
+        return;
+    }
+    // Once the lock is held, every record published before this call is visible to a single pass.
+    Platform::GuardLock guard(drain_mutex);
+    drain_once();
+}
+
+void submit_record(Level level, const Utils::FormatView &format, const Utils::FormatArg *args) noexcept
+{
+    // Sequentially consistent against the exchange in stop_async(): either it sees this producer or this producer
+    // sees the writer stopped.
+    active_producers.fetch_add(1);
+    if (running.load() == 0)
+    {
+        active_producers.fetch_sub(1, Utils::MemoryOrder::RELEASE);
+        LineBuffer line;
+        format_line(line, level, format, args);
+        crash_log_append(line.data, line.len);
+        write_sync(line);
+        return;
+    }
+    ThreadRing *ring = local_ring != nullptr ? local_ring : register_ring();
+    bool pushed;
+    if (config.encoding == LogEncoding::ENCODING_TEXT)
+    {
+        LineBuffer line;
+        format_line(line, level, format, args);
+        crash_log_append(line.data, line.len);
+        pushed = push(ring, line.data, line.len);
+    }
+    else
+    {
+        if (crash_log_active())
+        {
+            LineBuffer line;
+            format_line(line, level, format, args);
+            crash_log_append(line.data, line.len);
+        }
+        alignas(8) unsigned char record[BUFFER_SIZE];
+        const size_t size = encode_record(record, sizeof(record), level, format, args);
+        pushed = push(ring, reinterpret_cast<const char *>(record), size);
+    }
+    if (!pushed)
+    {
+        dropped.fetch_add(1, Utils::MemoryOrder::RELAXED);
+    }
+    active_producers.fetch_sub(1, Utils::MemoryOrder::RELEASE);
+}
+
+void flush_with(const Utils::FormatView &format, const Utils::FormatArg *args) noexcept
+{
+    LineBuffer line;
+    format_line(line, Level::LOG_FATAL, format, args);
+    // Into the crash log first, since draining below can take a while.
+    crash_log_append(line.data, line.len);
+    // Bounded, in case the fatal error was raised while this thread already held the lock.
+    if (running.load(Utils::MemoryOrder::ACQUIRE) != 0 &&
+        drain_mutex.lock(FATAL_DRAIN_TIMEOUT_MS) == Platform::ThreadError::THREAD_SUCCESS)
+    {
+        // The lock is never released: the caller terminates the process right after.
+        drain_once();
+        write_direct(Level::LOG_FATAL, format, args);
+        return;
+    }
+    write_sync(line);
+}
+} // namespace LunaVoxelEngine::Log
@@ -0,0 +1,211 @@
+#include <platform/common_binary_log.h>
+#include <utils/algorithm.h>
+
+namespace LunaVoxelEngine
+{
+namespace Log
+{
+size_t encode_record(unsigned char *out, size_t capacity, Level level, const Utils::FormatView &format,
+                     const Utils::FormatArg *args) noexcept
+{
+    // Everything except string bytes has a fixed size, so work out up front how much string data fits.
+    size_t fixed = sizeof(RingRecord);
+    for (unsigned int i = 0; i < format.segment_count; ++i)
+    {
+        const Utils::FormatSpec spec = format.segments[i].spec;
+        fixed += spec == Utils::FormatSpec::NONE ? 0 : (spec == Utils::FormatSpec::STRING ? 16 : 8);
+    }
+    size_t string_budget = capacity > fixed ? capacity - fixed : 0;
+
+    size_t pos = sizeof(RingRecord);
+    unsigned int arg_index = 0;
+    unsigned short float_mask = 0;
+    for (unsigned int i = 0; i < format.segment_count; ++i)
+    {
+        const Utils::FormatSpec spec = format.segments[i].spec;
+        if (spec == Utils::FormatSpec::NONE)
+        {
+            continue;
+        }
+        const Utils::FormatArg &arg = args[arg_index++];
+        if (spec == Utils::FormatSpec::FLOAT && arg.length == sizeof(float) && arg_index <= 16)
+        {
+            float_mask |= static_cast<unsigned short>(1u << (arg_index - 1));
+        }
+        if (spec != Utils::FormatSpec::STRING)
+        {
+            Utils::memcpy(out + pos, &arg.u, 8);
+            pos += 8;
+            continue;
+        }
+        if (arg.s == nullptr)
+        {
+            Utils::memcpy(out + pos, &BINARY_NULL_STRING, 8);
+            pos += 8;
+            continue;
+        }
+        // The extra slot reserved above for each string absorbs its padding.
+        unsigned long long length = arg.length < string_budget ? arg.length : string_budget;
+        string_budget -= length;
+        Utils::memcpy(out + pos, &length, 8);
+        pos += 8;
+        Utils::memcpy(out + pos, arg.s, length);
+        const size_t padded = binary_align(length);
+        Utils::memset(out + pos + length, 0, padded - length);
+        pos += padded;
+    }
+
+    RingRecord header;
+    header.entry.size = static_cast<unsigned int>(pos);
+    header.entry.kind = BinaryEntryKind::ENTRY_RECORD;
+    header.entry.level = level;
+    header.entry.info = float_mask;
+    header.entry.format_id = format.id;
+    header.format_text = format.text;
+    header.format_length = format.length;
+    header.reserved = 0;
+    Utils::memcpy(out, &header, sizeof(header));
+    return pos;
+}
+
+bool decode_args(const unsigned char *payload, size_t payload_size, const Utils::FormatView &format,
+                 unsigned short float_mask, Utils::FormatArg *args) noexcept
+{
+    size_t pos = 0;
+    unsigned int arg_index = 0;
+    for (unsigned int i = 0; i < format.segment_count; ++i)
+    {
+        const Utils::FormatSpec spec = format.segments[i].spec;
+        if (spec == Utils::FormatSpec::NONE)
+        {
+            continue;
+        }
+        if (pos + 8 > payload_size)
+        {
+            return false;
+        }
+        Utils::FormatArg &arg = args[arg_index];
+        Utils::memcpy(&arg.u, payload + pos, 8);
+        pos += 8;
+        if (spec != Utils::FormatSpec::STRING)
+        {
+            arg.length = arg_index < 16 && (float_mask >> arg_index) & 1 ? sizeof(float) : 0;
+            ++arg_index;
+            continue;
+        }
+        ++arg_index;
+        const unsigned long long length = arg.u;
+        if (length == BINARY_NULL_STRING)
+        {
+            arg.s = nullptr;
+            arg.length = 0;
+            continue;
+        }
+        if (length > payload_size - pos)
+        {
+            return false;
+        }
+        arg.s = reinterpret_cast<const char *>(payload + pos);
+        arg.length = static_cast<unsigned long>(length);
+        pos += binary_align(static_cast<unsigned long>(length));
+    }
+    return true;
+}
+
+FormatDictionary::~FormatDictionary()
+{
+    delete[] slots;
+}
+
+const Utils::FormatView *FormatDictionary::find(unsigned long long id) const noexcept
+{
+    if (capacity == 0)
+    {
+        return nullptr;
+    }
+    // IDs are already FNV-1a hashes, so the low bits index the table directly.
+    for (unsigned long i = id & (capacity - 1);; i = (i + 1) & (capacity - 1))
+    {
+        if (slots[i] == nullptr)
+        {
+            return nullptr;
+        }
+        if (slots[i]->id == id)
+        {
+            return slots[i];
+        }
+    }
+}
+
+const Utils::FormatView *FormatDictionary::insert(unsigned long long id, const char *text, unsigned int length,
+                                                  bool copy_text)
+{
+    Utils::FormatSegment parsed[MAX_BINARY_SEGMENTS];
+    unsigned int segment_count = 0;
+    if (Utils::parse_format(text, length, parsed, MAX_BINARY_SEGMENTS, segment_count) !=
+        Utils::FormatParseError::NONE)
+    {
+        return nullptr;
+    }
+    if ((count + 1) * 2 > capacity)
+    {
+        grow();
+    }
+
+    Utils::FormatSegment *segments = arena.allocate_array<Utils::FormatSegment>(segment_count);
+    Utils::memcpy(segments, parsed, segment_count * sizeof(Utils::FormatSegment));
+    Utils::FormatView *view = arena.allocate_array<Utils::FormatView>(1);
+    view->text = copy_text ? arena.copy_string(text, length) : text;
+    view->segments = segments;
+    view->segment_count = segment_count;
+    view->arg_count = Utils::count_conversions(parsed, segment_count);
+    view->length = length;
+    view->id = id;
+
+    unsigned long i = id & (capacity - 1);
+    while (slots[i] != nullptr && slots[i]->id != id)
+    {
+        i = (i + 1) & (capacity - 1);
+    }
+    if (slots[i] == nullptr)
+    {
+        ++count;
+    }
+    slots[i] = view;
+    return view;
+}
+
+void FormatDictionary::clear() noexcept
+{
+    if (slots != nullptr)
+    {
+        Utils::memset(slots, 0, capacity * sizeof(Utils::FormatView *));
+    }
+    count = 0;
+    arena.reset();
+}
+
+void FormatDictionary::grow()
+{
+    const unsigned long new_capacity = capacity == 0 ? 256 : capacity * 2;
+    Utils::FormatView **new_slots = new Utils::FormatView *[new_capacity];
+    Utils::memset(new_slots, 0, new_capacity * sizeof(Utils::FormatView *));
+    for (unsigned long i = 0; i < capacity; ++i)
+    {
+        if (slots[i] == nullptr)
+        {
+            continue;
+        }
+        unsigned long j = slots[i]->id & (new_capacity - 1);
+        while (new_slots[j] != nullptr)
+        {
+            j = (j + 1) & (new_capacity - 1);
+        }
+        new_slots[j] = slots[i];
+    }
+    delete[] slots;
+    slots = new_slots;
+    capacity = new_capacity;
+}
+} // namespace Log
+} // namespace LunaVoxelEngine
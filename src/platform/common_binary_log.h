@@ -0,0 +1,107 @@
+#ifndef COMMON_BINARY_LOG_H
+#define COMMON_BINARY_LOG_H
+#include <platform/log.h>
+#include <utils/arena.h>
+#include <utils/cdef.h>
+namespace LunaVoxelEngine
+{
+namespace Log
+{
+/*
+ * Binary log stream (LogEncoding::ENCODING_BINARY). Fields are native-endian and every entry is 8-byte aligned:
+ *
+ *   BINARY_LOG_MAGIC                 at the start, and again whenever binary logging is restarted
+ *   BinaryEntry + payload ...        a FORMAT entry precedes the first RECORD that uses its ID
+ *
+ * FORMAT payload: the format text, zero padded. RECORD payload: one 8-byte slot per conversion holding the
+ * FormatArg bits, except %s, which stores a u64 length (BINARY_NULL_STRING for null) followed by the bytes,
+ * zero padded. The format text alone therefore says how to read a record; the entry's info field only adds
+ * which %f arguments were floats, so they print at single precision.
+ */
+constexpr char BINARY_LOG_MAGIC[8] = {'L', 'V', 'L', 'O', 'G', 'B', '0', '1'};
+constexpr unsigned long long BINARY_NULL_STRING = ~0ULL;
+/// Upper bound on segments in a format read back at runtime; compile-time formats are far smaller.
+constexpr unsigned int MAX_BINARY_SEGMENTS = 64;
+
+enum class BinaryEntryKind : unsigned char
+{
+    ENTRY_FORMAT = 1,
+    ENTRY_RECORD = 2
+};
+
+struct BinaryEntry
+{
+    unsigned int size; ///< Whole entry including this header; a multiple of 8.
+    BinaryEntryKind kind;
+    Level level;
+    unsigned short info; ///< FORMAT: text length in bytes. RECORD: bit i set if conversion i (< 16) is a float.
+    unsigned long long format_id;
+};
+
+/**
+ * @brief A RECORD as stored in the per-thread rings: the entry plus where the writer can find the format text
+ *        the first time it sees the ID. Here entry.size covers the whole RingRecord.
+ */
+struct RingRecord
+{
+    BinaryEntry entry;
+    const char *format_text;
+    unsigned int format_length;
+    unsigned int reserved;
+};
+
+constexpr unsigned long binary_align(unsigned long size) noexcept
+{
+    return (size + 7) & ~7UL;
+}
+
+/**
+ * @brief Encodes a record in ring layout. Strings are truncated so that the record fits in capacity.
+ * @return The record size, a multiple of 8.
+ */
+size_t encode_record(unsigned char *out, size_t capacity, Level level, const Utils::FormatView &format,
+                     const Utils::FormatArg *args) noexcept;
+
+/**
+ * @brief Rebuilds the arguments of a RECORD payload for format. Strings point into payload.
+ * @param float_mask The RECORD entry's info field.
+ * @return false if the payload is too short for format.
+ */
+bool decode_args(const unsigned char *payload, size_t payload_size, const Utils::FormatView &format,
+                 unsigned short float_mask, Utils::FormatArg *args) noexcept;
+
+/**
+ * @class FormatDictionary
+ * @brief Format ID to parsed format, for readers that only have the text: the writer thread and the decoder.
+ * @warning Not thread-safe.
+ */
+class FormatDictionary final
+{
+  public:
+    FormatDictionary() noexcept = default;
+    ~FormatDictionary();
+    FormatDictionary(const FormatDictionary &) = delete;
+    FormatDictionary &operator=(const FormatDictionary &) = delete;
+
+    [[nodiscard]] const Utils::FormatView *find(unsigned long long id) const noexcept;
+
+    /**
+     * @brief Parses text and stores it under id, replacing any previous entry.
+     * @param copy_text Copy the text into the dictionary; otherwise it must outlive the dictionary.
+     * @return The parsed format, or null if text is not a valid format string.
+     */
+    const Utils::FormatView *insert(unsigned long long id, const char *text, unsigned int length, bool copy_text);
+
+    void clear() noexcept;
+
+  private:
+    Utils::Arena arena;
+    Utils::FormatView **slots = nullptr;
+    unsigned long capacity = 0;
+    unsigned long count = 0;
+
+    void grow();
+};
+} // namespace Log
+} // namespace LunaVoxelEngine
+#endif
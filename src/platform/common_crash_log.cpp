@@ -0,0 +1,83 @@
+#include <platform/common_crash_log.h>
+#include <platform/log.h>
+#include <utils/algorithm.h>
+
+namespace LunaVoxelEngine::Log
+{
+namespace
+{
+constexpr char SESSION_MARKER[] = "LUNAVOXEL - INFO: ---- crash log session start ----\n";
+
+CrashLogHeader *header = nullptr;
+char *data = nullptr;
+size_t mapped_size = 0;
+} // namespace
+
+bool open_crash_log(const char *path, unsigned long size) noexcept
+{
+    close_crash_log();
+    unsigned long long capacity = 4096;
+    while (capacity < size)
+    {
+        capacity <<= 1;
+    }
+    const size_t map_size = sizeof(CrashLogHeader) + capacity;
+    void *mapped = map_file(path, map_size);
+    if (mapped == nullptr)
+    {
+        return false;
+    }
+    CrashLogHeader *mapped_header = static_cast<CrashLogHeader *>(mapped);
+    // A log left by an earlier run is kept and appended to: it may hold the crash being investigated.
+    if (Utils::memcmp(mapped_header->magic, CRASH_LOG_MAGIC, sizeof(CRASH_LOG_MAGIC)) != 0 ||
+        mapped_header->capacity != capacity)
+    {
+        Utils::memset(mapped, 0, sizeof(CrashLogHeader));
+        mapped_header->capacity = capacity;
+        Utils::memcpy(mapped_header->magic, CRASH_LOG_MAGIC, sizeof(CRASH_LOG_MAGIC));
+    }
+    header = mapped_header;
+    data = static_cast<char *>(mapped) + sizeof(CrashLogHeader);
+    mapped_size = map_size;
+    crash_log_append(SESSION_MARKER, sizeof(SESSION_MARKER) - 1);
+    return true;
+}
+
+void close_crash_log() noexcept
+{
+    if (header == nullptr)
+    {
+        return;
+    }
+    void *mapped = header;
+    header = nullptr;
+    data = nullptr;
+    unmap_file(mapped, mapped_size);
+    mapped_size = 0;
+}
+
+bool crash_log_active() noexcept
+{
+    return header != nullptr;
+}
+
+void crash_log_append(const char *text, size_t len) noexcept
+{
+    if (header == nullptr)
+    {
+        return;
+    }
+    const unsigned long long capacity = header->capacity;
+    if (len > capacity)
+    {
+        text += len - capacity;
+        len = capacity;
+    }
+    // Writers only contend on this counter; each then owns its byte range for the copy.
+    const unsigned long long start = header->head.fetch_add(len, Utils::MemoryOrder::RELAXED);
+    const size_t offset = start & (capacity - 1);
+    const size_t first = Utils::min(len, static_cast<size_t>(capacity - offset));
+    Utils::memcpy(data + offset, text, first);
+    Utils::memcpy(data, text + first, len - first);
+}
+} // namespace LunaVoxelEngine::Log
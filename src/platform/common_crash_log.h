@@ -0,0 +1,45 @@
+#ifndef COMMON_CRASH_LOG_H
+#define COMMON_CRASH_LOG_H
+#include <utils/atomic.h>
+#include <utils/cdef.h>
+namespace LunaVoxelEngine
+{
+namespace Log
+{
+/*
+ * Crash log file (see open_crash_log()): a CrashLogHeader followed by `capacity` bytes of text used as a ring.
+ * Byte i of the stream lives at data[i % capacity], so the file holds the last `capacity` bytes of output.
+ * Fields are native-endian; the file is meant to be read on the machine that wrote it.
+ */
+constexpr char CRASH_LOG_MAGIC[8] = {'L', 'V', 'C', 'R', 'A', 'S', 'H', '1'};
+
+struct CrashLogHeader
+{
+    char magic[8];
+    unsigned long long capacity; ///< Data bytes after the header; a power of two.
+    /// Bytes ever appended. Advanced before the bytes are copied, so after a crash the last few lines may be torn.
+    Utils::Atomic<unsigned long long> head;
+    unsigned char reserved[40];
+};
+static_assert(sizeof(CrashLogHeader) == 64, "The crash log header is part of the file format");
+
+/**
+ * @brief Whether a crash log is open, so encodings that do not format on the caller know to do it anyway.
+ */
+[[nodiscard]] bool crash_log_active() noexcept;
+
+/**
+ * @brief Copies one finished line into the crash log, if one is open. Plain stores, no system calls.
+ */
+void crash_log_append(const char *text, size_t len) noexcept;
+
+// Implemented per platform.
+/**
+ * @brief Maps path shared and read-write, creating it if needed and resizing it to size bytes.
+ * @return The mapping, or null on failure.
+ */
+void *map_file(const char *path, size_t size) noexcept;
+void unmap_file(void *data, size_t size) noexcept;
+} // namespace Log
+} // namespace LunaVoxelEngine
+#endif
@@ -0,0 +1,110 @@
+#include <platform/frame_loop.h>
+#include <platform/time.h>
+#include <utils/algorithm.h>
+
+namespace LunaVoxelEngine::Platform
+{
+namespace
+{
+constexpr unsigned long long NS_PER_SECOND = 1000000000ULL;
+/// A longer frame (a breakpoint, a window drag) is counted as this long, so the simulation does not race.
+constexpr unsigned long long MAX_FRAME_NS = NS_PER_SECOND / 4;
+} // namespace
+
+void FrameStats::add(unsigned long long frame_ns) noexcept
+{
+    samples[next] = frame_ns;
+    next = (next + 1) % WINDOW;
+    count = Utils::min(count + 1, WINDOW);
+}
+
+FrameTimeSummary FrameStats::summarize() const noexcept
+{
+    FrameTimeSummary summary = {count, 0, 0, 0, 0};
+    if (count == 0)
+    {
+        return summary;
+    }
+    unsigned long long sorted[WINDOW];
+    unsigned long long total = 0;
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        sorted[i] = samples[i];
+        total += samples[i];
+    }
+    Utils::quicksort(sorted, sorted + count, [](unsigned long long a, unsigned long long b) { return a < b; });
+    summary.min_ns = sorted[0];
+    summary.avg_ns = total / count;
+    summary.p99_ns = sorted[(count - 1) * 99 / 100];
+    summary.max_ns = sorted[count - 1];
+    return summary;
+}
+
+FrameLoop::FrameLoop(const FrameLoopConfig &config_in) noexcept
+    : config(config_in)
+    , tick_ns(NS_PER_SECOND / (config_in.tick_rate > 0 ? config_in.tick_rate : 1))
+{
+}
+
+unsigned int FrameLoop::begin_frame() noexcept
+{
+    const unsigned long long now = time_now_ns();
+    if (frames++ == 0)
+    {
+        frame_start_ns = now;
+        return config.lockstep ? 1 : 0;
+    }
+    const unsigned long long elapsed = now - frame_start_ns;
+    frame_start_ns = now;
+    frame_stats.add(elapsed);
+    if (config.lockstep)
+    {
+        // Frame N has always simulated N ticks, so a run of a given length does the same work on any machine.
+        return 1;
+    }
+
+    accumulator_ns += Utils::min(elapsed, MAX_FRAME_NS);
+    unsigned long long ticks = accumulator_ns / tick_ns;
+    if (ticks > config.max_ticks_per_frame)
+    {
+        // Too far behind to catch up: give up the backlog and keep the phase.
+        ticks = config.max_ticks_per_frame;
+        accumulator_ns %= tick_ns;
+    }
+    else
+    {
+        accumulator_ns -= ticks * tick_ns;
+    }
+    return static_cast<unsigned int>(ticks);
+}
+
+void FrameLoop::end_frame() noexcept
+{
+    if (config.frame_cap == 0)
+    {
+        return;
+    }
+    time_wait_until_ns(frame_start_ns + NS_PER_SECOND / config.frame_cap, config.spin_ns);
+}
+
+float FrameLoop::alpha() const noexcept
+{
+    return static_cast<float>(accumulator_ns) / static_cast<float>(tick_ns);
+}
+
+double FrameLoop::tick_seconds() const noexcept
+{
+    return static_cast<double>(tick_ns) / static_cast<double>(NS_PER_SECOND);
+}
+
+void FrameLoop::set_frame_cap(unsigned int frames_per_second) noexcept
+{
+    config.frame_cap = frames_per_second;
+}
+
+void FrameLoop::set_lockstep(bool enabled) noexcept
+{
+    config.lockstep = enabled;
+    accumulator_ns = 0;
+}
+} // namespace LunaVoxelEngine::Platform
@@ -1,243 +1,187 @@
 #include <platform/common_log.h>
 #include <platform/log.h>
 #include <utils/algorithm.h>
-#include <utils/string.h>
+#include <utils/to_chars.h>
 
 namespace LunaVoxelEngine
 {
 namespace Log
 {
-void convert_and_write_string(char *str)
+namespace detail
 {
-    write_str(str, Utils::strlen(str));
-}
+Utils::Atomic<unsigned long long> level_mask{~0ULL};
+} // namespace detail
 
-void convert_and_write_char(char value)
-{
-    write_char(value);
-}
+static_assert(static_cast<unsigned int>(Module::MODULE_COUNT) * 8 <= 64, "Module levels must fit in one word");
 
-void int_to_string(int num, char *str)
+void set_module_level(Module module, Level level) noexcept
 {
-    int is_negative = 0;
-    int i = 0;
-
-    if (num < 0)
-    {
-        is_negative = 1;
-        num = -num;
-    }
-
-    do
+    const unsigned int shift = static_cast<unsigned int>(module) * 8;
+    const unsigned long long bits = (0xFFULL << static_cast<unsigned int>(level)) & 0xFF;
+    unsigned long long expected = detail::level_mask.load(Utils::MemoryOrder::RELAXED);
+    while (!detail::level_mask.compare_exchange(expected, (expected & ~(0xFFULL << shift)) | bits << shift,
+                                                Utils::MemoryOrder::RELAXED))
     {
-        str[i++] = (num % 10) + '0';
-        num /= 10;
-    } while (num > 0);
-
-    if (is_negative)
-    {
-        str[i++] = '-';
     }
+}
 
-    str[i] = '\0';
-    for (int j = 0, k = i - 1; j < k; j++, k--)
+Level get_module_level(Module module) noexcept
+{
+    const unsigned int shift = static_cast<unsigned int>(module) * 8;
+    const unsigned long long bits = detail::level_mask.load(Utils::MemoryOrder::RELAXED) >> shift & 0xFF;
+    unsigned int level = 0;
+    while (level < static_cast<unsigned int>(Level::LOG_FATAL) && (bits >> level & 1) == 0)
     {
-        char temp = str[j];
-        str[j] = str[k];
-        str[k] = temp;
+        ++level;
     }
+    return static_cast<Level>(level);
 }
 
-void float_to_string(float num, char *str)
+ThrottleResult LogThrottle::admit(unsigned long long key) noexcept
 {
-    int int_part = (int)num;
-    float fractional_part = num - int_part;
-    int i = 0;
-    if (int_part == 0)
+    // Fibonacci hashing: the top bits of the product depend on every bit of the key.
+    const unsigned int slot = static_cast<unsigned int>((key * 0x9E3779B97F4A7C15ULL) >> 58) % SLOTS;
+    const unsigned int count = counts[slot].fetch_add(1, Utils::MemoryOrder::RELAXED) + 1;
+    if (count <= burst)
     {
-        str[i++] = '0';
+        return {true, 0};
     }
-    else
+    const unsigned int multiple = count / burst;
+    if (count % burst != 0 || (multiple & (multiple - 1)) != 0)
     {
-        if (int_part < 0)
-        {
-            str[i++] = '-';
-            int_part = -int_part;
-        }
-        int int_str[20], int_len = 0;
-        while (int_part > 0)
-        {
-            int_str[int_len++] = int_part % 10;
-            int_part /= 10;
-        }
-        for (int j = int_len - 1; j >= 0; j--)
-        {
-            str[i++] = int_str[j] + '0';
-        }
+        return {false, 0};
     }
-    str[i++] = '.';
-    fractional_part *= 100;
-    int frac_part = (int)fractional_part;
-    str[i++] = (frac_part / 10) + '0';
-    str[i++] = (frac_part % 10) + '0';
-
-    str[i] = '\0';
+    // The previous allowed occurrence was count / 2.
+    return {true, count - count / 2 - 1};
 }
 
-void convert_and_write_int(int value)
+void LogThrottle::reset() noexcept
 {
-    unsigned char buffer[1024 * 4];
-    int_to_string(value, (char *)buffer);
-    for (int i = 0; buffer[i] != '\0'; i++)
+    for (Utils::Atomic<unsigned int> &count : counts)
     {
-        write_char(buffer[i]);
+        count.store(0, Utils::MemoryOrder::RELAXED);
     }
 }
 
-void convert_and_write_float(double value)
+// Converts straight into the line when the worst case fits, otherwise via scratch space so the tail truncates.
+template<unsigned long MaxChars, typename Convert> static inline void write_number(LineBuffer &line, Convert convert)
 {
-    unsigned char buffer[1024 * 4];
-    float_to_string(value, (char *)buffer);
-    for (int i = 0; buffer[i] != '\0'; i++)
+    if (BUFFER_SIZE - 1 - line.len >= MaxChars)
     {
-        write_char(buffer[i]);
+        line.len = static_cast<size_t>(convert(line.data + line.len) - line.data);
+        return;
     }
+    char scratch[MaxChars];
+    write_str(line, scratch, static_cast<size_t>(convert(scratch) - scratch));
 }
 
-void convert_and_write_hex(int value)
+void write_prefix(LineBuffer &line, Level level) noexcept
 {
-    // Convert and write the hexadecimal value (implement this yourself)
-    // Example: Use a custom function to convert the integer to a hex string and then call write_str
-    write_str("(Hex value TODO)", 2);
+    static constexpr Utils::StringView PREFIXES[] = {
+        "LUNAVOXEL - TRACE: ", "LUNAVOXEL - DEBUG: ", "LUNAVOXEL - INFO: ",
+        "LUNAVOXEL - WARN: ",  "LUNAVOXEL - ERROR: ", "LUNAVOXEL - FATAL: ",
+    };
+    const Utils::StringView prefix = PREFIXES[static_cast<unsigned char>(level)];
+    write_str(line, prefix.data(), prefix.size());
 }
 
-void print_generic(const char *format, va_list args)
+void write_args(LineBuffer &line, const Utils::FormatView &format, const Utils::FormatArg *args) noexcept
 {
-    unsigned long i = 0;
-    while (format[i] != '\0')
+    unsigned int arg_index = 0;
+    for (unsigned int i = 0; i < format.segment_count; ++i)
     {
-        if (format[i] == '%' && format[i + 1] != '\0')
+        const Utils::FormatSegment &segment = format.segments[i];
+        if (segment.length > 0)
+        {
+            write_str(line, format.text + segment.offset, segment.length);
+        }
+        if (segment.spec == Utils::FormatSpec::NONE)
+        {
+            continue;
+        }
+        const Utils::FormatArg &arg = args[arg_index++];
+        switch (segment.spec)
         {
-            i++;
-            switch (format[i])
+        case Utils::FormatSpec::I32:
+        case Utils::FormatSpec::I64:
+            write_number<Utils::MAX_I64_CHARS>(line, [&](char *out) { return Utils::i64_to_chars(out, arg.i); });
+            break;
+        case Utils::FormatSpec::U32:
+        case Utils::FormatSpec::U64:
+            write_number<Utils::MAX_U64_CHARS>(line, [&](char *out) { return Utils::u64_to_chars(out, arg.u); });
+            break;
+        case Utils::FormatSpec::HEX32:
+            write_number<Utils::MAX_HEX64_CHARS>(
+                line, [&](char *out) { return Utils::hex_to_chars(out, arg.u & 0xFFFFFFFFULL); });
+            break;
+        case Utils::FormatSpec::HEX64:
+            write_number<Utils::MAX_HEX64_CHARS>(line, [&](char *out) { return Utils::hex_to_chars(out, arg.u); });
+            break;
+        case Utils::FormatSpec::FLOAT:
+            write_number<Utils::MAX_FLOAT_CHARS>(line, [&](char *out) {
+                return arg.length == sizeof(float) ? Utils::float_to_chars(out, static_cast<float>(arg.f))
+                                                   : Utils::double_to_chars(out, arg.f);
+            });
+            break;
+        case Utils::FormatSpec::CHAR:
+            write_char(line, static_cast<char>(arg.i));
+            break;
+        case Utils::FormatSpec::STRING:
+            if (arg.s != nullptr)
             {
-            case 'd': {
-                int num = va_arg(args, int);
-                convert_and_write_int(num);
-                break;
-            }
-            case 's': {
-                char *str = va_arg(args, char *);
-                convert_and_write_string(str);
-                break;
-            }
-            case 'c': {
-                char ch = (char)va_arg(args, int);
-                convert_and_write_char(ch);
-                break;
-            }
-            case 'f': {
-                double num = va_arg(args, double);
-                convert_and_write_float(num);
-                break;
-            }
-            case 'x': {
-                int num = va_arg(args, int);
-                convert_and_write_hex(num);
-                break;
-            }
-            case 'z': {
-                if (format[i + 1] == 'u')
-                {
-                    i++;
-                    unsigned long num = va_arg(args, unsigned long);
-                    char buffer[21];
-                    unsigned long index = 20;
-                    do
-                    {
-                        buffer[--index] = (num % 10) + '0';
-                        num /= 10;
-                    } while (num > 0);
-                    buffer[index] = '\0';
-                    write_str(buffer + index, 20 - index);
-                }
-                else
-                {
-                    write_char('%');
-                    write_char(format[i]);
-                }
-                break;
-            }
-            case '%': {
-                write_char('%');
-                break;
-            }
-            default: {
-                write_char('%');
-                write_char(format[i]);
-                break;
+                write_str(line, arg.s, arg.length);
             }
+            else
+            {
+                write_str(line, "(null)", 6);
             }
+            break;
+        case Utils::FormatSpec::POINTER:
+            write_str(line, "0x", 2);
+            write_number<Utils::MAX_HEX64_CHARS>(line, [&](char *out) {
+                return Utils::hex_to_chars(out, reinterpret_cast<unsigned long long>(arg.p));
+            });
+            break;
+        default:
+            break;
         }
-        else
-        {
-            write_char(format[i]);
-        }
-        i++;
     }
 }
 
-void trace(const Utils::String &fmt, ...) noexcept
+void write_str(LineBuffer &line, const char *str, size_t len) noexcept
 {
-    va_list args;
-    auto str = fmt.throw_away();
-    va_start(args, str.c_str());
-    write_str("LUNAVOXEL - TRACE: ", 20);
-    print_generic(str.c_str(), args);
-    write_char('\n');
-    va_end(args);
+    size_t space = BUFFER_SIZE - 1 - line.len;
+    size_t copy_len = len < space ? len : space;
+    Utils::memcpy(line.data + line.len, str, copy_len);
+    line.len += copy_len;
 }
-void debug(const Utils::String &fmt, ...) noexcept
+
+void write_char(LineBuffer &line, const char c) noexcept
 {
-#ifdef DEBUG
-    va_list args;
-    auto str = fmt.throw_away();
-    va_start(args, str.c_str());
-    write_str("LUNAVOXEL - DEBUG: ", 20);
-    print_generic(str.c_str(), args);
-    write_char('\n');
-    va_end(args);
-#endif
+    if (line.len < BUFFER_SIZE - 1)
+    {
+        line.data[line.len++] = c;
+    }
 }
-void info(const Utils::String &fmt, ...) noexcept
+
+void format_line(LineBuffer &line, Level level, const Utils::FormatView &format,
+                 const Utils::FormatArg *args) noexcept
 {
-    va_list args;
-    auto str = fmt.throw_away();
-    va_start(args, str.c_str());
-    write_str("LUNAVOXEL - INFO: ", 20);
-    print_generic(str.c_str(), args);
-    write_char('\n');
-    va_end(args);
+    write_prefix(line, level);
+    write_args(line, format, args);
+    // The last byte is reserved so that a truncated record still ends its line.
+    line.data[line.len++] = '\n';
 }
-void warn(const Utils::String &fmt, ...) noexcept
+
+void write_formatted(Level level, const Utils::FormatView &format, const Utils::FormatArg *args) noexcept
 {
-    va_list args;
-    auto str = fmt.throw_away();
-    va_start(args, str.c_str());
-    write_str("LUNAVOXEL - WARN: ", 20);
-    print_generic(str.c_str(), args);
-    write_char('\n');
-    va_end(args);
+    submit_record(level, format, args);
 }
-void error(const Utils::String &fmt, ...) noexcept
+
+void write_fatal(const Utils::FormatView &format, const Utils::FormatArg *args) noexcept
 {
-    va_list args;
-    auto str = fmt.throw_away();
-    va_start(args, str.c_str());
-    write_str("LUNAVOXEL - ERROR: ", 20);
-    print_generic(str.c_str(), args);
-    write_char('\n');
-    va_end(args);
+    flush_with(format, args);
+    sink_terminate();
 }
 } // namespace Log
 } // namespace LunaVoxelEngine
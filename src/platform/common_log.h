@@ -1,15 +1,60 @@
 #ifndef COMMON_LOG_H
 #define COMMON_LOG_H
+#include <platform/log.h>
 #include <utils/cdef.h>
-#include <cstdarg>
 constexpr auto BUFFER_SIZE = 1024;
 namespace LunaVoxelEngine
 {
-namespace Log 
+namespace Log
 {
-void write_str(const char *str, size_t len) noexcept;
-void write_char(const char c) noexcept;
-void print_generic(const char *format, va_list args);
+/**
+ * @brief One formatted record, built on the caller's stack and then handed to the async rings or the sink.
+ * @details Output past BUFFER_SIZE - 1 bytes is truncated; the final byte is reserved for the newline.
+ */
+struct LineBuffer
+{
+    char data[BUFFER_SIZE];
+    size_t len = 0;
+};
+
+/**
+ * @brief A contiguous run of bytes for the platform sink.
+ */
+struct LogSlice
+{
+    const char *data;
+    size_t len;
+};
+
+void write_str(LineBuffer &line, const char *str, size_t len) noexcept;
+void write_char(LineBuffer &line, const char c) noexcept;
+void write_prefix(LineBuffer &line, Level level) noexcept;
+/**
+ * @brief Walks the precompiled segments of format, writing literal runs and converted arguments.
+ */
+void write_args(LineBuffer &line, const Utils::FormatView &format, const Utils::FormatArg *args) noexcept;
+/**
+ * @brief Formats a complete record (prefix, message and newline) into line.
+ */
+void format_line(LineBuffer &line, Level level, const Utils::FormatView &format,
+                 const Utils::FormatArg *args) noexcept;
+
+/**
+ * @brief Routes one record by the async mode: written synchronously when the async logger is not running,
+ *        otherwise formatted or encoded (see LogEncoding) into the calling thread's ring.
+ */
+void submit_record(Level level, const Utils::FormatView &format, const Utils::FormatArg *args) noexcept;
+/**
+ * @brief Drains every pending record and then writes a FATAL record synchronously.
+ */
+void flush_with(const Utils::FormatView &format, const Utils::FormatArg *args) noexcept;
+
+// Implemented per platform.
+/**
+ * @brief Writes all slices to the log output, retrying partial writes. Safe to call from any thread.
+ */
+void sink_write(const LogSlice *slices, unsigned int count) noexcept;
+[[noreturn]] void sink_terminate() noexcept;
 } // namespace Log
 } // namespace LunaVoxelEngine
 #endif
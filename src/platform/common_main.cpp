@@ -1,126 +1,413 @@
+#include <platform/log.h>
 #include <platform/main.h>
+#include <platform/profiler.h>
+#include <platform/time.h>
 #include <utils/new.h>
 
 namespace LunaVoxelEngine::Platform
 {
-bool Runtime::Init(Utils::Vector<Utils::String> args) noexcept
+constexpr unsigned int DEFAULT_WIDTH = 1280;
+constexpr unsigned int DEFAULT_HEIGHT = 720;
+/// Matches the format the swapchain prefers, so headless runs use the same pipeline.
+constexpr VkFormat OFFSCREEN_FORMAT = VK_FORMAT_B8G8R8A8_SRGB;
+/// There is no camera yet, so world space is clip space.
+constexpr float VIEW_PROJ[16] = {1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f,
+                                 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f};
+
+/**
+ * @brief Adds the test triangle as a chunk, so the chunk draw path has something to draw until the world
+ *        generates meshes.
+ */
+static void add_test_chunk(Renderer::ChunkRenderer *chunks) noexcept
+{
+    // Colors are R8G8B8A8, so red is the low byte.
+    const Renderer::ChunkVertex vertices[3] = {
+        {{0.0f, -0.5f, 0.5f}, 0xFF0000FF}, {{0.5f, 0.5f, 0.5f}, 0xFF00FF00}, {{-0.5f, 0.5f, 0.5f}, 0xFFFF0000}};
+    const unsigned int indices[3] = {0, 1, 2};
+    const float bounds_min[3] = {-0.5f, -0.5f, 0.5f};
+    const float bounds_max[3] = {0.5f, 0.5f, 0.5f};
+    if (chunks->add_chunk(vertices, 3, indices, 3, bounds_min, bounds_max) == Renderer::ChunkRenderer::INVALID_CHUNK)
+    {
+        Log::warn(Log::Module::PLATFORM, "Failed to add the test chunk");
+    }
+}
+
+static VkPresentModeKHR to_vulkan(PresentMode mode) noexcept
+{
+    switch (mode)
+    {
+    case PresentMode::PRESENT_MAILBOX:
+        return VK_PRESENT_MODE_MAILBOX_KHR;
+    case PresentMode::PRESENT_IMMEDIATE:
+        return VK_PRESENT_MODE_IMMEDIATE_KHR;
+    case PresentMode::PRESENT_FIFO:
+        break;
+    }
+    return VK_PRESENT_MODE_FIFO_KHR;
+}
+
+bool Runtime::Init(const Utils::Vector<Utils::StringView> &args) noexcept
 {
-    window = new Window(1280, 720, "LunaVoxelEngine");
-    window->show();
-    device = new Renderer::Device(true);
-    swap_chain = new Renderer::SwapChain(device, window->getVulkanLink());
-    command_buffer = new Renderer::CommandBuffer(nullptr);
+    const unsigned long long settings_start_ns = time_now_ns();
+    settings.parse_args(args);
+    const bool have_config = settings.load_file();
+    Log::debug(Log::Module::PLATFORM, "Settings loaded in %llu us (%s %s)", (time_now_ns() - settings_start_ns) / 1000,
+               settings.config_path(), have_config ? "read" : "not found");
+
+    // --profile <file>: capture the whole run and write it as a Chrome trace on shutdown.
+    if (!settings.get_string(SettingId::PROFILE_PATH).empty())
+    {
+#if !defined(LUNA_PROFILER)
+        Log::warn(Log::Module::PLATFORM, "Built without ENABLE_PROFILER; the trace will be empty");
+#endif
+        Platform::profiler_set_thread_name("main");
+        Platform::profiler_begin_capture();
+    }
+    // --max-fps <n>: cap the render rate; the simulation rate does not change.
+    frame_loop.set_frame_cap(settings.get<unsigned int>(SettingId::MAX_FPS));
+    settings_generation = settings.get_generation();
+    // --headless: no window or swapchain; render offscreen and simulate exactly one tick per frame.
+    headless = settings.get<bool>(SettingId::HEADLESS);
+    const unsigned int frames_in_flight = settings.get<unsigned int>(SettingId::FRAMES_IN_FLIGHT);
+
+    if (headless)
+    {
+        frame_loop.set_lockstep(true);
+        device = new Renderer::Device(true, true);
+        timeline = new Renderer::Timeline("graphics");
+        frames = new Renderer::FrameRing(device, timeline, 0, frames_in_flight);
+        // One target per frame in flight, so a frame never draws over an image the GPU is still writing.
+        for (unsigned int i = 0; i < frames->get_frames_in_flight(); ++i)
+        {
+            offscreen_targets[i] =
+                new Renderer::Image(device, DEFAULT_WIDTH, DEFAULT_HEIGHT, OFFSCREEN_FORMAT,
+                                    VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT);
+        }
+        Log::info(Log::Module::PLATFORM, "Running headless at %ux%u for %u frames", DEFAULT_WIDTH, DEFAULT_HEIGHT,
+                  settings.get<unsigned int>(SettingId::FRAME_LIMIT));
+    }
+    else
+    {
+        window = new Window(DEFAULT_WIDTH, DEFAULT_HEIGHT, "LunaVoxelEngine");
+        window->show();
+        device = new Renderer::Device(true);
+        timeline = new Renderer::Timeline("graphics");
+        swap_chain = new Renderer::SwapChain(device, window->getVulkanLink(),
+                                             to_vulkan(settings.get<PresentMode>(SettingId::PRESENT_MODE)));
+        frames = new Renderer::FrameRing(device, timeline, swap_chain->getImageCount(), frames_in_flight);
+    }
+    // --memory.gpu_budget_mb <n>: warn once a GPU heap passes n MB; 0 leaves the budget to the driver.
+    device->get_allocator()->set_budget_limit(settings.get<unsigned long long>(SettingId::GPU_MEMORY_BUDGET_MB) << 20);
     queue = new Renderer::Queue(device->get_graphics_family_index());
-    Renderer::GraphicsPipelineBuilder builder;
-    pipeline = new Renderer::Pipeline(&builder);
+    // --memory.staging_mb <n>: staging memory shared by the frames in flight for streaming data to the GPU.
+    uploads = new Renderer::UploadQueue(device, settings.get<unsigned long long>(SettingId::STAGING_BUDGET_MB) << 20,
+                                        frames->get_frames_in_flight());
+    // --render.pipeline_cache <file>: where compiled pipelines are kept between runs.
+    const Utils::StringView cache_path = settings.get_string(SettingId::PIPELINE_CACHE_PATH);
+    pipeline_cache = new Renderer::PipelineCache(
+        device, cache_path.empty() ? Renderer::DEFAULT_PIPELINE_CACHE_PATH : cache_path.data());
+    // --render.pipeline_threads <n>: compile pipelines in the background; 0 compiles them where they are requested.
+    pipelines = new Renderer::PipelineCompiler(pipeline_cache->handle(),
+                                               settings.get<unsigned int>(SettingId::PIPELINE_THREADS));
+    bindless = new Renderer::BindlessHeap(device, timeline);
+    depth_pyramid = new Renderer::DepthPyramid(
+        device, bindless, pipeline_cache->handle(),
+        headless ? VkExtent2D{DEFAULT_WIDTH, DEFAULT_HEIGHT} : swap_chain->getExtent());
+    // --jobs.workers <n>: threads that record chunk draws alongside the main thread; 0 records them on it alone.
+    recorder = new Renderer::ParallelRecorder(device->get_graphics_family_index(),
+                                              settings.get<unsigned int>(SettingId::WORKER_THREADS),
+                                              frames->get_frames_in_flight());
+    // --render.max_chunks <n>: chunks the renderer has room for; each costs 92 bytes of GPU memory per frame
+    // in flight.
+    chunks = new Renderer::ChunkRenderer(device, uploads, pipelines, bindless, recorder, depth_pyramid, timeline,
+                                         pipeline_cache->handle(),
+                                         headless ? OFFSCREEN_FORMAT : swap_chain->getImageFormat(),
+                                         frames->get_frames_in_flight(),
+                                         settings.get<unsigned int>(SettingId::MAX_CHUNKS));
+    add_test_chunk(chunks);
+    render_graph = new Renderer::RenderGraph();
+    BuildRenderGraph();
+    run_start_ns = time_now_ns();
     return false;
 }
 
 bool Runtime::IsRunning() const noexcept
 {
-    return !window->shouldClose();
+    const unsigned int frame_limit = settings.get<unsigned int>(SettingId::FRAME_LIMIT);
+    if (frame_limit != 0 && frame_loop.frame_count() >= frame_limit)
+    {
+        return false;
+    }
+    // Without a limit a headless run goes on until the process is stopped.
+    return headless || !window->shouldClose();
 }
 
-void Runtime::Update() noexcept {
+void Runtime::Update() noexcept
+{
+    LUNA_PROFILE_SCOPE("frame");
     // Poll window events
-    window->pollEvents();
+    if (window != nullptr)
+    {
+        LUNA_PROFILE_SCOPE("poll events");
+        window->pollEvents();
+    }
 
-    // Synchronization objects
-    VkSemaphore image_available_semaphore;
-    VkSemaphore render_finished_semaphore;
-    VkFence in_flight_fence;
+    // Checking the config file costs a system call, so only look every 64 frames.
+    if (frame_loop.frame_count() % 64 == 0 && settings.reload_if_changed())
+    {
+        ApplySettings();
+    }
 
-    //VkSemaphoreCreateInfo semaphore_info{};
-    //semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    const unsigned int ticks = frame_loop.begin_frame();
+    for (unsigned int i = 0; i < ticks; ++i)
+    {
+        Tick(frame_loop.tick_seconds());
+    }
+    Render(frame_loop.alpha());
+    {
+        LUNA_PROFILE_SCOPE("frame pacing");
+        frame_loop.end_frame();
+    }
 
-    //VkFenceCreateInfo fence_info{};
-    //fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-    //fence_info.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+    if (frame_loop.frame_count() % FrameStats::WINDOW == 0)
+    {
+        const FrameTimeSummary summary = frame_loop.stats().summarize();
+        Log::debug(Log::Module::PLATFORM, "Frame time over %u frames (us): min %llu, avg %llu, p99 %llu, max %llu",
+                   summary.frames, summary.min_ns / 1000, summary.avg_ns / 1000, summary.p99_ns / 1000,
+                   summary.max_ns / 1000);
+        const FrameTimeSummary wait = frames->get_wait_stats().summarize();
+        Log::debug(Log::Module::PLATFORM, "Frame wait (us, %u in flight): avg %llu, p99 %llu, max %llu",
+                   frames->get_frames_in_flight(), wait.avg_ns / 1000, wait.p99_ns / 1000, wait.max_ns / 1000);
+        const Renderer::GpuAllocator *allocator = device->get_allocator();
+        for (unsigned int heap = 0; heap < allocator->get_heap_count(); ++heap)
+        {
+            const Renderer::HeapBudget budget = allocator->get_heap_budget(heap);
+            Log::debug(Log::Module::PLATFORM, "GPU heap %u (MB): %llu of %llu in blocks, usage %llu, budget %llu", heap,
+                       budget.allocation_bytes >> 20, budget.block_bytes >> 20, budget.usage >> 20,
+                       budget.budget >> 20);
+        }
+        const Renderer::StagingRing &staging = uploads->get_ring();
+        Log::debug(Log::Module::PLATFORM, "Staging: %llu of %llu KB in use, last flush %llu KB in %u regions",
+                   staging.get_used() >> 10, staging.get_capacity() >> 10, uploads->get_last_flush_bytes() >> 10,
+                   uploads->get_last_flush_regions());
+        Log::debug(Log::Module::PLATFORM, "Timeline: graphics at %llu, uploads at %llu, %lu deletions pending",
+                   timeline->get_last_submitted(), uploads->get_timeline().get_last_submitted(),
+                   timeline->get_deletions().get_pending());
+        Log::debug(Log::Module::PLATFORM, "Pipelines: %u of %u compiled, %llu requests reused, longest compile %llu us",
+                   pipelines->get_compiled_count(), pipelines->get_pipeline_count(), pipelines->get_reused_count(),
+                   pipelines->get_longest_compile_ns() / 1000);
+        const Renderer::BindlessSlotAllocator &textures = bindless->get_slots(Renderer::BindlessType::SAMPLED_IMAGE);
+        const Renderer::BindlessSlotAllocator &buffers = bindless->get_slots(Renderer::BindlessType::STORAGE_BUFFER);
+        // Released indices count as used until their deletions above have been collected.
+        Log::debug(Log::Module::PLATFORM, "Bindless: %u of %u textures, %u of %u buffers", textures.get_used(),
+                   textures.get_capacity(), buffers.get_used(), buffers.get_capacity());
+        const Utils::RangeAllocator &vertices = chunks->get_vertex_arena();
+        const Utils::RangeAllocator &indices = chunks->get_index_arena();
+        Log::debug(Log::Module::PLATFORM,
+                   "Chunks: %u, culled on the %s, arenas %llu of %llu KB vertices, %llu of %llu KB indices",
+                   chunks->get_chunk_count(), chunks->is_gpu_culling() ? "GPU" : "CPU",
+                   (vertices.get_capacity() - vertices.get_free_bytes()) >> 10, vertices.get_capacity() >> 10,
+                   (indices.get_capacity() - indices.get_free_bytes()) >> 10, indices.get_capacity() >> 10);
+        const Renderer::ChunkCullStats &cull = chunks->get_cull_stats();
+        const unsigned int culled = cull.frustum_culled + cull.occlusion_culled;
+        Log::debug(Log::Module::PLATFORM,
+                   "Culling: %u of %u chunks drawn, %u%% culled (%u by frustum, %u by occlusion), occlusion %s",
+                   cull.drawn, cull.tested, cull.tested == 0 ? 0 : culled * 100 / cull.tested, cull.frustum_culled,
+                   cull.occlusion_culled, chunks->is_occlusion_culling() ? "on" : "off");
+        const FrameTimeSummary recording = recorder->get_record_stats().summarize();
+        Log::debug(Log::Module::PLATFORM, "Draw recording (us, %u threads, %u calls): avg %llu, p99 %llu, max %llu",
+                   recorder->get_thread_count(), recording.frames, recording.avg_ns / 1000, recording.p99_ns / 1000,
+                   recording.max_ns / 1000);
+    }
+}
+
+void Runtime::ApplySettings() noexcept
+{
+    if (settings.get_generation() == settings_generation)
+    {
+        return;
+    }
+    settings_generation = settings.get_generation();
+    frame_loop.set_frame_cap(settings.get<unsigned int>(SettingId::MAX_FPS));
+    device->get_allocator()->set_budget_limit(settings.get<unsigned long long>(SettingId::GPU_MEMORY_BUDGET_MB) << 20);
+}
+
+void Runtime::Tick(double) noexcept
+{
+    // Nothing is simulated yet; world updates belong here, at the fixed tick rate, not in Render.
+}
+
+void Runtime::BuildRenderGraph() noexcept
+{
+    // The target comes from the presentation engine, or from a frame FrameRing has seen finish; either way its
+    // contents are discarded, and the acquire semaphore waits at color attachment output.
+    Renderer::ImportedImage target;
+    target.initial_stages = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+    target.final_layout = headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    target.final_stages = VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT;
+    target.output = true;
+    target_resource = render_graph->import_image("target", target);
+
+    // Depth is cleared every frame, but only once the last frame has finished drawing to and reducing it.
+    Renderer::ImportedImage depth;
+    depth.aspect = VK_IMAGE_ASPECT_DEPTH_BIT;
+    depth.initial_stages = VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+    depth.initial_write_access = VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    depth_resource = render_graph->import_image("depth", depth);
+    const Renderer::Image &depth_image = depth_pyramid->get_depth();
+    render_graph->set_image(depth_resource, depth_image.getImage(), depth_image.getImageView());
+
+    // The culling passes synchronise their own buffers, so to the graph they are only side effects.
+    render_graph->add_pass("cull", RecordCull, this, true);
+    const Renderer::RenderPass draw = render_graph->add_pass("draw", RecordDraw, this);
+    render_graph->use(draw, target_resource, Renderer::RenderAccess::COLOR_ATTACHMENT_WRITE);
+    render_graph->use(draw, depth_resource, Renderer::RenderAccess::DEPTH_ATTACHMENT_WRITE);
+    // Rebuild the depth pyramid from what was drawn, then draw the chunks last frame's pyramid wrongly hid
+    if (chunks->is_occlusion_culling())
+    {
+        const Renderer::RenderPass pyramid = render_graph->add_pass("depth pyramid", RecordDepthPyramid, this, true);
+        render_graph->use(pyramid, depth_resource, Renderer::RenderAccess::SAMPLED_COMPUTE);
+    }
+    render_graph->add_pass("late cull", RecordLateCull, this, true);
+    if (chunks->is_occlusion_culling())
+    {
+        const Renderer::RenderPass late_draw = render_graph->add_pass("late draw", RecordLateDraw, this);
+        render_graph->use(late_draw, target_resource, Renderer::RenderAccess::COLOR_ATTACHMENT_READ_WRITE);
+        render_graph->use(late_draw, depth_resource, Renderer::RenderAccess::DEPTH_ATTACHMENT_READ_WRITE);
+    }
+    if (!render_graph->build(device))
+    {
+        Log::fatal("Failed to build the frame's render graph");
+    }
+}
+
+void Runtime::BeginChunkRendering(Renderer::CommandBuffer &command_buffer, const Renderer::RenderGraph &graph,
+                                  VkAttachmentLoadOp load_op) const noexcept
+{
+    // The depth buffer is made to match the target, so its size is the target's.
+    const VkExtent2D extent = depth_pyramid->get_depth().getExtent();
 
-    // Wait for previous frame
-    //device->waitForFences(1, &in_flight_fence, VK_TRUE, UINT64_MAX);
-    //device->resetFences(1, &in_flight_fence);
-    uint32_t image_index = 0;
-    swap_chain->acquireNextImage(image_available_semaphore, nullptr, &image_index);
-    auto swap_chain_extent = swap_chain->getExtent();
-    
-    // Setup color attachment
     VkRenderingAttachmentInfo color_attachment{};
     color_attachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
-    color_attachment.imageView = swap_chain->getImageViews()[image_index];
+    color_attachment.imageView = graph.get_image_view(target_resource);
     color_attachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-    color_attachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    color_attachment.loadOp = load_op;
     color_attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
     color_attachment.clearValue = {{0.0f, 0.0f, 0.0f, 1.0f}};
 
-    // Record commands
-    command_buffer->begin();
-
-    // Image layout transition: Undefined → Color Attachment Optimal
-    VkImageMemoryBarrier2 image_memory_barrier{};
-    image_memory_barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
-    image_memory_barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    image_memory_barrier.newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-    image_memory_barrier.image = swap_chain->getImages()[image_index];
-    image_memory_barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    image_memory_barrier.subresourceRange.baseMipLevel = 0;
-    image_memory_barrier.subresourceRange.levelCount = 1;
-    image_memory_barrier.subresourceRange.baseArrayLayer = 0;
-    image_memory_barrier.subresourceRange.layerCount = 1;
-    image_memory_barrier.srcStageMask = VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT;
-    image_memory_barrier.dstStageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
-    image_memory_barrier.srcAccessMask = 0;
-    image_memory_barrier.dstAccessMask = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
-
-    VkDependencyInfo dependency_info{};
-    dependency_info.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
-    dependency_info.imageMemoryBarrierCount = 1;
-    dependency_info.pImageMemoryBarriers = &image_memory_barrier;
-
-    command_buffer->pipelineBarrier2(&dependency_info);
-
-    // Begin dynamic rendering
+    VkRenderingAttachmentInfo depth_attachment{};
+    depth_attachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+    depth_attachment.imageView = graph.get_image_view(depth_resource);
+    depth_attachment.imageLayout = VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL;
+    depth_attachment.loadOp = load_op;
+    depth_attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    depth_attachment.clearValue.depthStencil = {1.0f, 0};
+
     VkRenderingInfo rendering_info{};
     rendering_info.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
     rendering_info.renderArea.offset = {0, 0};
-    rendering_info.renderArea.extent = swap_chain_extent;
+    rendering_info.renderArea.extent = extent;
     rendering_info.layerCount = 1;
     rendering_info.viewMask = 0;
     rendering_info.colorAttachmentCount = 1;
     rendering_info.pColorAttachments = &color_attachment;
+    rendering_info.pDepthAttachment = &depth_attachment;
+    // Secondary buffers set their own viewport and scissor, and nothing else may be recorded alongside them.
+    if (chunks->is_recording_secondary())
+    {
+        rendering_info.flags = VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT;
+        command_buffer.beginRendering(&rendering_info);
+        return;
+    }
+    command_buffer.beginRendering(&rendering_info);
 
-    command_buffer->beginRendering(&rendering_info);
-    command_buffer->bindPipeline(VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
-
-    // Set viewport and scissor
     VkViewport viewport{};
     viewport.x = 0.0f;
     viewport.y = 0.0f;
-    viewport.width = static_cast<float>(swap_chain_extent.width);
-    viewport.height = static_cast<float>(swap_chain_extent.height);
+    viewport.width = static_cast<float>(extent.width);
+    viewport.height = static_cast<float>(extent.height);
     viewport.minDepth = 0.0f;
     viewport.maxDepth = 1.0f;
-    command_buffer->setViewport(0, 1, &viewport);
+    command_buffer.setViewport(0, 1, &viewport);
 
     VkRect2D scissor{};
     scissor.offset = {0, 0};
-    scissor.extent = swap_chain_extent;
-    command_buffer->setScissor(0, 1, &scissor);
+    scissor.extent = extent;
+    command_buffer.setScissor(0, 1, &scissor);
+}
 
-    // Draw call
-    command_buffer->draw(3, 1, 0, 0);
-    command_buffer->endRendering();
+void Runtime::RecordCull(Renderer::CommandBuffer &command_buffer, const Renderer::RenderGraph &, void *user) noexcept
+{
+    static_cast<Runtime *>(user)->chunks->cull(command_buffer, VIEW_PROJ);
+}
 
-    // Image layout transition: Color Attachment Optimal → Present
-    image_memory_barrier.oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-    image_memory_barrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-    image_memory_barrier.srcStageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
-    image_memory_barrier.dstStageMask = VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT;
-    image_memory_barrier.srcAccessMask = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
-    image_memory_barrier.dstAccessMask = 0;
+void Runtime::RecordDraw(Renderer::CommandBuffer &command_buffer, const Renderer::RenderGraph &graph,
+                         void *user) noexcept
+{
+    const Runtime *runtime = static_cast<Runtime *>(user);
+    runtime->BeginChunkRendering(command_buffer, graph, VK_ATTACHMENT_LOAD_OP_CLEAR);
+    // Every chunk in one draw, once the pipeline has compiled; until then the frame is only cleared
+    runtime->chunks->draw(command_buffer, VIEW_PROJ);
+    command_buffer.endRendering();
+}
 
-    command_buffer->pipelineBarrier2(&dependency_info);
-    command_buffer->end();
+void Runtime::RecordDepthPyramid(Renderer::CommandBuffer &command_buffer, const Renderer::RenderGraph &,
+                                 void *user) noexcept
+{
+    static_cast<Runtime *>(user)->depth_pyramid->build(command_buffer);
+}
+
+void Runtime::RecordLateCull(Renderer::CommandBuffer &command_buffer, const Renderer::RenderGraph &,
+                             void *user) noexcept
+{
+    static_cast<Runtime *>(user)->chunks->cull_late(command_buffer);
+}
+
+void Runtime::RecordLateDraw(Renderer::CommandBuffer &command_buffer, const Renderer::RenderGraph &graph,
+                             void *user) noexcept
+{
+    const Runtime *runtime = static_cast<Runtime *>(user);
+    runtime->BeginChunkRendering(command_buffer, graph, VK_ATTACHMENT_LOAD_OP_LOAD);
+    runtime->chunks->draw_late(command_buffer, VIEW_PROJ);
+    command_buffer.endRendering();
+}
+
+void Runtime::Render(float) noexcept
+{
+    // Wait until this frame's previous submission is done with its command buffer and semaphores
+    Renderer::FrameContext &frame = frames->begin_frame();
+    Renderer::CommandBuffer *command_buffer = frame.command_buffer;
+    // Whatever the waited-for frame was the last to use can go now.
+    timeline->collect();
+    recorder->begin_frame(frames->get_frame_index());
+    chunks->begin_frame(frames->get_frame_index());
+
+    uint32_t image_index = 0;
+    VkImage target_image = VK_NULL_HANDLE;
+    VkImageView target_view = VK_NULL_HANDLE;
+    if (headless)
+    {
+        const Renderer::Image *target = offscreen_targets[frames->get_frame_index()];
+        target_image = target->getImage();
+        target_view = target->getImageView();
+    }
+    else
+    {
+        LUNA_PROFILE_SCOPE("acquire image");
+        swap_chain->acquireNextImage(frame.image_available, nullptr, &image_index);
+        target_image = swap_chain->getImages()[image_index];
+        target_view = swap_chain->getImageViews()[image_index];
+    }
+
+    {
+        LUNA_PROFILE_SCOPE("record");
+        command_buffer->begin();
+        // Bound once for the whole frame; draws find their resources by index.
+        bindless->bind(*command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS);
+        render_graph->set_image(target_resource, target_image, target_view);
+        render_graph->execute(*command_buffer);
+        command_buffer->end();
+    }
 
     // Submit command buffer
     VkSubmitInfo2 submit_info{};
@@ -130,35 +417,78 @@ void Runtime::Update() noexcept {
     cmd_submit_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO;
     cmd_submit_info.commandBuffer = command_buffer->handle();
 
-    VkSemaphoreSubmitInfo wait_semaphore_info{};
-    wait_semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
-    wait_semaphore_info.semaphore = image_available_semaphore;
-    wait_semaphore_info.stageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+    // Offscreen targets are not shared with a presentation engine, so they need no acquire semaphore
+    VkSemaphoreSubmitInfo wait_semaphore_infos[2]{};
+    uint32_t wait_count = 0;
+    if (!headless)
+    {
+        wait_semaphore_infos[wait_count].sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+        wait_semaphore_infos[wait_count].semaphore = frame.image_available;
+        wait_semaphore_infos[wait_count].stageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+        ++wait_count;
+    }
+    const unsigned long long uploads_done = uploads->flush();
+    if (uploads_done != 0)
+    {
+        wait_semaphore_infos[wait_count++] =
+            uploads->get_timeline().wait_info(uploads_done, Renderer::UPLOAD_WAIT_STAGES);
+    }
 
     VkSemaphoreSubmitInfo signal_semaphore_info{};
     signal_semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
-    signal_semaphore_info.semaphore = render_finished_semaphore;
+    signal_semaphore_info.semaphore = headless ? VK_NULL_HANDLE : frames->get_render_finished(image_index);
     signal_semaphore_info.stageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
 
     submit_info.commandBufferInfoCount = 1;
     submit_info.pCommandBufferInfos = &cmd_submit_info;
-    submit_info.waitSemaphoreInfoCount = 1;
-    submit_info.pWaitSemaphoreInfos = &wait_semaphore_info;
-    submit_info.signalSemaphoreInfoCount = 1;
+    submit_info.waitSemaphoreInfoCount = wait_count;
+    submit_info.pWaitSemaphoreInfos = wait_semaphore_infos;
+    submit_info.signalSemaphoreInfoCount = headless ? 0 : 1;
     submit_info.pSignalSemaphoreInfos = &signal_semaphore_info;
 
-    queue->submit2(submit_info, in_flight_fence);
-
-    swap_chain->present(queue, image_index, render_finished_semaphore);
+    unsigned long long submitted;
+    {
+        LUNA_PROFILE_SCOPE("submit");
+        submitted = timeline->submit(*queue, submit_info);
+    }
 
-    // Cleanup
-    command_buffer->reset(VK_COMMAND_BUFFER_RESET_RELEASE_RESOURCES_BIT);
+    if (!headless)
+    {
+        LUNA_PROFILE_SCOPE("present");
+        swap_chain->present(queue, image_index, signal_semaphore_info.semaphore);
+    }
+    frames->end_frame(submitted);
 }
 
 void Runtime::Shutdown() noexcept
 {
     vkDeviceWaitIdle(volkGetLoadedDevice());
-    delete command_buffer;
+    const unsigned long long run_ns = time_now_ns() - run_start_ns;
+    const unsigned long long run_frames = frame_loop.frame_count();
+    Log::info(Log::Module::PLATFORM, "Ran %llu frames in %llu ms (%llu us per frame)", run_frames, run_ns / 1000000,
+              run_frames > 0 ? run_ns / run_frames / 1000 : 0);
+    const Utils::StringView profile_path = settings.get_string(SettingId::PROFILE_PATH);
+    if (!profile_path.empty())
+    {
+        Platform::profiler_end_capture();
+        Platform::profiler_write_chrome_trace(profile_path.data());
+    }
+    for (Renderer::Image *target : offscreen_targets)
+    {
+        delete target;
+    }
+    // Joins the compile threads first, so pipelines still compiling make it into the saved cache.
+    delete pipelines;
+    pipeline_cache->save();
+    delete render_graph;
+    delete chunks;
+    delete recorder;
+    delete depth_pyramid;
+    delete pipeline_cache;
+    delete bindless;
+    delete uploads;
+    delete frames;
+    delete timeline;
     delete queue;
     delete swap_chain;
     delete device;
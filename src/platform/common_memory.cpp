@@ -12,6 +12,7 @@ MemoryManager::MemoryManager()
     : pools(nullptr)
     , total_allocated(0)
     , total_used(0)
+    , allocation_count(0)
 {
 }
 
@@ -226,6 +227,7 @@ void *MemoryManager::allocate(size_t size, size_t alignment)
 
     // Update the total amount of used memory.
     total_used += size;
+    ++allocation_count;
 
     // Return the aligned address.
     return aligned_addr;
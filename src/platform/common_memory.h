@@ -31,6 +31,7 @@ class MemoryManager
     Pool *pools;
     size_t total_allocated;
     size_t total_used;
+    size_t allocation_count;
     // Prevent copying
     MemoryManager(const MemoryManager &) = delete;
     MemoryManager &operator=(const MemoryManager &) = delete;
@@ -60,6 +61,11 @@ class MemoryManager
     {
         return total_used;
     }
+    /// Successful allocate() calls since startup, freed or not.
+    size_t get_allocation_count() const
+    {
+        return allocation_count;
+    }
     float get_fragmentation() const
     {
         return total_allocated > 0 ? 1.0f - ((float)total_used / total_allocated) : 0.0f;
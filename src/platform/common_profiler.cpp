@@ -0,0 +1,246 @@
+#include <platform/file.h>
+#include <platform/log.h>
+#include <platform/profiler.h>
+#include <utils/algorithm.h>
+#include <utils/new.h>
+#include <utils/to_chars.h>
+
+namespace LunaVoxelEngine::Platform
+{
+namespace detail
+{
+Utils::Atomic<unsigned int> profiler_capturing;
+} // namespace detail
+
+namespace
+{
+using detail::ProfileEvent;
+using detail::ThreadEvents;
+
+Utils::Atomic<ThreadEvents *> threads;
+Utils::Atomic<unsigned int> thread_count;
+Utils::Atomic<unsigned int> generation;
+Utils::Atomic<unsigned long> dropped;
+unsigned long long capture_begin = 0;
+
+ThreadEvents *register_thread()
+{
+    ThreadEvents *events = new ThreadEvents();
+    events->events = new ProfileEvent[PROFILER_EVENTS_PER_THREAD];
+    events->name = nullptr;
+    events->index = thread_count.fetch_add(1, Utils::MemoryOrder::RELAXED) + 1;
+    // Never unlinked, like the log rings: the exporter may walk the list at any time.
+    ThreadEvents *list_head = threads.load(Utils::MemoryOrder::RELAXED);
+    do
+    {
+        events->next = list_head;
+    } while (!threads.compare_exchange(list_head, events, Utils::MemoryOrder::RELEASE));
+    detail::profiler_thread_events = events;
+    return events;
+}
+
+ThreadEvents *current_thread()
+{
+    ThreadEvents *events = detail::profiler_thread_events;
+    if (events == nullptr)
+    {
+        events = register_thread();
+    }
+    const unsigned int current = generation.load(Utils::MemoryOrder::RELAXED);
+    if (events->generation.load(Utils::MemoryOrder::RELAXED) != current)
+    {
+        events->count.store(0, Utils::MemoryOrder::RELAXED);
+        events->generation.store(current, Utils::MemoryOrder::RELEASE);
+    }
+    return events;
+}
+
+/**
+ * Buffered output for the exporter.
+ */
+class JsonWriter final
+{
+  public:
+    explicit JsonWriter(File &file_in)
+        : file(file_in)
+    {
+    }
+
+    void text(const char *str, size_t len)
+    {
+        while (len > 0)
+        {
+            const size_t chunk = Utils::min(len, SIZE - used);
+            Utils::memcpy(buffer + used, str, chunk);
+            used += chunk;
+            str += chunk;
+            len -= chunk;
+            if (used == SIZE)
+            {
+                flush();
+            }
+        }
+    }
+
+    template<size_t N> void literal(const char (&str)[N])
+    {
+        text(str, N - 1);
+    }
+
+    void string(const char *str)
+    {
+        literal("\"");
+        for (; *str != '\0'; ++str)
+        {
+            if (*str == '"' || *str == '\\')
+            {
+                literal("\\");
+            }
+            text(str, 1);
+        }
+        literal("\"");
+    }
+
+    void number(unsigned long long value)
+    {
+        char digits[Utils::MAX_U64_CHARS];
+        text(digits, static_cast<size_t>(Utils::u64_to_chars(digits, value) - digits));
+    }
+
+    // Trace timestamps are microseconds; three decimals keep full nanosecond resolution.
+    void microseconds(unsigned long long ns)
+    {
+        number(ns / 1000);
+        const unsigned int fraction = static_cast<unsigned int>(ns % 1000);
+        const char decimals[4] = {'.', static_cast<char>('0' + fraction / 100),
+                                  static_cast<char>('0' + fraction / 10 % 10), static_cast<char>('0' + fraction % 10)};
+        text(decimals, 4);
+    }
+
+    // Between array elements; first is cleared.
+    void separator(bool &first)
+    {
+        if (!first)
+        {
+            literal(",\n");
+        }
+        first = false;
+    }
+
+    bool flush()
+    {
+        ok = ok && file.write(buffer, used);
+        used = 0;
+        return ok;
+    }
+
+  private:
+    static constexpr size_t SIZE = 64 * 1024;
+    File &file;
+    char buffer[SIZE];
+    size_t used = 0;
+    bool ok = true;
+};
+} // namespace
+
+void profiler_begin_capture() noexcept
+{
+    dropped.store(0, Utils::MemoryOrder::RELAXED);
+    // Skips 0, which profiler_capturing keeps for no capture.
+    unsigned int current = generation.fetch_add(1, Utils::MemoryOrder::RELAXED) + 1;
+    if (current == 0)
+    {
+        current = generation.fetch_add(1, Utils::MemoryOrder::RELAXED) + 1;
+    }
+    capture_begin = time_ticks();
+    detail::profiler_capturing.store(current, Utils::MemoryOrder::RELEASE);
+}
+
+void profiler_end_capture() noexcept
+{
+    detail::profiler_capturing.store(0, Utils::MemoryOrder::RELEASE);
+    const unsigned long lost = dropped.load(Utils::MemoryOrder::RELAXED);
+    if (lost > 0)
+    {
+        Log::warn(Log::Module::PLATFORM, "Profiler dropped %lu events: a thread buffer filled up", lost);
+    }
+}
+
+void profiler_set_thread_name(const char *name) noexcept
+{
+    current_thread()->name = name;
+}
+
+bool profiler_write_chrome_trace(const char *path) noexcept
+{
+    File file(path, FileMode::FILE_WRITE);
+    if (!file.is_open())
+    {
+        Log::error(Log::Module::PLATFORM, "Cannot write trace to %s", path);
+        return false;
+    }
+    const double ns_per_tick = 1e9 / static_cast<double>(time_ticks_per_second());
+    const unsigned int current = generation.load(Utils::MemoryOrder::RELAXED);
+    JsonWriter *json = new JsonWriter(file);
+    json->literal("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+    for (ThreadEvents *events = threads.load(Utils::MemoryOrder::ACQUIRE); events != nullptr; events = events->next)
+    {
+        if (events->name != nullptr)
+        {
+            json->separator(first);
+            json->literal("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":");
+            json->number(events->index);
+            json->literal(",\"args\":{\"name\":");
+            json->string(events->name);
+            json->literal("}}");
+        }
+        if (events->generation.load(Utils::MemoryOrder::ACQUIRE) != current)
+        {
+            continue;
+        }
+        const unsigned int count = events->count.load(Utils::MemoryOrder::ACQUIRE);
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            const ProfileEvent &event = events->events[i];
+            // Timestamps from other cores can trail capture_begin by a few ticks.
+            const unsigned long long begin = event.begin > capture_begin ? event.begin - capture_begin : 0;
+            const unsigned long long end = event.end > capture_begin ? event.end - capture_begin : 0;
+            json->separator(first);
+            json->literal("{\"name\":");
+            json->string(event.name);
+            json->literal(",\"ph\":\"X\",\"pid\":1,\"tid\":");
+            json->number(events->index);
+            json->literal(",\"ts\":");
+            json->microseconds(static_cast<unsigned long long>(static_cast<double>(begin) * ns_per_tick));
+            json->literal(",\"dur\":");
+            json->microseconds(static_cast<unsigned long long>(static_cast<double>(end - begin) * ns_per_tick));
+            json->literal("}");
+        }
+    }
+    json->literal("\n]}\n");
+    const bool ok = json->flush();
+    delete json;
+    if (!ok)
+    {
+        Log::error(Log::Module::PLATFORM, "Cannot write trace to %s", path);
+    }
+    return ok;
+}
+
+namespace detail
+{
+void profiler_record(const char *name, unsigned long long begin, unsigned long long end) noexcept
+{
+    ThreadEvents *events = current_thread();
+    const unsigned int count = events->count.load(Utils::MemoryOrder::RELAXED);
+    if (count == PROFILER_EVENTS_PER_THREAD)
+    {
+        dropped.fetch_add(1, Utils::MemoryOrder::RELAXED);
+        return;
+    }
+    events->events[count] = {name, begin, end};
+    events->count.store(count + 1, Utils::MemoryOrder::RELEASE);
+}
+} // namespace detail
+} // namespace LunaVoxelEngine::Platform
@@ -0,0 +1,398 @@
+#include <platform/file.h>
+#include <platform/log.h>
+#include <platform/settings.h>
+#include <utils/algorithm.h>
+
+namespace LunaVoxelEngine::Platform
+{
+namespace
+{
+constexpr unsigned int SETTING_COUNT = static_cast<unsigned int>(SettingId::SETTING_COUNT);
+/// Longest "section.key" the file parser can build.
+constexpr unsigned long MAX_KEY_LENGTH = 64;
+
+bool is_space(char c) noexcept
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+Utils::StringView trim(Utils::StringView text) noexcept
+{
+    unsigned long start = 0;
+    unsigned long end = text.size();
+    while (start < end && is_space(text[start]))
+    {
+        ++start;
+    }
+    while (end > start && is_space(text[end - 1]))
+    {
+        --end;
+    }
+    return text.substr(start, end - start);
+}
+
+bool equals_ignore_case(Utils::StringView text, const char *name) noexcept
+{
+    unsigned long i = 0;
+    for (; i < text.size() && name[i] != 0; ++i)
+    {
+        const char c = text[i] >= 'A' && text[i] <= 'Z' ? static_cast<char>(text[i] - 'A' + 'a') : text[i];
+        if (c != name[i])
+        {
+            return false;
+        }
+    }
+    return i == text.size() && name[i] == 0;
+}
+
+bool parse_number(Utils::StringView text, unsigned long long &value) noexcept
+{
+    value = 0;
+    for (const char c : text)
+    {
+        if (c < '0' || c > '9' || value > (~0ULL - 9) / 10)
+        {
+            return false;
+        }
+        value = value * 10 + static_cast<unsigned long long>(c - '0');
+    }
+    return !text.empty();
+}
+
+bool parse_value(const SettingInfo &info, Utils::StringView text, unsigned long long &value) noexcept
+{
+    switch (info.type)
+    {
+    case SettingType::SETTING_BOOL:
+        if (equals_ignore_case(text, "true") || equals_ignore_case(text, "on") || equals_ignore_case(text, "yes") ||
+            text == "1")
+        {
+            value = 1;
+            return true;
+        }
+        if (equals_ignore_case(text, "false") || equals_ignore_case(text, "off") ||
+            equals_ignore_case(text, "no") || text == "0")
+        {
+            value = 0;
+            return true;
+        }
+        return false;
+    case SettingType::SETTING_UINT:
+        return parse_number(text, value) && value >= info.min_value && value <= info.max_value;
+    case SettingType::SETTING_ENUM:
+        for (unsigned long long i = 0; i <= info.max_value; ++i)
+        {
+            if (equals_ignore_case(text, info.enum_names[i]))
+            {
+                value = i;
+                return true;
+            }
+        }
+        return false;
+    case SettingType::SETTING_STRING:
+        break;
+    }
+    return false;
+}
+
+/**
+ * @return The setting whose key or alias is name, or SETTING_COUNT.
+ */
+unsigned int find_setting(Utils::StringView name) noexcept
+{
+    for (unsigned int i = 0; i < SETTING_COUNT; ++i)
+    {
+        if (name == SETTING_INFO[i].key || (SETTING_INFO[i].alias != nullptr && name == SETTING_INFO[i].alias))
+        {
+            return i;
+        }
+    }
+    return SETTING_COUNT;
+}
+} // namespace
+
+Settings::Settings() noexcept
+{
+    for (unsigned int i = 0; i < SETTING_COUNT; ++i)
+    {
+        values[i].store(SETTING_INFO[i].default_value, Utils::MemoryOrder::RELAXED);
+    }
+    generation.store(0, Utils::MemoryOrder::RELAXED);
+    // Strings are stored as offset << 32 | length into the pool; offset 0 is the empty string.
+    string_pool[0] = 0;
+    string_pool_used = 1;
+    unsigned int i = 0;
+    for (; DEFAULT_CONFIG_PATH[i] != 0; ++i)
+    {
+        path[i] = DEFAULT_CONFIG_PATH[i];
+    }
+    path[i] = 0;
+}
+
+Utils::StringView Settings::get_string(SettingId id) const noexcept
+{
+    const unsigned long long packed = values[static_cast<unsigned int>(id)].load(Utils::MemoryOrder::ACQUIRE);
+    return Utils::StringView(string_pool + (packed >> 32), packed & 0xFFFFFFFF);
+}
+
+bool Settings::set(SettingId id, Utils::StringView text) noexcept
+{
+    return apply(id, text, Source::SOURCE_COMMAND_LINE);
+}
+
+bool Settings::apply(SettingId id, Utils::StringView text, Source source) noexcept
+{
+    const unsigned int index = static_cast<unsigned int>(id);
+    const SettingInfo &info = SETTING_INFO[index];
+    const unsigned long long bit = 1ULL << index;
+    if (source != Source::SOURCE_COMMAND_LINE && (from_command_line & bit) != 0)
+    {
+        return true;
+    }
+
+    unsigned long long value = 0;
+    if (info.type == SettingType::SETTING_STRING)
+    {
+        if (source == Source::SOURCE_RELOAD)
+        {
+            if (get_string(id) != text)
+            {
+                Log::info(Log::Module::PLATFORM, "%s changed in %s; restart to apply it", info.key, path);
+            }
+            return true;
+        }
+        if (text.size() + 1 > STRING_POOL_SIZE - string_pool_used)
+        {
+            Log::warn(Log::Module::PLATFORM, "No room left to store %s", info.key);
+            return false;
+        }
+        Utils::memcpy(string_pool + string_pool_used, text.data(), text.size());
+        string_pool[string_pool_used + text.size()] = 0;
+        value = static_cast<unsigned long long>(string_pool_used) << 32 | text.size();
+        string_pool_used += static_cast<unsigned int>(text.size() + 1);
+    }
+    else if (!parse_value(info, text, value))
+    {
+        if (info.type == SettingType::SETTING_UINT)
+        {
+            Log::warn(Log::Module::PLATFORM, "Ignoring %s = %s: expected a whole number from %llu to %llu", info.key,
+                      text, info.min_value, info.max_value);
+        }
+        else
+        {
+            Log::warn(Log::Module::PLATFORM, "Ignoring %s = %s: not a valid value", info.key, text);
+        }
+        return false;
+    }
+    else if (source == Source::SOURCE_RELOAD && !info.reloadable)
+    {
+        if (value != values[index].load(Utils::MemoryOrder::RELAXED))
+        {
+            Log::info(Log::Module::PLATFORM, "%s changed in %s; restart to apply it", info.key, path);
+        }
+        return true;
+    }
+
+    if (source == Source::SOURCE_COMMAND_LINE)
+    {
+        from_command_line |= bit;
+    }
+    if (values[index].exchange(value, Utils::MemoryOrder::RELEASE) != value)
+    {
+        generation.fetch_add(1, Utils::MemoryOrder::RELEASE);
+        if (source == Source::SOURCE_RELOAD)
+        {
+            Log::info(Log::Module::PLATFORM, "Reloaded %s = %s", info.key, text);
+        }
+    }
+    return true;
+}
+
+void Settings::parse_args(const Utils::Vector<Utils::StringView> &args) noexcept
+{
+    for (unsigned long i = 1; i < args.size(); ++i)
+    {
+        const Utils::StringView arg = args[i];
+        if (!arg.starts_with("--"))
+        {
+            Log::warn(Log::Module::PLATFORM, "Ignoring argument %s", arg);
+            continue;
+        }
+        Utils::StringView name = arg.substr(2);
+        Utils::StringView value;
+        bool has_value = false;
+        const unsigned long equals = name.find('=');
+        if (equals != Utils::StringView::npos)
+        {
+            value = name.substr(equals + 1);
+            name = name.substr(0, equals);
+            has_value = true;
+        }
+
+        const bool is_config = name == "config";
+        const unsigned int index = is_config ? SETTING_COUNT : find_setting(name);
+        if (!is_config && index == SETTING_COUNT)
+        {
+            Log::warn(Log::Module::PLATFORM, "Ignoring unknown option %s", arg);
+            continue;
+        }
+        if (!has_value)
+        {
+            const bool next_is_value = i + 1 < args.size() && !args[i + 1].starts_with("--");
+            if (next_is_value)
+            {
+                value = args[++i];
+            }
+            else if (!is_config && SETTING_INFO[index].type == SettingType::SETTING_BOOL)
+            {
+                value = "true";
+            }
+            else
+            {
+                Log::warn(Log::Module::PLATFORM, "Ignoring %s: expected a value", arg);
+                continue;
+            }
+        }
+
+        if (is_config)
+        {
+            if (value.size() >= MAX_PATH_LENGTH)
+            {
+                Log::warn(Log::Module::PLATFORM, "Ignoring --config: the path is too long");
+                continue;
+            }
+            Utils::memcpy(path, value.data(), value.size());
+            path[value.size()] = 0;
+            continue;
+        }
+        apply(static_cast<SettingId>(index), value, Source::SOURCE_COMMAND_LINE);
+    }
+}
+
+bool Settings::load_file(const char *path_in) noexcept
+{
+    if (path_in != nullptr)
+    {
+        const Utils::StringView view(path_in);
+        if (view.size() >= MAX_PATH_LENGTH)
+        {
+            return false;
+        }
+        Utils::memcpy(path, view.data(), view.size());
+        path[view.size()] = 0;
+    }
+    file_time_ns = file_modified_ns(path);
+    MappedFile file(path);
+    if (!file.is_open())
+    {
+        return false;
+    }
+    parse_file(Utils::StringView(file.data(), file.size()), Source::SOURCE_FILE);
+    return true;
+}
+
+bool Settings::reload_if_changed() noexcept
+{
+    const unsigned long long time_ns = file_modified_ns(path);
+    if (time_ns == 0 || time_ns == file_time_ns)
+    {
+        return false;
+    }
+    file_time_ns = time_ns;
+    MappedFile file(path);
+    if (!file.is_open())
+    {
+        return false;
+    }
+    const unsigned long long before = get_generation();
+    parse_file(Utils::StringView(file.data(), file.size()), Source::SOURCE_RELOAD);
+    return get_generation() != before;
+}
+
+void Settings::parse_file(Utils::StringView text, Source source) noexcept
+{
+    // The key is assembled as "section.name" in place; everything else is a view into the mapping.
+    char key[MAX_KEY_LENGTH];
+    unsigned long section_length = 0;
+    unsigned long line_number = 0;
+    unsigned long pos = 0;
+    while (pos < text.size())
+    {
+        ++line_number;
+        unsigned long end = text.find('\n', pos);
+        if (end == Utils::StringView::npos)
+        {
+            end = text.size();
+        }
+        const Utils::StringView line = trim(text.substr(pos, end - pos));
+        pos = end + 1;
+        if (line.empty() || line[0] == '#' || line[0] == ';')
+        {
+            continue;
+        }
+
+        if (line[0] == '[')
+        {
+            const unsigned long close = line.find(']');
+            const Utils::StringView section =
+                close == Utils::StringView::npos ? Utils::StringView() : trim(line.substr(1, close - 1));
+            if (section.empty() || section.size() + 1 >= MAX_KEY_LENGTH)
+            {
+                Log::warn(Log::Module::PLATFORM, "%s:%lu: invalid section", path, line_number);
+                section_length = 0;
+                continue;
+            }
+            Utils::memcpy(key, section.data(), section.size());
+            key[section.size()] = '.';
+            section_length = section.size() + 1;
+            continue;
+        }
+
+        const unsigned long equals = line.find('=');
+        if (equals == Utils::StringView::npos)
+        {
+            Log::warn(Log::Module::PLATFORM, "%s:%lu: expected key = value", path, line_number);
+            continue;
+        }
+        const Utils::StringView name = trim(line.substr(0, equals));
+        Utils::StringView value = trim(line.substr(equals + 1));
+        if (!value.empty() && value[0] == '"')
+        {
+            const unsigned long quote = value.find('"', 1);
+            if (quote == Utils::StringView::npos)
+            {
+                Log::warn(Log::Module::PLATFORM, "%s:%lu: unterminated string", path, line_number);
+                continue;
+            }
+            value = value.substr(1, quote - 1);
+        }
+        else
+        {
+            // A comment may follow an unquoted value.
+            for (unsigned long i = 0; i < value.size(); ++i)
+            {
+                if (value[i] == '#' || value[i] == ';')
+                {
+                    value = trim(value.substr(0, i));
+                    break;
+                }
+            }
+        }
+
+        if (section_length + name.size() > MAX_KEY_LENGTH)
+        {
+            Log::warn(Log::Module::PLATFORM, "%s:%lu: key too long", path, line_number);
+            continue;
+        }
+        Utils::memcpy(key + section_length, name.data(), name.size());
+        const Utils::StringView full_key(key, section_length + name.size());
+        const unsigned int index = find_setting(full_key);
+        if (index == SETTING_COUNT)
+        {
+            Log::warn(Log::Module::PLATFORM, "%s:%lu: unknown setting %s", path, line_number, full_key);
+            continue;
+        }
+        apply(static_cast<SettingId>(index), value, source);
+    }
+}
+} // namespace LunaVoxelEngine::Platform
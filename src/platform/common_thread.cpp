@@ -6,19 +6,32 @@ using namespace LunaVoxelEngine::Platform;
 
 static Mutex guard_mutex;
 
-extern "C" void __cxa_guard_acquire(void *guard_var)
+// The Itanium C++ ABI guard for function-local statics: the first byte of the guard is set once the object is
+// constructed. acquire() returns 1 when the caller is to construct it, holding the mutex until release() or abort().
+extern "C" int __cxa_guard_acquire(unsigned long long *guard_var)
 {
+    unsigned char *initialized = reinterpret_cast<unsigned char *>(guard_var);
+    if (__atomic_load_n(initialized, __ATOMIC_ACQUIRE) != 0)
+        return 0;
     ThreadError result = guard_mutex.lock();
     if (result != ThreadError::THREAD_SUCCESS)
         LunaVoxelEngine::Log::error("Error acquiring guard mutex!");
+    // Another thread may have constructed it while this one waited.
+    if (__atomic_load_n(initialized, __ATOMIC_ACQUIRE) != 0)
+    {
+        guard_mutex.unlock();
+        return 0;
+    }
+    return 1;
 }
 
-extern "C" void __cxa_guard_release(void *guard_var)
+extern "C" void __cxa_guard_release(unsigned long long *guard_var)
 {
+    __atomic_store_n(reinterpret_cast<unsigned char *>(guard_var), 1, __ATOMIC_RELEASE);
     guard_mutex.unlock();
 }
 
-extern "C" void __cxa_guard_abort(void *guard_var)
+extern "C" void __cxa_guard_abort(unsigned long long *)
 {
     guard_mutex.unlock();
 }
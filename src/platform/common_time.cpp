@@ -0,0 +1,54 @@
+#include <platform/time.h>
+#include <utils/atomic.h>
+
+namespace LunaVoxelEngine::Platform
+{
+namespace
+{
+constexpr unsigned long long NS_PER_SECOND = 1000000000ULL;
+constexpr unsigned long long CALIBRATION_NS = 10000000ULL;
+
+Utils::Atomic<unsigned long long> ticks_per_second;
+} // namespace
+
+unsigned long long time_ticks_per_second() noexcept
+{
+#if (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))) || defined(__x86_64__) || defined(__i386__)
+    unsigned long long rate = ticks_per_second.load(Utils::MemoryOrder::RELAXED);
+    if (rate != 0)
+    {
+        return rate;
+    }
+    // Racing callers each calibrate and store a near-identical value.
+    const unsigned long long start_ns = time_now_ns();
+    const unsigned long long start_ticks = time_ticks();
+    unsigned long long end_ns = start_ns;
+    while (end_ns - start_ns < CALIBRATION_NS)
+    {
+        Utils::cpu_relax();
+        end_ns = time_now_ns();
+    }
+    const unsigned long long end_ticks = time_ticks();
+    rate = (end_ticks - start_ticks) * NS_PER_SECOND / (end_ns - start_ns);
+    ticks_per_second.store(rate, Utils::MemoryOrder::RELAXED);
+    return rate;
+#else
+    return NS_PER_SECOND;
+#endif
+}
+
+void time_wait_until_ns(unsigned long long deadline_ns, unsigned long long spin_ns) noexcept
+{
+    unsigned long long now = time_now_ns();
+    if (now + spin_ns < deadline_ns)
+    {
+        time_sleep_ns(deadline_ns - spin_ns - now);
+        now = time_now_ns();
+    }
+    while (now < deadline_ns)
+    {
+        Utils::cpu_relax();
+        now = time_now_ns();
+    }
+}
+} // namespace LunaVoxelEngine::Platform
@@ -0,0 +1,115 @@
+#ifndef FILE_ABSTRACTION_H
+#define FILE_ABSTRACTION_H
+#include <utils/cdef.h>
+namespace LunaVoxelEngine
+{
+namespace Platform
+{
+enum class FileMode
+{
+    FILE_READ,  ///< Existing file, read only.
+    FILE_WRITE, ///< Created if missing and truncated, write only.
+};
+
+struct file_handle;
+
+// Core file operations. Paths are UTF-8.
+file_handle *file_open(const char *path, FileMode mode);
+void file_close(file_handle *handle);
+/**
+ * @brief Reads up to size bytes. Returns the number read, 0 at the end of the file, or -1 on error.
+ */
+long file_read(file_handle *handle, void *data, size_t size);
+/**
+ * @brief Writes all size bytes, retrying partial writes. Returns false on error.
+ */
+bool file_write(file_handle *handle, const void *data, size_t size);
+
+/**
+ * @brief Maps an existing file read-only. An empty file maps as null data with size 0.
+ * @return false if the file cannot be opened or mapped.
+ */
+bool file_map(const char *path, const void *&data, size_t &size);
+void file_unmap(const void *data, size_t size);
+/**
+ * @brief Last modification time in nanoseconds from an arbitrary epoch, or 0 if path does not exist.
+ */
+unsigned long long file_modified_ns(const char *path);
+
+// File Wrapper
+class [[nodiscard]] File final
+{
+  public:
+    File(const char *path, FileMode mode)
+        : handle(file_open(path, mode))
+    {
+    }
+
+    ~File()
+    {
+        if (handle)
+            file_close(handle);
+    }
+
+    File(const File &) = delete;
+    File &operator=(const File &) = delete;
+
+    bool is_open() const
+    {
+        return handle != nullptr;
+    }
+
+    long read(void *data, size_t size)
+    {
+        return handle ? file_read(handle, data, size) : -1;
+    }
+
+    bool write(const void *data, size_t size)
+    {
+        return handle && file_write(handle, data, size);
+    }
+
+  private:
+    file_handle *handle;
+};
+
+class [[nodiscard]] MappedFile final
+{
+  public:
+    explicit MappedFile(const char *path)
+        : mapped(file_map(path, bytes, length))
+    {
+    }
+
+    ~MappedFile()
+    {
+        if (mapped)
+            file_unmap(bytes, length);
+    }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool is_open() const
+    {
+        return mapped;
+    }
+
+    const char *data() const
+    {
+        return static_cast<const char *>(bytes);
+    }
+
+    size_t size() const
+    {
+        return length;
+    }
+
+  private:
+    const void *bytes = nullptr;
+    size_t length = 0;
+    bool mapped;
+};
+} // namespace Platform
+} // namespace LunaVoxelEngine
+#endif
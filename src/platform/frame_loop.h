@@ -0,0 +1,91 @@
+#ifndef FRAME_LOOP_H
+#define FRAME_LOOP_H
+namespace LunaVoxelEngine
+{
+namespace Platform
+{
+struct FrameTimeSummary
+{
+    unsigned int frames; ///< Samples in the window; the other fields are 0 when this is.
+    unsigned long long min_ns;
+    unsigned long long avg_ns;
+    unsigned long long p99_ns;
+    unsigned long long max_ns;
+};
+
+/**
+ * @class FrameStats
+ * @brief Frame times over a rolling window of the last WINDOW frames.
+ */
+class FrameStats final
+{
+  public:
+    static constexpr unsigned int WINDOW = 256;
+
+    void add(unsigned long long frame_ns) noexcept;
+    /**
+     * @brief Sorts a copy of the window, so call it once per report rather than per frame.
+     */
+    [[nodiscard]] FrameTimeSummary summarize() const noexcept;
+
+  private:
+    unsigned long long samples[WINDOW] = {};
+    unsigned int next = 0;
+    unsigned int count = 0;
+};
+
+struct FrameLoopConfig
+{
+    unsigned int tick_rate = 60;          ///< Simulation ticks per second.
+    unsigned int max_ticks_per_frame = 8; ///< After a stall, drop simulation time rather than spiral.
+    unsigned int frame_cap = 0;           ///< Rendered frames per second at most; 0 leaves pacing to present.
+    unsigned long long spin_ns = 1000000; ///< How long before a capped frame's deadline to stop sleeping and spin.
+    bool lockstep = false;                ///< One tick per frame whatever the real time, so runs are reproducible.
+};
+
+/**
+ * @class FrameLoop
+ * @brief Runs the simulation at a fixed rate and renders at whatever rate the display and frame cap allow.
+ * @details Each frame: begin_frame() says how many fixed ticks catch the simulation up with real time, the
+ *          caller simulates that many and renders with alpha() to blend the last two simulation states, and
+ *          end_frame() waits out the frame cap. Time is kept in integer nanoseconds, so it does not drift.
+ */
+class FrameLoop final
+{
+  public:
+    explicit FrameLoop(const FrameLoopConfig &config_in = FrameLoopConfig()) noexcept;
+
+    [[nodiscard]] unsigned int begin_frame() noexcept;
+    void end_frame() noexcept;
+
+    /**
+     * @brief How far real time is past the last simulated tick, in [0, 1) ticks.
+     */
+    [[nodiscard]] float alpha() const noexcept;
+    [[nodiscard]] double tick_seconds() const noexcept;
+    void set_frame_cap(unsigned int frames_per_second) noexcept;
+    void set_lockstep(bool enabled) noexcept;
+
+    /**
+     * @brief Start-to-start time of recent frames, waiting included.
+     */
+    [[nodiscard]] const FrameStats &stats() const noexcept
+    {
+        return frame_stats;
+    }
+    [[nodiscard]] unsigned long long frame_count() const noexcept
+    {
+        return frames;
+    }
+
+  private:
+    FrameLoopConfig config;
+    unsigned long long tick_ns;
+    unsigned long long accumulator_ns = 0;
+    unsigned long long frame_start_ns = 0;
+    unsigned long long frames = 0;
+    FrameStats frame_stats;
+};
+} // namespace Platform
+} // namespace LunaVoxelEngine
+#endif
@@ -0,0 +1,113 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <platform/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <utils/new.h>
+
+namespace LunaVoxelEngine::Platform
+{
+struct file_handle
+{
+    int fd;
+};
+
+file_handle *file_open(const char *path, FileMode mode)
+{
+    const int flags = mode == FileMode::FILE_READ ? O_RDONLY : O_WRONLY | O_CREAT | O_TRUNC;
+    const int fd = static_cast<int>(syscall(SYS_openat, AT_FDCWD, path, flags | O_CLOEXEC, 0644));
+    if (fd < 0)
+    {
+        return nullptr;
+    }
+    file_handle *handle = new file_handle();
+    handle->fd = fd;
+    return handle;
+}
+
+void file_close(file_handle *handle)
+{
+    syscall(SYS_close, handle->fd);
+    delete handle;
+}
+
+long file_read(file_handle *handle, void *data, size_t size)
+{
+    while (true)
+    {
+        const long got = syscall(SYS_read, handle->fd, data, size);
+        if (got >= 0 || errno != EINTR)
+        {
+            return got < 0 ? -1 : got;
+        }
+    }
+}
+
+bool file_write(file_handle *handle, const void *data, size_t size)
+{
+    const char *bytes = static_cast<const char *>(data);
+    while (size > 0)
+    {
+        const long written = syscall(SYS_write, handle->fd, bytes, size);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+        bytes += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+bool file_map(const char *path, const void *&data, size_t &size)
+{
+    data = nullptr;
+    size = 0;
+    const int fd = static_cast<int>(syscall(SYS_openat, AT_FDCWD, path, O_RDONLY | O_CLOEXEC));
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct stat info;
+    bool mapped = syscall(SYS_fstat, fd, &info) == 0;
+    if (mapped && info.st_size > 0)
+    {
+        void *view = reinterpret_cast<void *>(
+            syscall(SYS_mmap, nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0));
+        mapped = view != MAP_FAILED;
+        if (mapped)
+        {
+            data = view;
+            size = static_cast<size_t>(info.st_size);
+        }
+    }
+    // The mapping keeps the file open.
+    syscall(SYS_close, fd);
+    return mapped;
+}
+
+void file_unmap(const void *data, size_t size)
+{
+    if (data != nullptr)
+    {
+        syscall(SYS_munmap, data, size);
+    }
+}
+
+unsigned long long file_modified_ns(const char *path)
+{
+    struct stat info;
+    if (syscall(SYS_newfstatat, AT_FDCWD, path, &info, 0) != 0)
+    {
+        return 0;
+    }
+    return static_cast<unsigned long long>(info.st_mtim.tv_sec) * 1000000000ULL +
+           static_cast<unsigned long long>(info.st_mtim.tv_nsec);
+}
+} // namespace LunaVoxelEngine::Platform
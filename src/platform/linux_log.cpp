@@ -1,60 +1,83 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <platform/common_crash_log.h>
 #include <platform/common_log.h>
 #include <platform/log.h>
+#include <sys/mman.h>
 #include <sys/syscall.h>
+#include <sys/uio.h>
 #include <unistd.h>
-#include <utils/algorithm.h>
-#include <utils/string.h>
 
 namespace LunaVoxelEngine::Log
 {
-static char buffer[BUFFER_SIZE];
-static size_t buffer_pos = 0;
-
-inline void flush() noexcept
+void sink_write(const LogSlice *slices, unsigned int count) noexcept
 {
-    if (buffer_pos > 0)
+    constexpr unsigned int MAX_SLICES = 64;
+    iovec batch[MAX_SLICES];
+    while (count > 0)
     {
-        syscall(SYS_write, 1, buffer, buffer_pos);
-        buffer_pos = 0;
+        unsigned int batch_count = count < MAX_SLICES ? count : MAX_SLICES;
+        for (unsigned int i = 0; i < batch_count; ++i)
+        {
+            batch[i].iov_base = const_cast<char *>(slices[i].data);
+            batch[i].iov_len = slices[i].len;
+        }
+        slices += batch_count;
+        count -= batch_count;
+
+        // writev may stop short (pipes, signals); resume from the first byte not written.
+        iovec *pending = batch;
+        while (batch_count > 0)
+        {
+            ssize_t written = syscall(SYS_writev, 1, pending, batch_count);
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                return;
+            }
+            while (batch_count > 0 && static_cast<size_t>(written) >= pending->iov_len)
+            {
+                written -= static_cast<ssize_t>(pending->iov_len);
+                ++pending;
+                --batch_count;
+            }
+            if (batch_count > 0)
+            {
+                pending->iov_base = static_cast<char *>(pending->iov_base) + written;
+                pending->iov_len -= static_cast<size_t>(written);
+            }
+        }
     }
 }
 
-void write_str(const char *str, size_t len) noexcept
+void *map_file(const char *path, size_t size) noexcept
 {
-    if (len + buffer_pos >= BUFFER_SIZE)
+    const int fd = static_cast<int>(syscall(SYS_openat, AT_FDCWD, path, O_RDWR | O_CREAT | O_CLOEXEC, 0644));
+    if (fd < 0)
     {
-        flush();
+        return nullptr;
     }
-    size_t remaining_space = BUFFER_SIZE - buffer_pos;
-    size_t copy_len = (len < remaining_space) ? len : remaining_space;
-
-    Utils::memcpy(buffer + buffer_pos, str, copy_len);
-    buffer_pos += copy_len;
-    if (copy_len < len)
+    void *data = nullptr;
+    if (syscall(SYS_ftruncate, fd, size) == 0)
     {
-        flush();
-        write_str(str + copy_len, len - copy_len);
+        data = reinterpret_cast<void *>(syscall(SYS_mmap, nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0));
     }
+    // The mapping keeps the file open.
+    syscall(SYS_close, fd);
+    return data == MAP_FAILED ? nullptr : data;
 }
 
-void write_char(const char c) noexcept
+void unmap_file(void *data, size_t size) noexcept
 {
-    if (buffer_pos >= BUFFER_SIZE || c == '\n')
-    {
-        flush();
-    }
-    buffer[buffer_pos++] = c;
+    syscall(SYS_munmap, data, size);
 }
 
-void fatal(const Utils::String &fmt, ...) noexcept
+void sink_terminate() noexcept
 {
-    va_list args;
-    va_start(args, fmt);
-    write_str("LUNAVOXEL - FATAL: ", 20);
-    auto str = fmt.throw_away();
-    print_generic(str.c_str(), args);
-    write_char('\n');
-    va_end(args);
-    syscall(SYS_exit, 1);
+    syscall(SYS_exit_group, 1);
+    __builtin_unreachable();
 }
 } // namespace LunaVoxelEngine::Log
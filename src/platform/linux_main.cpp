@@ -5,12 +5,18 @@ using namespace LunaVoxelEngine::Log;
 
 int main(int argc, char *argv[])
 {
-    LunaVoxelEngine::Utils::Vector<LunaVoxelEngine::Utils::String> args;
+    // argv is already UTF-8, so the runtime reads it in place.
+    LunaVoxelEngine::Utils::Vector<LunaVoxelEngine::Utils::StringView> args;
     args.reserve(argc);
     for (int i = 0; i < argc; i++)
     {
         args.emplace_back(argv[i]);
     }
+    if (!open_crash_log(DEFAULT_CRASH_LOG_PATH))
+    {
+        warn("Cannot open crash log %s", DEFAULT_CRASH_LOG_PATH);
+    }
+    start_async();
     debug("Hello from LunaVoxelEngine");
     LunaVoxelEngine::Platform::Runtime *runtime = LunaVoxelEngine::Platform::Runtime::Get();
     debug("Runtime initializing...");
@@ -23,8 +29,12 @@ int main(int argc, char *argv[])
         }
         runtime->Shutdown();
         debug("Runtime shutdown");
+        stop_async();
+        close_crash_log();
         return 0;
     }
     error("Error while initializing runtime");
+    stop_async();
+    close_crash_log();
     return -1;
 }
\ No newline at end of file
@@ -8,9 +8,15 @@
 
 namespace LunaVoxelEngine::Platform
 {
+// Matches the wrappers' default timeout and Win32's INFINITE; 0 means try once without blocking.
+static constexpr size_t WAIT_INFINITE = 0xFFFFFFFF;
+
 struct thread_handle
 {
     pthread_t thread;
+    // Cleared once the thread is joined, or from the start for detached threads, so thread_destroy only detaches
+    // a thread nobody has released yet.
+    bool joinable;
 };
 
 struct condition_handle
@@ -41,6 +47,7 @@ struct spinlock_handle
 thread_handle *thread_create(thread_func func, void *arg, int flags)
 {
     thread_handle *th = new thread_handle();
+    th->joinable = !(flags & THREAD_FLAG_DETACHED);
     pthread_attr_t attr;
     pthread_attr_init(&attr);
     if (flags & THREAD_FLAG_DETACHED)
@@ -54,24 +61,71 @@ thread_handle *thread_create(thread_func func, void *arg, int flags)
         param.sched_priority = sched_get_priority_max(SCHED_FIFO);
         pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
         pthread_attr_setschedparam(&attr, &param);
-        pthread_create(&th->thread, &attr, reinterpret_cast<void *(*)(void *)>(func), arg);
-        pthread_attr_destroy(&attr);
+    }
+    int result = pthread_create(&th->thread, &attr, reinterpret_cast<void *(*)(void *)>(func), arg);
+    pthread_attr_destroy(&attr);
+    if (result != 0)
+    {
+        delete th;
+        return nullptr;
     }
     return th;
 }
 ThreadError thread_destroy(thread_handle *handle)
 {
     if (!handle)
-        return THREAD_ERROR_CREATE;
-    pthread_detach(handle->thread);
+        return ThreadError::THREAD_ERROR_CREATE;
+    if (handle->joinable)
+        pthread_detach(handle->thread);
     delete handle;
-    return THREAD_SUCCESS;
+    return ThreadError::THREAD_SUCCESS;
 }
-ThreadError thread_wait(thread_handle *handle, unsigned int timeout_ms)
+ThreadError thread_wait(thread_handle *handle, size_t timeout_ms)
 {
     if (!handle)
-        return THREAD_ERROR_CREATE;
-    return pthread_join(handle->thread, nullptr) == 0 ? THREAD_SUCCESS : THREAD_ERROR_WAIT;
+        return ThreadError::THREAD_ERROR_CREATE;
+    if (!handle->joinable)
+        return ThreadError::THREAD_ERROR_WAIT;
+
+    int result;
+    if (timeout_ms == WAIT_INFINITE)
+    {
+        result = pthread_join(handle->thread, nullptr);
+    }
+    else if (timeout_ms == 0)
+    {
+        result = pthread_tryjoin_np(handle->thread, nullptr);
+    }
+    else
+    {
+        // pthread_timedjoin_np measures the deadline against CLOCK_REALTIME.
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+
+        ts.tv_sec += timeout_ms / 1000;
+        ts.tv_nsec += (timeout_ms % 1000) * 1000000;
+
+        // Normalize nanoseconds
+        if (ts.tv_nsec >= 1000000000)
+        {
+            ts.tv_sec++;
+            ts.tv_nsec -= 1000000000;
+        }
+
+        result = pthread_timedjoin_np(handle->thread, nullptr, &ts);
+    }
+
+    switch (result)
+    {
+    case 0:
+        handle->joinable = false;
+        return ThreadError::THREAD_SUCCESS;
+    case EBUSY:
+    case ETIMEDOUT:
+        return ThreadError::THREAD_ERROR_TIMEOUT;
+    default:
+        return ThreadError::THREAD_ERROR_WAIT;
+    }
 }
 ThreadError thread_set_priority(thread_handle *handle, ThreadPriority priority)
 {
@@ -79,50 +133,50 @@ ThreadError thread_set_priority(thread_handle *handle, ThreadPriority priority)
     int policy;
     switch (priority)
     {
-    case THREAD_PRIORITY_LOWEST: {
+    case ThreadPriority::THREAD_PRIORITY_LOWEST: {
         policy = SCHED_OTHER;
         param.sched_priority = sched_get_priority_min(SCHED_OTHER);
         break;
     }
-    case THREAD_PRIORITY_LOW: {
+    case ThreadPriority::THREAD_PRIORITY_LOW: {
         policy = SCHED_OTHER;
         param.sched_priority = (sched_get_priority_min(SCHED_OTHER) + sched_get_priority_max(SCHED_OTHER)) / 2;
         break;
     }
-    case THREAD_PRIORITY_NORMAL: {
+    case ThreadPriority::THREAD_PRIORITY_NORMAL: {
         policy = SCHED_OTHER;
         param.sched_priority = 0;
         break;
     }
-    case THREAD_PRIORITY_HIGH: {
+    case ThreadPriority::THREAD_PRIORITY_HIGH: {
         policy = SCHED_RR;
         param.sched_priority = sched_get_priority_max(SCHED_RR) / 2;
         break;
     }
-    case THREAD_PRIORITY_HIGHEST: {
+    case ThreadPriority::THREAD_PRIORITY_HIGHEST: {
         policy = SCHED_RR;
         param.sched_priority = sched_get_priority_max(SCHED_RR);
         break;
     }
-    case THREAD_PRIORITY_REALTIME: {
+    case ThreadPriority::THREAD_PRIORITY_REALTIME: {
         policy = SCHED_FIFO;
         param.sched_priority = sched_get_priority_max(SCHED_FIFO);
         break;
     }
     default:
-        return THREAD_ERROR_CREATE;
+        return ThreadError::THREAD_ERROR_CREATE;
     }
-    return pthread_setschedparam(handle->thread, policy, &param) == 0 ? THREAD_SUCCESS : THREAD_ERROR_CREATE;
+    return pthread_setschedparam(handle->thread, policy, &param) == 0 ? ThreadError::THREAD_SUCCESS : ThreadError::THREAD_ERROR_CREATE;
 }
-unsigned int thread_get_id()
+size_t thread_get_id()
 {
-    return (unsigned int)pthread_self();
+    return static_cast<size_t>(pthread_self());
 }
 void thread_yield()
 {
     sched_yield();
 }
-void thread_sleep(unsigned int ms)
+void thread_sleep(size_t ms)
 {
     usleep(ms * 1000);
 }
@@ -141,14 +195,18 @@ void mutex_destroy(mutex_handle *handle)
         pthread_mutex_destroy(&handle->mutex);
 }
 
-ThreadError mutex_lock(mutex_handle *handle, unsigned int timeout_ms)
+ThreadError mutex_lock(mutex_handle *handle, size_t timeout_ms)
 {
     if (!handle)
-        return THREAD_ERROR_CREATE;
+        return ThreadError::THREAD_ERROR_CREATE;
 
-    if (timeout_ms == 0)
+    if (timeout_ms == WAIT_INFINITE)
     {
-        return pthread_mutex_lock(&handle->mutex) == 0 ? THREAD_SUCCESS : THREAD_ERROR_WAIT;
+        return pthread_mutex_lock(&handle->mutex) == 0 ? ThreadError::THREAD_SUCCESS : ThreadError::THREAD_ERROR_WAIT;
+    }
+    else if (timeout_ms == 0)
+    {
+        return pthread_mutex_trylock(&handle->mutex) == 0 ? ThreadError::THREAD_SUCCESS : ThreadError::THREAD_ERROR_TIMEOUT;
     }
     else
     {
@@ -160,19 +218,21 @@ ThreadError mutex_lock(mutex_handle *handle, unsigned int timeout_ms)
 
         // Normalize nanoseconds
         if (ts.tv_nsec >= 1000000000)
+        {
             ts.tv_sec++;
-        ts.tv_nsec -= 1000000000;
+            ts.tv_nsec -= 1000000000;
+        }
 
         int result = pthread_mutex_timedlock(&handle->mutex, &ts);
 
         switch (result)
         {
         case 0:
-            return THREAD_SUCCESS;
+            return ThreadError::THREAD_SUCCESS;
         case ETIMEDOUT:
-            return THREAD_ERROR_TIMEOUT;
+            return ThreadError::THREAD_ERROR_TIMEOUT;
         default:
-            return THREAD_ERROR_WAIT;
+            return ThreadError::THREAD_ERROR_WAIT;
         }
     }
 }
@@ -200,14 +260,18 @@ void rwlock_destroy(rwlock_handle *handle)
     }
 }
 
-ThreadError rwlock_read_lock(rwlock_handle *handle, unsigned int timeout_ms)
+ThreadError rwlock_read_lock(rwlock_handle *handle, size_t timeout_ms)
 {
     if (!handle)
-        return THREAD_ERROR_CREATE;
+        return ThreadError::THREAD_ERROR_CREATE;
 
-    if (timeout_ms == 0)
+    if (timeout_ms == WAIT_INFINITE)
     {
-        return pthread_rwlock_rdlock(&handle->rwlock) == 0 ? THREAD_SUCCESS : THREAD_ERROR_WAIT;
+        return pthread_rwlock_rdlock(&handle->rwlock) == 0 ? ThreadError::THREAD_SUCCESS : ThreadError::THREAD_ERROR_WAIT;
+    }
+    else if (timeout_ms == 0)
+    {
+        return pthread_rwlock_tryrdlock(&handle->rwlock) == 0 ? ThreadError::THREAD_SUCCESS : ThreadError::THREAD_ERROR_TIMEOUT;
     }
     else
     {
@@ -229,23 +293,27 @@ ThreadError rwlock_read_lock(rwlock_handle *handle, unsigned int timeout_ms)
         switch (result)
         {
         case 0:
-            return THREAD_SUCCESS;
+            return ThreadError::THREAD_SUCCESS;
         case ETIMEDOUT:
-            return THREAD_ERROR_TIMEOUT;
+            return ThreadError::THREAD_ERROR_TIMEOUT;
         default:
-            return THREAD_ERROR_WAIT;
+            return ThreadError::THREAD_ERROR_WAIT;
         }
     }
 }
 
-ThreadError rwlock_write_lock(rwlock_handle *handle, unsigned int timeout_ms)
+ThreadError rwlock_write_lock(rwlock_handle *handle, size_t timeout_ms)
 {
     if (!handle)
-        return THREAD_ERROR_CREATE;
+        return ThreadError::THREAD_ERROR_CREATE;
 
-    if (timeout_ms == 0)
+    if (timeout_ms == WAIT_INFINITE)
+    {
+        return pthread_rwlock_wrlock(&handle->rwlock) == 0 ? ThreadError::THREAD_SUCCESS : ThreadError::THREAD_ERROR_WAIT;
+    }
+    else if (timeout_ms == 0)
     {
-        return pthread_rwlock_wrlock(&handle->rwlock) == 0 ? THREAD_SUCCESS : THREAD_ERROR_WAIT;
+        return pthread_rwlock_trywrlock(&handle->rwlock) == 0 ? ThreadError::THREAD_SUCCESS : ThreadError::THREAD_ERROR_TIMEOUT;
     }
     else
     {
@@ -267,11 +335,11 @@ ThreadError rwlock_write_lock(rwlock_handle *handle, unsigned int timeout_ms)
         switch (result)
         {
         case 0:
-            return THREAD_SUCCESS;
+            return ThreadError::THREAD_SUCCESS;
         case ETIMEDOUT:
-            return THREAD_ERROR_TIMEOUT;
+            return ThreadError::THREAD_ERROR_TIMEOUT;
         default:
-            return THREAD_ERROR_WAIT;
+            return ThreadError::THREAD_ERROR_WAIT;
         }
     }
 }
@@ -309,15 +377,15 @@ void condition_destroy(condition_handle *handle)
     }
 }
 
-ThreadError condition_wait(condition_handle *handle, mutex_handle *mutex, unsigned int timeout_ms)
+ThreadError condition_wait(condition_handle *handle, mutex_handle *mutex, size_t timeout_ms)
 {
     if (!handle || !mutex)
-        return THREAD_ERROR_CREATE;
+        return ThreadError::THREAD_ERROR_CREATE;
 
-    if (timeout_ms == 0)
+    if (timeout_ms == WAIT_INFINITE)
     {
         // Infinite wait
-        return pthread_cond_wait(&handle->cond, &mutex->mutex) == 0 ? THREAD_SUCCESS : THREAD_ERROR_WAIT;
+        return pthread_cond_wait(&handle->cond, &mutex->mutex) == 0 ? ThreadError::THREAD_SUCCESS : ThreadError::THREAD_ERROR_WAIT;
     }
     else
     {
@@ -340,11 +408,11 @@ ThreadError condition_wait(condition_handle *handle, mutex_handle *mutex, unsign
         switch (result)
         {
         case 0:
-            return THREAD_SUCCESS;
+            return ThreadError::THREAD_SUCCESS;
         case ETIMEDOUT:
-            return THREAD_ERROR_TIMEOUT;
+            return ThreadError::THREAD_ERROR_TIMEOUT;
         default:
-            return THREAD_ERROR_WAIT;
+            return ThreadError::THREAD_ERROR_WAIT;
         }
     }
 }
@@ -366,7 +434,7 @@ void condition_broadcast(condition_handle *handle)
 }
 
 // Barrier synchronization
-barrier_handle *barrier_create(unsigned int thread_count)
+barrier_handle *barrier_create(size_t thread_count)
 {
     barrier_handle *handle = new barrier_handle;
     if (pthread_barrier_init(&handle->barrier, nullptr, thread_count) != 0)
@@ -389,9 +457,9 @@ void barrier_destroy(barrier_handle *handle)
 ThreadError barrier_wait(barrier_handle *handle)
 {
     if (!handle)
-        return THREAD_ERROR_WAIT;
+        return ThreadError::THREAD_ERROR_WAIT;
     int result = pthread_barrier_wait(&handle->barrier);
-    return (result == 0 || result == PTHREAD_BARRIER_SERIAL_THREAD) ? THREAD_SUCCESS : THREAD_ERROR_WAIT;
+    return (result == 0 || result == PTHREAD_BARRIER_SERIAL_THREAD) ? ThreadError::THREAD_SUCCESS : ThreadError::THREAD_ERROR_WAIT;
 }
 
 // Spinlock operations
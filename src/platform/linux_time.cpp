@@ -0,0 +1,25 @@
+#include <errno.h>
+#include <platform/time.h>
+#include <time.h>
+
+namespace LunaVoxelEngine::Platform
+{
+unsigned long long time_now_ns() noexcept
+{
+    // Served from the vDSO, without entering the kernel.
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<unsigned long long>(ts.tv_sec) * 1000000000ULL + static_cast<unsigned long long>(ts.tv_nsec);
+}
+
+void time_sleep_ns(unsigned long long ns) noexcept
+{
+    struct timespec ts;
+    ts.tv_sec = static_cast<time_t>(ns / 1000000000ULL);
+    ts.tv_nsec = static_cast<long>(ns % 1000000000ULL);
+    // A signal returns early with the time left in ts.
+    while (clock_nanosleep(CLOCK_MONOTONIC, 0, &ts, &ts) == EINTR)
+    {
+    }
+}
+} // namespace LunaVoxelEngine::Platform
@@ -1,7 +1,7 @@
 #include <platform/log.h>
 #include <platform/window.h>
 #include <utils/algorithm.h>
-#include <utils/string.h>
+#include <utils/string8.h>
 #ifdef USE_WAYLAND
 extern "C"
 {
@@ -68,7 +68,7 @@ const static wl_registry_listener registry_listener = {
     .global_remove = [](void *, wl_registry *, uint32_t) {},
 };
 
-Window::Window(unsigned int width, unsigned int height, const Utils::String &title)
+Window::Window(unsigned int width, unsigned int height, Utils::StringView title)
 {
     wl_display *display = wl_display_connect(nullptr);
     [[unlikely]] if (!display)
@@ -107,9 +107,11 @@ Window::Window(unsigned int width, unsigned int height, const Utils::String &tit
         Log::fatal("Failed to create xdg_toplevel");
     }
 
-    xdg_toplevel_set_title(xdg_toplevel, title.throw_away().c_str());
-    Utils::String app_id = "com.github.LunaVoxelEngine." + title;
-    xdg_toplevel_set_app_id(xdg_toplevel, app_id.throw_away().c_str());
+    Utils::String8 app_id("com.github.LunaVoxelEngine.");
+    app_id.append(title);
+    // The title is the null terminated tail of the app id, so one buffer serves both requests.
+    xdg_toplevel_set_title(xdg_toplevel, app_id.c_str() + app_id.size() - title.size());
+    xdg_toplevel_set_app_id(xdg_toplevel, app_id.c_str());
     data->xdg_toplevel = xdg_toplevel;
 
     xdg_positioner *positioner = xdg_wm_base_create_positioner(data->xdg_wm_base);
@@ -201,7 +203,7 @@ struct __WindowData
     bool should_close = false;
 };
 
-Window::Window(unsigned int width, unsigned int height, const Utils::String &title)
+Window::Window(unsigned int width, unsigned int height, Utils::StringView title)
 {
     __WindowData *data = new __WindowData{};
     uint32_t mask = XCB_CW_BACK_PIXEL | XCB_CW_EVENT_MASK;
@@ -225,9 +227,8 @@ Window::Window(unsigned int width, unsigned int height, const Utils::String &tit
     xcb_change_property(data->con, XCB_PROP_MODE_REPLACE, data->win, (*reply).atom, 4, 32, 1,
                         &(*data->atom_wm_delete_window).atom);
     free(reply);
-    auto temp = title.throw_away();
-    xcb_change_property(data->con, XCB_PROP_MODE_REPLACE, data->win, XCB_ATOM_WM_NAME, XCB_ATOM_STRING, 8, temp.size(),
-                        temp.c_str());
+    xcb_change_property(data->con, XCB_PROP_MODE_REPLACE, data->win, XCB_ATOM_WM_NAME, XCB_ATOM_STRING, 8,
+                        title.size(), title.data());
 
     /* Map the window on the screen */
     xcb_map_window(data->con, data->win);
@@ -1,14 +1,315 @@
 #ifndef LOG_H
 #define LOG_H
-#include <utils/string.h>
+#include <utils/atomic.h>
+#include <utils/format.h>
+
+#ifndef LUNA_LOG_MIN_LEVEL
+/// Records below this Level (as a number, 0 = LOG_TRACE) are compiled out. Set by the LOG_MIN_LEVEL CMake option.
+#    define LUNA_LOG_MIN_LEVEL 0
+#endif
 
 namespace LunaVoxelEngine::Log
 {
-void trace(const Utils::String &fmt, ...) noexcept;
-void debug(const Utils::String &fmt, ...) noexcept;
-void info(const Utils::String &fmt, ...) noexcept;
-void warn(const Utils::String &fmt, ...) noexcept;
-void error(const Utils::String &fmt, ...) noexcept;
-void fatal(const Utils::String &fmt, ...) noexcept;
+enum class Level : unsigned char
+{
+    LOG_TRACE,
+    LOG_DEBUG,
+    LOG_INFO,
+    LOG_WARN,
+    LOG_ERROR,
+    LOG_FATAL
+};
+
+/**
+ * @brief The subsystem a record comes from, for per-module filtering with set_module_level().
+ */
+enum class Module : unsigned char
+{
+    GENERAL,
+    PLATFORM,
+    RENDERER,
+    VULKAN,
+    UTILS,
+    MODULE_COUNT
+};
+
+constexpr Level MIN_LEVEL = static_cast<Level>(LUNA_LOG_MIN_LEVEL);
+
+/**
+ * @brief Whether records of this level are built in at all: at least MIN_LEVEL, and DEBUG only in debug builds.
+ */
+constexpr bool is_compiled(Level level) noexcept
+{
+#ifdef DEBUG
+    return level >= MIN_LEVEL;
+#else
+    return level >= MIN_LEVEL && level != Level::LOG_DEBUG;
+#endif
+}
+
+enum class OverflowPolicy : unsigned char
+{
+    OVERFLOW_DROP,  ///< Discard the record and count it; the writer thread reports the total later.
+    OVERFLOW_BLOCK, ///< Spin until the writer thread makes room.
+};
+
+enum class LogEncoding : unsigned char
+{
+    ENCODING_TEXT,     ///< Callers format; the rings carry finished lines.
+    ENCODING_DEFERRED, ///< Callers copy the format ID and raw arguments; the writer thread formats.
+    ENCODING_BINARY,   ///< As deferred, but the writer emits a binary stream for LunaLogDecode to format offline.
+};
+
+struct AsyncConfig
+{
+    unsigned long ring_size = 64 * 1024; ///< Bytes per logging thread, rounded up to a power of two.
+    OverflowPolicy overflow = OverflowPolicy::OVERFLOW_DROP;
+    unsigned long idle_sleep_ms = 1; ///< How long the writer thread sleeps when every ring is empty.
+    LogEncoding encoding = LogEncoding::ENCODING_TEXT;
+};
+
+/**
+ * @brief Starts the background writer. Until then, and after stop_async(), records are written synchronously.
+ * @details Each logging thread gets its own lock-free ring on first use, so callers only format and copy;
+ *          the writer thread gathers all rings into one writev per pass. Records from one thread stay in
+ *          order; records from different threads are interleaved by line.
+ */
+void start_async(const AsyncConfig &config = AsyncConfig()) noexcept;
+
+/**
+ * @brief Drains everything pending, stops the writer thread and reverts to synchronous output.
+ */
+void stop_async() noexcept;
+
+/**
+ * @brief Blocks until every record submitted so far has been written.
+ */
+void flush() noexcept;
+
+/**
+ * @brief Mirrors every record into a memory-mapped circular file that outlives the process, for reading back
+ *        with LunaCrashLog after a crash.
+ * @details Each record costs a few plain memory stores; the kernel writes the pages back, even if the process
+ *          is killed. Lines are copied as they are submitted, so records still queued for the async writer are
+ *          in the file too. With a crash log open, the deferred and binary encodings also format on the caller.
+ *          An existing file of the same size is appended to rather than cleared.
+ * @param size Bytes of history to keep, rounded up to a power of two.
+ * @warning Open before and close after any other thread logs.
+ * @return false if the file cannot be created or mapped.
+ */
+constexpr const char *DEFAULT_CRASH_LOG_PATH = "LunaVoxelEngine.crashlog";
+bool open_crash_log(const char *path, unsigned long size = 4 * 1024 * 1024) noexcept;
+void close_crash_log() noexcept;
+
+/**
+ * @brief Drops records from module below level at runtime. Every module starts at LOG_TRACE; FATAL is always
+ *        written.
+ */
+void set_module_level(Module module, Level level) noexcept;
+[[nodiscard]] Level get_module_level(Module module) noexcept;
+
+namespace detail
+{
+/// Bit (module * 8 + level) is set while that module logs that level.
+extern Utils::Atomic<unsigned long long> level_mask;
+} // namespace detail
+
+/**
+ * @brief The runtime filter. With constant arguments this is one relaxed load, a bit test and a branch.
+ */
+[[nodiscard]] inline bool is_enabled(Module module, Level level) noexcept
+{
+    const unsigned int bit = static_cast<unsigned int>(module) * 8 + static_cast<unsigned int>(level);
+    return is_compiled(level) && (detail::level_mask.load(Utils::MemoryOrder::RELAXED) >> bit & 1) != 0;
+}
+
+struct ThrottleResult
+{
+    bool allowed;
+    unsigned int suppressed; ///< Occurrences of the key swallowed since the last one allowed.
+};
+
+/**
+ * @class LogThrottle
+ * @brief Bounds how often one kind of message is logged, for sources that repeat the same message every frame.
+ * @details The first `burst` occurrences of a key are allowed, after that only occurrence 2 * burst, 4 * burst
+ *          and so on, so a flood costs O(log n) lines. Keys share SLOTS counters, so rare collisions merge
+ *          two keys' counts. Thread-safe.
+ */
+class LogThrottle final
+{
+  public:
+    static constexpr unsigned int SLOTS = 64;
+
+    explicit constexpr LogThrottle(unsigned int burst_in = 4) noexcept
+        : burst(burst_in > 0 ? burst_in : 1)
+    {
+    }
+    LogThrottle(const LogThrottle &) = delete;
+    LogThrottle &operator=(const LogThrottle &) = delete;
+
+    [[nodiscard]] ThrottleResult admit(unsigned long long key) noexcept;
+
+    /**
+     * @brief Starts every key over, e.g. after the condition that caused a flood has been fixed.
+     */
+    void reset() noexcept;
+
+  private:
+    Utils::Atomic<unsigned int> counts[SLOTS];
+    unsigned int burst;
+};
+
+/**
+ * @brief Writes one record from a compiled format.
+ * @param args One entry per conversion in format; may be null when there are none.
+ */
+void write_formatted(Level level, const Utils::FormatView &format, const Utils::FormatArg *args) noexcept;
+
+/**
+ * @brief Writes every pending record and then a FATAL record, and terminates the process.
+ */
+[[noreturn]] void write_fatal(const Utils::FormatView &format, const Utils::FormatArg *args) noexcept;
+
+namespace detail
+{
+template<typename... Args>
+inline void write(Level level, const Utils::FormatView &format, const Args &...args) noexcept
+{
+    if constexpr (sizeof...(Args) == 0)
+    {
+        write_formatted(level, format, nullptr);
+    }
+    else
+    {
+        const Utils::FormatArg packed[] = {Utils::make_format_arg(args)...};
+        write_formatted(level, format, packed);
+    }
+}
+
+template<typename... Args>
+[[noreturn]] inline void log_fatal(const Utils::FormatView &format, const Args &...args) noexcept
+{
+    if constexpr (sizeof...(Args) == 0)
+    {
+        write_fatal(format, nullptr);
+    }
+    else
+    {
+        const Utils::FormatArg packed[] = {Utils::make_format_arg(args)...};
+        write_fatal(format, packed);
+    }
+}
+
+// The LUNA_LOG macros have already filtered; this only checks the format against the arguments.
+template<typename... Args>
+inline void write_unchecked(Level level, Utils::FormatFor<Args...> fmt, const Args &...args) noexcept
+{
+    write(level, fmt.view(), args...);
+}
+
+template<Level L, typename... Args>
+inline void log(Module module, const Utils::FormatView &format, const Args &...args) noexcept
+{
+    if constexpr (is_compiled(L))
+    {
+        if (is_enabled(module, L))
+        {
+            write(L, format, args...);
+        }
+    }
+}
+} // namespace detail
+
+/**
+ * @brief Writes a record whose level is only known at runtime, subject to the same filters.
+ */
+template<typename... Args>
+inline void write(Level level, Module module, Utils::FormatFor<Args...> fmt, const Args &...args) noexcept
+{
+    if (is_enabled(module, level))
+    {
+        detail::write(level, fmt.view(), args...);
+    }
+}
+
+// Format strings are parsed and checked against the argument types at compile time; see Utils::FormatString.
+// The arguments are evaluated even when the record is filtered out; the LUNA_LOG macros below avoid that.
+template<typename... Args>
+inline void trace(Module module, Utils::FormatFor<Args...> fmt, const Args &...args) noexcept
+{
+    detail::log<Level::LOG_TRACE>(module, fmt.view(), args...);
+}
+template<typename... Args>
+inline void debug(Module module, Utils::FormatFor<Args...> fmt, const Args &...args) noexcept
+{
+    detail::log<Level::LOG_DEBUG>(module, fmt.view(), args...);
+}
+template<typename... Args>
+inline void info(Module module, Utils::FormatFor<Args...> fmt, const Args &...args) noexcept
+{
+    detail::log<Level::LOG_INFO>(module, fmt.view(), args...);
+}
+template<typename... Args>
+inline void warn(Module module, Utils::FormatFor<Args...> fmt, const Args &...args) noexcept
+{
+    detail::log<Level::LOG_WARN>(module, fmt.view(), args...);
+}
+template<typename... Args>
+inline void error(Module module, Utils::FormatFor<Args...> fmt, const Args &...args) noexcept
+{
+    detail::log<Level::LOG_ERROR>(module, fmt.view(), args...);
+}
+
+template<typename... Args> inline void trace(Utils::FormatFor<Args...> fmt, const Args &...args) noexcept
+{
+    detail::log<Level::LOG_TRACE>(Module::GENERAL, fmt.view(), args...);
+}
+template<typename... Args> inline void debug(Utils::FormatFor<Args...> fmt, const Args &...args) noexcept
+{
+    detail::log<Level::LOG_DEBUG>(Module::GENERAL, fmt.view(), args...);
+}
+template<typename... Args> inline void info(Utils::FormatFor<Args...> fmt, const Args &...args) noexcept
+{
+    detail::log<Level::LOG_INFO>(Module::GENERAL, fmt.view(), args...);
+}
+template<typename... Args> inline void warn(Utils::FormatFor<Args...> fmt, const Args &...args) noexcept
+{
+    detail::log<Level::LOG_WARN>(Module::GENERAL, fmt.view(), args...);
+}
+template<typename... Args> inline void error(Utils::FormatFor<Args...> fmt, const Args &...args) noexcept
+{
+    detail::log<Level::LOG_ERROR>(Module::GENERAL, fmt.view(), args...);
+}
+template<typename... Args> [[noreturn]] inline void fatal(Utils::FormatFor<Args...> fmt, const Args &...args) noexcept
+{
+    detail::log_fatal(fmt.view(), args...);
+}
 } // namespace LunaVoxelEngine::Log
-#endif
\ No newline at end of file
+
+/*
+ * Statement forms of the functions above that do not evaluate their arguments unless the record is written:
+ *
+ *     LUNA_LOG_WARN(VULKAN, "Swapchain out of date: %s", describe(result));
+ *
+ * Below LUNA_LOG_MIN_LEVEL the statement compiles to nothing; otherwise a filtered record costs is_enabled().
+ */
+#define LUNA_LOG_AT(LEVEL, MODULE, ...)                                                                                \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        if constexpr (::LunaVoxelEngine::Log::is_compiled(::LunaVoxelEngine::Log::Level::LEVEL))                       \
+        {                                                                                                              \
+            if (::LunaVoxelEngine::Log::is_enabled(::LunaVoxelEngine::Log::Module::MODULE,                             \
+                                                   ::LunaVoxelEngine::Log::Level::LEVEL))                              \
+            {                                                                                                          \
+                ::LunaVoxelEngine::Log::detail::write_unchecked(::LunaVoxelEngine::Log::Level::LEVEL, __VA_ARGS__);    \
+            }                                                                                                          \
+        }                                                                                                              \
+    } while (0)
+
+#define LUNA_LOG_TRACE(MODULE, ...) LUNA_LOG_AT(LOG_TRACE, MODULE, __VA_ARGS__)
+#define LUNA_LOG_DEBUG(MODULE, ...) LUNA_LOG_AT(LOG_DEBUG, MODULE, __VA_ARGS__)
+#define LUNA_LOG_INFO(MODULE, ...) LUNA_LOG_AT(LOG_INFO, MODULE, __VA_ARGS__)
+#define LUNA_LOG_WARN(MODULE, ...) LUNA_LOG_AT(LOG_WARN, MODULE, __VA_ARGS__)
+#define LUNA_LOG_ERROR(MODULE, ...) LUNA_LOG_AT(LOG_ERROR, MODULE, __VA_ARGS__)
+#endif
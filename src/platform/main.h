@@ -1,17 +1,34 @@
 #ifndef COMMON_MAIN_H
 #define COMMON_MAIN_H
+#include <platform/frame_loop.h>
+#include <platform/settings.h>
 #include <platform/window.h>
-#include <renderer/vulkan/cmd_buffer.h>
+#include <renderer/vulkan/bindless.h>
+#include <renderer/vulkan/chunk_renderer.h>
+#include <renderer/vulkan/depth_pyramid.h>
 #include <renderer/vulkan/device.h>
+#include <renderer/vulkan/frame_ring.h>
+#include <renderer/vulkan/image.h>
+#include <renderer/vulkan/parallel_recorder.h>
 #include <renderer/vulkan/swapchain.h>
 #include <renderer/vulkan/pipeline.h>
+#include <renderer/vulkan/pipeline_cache.h>
+#include <renderer/vulkan/pipeline_compiler.h>
 #include <renderer/vulkan/queue.h>
+#include <renderer/vulkan/render_graph.h>
+#include <renderer/vulkan/timeline.h>
+#include <renderer/vulkan/upload_queue.h>
+#include <utils/string_view.h>
+#include <utils/vector.h>
 namespace LunaVoxelEngine::Platform
 {
 class Runtime final
 {
   public:
-    bool Init(Utils::Vector<Utils::String> args) noexcept;
+    /**
+     * @brief Reads settings from args (argv, as UTF-8 views) and the config file, then creates the renderer.
+     */
+    bool Init(const Utils::Vector<Utils::StringView> &args) noexcept;
     bool IsRunning() const noexcept;
     void Update() noexcept;
     void Shutdown() noexcept;
@@ -30,12 +47,62 @@ class Runtime final
     }
 
   private:
-    Window *window;
+    /**
+     * @brief Pushes reloadable settings that changed since the last call to the systems that use them.
+     */
+    void ApplySettings() noexcept;
+    /**
+     * @brief Advances the simulation by one fixed step of dt seconds.
+     */
+    void Tick(double dt) noexcept;
+    /**
+     * @brief Draws one frame; alpha in [0, 1) is how far real time is between the last two simulation steps.
+     */
+    void Render(float alpha) noexcept;
+    /**
+     * @brief Adds the frame's passes to render_graph and compiles it; the passes do not change between frames.
+     */
+    void BuildRenderGraph() noexcept;
+    // Passes of render_graph; user is the Runtime.
+    static void RecordCull(Renderer::CommandBuffer &command_buffer, const Renderer::RenderGraph &graph,
+                           void *user) noexcept;
+    static void RecordDraw(Renderer::CommandBuffer &command_buffer, const Renderer::RenderGraph &graph,
+                           void *user) noexcept;
+    static void RecordDepthPyramid(Renderer::CommandBuffer &command_buffer, const Renderer::RenderGraph &graph,
+                                   void *user) noexcept;
+    static void RecordLateCull(Renderer::CommandBuffer &command_buffer, const Renderer::RenderGraph &graph,
+                               void *user) noexcept;
+    static void RecordLateDraw(Renderer::CommandBuffer &command_buffer, const Renderer::RenderGraph &graph,
+                               void *user) noexcept;
+    /**
+     * @brief Begins rendering to the frame's target and the depth buffer, clearing both or loading what is there,
+     *        for secondary command buffers if the chunks are recorded into them.
+     */
+    void BeginChunkRendering(Renderer::CommandBuffer &command_buffer, const Renderer::RenderGraph &graph,
+                             VkAttachmentLoadOp load_op) const noexcept;
+
+    Settings settings;
+    unsigned long long settings_generation = 0;
+    FrameLoop frame_loop;
+    Window *window = nullptr; ///< Null when headless, as is swap_chain.
     Renderer::Queue *queue;
-    Renderer::Pipeline* pipeline;
+    Renderer::Timeline *timeline; ///< The graphics queue's; also holds resources awaiting deletion.
+    Renderer::PipelineCache *pipeline_cache;
+    Renderer::PipelineCompiler *pipelines;
     Renderer::Device *device;
-    Renderer::SwapChain *swap_chain;
-    Renderer::CommandBuffer *command_buffer;
+    Renderer::SwapChain *swap_chain = nullptr;
+    Renderer::FrameRing *frames;
+    Renderer::UploadQueue *uploads;
+    Renderer::BindlessHeap *bindless;
+    Renderer::DepthPyramid *depth_pyramid;
+    Renderer::ParallelRecorder *recorder;
+    Renderer::ChunkRenderer *chunks;
+    Renderer::RenderGraph *render_graph;
+    Renderer::RenderResource target_resource = Renderer::INVALID_RENDER_RESOURCE; ///< This frame's color target.
+    Renderer::RenderResource depth_resource = Renderer::INVALID_RENDER_RESOURCE;
+    Renderer::Image *offscreen_targets[Renderer::MAX_FRAMES_IN_FLIGHT] = {}; ///< Render targets when headless.
+    bool headless = false;
+    unsigned long long run_start_ns = 0;
 };
 } // namespace LunaVoxelEngine::Platform
 #endif
\ No newline at end of file
@@ -0,0 +1,124 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+#include <platform/time.h>
+#include <utils/atomic.h>
+namespace LunaVoxelEngine
+{
+namespace Platform
+{
+constexpr unsigned int PROFILER_EVENTS_PER_THREAD = 64 * 1024;
+
+/**
+ * @brief Starts recording LUNA_PROFILE_SCOPE scopes on every thread, replacing the previous capture.
+ * @details Each thread records into its own buffer of PROFILER_EVENTS_PER_THREAD events, so recording takes no locks;
+ *          once a buffer is full, further events in the capture are counted and dropped.
+ */
+void profiler_begin_capture() noexcept;
+void profiler_end_capture() noexcept;
+
+/**
+ * @brief Writes the last capture as Chrome trace JSON, for chrome://tracing or ui.perfetto.dev.
+ * @warning Call after profiler_end_capture(), once the instrumented threads are quiet.
+ * @return false if the file cannot be written.
+ */
+bool profiler_write_chrome_trace(const char *path) noexcept;
+
+/**
+ * @brief Labels the calling thread in exported traces. name must outlive the profiler, e.g. a literal.
+ */
+void profiler_set_thread_name(const char *name) noexcept;
+
+namespace detail
+{
+struct ProfileEvent
+{
+    const char *name;
+    unsigned long long begin;
+    unsigned long long end;
+};
+
+/**
+ * Events of one thread. Only the owner writes; the exporter reads up to count. A thread notices a new capture
+ * by its generation and starts over from the front.
+ */
+struct ThreadEvents
+{
+    ProfileEvent *events;
+    ThreadEvents *next;
+    const char *name;
+    unsigned int index;
+    Utils::Atomic<unsigned int> generation;
+    Utils::Atomic<unsigned int> count;
+};
+
+/// The capture's generation while one is running, otherwise 0.
+extern Utils::Atomic<unsigned int> profiler_capturing;
+/// The calling thread's events, or null until it first records.
+inline thread_local ThreadEvents *profiler_thread_events = nullptr;
+/// Registers the thread or starts its events over for a new capture, then records; also counts dropped events.
+void profiler_record(const char *name, unsigned long long begin, unsigned long long end) noexcept;
+} // namespace detail
+
+/**
+ * @class ProfileScope
+ * @brief Records the time between construction and destruction as one trace event. Use LUNA_PROFILE_SCOPE.
+ *        Scopes entered before profiler_begin_capture() are not recorded.
+ */
+class [[nodiscard]] ProfileScope final
+{
+  public:
+    // Outside a capture a scope costs one relaxed load and a branch at each end. In one, it reads the clock at
+    // each end and appends the event to the thread's buffer inline; only a thread's first event of a capture, or
+    // one that does not fit, takes the call.
+    explicit ProfileScope(const char *name_in) noexcept
+        : name(name_in)
+        , generation(detail::profiler_capturing.load(Utils::MemoryOrder::RELAXED))
+        , begin(generation != 0 ? time_ticks() : 0)
+    {
+    }
+
+    ~ProfileScope()
+    {
+        if (generation == 0)
+        {
+            return;
+        }
+        const unsigned long long end = time_ticks();
+        detail::ThreadEvents *events = detail::profiler_thread_events;
+        if (events != nullptr && events->generation.load(Utils::MemoryOrder::RELAXED) == generation)
+        {
+            const unsigned int count = events->count.load(Utils::MemoryOrder::RELAXED);
+            if (count < PROFILER_EVENTS_PER_THREAD)
+            {
+                events->events[count] = {name, begin, end};
+                events->count.store(count + 1, Utils::MemoryOrder::RELEASE);
+                return;
+            }
+        }
+        detail::profiler_record(name, begin, end);
+    }
+
+    ProfileScope(const ProfileScope &) = delete;
+    ProfileScope &operator=(const ProfileScope &) = delete;
+
+  private:
+    const char *name;
+    unsigned int generation;
+    unsigned long long begin;
+};
+} // namespace Platform
+} // namespace LunaVoxelEngine
+
+/*
+ * LUNA_PROFILE_SCOPE("name") times the rest of the enclosing block. name must be a string literal. Without the
+ * ENABLE_PROFILER CMake option (LUNA_PROFILER) it expands to nothing.
+ */
+#if defined(LUNA_PROFILER)
+#    define LUNA_PROFILE_CONCAT_(A, B) A##B
+#    define LUNA_PROFILE_CONCAT(A, B) LUNA_PROFILE_CONCAT_(A, B)
+#    define LUNA_PROFILE_SCOPE(NAME)                                                                                   \
+        const ::LunaVoxelEngine::Platform::ProfileScope LUNA_PROFILE_CONCAT(luna_profile_scope_, __LINE__)(NAME)
+#else
+#    define LUNA_PROFILE_SCOPE(NAME) static_cast<void>(0)
+#endif
+#endif
@@ -0,0 +1,174 @@
+#ifndef SETTINGS_H
+#define SETTINGS_H
+#include <utils/atomic.h>
+#include <utils/string_view.h>
+#include <utils/vector.h>
+namespace LunaVoxelEngine
+{
+namespace Platform
+{
+/*
+ * Engine settings come from three places, later ones winning: the defaults in SETTING_INFO, the config file,
+ * and the command line. The file is INI-like:
+ *
+ *   # comment                  ; also a comment
+ *   [render]
+ *   distance = 16              read as render.distance
+ *   present_mode = "mailbox"
+ *
+ * On the command line the same keys are written --render.distance 16 or --render.distance=16, and a bool
+ * given without a value is set. Parsing tokenizes in place over the mapped file or argv and never allocates.
+ */
+enum class SettingId : unsigned char
+{
+    RENDER_DISTANCE,
+    MAX_FPS,
+    FRAMES_IN_FLIGHT,
+    PRESENT_MODE,
+    HEADLESS,
+    FRAME_LIMIT,
+    WORKER_THREADS,
+    GPU_MEMORY_BUDGET_MB,
+    STAGING_BUDGET_MB,
+    PIPELINE_THREADS,
+    PIPELINE_CACHE_PATH,
+    PROFILE_PATH,
+    MAX_CHUNKS,
+    SETTING_COUNT
+};
+
+enum class SettingType : unsigned char
+{
+    SETTING_BOOL,
+    SETTING_UINT,
+    SETTING_ENUM,  ///< Stored as the index of the value's name in enum_names.
+    SETTING_STRING ///< Read once at startup; never reloaded.
+};
+
+enum class PresentMode : unsigned char
+{
+    PRESENT_FIFO,
+    PRESENT_MAILBOX,
+    PRESENT_IMMEDIATE
+};
+
+struct SettingInfo
+{
+    const char *key;
+    const char *alias; ///< A shorter command line spelling, without the dashes, or null.
+    SettingType type;
+    bool reloadable; ///< Whether a change in the config file applies while running.
+    unsigned long long default_value;
+    unsigned long long min_value;
+    unsigned long long max_value;
+    const char *const *enum_names; ///< max_value + 1 names, for SETTING_ENUM.
+};
+
+constexpr const char *PRESENT_MODE_NAMES[] = {"fifo", "mailbox", "immediate"};
+
+/// In SettingId order.
+constexpr SettingInfo SETTING_INFO[] = {
+    {"render.distance", nullptr, SettingType::SETTING_UINT, true, 12, 2, 64, nullptr},
+    {"render.max_fps", "max-fps", SettingType::SETTING_UINT, true, 0, 0, 1000, nullptr},
+    {"render.frames_in_flight", "frames-in-flight", SettingType::SETTING_UINT, false, 2, 1, 4, nullptr},
+    {"render.present_mode", nullptr, SettingType::SETTING_ENUM, false, 1, 0, 2, PRESENT_MODE_NAMES},
+    {"run.headless", "headless", SettingType::SETTING_BOOL, false, 0, 0, 1, nullptr},
+    {"run.frames", "frames", SettingType::SETTING_UINT, false, 0, 0, 0xFFFFFFFF, nullptr},
+    {"jobs.workers", nullptr, SettingType::SETTING_UINT, false, 0, 0, 256, nullptr},
+    {"memory.gpu_budget_mb", nullptr, SettingType::SETTING_UINT, true, 0, 0, 1 << 20, nullptr},
+    {"memory.staging_mb", nullptr, SettingType::SETTING_UINT, false, 64, 1, 4096, nullptr},
+    {"render.pipeline_threads", nullptr, SettingType::SETTING_UINT, false, 2, 0, 8, nullptr},
+    {"render.pipeline_cache", nullptr, SettingType::SETTING_STRING, false, 0, 0, 0, nullptr},
+    {"run.profile", "profile", SettingType::SETTING_STRING, false, 0, 0, 0, nullptr},
+    {"render.max_chunks", nullptr, SettingType::SETTING_UINT, false, 16384, 1, 1 << 20, nullptr},
+};
+static_assert(sizeof(SETTING_INFO) / sizeof(SETTING_INFO[0]) == static_cast<unsigned long>(SettingId::SETTING_COUNT),
+              "SETTING_INFO must have one entry per SettingId");
+
+constexpr const char *DEFAULT_CONFIG_PATH = "LunaVoxelEngine.ini";
+
+/**
+ * @class Settings
+ * @brief Typed engine settings, loaded from the command line and a config file that is watched for changes.
+ * @details Values are atomics, so any thread may read them while the main thread reloads. Readers that cache a
+ *          derived value compare get_generation() to know when to recompute it.
+ */
+class Settings final
+{
+  public:
+    static constexpr unsigned int MAX_PATH_LENGTH = 256;
+    static constexpr unsigned int STRING_POOL_SIZE = 1024;
+
+    Settings() noexcept;
+    Settings(const Settings &) = delete;
+    Settings &operator=(const Settings &) = delete;
+
+    /**
+     * @brief Applies --key value, --key=value and the aliases in SETTING_INFO. --config <file> picks the file
+     *        load_file() reads. args[0] is the program and is skipped.
+     */
+    void parse_args(const Utils::Vector<Utils::StringView> &args) noexcept;
+
+    /**
+     * @brief Reads the config file (config_path(), unless given) without overriding command line values.
+     * @return false if the file does not exist or cannot be mapped; defaults stay in effect.
+     */
+    bool load_file(const char *path = nullptr) noexcept;
+
+    /**
+     * @brief Rereads the config file if it changed on disk. Only reloadable settings take the new values.
+     * @return true if any value changed.
+     */
+    bool reload_if_changed() noexcept;
+
+    template<typename T> [[nodiscard]] T get(SettingId id) const noexcept
+    {
+        return static_cast<T>(values[static_cast<unsigned int>(id)].load(Utils::MemoryOrder::RELAXED));
+    }
+
+    /**
+     * @brief The value of a SETTING_STRING setting, null terminated; empty if unset.
+     */
+    [[nodiscard]] Utils::StringView get_string(SettingId id) const noexcept;
+
+    /**
+     * @brief Parses text as the type of setting id and stores it.
+     * @return false, leaving the value alone, if text is not a valid value.
+     */
+    bool set(SettingId id, Utils::StringView text) noexcept;
+
+    /**
+     * @brief Incremented by every change to a value, so readers can tell when to recompute derived state.
+     */
+    [[nodiscard]] unsigned long long get_generation() const noexcept
+    {
+        return generation.load(Utils::MemoryOrder::ACQUIRE);
+    }
+
+    [[nodiscard]] const char *config_path() const noexcept
+    {
+        return path;
+    }
+
+  private:
+    enum class Source : unsigned char
+    {
+        SOURCE_COMMAND_LINE,
+        SOURCE_FILE,
+        SOURCE_RELOAD
+    };
+
+    Utils::Atomic<unsigned long long> values[static_cast<unsigned int>(SettingId::SETTING_COUNT)];
+    Utils::Atomic<unsigned long long> generation;
+    unsigned long long from_command_line = 0; ///< Bit per SettingId; the file does not override these.
+    unsigned long long file_time_ns = 0;
+    unsigned int string_pool_used = 0;
+    char path[MAX_PATH_LENGTH];
+    char string_pool[STRING_POOL_SIZE];
+
+    bool apply(SettingId id, Utils::StringView text, Source source) noexcept;
+    void parse_file(Utils::StringView text, Source source) noexcept;
+};
+} // namespace Platform
+} // namespace LunaVoxelEngine
+#endif
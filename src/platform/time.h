@@ -0,0 +1,51 @@
+#ifndef TIME_ABSTRACTION_H
+#define TIME_ABSTRACTION_H
+#if defined(_MSC_VER)
+#    include <intrin.h>
+#endif
+namespace LunaVoxelEngine
+{
+namespace Platform
+{
+/**
+ * @brief Monotonic time in nanoseconds since an arbitrary origin (CLOCK_MONOTONIC, QueryPerformanceCounter).
+ */
+unsigned long long time_now_ns() noexcept;
+
+/**
+ * @brief A raw timestamp for timing short intervals: the TSC on x86, otherwise time_now_ns().
+ * @details A few nanoseconds to read, against tens for the OS clock. Only differences are meaningful; convert
+ *          them with time_ticks_per_second(). Assumes an invariant TSC, which every x86-64 CPU the renderer
+ *          supports has.
+ */
+inline unsigned long long time_ticks() noexcept
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    return __rdtsc();
+#elif defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    return time_now_ns();
+#endif
+}
+
+/**
+ * @brief The rate of time_ticks(). The first call calibrates the TSC against time_now_ns(), which busy-waits
+ *        for about 10 ms; later calls return the cached value.
+ */
+unsigned long long time_ticks_per_second() noexcept;
+
+/**
+ * @brief Sleeps for about ns nanoseconds. May overshoot by the OS timer slack: tens of microseconds on Linux,
+ *        up to a millisecond on Windows.
+ */
+void time_sleep_ns(unsigned long long ns) noexcept;
+
+/**
+ * @brief Returns at time_now_ns() >= deadline_ns, late by well under a microsecond: sleeps until spin_ns
+ *        before the deadline, then spins.
+ */
+void time_wait_until_ns(unsigned long long deadline_ns, unsigned long long spin_ns) noexcept;
+} // namespace Platform
+} // namespace LunaVoxelEngine
+#endif
@@ -1,6 +1,6 @@
 #ifndef PLATFORM_WINDOW_H
 #define PLATFORM_WINDOW_H
-#include <utils/string.h>
+#include <utils/string_view.h>
 namespace LunaVoxelEngine
 {
 namespace  Platform
@@ -15,7 +15,7 @@ struct NativeWindow
 class Window final
 {
   public:
-    Window(unsigned int width, unsigned int height, const Utils::String &title);
+    Window(unsigned int width, unsigned int height, Utils::StringView title);
     void pollEvents();
     void show();
     bool shouldClose() const;
@@ -34,7 +34,7 @@ class Window final
 class ChildWindow final
 {
   public:
-    ChildWindow(unsigned int width, unsigned int height, const Utils::String &title, Window *parent);
+    ChildWindow(unsigned int width, unsigned int height, Utils::StringView title, Window *parent);
     void embed();
     void pop();
     void pollEvents();
@@ -0,0 +1,131 @@
+#include <platform/file.h>
+#include <utils/new.h>
+#include <Windows.h>
+
+namespace LunaVoxelEngine::Platform
+{
+struct file_handle
+{
+    HANDLE file;
+};
+
+static bool to_wide_path(const char *path, wchar_t (&wide_path)[MAX_PATH])
+{
+    return MultiByteToWideChar(CP_UTF8, 0, path, -1, wide_path, MAX_PATH) != 0;
+}
+
+file_handle *file_open(const char *path, FileMode mode)
+{
+    wchar_t wide_path[MAX_PATH];
+    if (!to_wide_path(path, wide_path))
+    {
+        return nullptr;
+    }
+    const bool read = mode == FileMode::FILE_READ;
+    HANDLE file = CreateFileW(wide_path, read ? GENERIC_READ : GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                              read ? OPEN_EXISTING : CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return nullptr;
+    }
+    file_handle *handle = new file_handle();
+    handle->file = file;
+    return handle;
+}
+
+void file_close(file_handle *handle)
+{
+    CloseHandle(handle->file);
+    delete handle;
+}
+
+long file_read(file_handle *handle, void *data, size_t size)
+{
+    // ReadFile takes a 32-bit count; callers loop until 0 anyway.
+    const DWORD request = size < 0x40000000 ? static_cast<DWORD>(size) : 0x40000000;
+    DWORD got = 0;
+    if (!ReadFile(handle->file, data, request, &got, nullptr))
+    {
+        return -1;
+    }
+    return static_cast<long>(got);
+}
+
+bool file_write(file_handle *handle, const void *data, size_t size)
+{
+    const char *bytes = static_cast<const char *>(data);
+    while (size > 0)
+    {
+        const DWORD request = size < 0x40000000 ? static_cast<DWORD>(size) : 0x40000000;
+        DWORD written = 0;
+        if (!WriteFile(handle->file, bytes, request, &written, nullptr) || written == 0)
+        {
+            return false;
+        }
+        bytes += written;
+        size -= written;
+    }
+    return true;
+}
+
+bool file_map(const char *path, const void *&data, size_t &size)
+{
+    data = nullptr;
+    size = 0;
+    wchar_t wide_path[MAX_PATH];
+    if (!to_wide_path(path, wide_path))
+    {
+        return false;
+    }
+    HANDLE file = CreateFileW(wide_path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    LARGE_INTEGER file_size;
+    bool mapped = GetFileSizeEx(file, &file_size) != 0;
+    if (mapped && file_size.QuadPart > 0)
+    {
+        // CreateFileMapping fails on empty files, which is why they are handled as null above.
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        void *view = mapping != nullptr ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (mapping != nullptr)
+        {
+            // The view keeps the mapping alive.
+            CloseHandle(mapping);
+        }
+        mapped = view != nullptr;
+        if (mapped)
+        {
+            data = view;
+            size = static_cast<size_t>(file_size.QuadPart);
+        }
+    }
+    CloseHandle(file);
+    return mapped;
+}
+
+void file_unmap(const void *data, size_t)
+{
+    if (data != nullptr)
+    {
+        UnmapViewOfFile(data);
+    }
+}
+
+unsigned long long file_modified_ns(const char *path)
+{
+    wchar_t wide_path[MAX_PATH];
+    WIN32_FILE_ATTRIBUTE_DATA attributes;
+    if (!to_wide_path(path, wide_path) || !GetFileAttributesExW(wide_path, GetFileExInfoStandard, &attributes))
+    {
+        return 0;
+    }
+    // FILETIME counts 100 ns intervals.
+    const unsigned long long ticks =
+        static_cast<unsigned long long>(attributes.ftLastWriteTime.dwHighDateTime) << 32 |
+        attributes.ftLastWriteTime.dwLowDateTime;
+    return ticks * 100;
+}
+} // namespace LunaVoxelEngine::Platform
@@ -1,65 +1,67 @@
+#include <platform/common_crash_log.h>
 #include <platform/common_log.h>
 #include <platform/log.h>
-#include <utils/string.h>
-#include <utils/algorithm.h>
 #include <Windows.h>
 
 namespace LunaVoxelEngine::Log
 {
-static char buffer[BUFFER_SIZE];
-static size_t buffer_pos = 0;
-inline void flush() noexcept
+void sink_write(const LogSlice *slices, unsigned int count) noexcept
 {
-    if (buffer_pos > 0)
+    HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
+    if (hConsole == nullptr || hConsole == INVALID_HANDLE_VALUE)
     {
-        HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
-        if (hConsole != nullptr && hConsole != INVALID_HANDLE_VALUE)
+        return;
+    }
+    // Win32 has no gather write for console handles, so each slice is one call.
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        const char *data = slices[i].data;
+        size_t remaining = slices[i].len;
+        while (remaining > 0)
         {
-            WriteConsole(hConsole, buffer, static_cast<unsigned long>(buffer_pos), nullptr, nullptr);
+            DWORD written = 0;
+            if (!WriteFile(hConsole, data, static_cast<DWORD>(remaining), &written, nullptr) || written == 0)
+            {
+                return;
+            }
+            data += written;
+            remaining -= written;
         }
-        buffer_pos = 0;
     }
 }
 
-void write_str(const char *str, size_t len) noexcept
+void *map_file(const char *path, size_t size) noexcept
 {
-    if (len + buffer_pos >= BUFFER_SIZE)
+    HANDLE file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
     {
-        flush();
+        return nullptr;
     }
-    size_t remaining_space = BUFFER_SIZE - buffer_pos;
-    size_t copy_len = (len < remaining_space) ? len : remaining_space;
-
-    Utils::memcpy(buffer + buffer_pos, str, copy_len);
-    buffer_pos += copy_len;
-    if (copy_len < len)
+    LARGE_INTEGER end;
+    end.QuadPart = static_cast<LONGLONG>(size);
+    void *data = nullptr;
+    if (SetFilePointerEx(file, end, nullptr, FILE_BEGIN) && SetEndOfFile(file))
     {
-        flush();
-        write_str(str + copy_len, len - copy_len);
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE, 0, 0, nullptr);
+        if (mapping != nullptr)
+        {
+            data = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+            // The view keeps the mapping and the file open.
+            CloseHandle(mapping);
+        }
     }
+    CloseHandle(file);
+    return data;
 }
 
-void write_char(const char c) noexcept
+void unmap_file(void *data, size_t) noexcept
 {
-    if (buffer_pos >= BUFFER_SIZE || c == '\n')
-    {
-        flush();
-    }
-    [[likely]] if (buffer_pos < BUFFER_SIZE)
-    {
-        buffer[buffer_pos++] = c;
-    }
+    UnmapViewOfFile(data);
 }
 
-void fatal(const Utils::String &fmt, ...) noexcept
+void sink_terminate() noexcept
 {
-    va_list args;
-    auto str = fmt.throw_away();
-    va_start(args, str.c_str());
-    write_str("LUNAVOXEL - FATAL: ", 20);
-    print_generic(str.c_str(), args);
-    write_char('\n');
-    va_end(args);
     ExitProcess(1);
 }
 } // namespace LunaVoxelEngine::Log
@@ -1,7 +1,8 @@
 #include <platform/log.h>
 #include <platform/main.h>
 #include <shellapi.h>
-#include <utils/string.h>
+#include <utils/string8.h>
+#include <utils/string_view.h>
 #include <utils/vector.h>
 #include <windows.h>
 
@@ -14,18 +15,30 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PSTR lpCmdLine,
 
     int argc = 0;
     LPWSTR *argvW = CommandLineToArgvW(GetCommandLineW(), &argc);
-    Vector<String> args;
+    // The runtime takes UTF-8 views; utf8_args owns the converted text for the whole run.
+    Vector<String8> utf8_args;
+    Vector<StringView> args;
+    utf8_args.reserve(argc);
     args.reserve(argc);
     for (int i = 0; i < argc; i++)
     {
         int size_needed = WideCharToMultiByte(CP_UTF8, 0, argvW[i], -1, NULL, 0, NULL, NULL);
         char *arg = new char[size_needed];
         WideCharToMultiByte(CP_UTF8, 0, argvW[i], -1, &arg[0], size_needed, NULL, NULL);
-        args.emplace_back(arg);
+        utf8_args.emplace_back(arg);
         delete[] arg;
     }
     LocalFree(argvW);
+    for (const String8 &arg : utf8_args)
+    {
+        args.emplace_back(arg.view());
+    }
 
+    if (!open_crash_log(DEFAULT_CRASH_LOG_PATH))
+    {
+        warn("Cannot open crash log %s", DEFAULT_CRASH_LOG_PATH);
+    }
+    start_async();
     debug("Hello from LunaVoxelEngine");
     LunaVoxelEngine::Platform::Runtime *runtime = LunaVoxelEngine::Platform::Runtime::Get();
     debug("Runtime initializing...");
@@ -40,10 +53,14 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PSTR lpCmdLine,
 
         runtime->Shutdown();
         debug("Runtime shutdown");
+        stop_async();
+        close_crash_log();
 
         return 0;
     }
 
     error("Error while initializing runtime");
+    stop_async();
+    close_crash_log();
     return -1;
 }
@@ -48,20 +48,29 @@ struct spinlock_handle
     volatile LONG lock;
 };
 
+struct thread_start
+{
+    thread_func func;
+    void *arg;
+};
+
 // Thread entry wrapper
 static unsigned __stdcall thread_entry(void *param)
 {
-    return reinterpret_cast<thread_func>(param)(nullptr);
+    thread_start start = *static_cast<thread_start *>(param);
+    delete static_cast<thread_start *>(param);
+    return static_cast<unsigned>(start.func(start.arg));
 }
 
 // Thread creation
 thread_handle *thread_create(thread_func func, void *arg, int flags)
 {
     thread_handle *handle = new thread_handle();
-    handle->handle = reinterpret_cast<HANDLE>(
-        _beginthreadex(nullptr, 0, thread_entry, reinterpret_cast<void *>(func), 0, &handle->id));
+    thread_start *start = new thread_start{func, arg};
+    handle->handle = reinterpret_cast<HANDLE>(_beginthreadex(nullptr, 0, thread_entry, start, 0, &handle->id));
     if (!handle->handle)
     {
+        delete start;
         delete handle;
         return nullptr;
     }
@@ -82,7 +91,15 @@ ThreadError thread_destroy(thread_handle *handle)
 ThreadError thread_wait(thread_handle *handle, size_t timeout_ms)
 {
     DWORD result = WaitForSingleObject(handle->handle, static_cast<DWORD>(timeout_ms));
-    return (result == WAIT_OBJECT_0) ? ThreadError::THREAD_SUCCESS : ThreadError::THREAD_ERROR_TIMEOUT;
+    switch (result)
+    {
+    case WAIT_OBJECT_0:
+        return ThreadError::THREAD_SUCCESS;
+    case WAIT_TIMEOUT:
+        return ThreadError::THREAD_ERROR_TIMEOUT;
+    default:
+        return ThreadError::THREAD_ERROR_WAIT;
+    }
 }
 
 // Thread priority
@@ -126,6 +143,12 @@ void mutex_destroy(mutex_handle *handle)
 
 ThreadError mutex_lock(mutex_handle *handle, size_t timeout_ms)
 {
+    // Critical sections have no timed acquire: block for INFINITE, otherwise make a single attempt.
+    if (timeout_ms == INFINITE)
+    {
+        EnterCriticalSection(&handle->cs);
+        return ThreadError::THREAD_SUCCESS;
+    }
     return TryEnterCriticalSection(&handle->cs) ? ThreadError::THREAD_SUCCESS : ThreadError::THREAD_ERROR_TIMEOUT;
 }
 
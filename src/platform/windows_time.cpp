@@ -0,0 +1,45 @@
+#include <platform/time.h>
+#include <Windows.h>
+
+namespace LunaVoxelEngine::Platform
+{
+unsigned long long time_now_ns() noexcept
+{
+    // Fixed at boot, so racing first callers store the same value.
+    static LONGLONG frequency = 0;
+    if (frequency == 0)
+    {
+        LARGE_INTEGER value;
+        QueryPerformanceFrequency(&value);
+        frequency = value.QuadPart;
+    }
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    const unsigned long long ticks = static_cast<unsigned long long>(counter.QuadPart);
+    const unsigned long long rate = static_cast<unsigned long long>(frequency);
+    // Split to keep ticks * 1e9 from overflowing.
+    return ticks / rate * 1000000000ULL + ticks % rate * 1000000000ULL / rate;
+}
+
+void time_sleep_ns(unsigned long long ns) noexcept
+{
+    // Sleep() rounds to the 1-15.6 ms scheduler tick; a high-resolution waitable timer does not.
+    static thread_local HANDLE timer = nullptr;
+    if (timer == nullptr)
+    {
+        timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+    }
+    if (timer == nullptr)
+    {
+        Sleep(static_cast<DWORD>(ns / 1000000ULL));
+        return;
+    }
+    LARGE_INTEGER due;
+    // Negative means relative, in 100 ns units.
+    due.QuadPart = -static_cast<LONGLONG>(ns / 100ULL);
+    if (SetWaitableTimer(timer, &due, 0, nullptr, nullptr, FALSE))
+    {
+        WaitForSingleObject(timer, INFINITE);
+    }
+}
+} // namespace LunaVoxelEngine::Platform
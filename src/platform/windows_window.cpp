@@ -1,4 +1,5 @@
 #include <platform/window.h>
+#include <utils/string8.h>
 
 #include <windows.h>
 
@@ -13,7 +14,7 @@ struct __WindowData
     HINSTANCE hInstance;
 };
 
-Window::Window(unsigned int width, unsigned int height, const Utils::String &title)
+Window::Window(unsigned int width, unsigned int height, Utils::StringView title)
 {
     window = new __WindowData;
     __WindowData *data = static_cast<__WindowData *>(window);
@@ -25,7 +26,7 @@ Window::Window(unsigned int width, unsigned int height, const Utils::String &tit
     wc.lpszClassName = reinterpret_cast<LPCSTR>(L"LunaVoxelEngineWindow");
     RegisterClass(&wc);
 
-    const auto str = title.throw_away();
+    const Utils::String8 str(title);
     data->hwnd = CreateWindowEx(0, wc.lpszClassName, str.c_str(), WS_OVERLAPPEDWINDOW, CW_USEDEFAULT, CW_USEDEFAULT,
                                 width, height, nullptr, nullptr, data->hInstance, nullptr);
     visible = false;
@@ -84,7 +85,7 @@ Window::~Window()
     delete data;
 }
 
-ChildWindow::ChildWindow(unsigned int width, unsigned int height, const Utils::String &title, Window *parent_in)
+ChildWindow::ChildWindow(unsigned int width, unsigned int height, Utils::StringView title, Window *parent_in)
     : parent(parent_in)
 {
     window = new __WindowData;
@@ -97,7 +98,7 @@ ChildWindow::ChildWindow(unsigned int width, unsigned int height, const Utils::S
     wc.lpszClassName = reinterpret_cast<LPCSTR>(L"LunaVoxelEngineChildWindow");
     RegisterClass(&wc);
 
-    const auto str = title.throw_away();
+    const Utils::String8 str(title);
     data->hwnd =
         CreateWindowEx(0, wc.lpszClassName, str.c_str(), WS_CHILD | WS_VISIBLE, CW_USEDEFAULT, CW_USEDEFAULT, width,
                        height, static_cast<__WindowData *>(parent->window)->hwnd, nullptr, data->hInstance, nullptr);
@@ -0,0 +1,246 @@
+#include <platform/log.h>
+#include <renderer/vulkan/bindless.h>
+#include <utils/algorithm.h>
+extern VkAllocationCallbacks callbacks;
+
+namespace LunaVoxelEngine::Renderer
+{
+namespace
+{
+constexpr VkDescriptorType DESCRIPTOR_TYPES[BINDLESS_TYPE_COUNT] = {
+    VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+    VK_DESCRIPTOR_TYPE_SAMPLER};
+constexpr const char *TYPE_NAMES[BINDLESS_TYPE_COUNT] = {"sampled image", "storage image", "storage buffer",
+                                                         "sampler"};
+} // namespace
+
+BindlessSlotAllocator::BindlessSlotAllocator(uint32_t capacity_in)
+    : capacity(capacity_in)
+{
+}
+
+uint32_t BindlessSlotAllocator::allocate() noexcept
+{
+    if (!free_slots.empty())
+    {
+        const uint32_t index = free_slots.back();
+        free_slots.pop_back();
+        return index;
+    }
+    return next < capacity ? next++ : INVALID_BINDLESS_INDEX;
+}
+
+void BindlessSlotAllocator::free(uint32_t index) noexcept
+{
+    free_slots.push_back(index);
+}
+
+BindlessHeap::BindlessHeap(const Device *device, Timeline *timeline_in)
+    : timeline(timeline_in)
+{
+    VkPhysicalDeviceDescriptorIndexingProperties indexing{};
+    indexing.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES;
+    VkPhysicalDeviceProperties2 properties{};
+    properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    properties.pNext = &indexing;
+    vkGetPhysicalDeviceProperties2(device->get_physical_device(), &properties);
+    const uint32_t limits[BINDLESS_TYPE_COUNT] = {
+        Utils::min(indexing.maxPerStageDescriptorUpdateAfterBindSampledImages,
+                   indexing.maxDescriptorSetUpdateAfterBindSampledImages),
+        Utils::min(indexing.maxPerStageDescriptorUpdateAfterBindStorageImages,
+                   indexing.maxDescriptorSetUpdateAfterBindStorageImages),
+        Utils::min(indexing.maxPerStageDescriptorUpdateAfterBindStorageBuffers,
+                   indexing.maxDescriptorSetUpdateAfterBindStorageBuffers),
+        Utils::min(indexing.maxPerStageDescriptorUpdateAfterBindSamplers,
+                   indexing.maxDescriptorSetUpdateAfterBindSamplers)};
+
+    const VkDevice vk_device = volkGetLoadedDevice();
+    VkDescriptorPoolSize pool_sizes[BINDLESS_TYPE_COUNT];
+    for (unsigned int i = 0; i < BINDLESS_TYPE_COUNT; ++i)
+    {
+        const uint32_t capacity = Utils::min(DEFAULT_CAPACITY[i], limits[i]);
+        if (capacity < DEFAULT_CAPACITY[i])
+        {
+            Log::warn(Log::Module::VULKAN, "Bindless %s set limited to %u descriptors by the device", TYPE_NAMES[i],
+                      capacity);
+        }
+        slots[i] = BindlessSlotAllocator(capacity);
+        pool_sizes[i].type = DESCRIPTOR_TYPES[i];
+        pool_sizes[i].descriptorCount = capacity;
+
+        // Recycled indices are only rewritten once no pending submission can read them, which is what
+        // UPDATE_UNUSED_WHILE_PENDING allows.
+        const VkDescriptorBindingFlags binding_flags = VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+                                                       VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT |
+                                                       VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT;
+        VkDescriptorSetLayoutBindingFlagsCreateInfo flags_info{};
+        flags_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+        flags_info.bindingCount = 1;
+        flags_info.pBindingFlags = &binding_flags;
+
+        VkDescriptorSetLayoutBinding binding{};
+        binding.binding = 0;
+        binding.descriptorType = DESCRIPTOR_TYPES[i];
+        binding.descriptorCount = capacity;
+        binding.stageFlags = VK_SHADER_STAGE_ALL;
+
+        VkDescriptorSetLayoutCreateInfo layout_info{};
+        layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        layout_info.pNext = &flags_info;
+        layout_info.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+        layout_info.bindingCount = 1;
+        layout_info.pBindings = &binding;
+        if (vkCreateDescriptorSetLayout(vk_device, &layout_info, &callbacks, &set_layouts[i]) != VK_SUCCESS)
+        {
+            Log::fatal("Failed to create the bindless descriptor set layouts");
+        }
+    }
+
+    VkDescriptorPoolCreateInfo pool_info{};
+    pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    pool_info.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+    pool_info.maxSets = BINDLESS_TYPE_COUNT;
+    pool_info.poolSizeCount = BINDLESS_TYPE_COUNT;
+    pool_info.pPoolSizes = pool_sizes;
+    if (vkCreateDescriptorPool(vk_device, &pool_info, &callbacks, &pool) != VK_SUCCESS)
+    {
+        Log::fatal("Failed to create the bindless descriptor pool");
+    }
+
+    VkDescriptorSetAllocateInfo allocate_info{};
+    allocate_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocate_info.descriptorPool = pool;
+    allocate_info.descriptorSetCount = BINDLESS_TYPE_COUNT;
+    allocate_info.pSetLayouts = set_layouts;
+    if (vkAllocateDescriptorSets(vk_device, &allocate_info, sets) != VK_SUCCESS)
+    {
+        Log::fatal("Failed to allocate the bindless descriptor sets");
+    }
+
+    VkPushConstantRange push_constants{};
+    push_constants.stageFlags = VK_SHADER_STAGE_ALL;
+    push_constants.offset = 0;
+    push_constants.size = BINDLESS_PUSH_CONSTANT_SIZE;
+
+    VkPipelineLayoutCreateInfo pipeline_layout_info{};
+    pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipeline_layout_info.setLayoutCount = BINDLESS_TYPE_COUNT;
+    pipeline_layout_info.pSetLayouts = set_layouts;
+    pipeline_layout_info.pushConstantRangeCount = 1;
+    pipeline_layout_info.pPushConstantRanges = &push_constants;
+    if (vkCreatePipelineLayout(vk_device, &pipeline_layout_info, &callbacks, &pipeline_layout) != VK_SUCCESS)
+    {
+        Log::fatal("Failed to create the bindless pipeline layout");
+    }
+}
+
+BindlessHeap::~BindlessHeap()
+{
+    // Deferred releases free into slots, so none may be left once it is gone.
+    timeline->flush();
+    const VkDevice vk_device = volkGetLoadedDevice();
+    vkDestroyPipelineLayout(vk_device, pipeline_layout, &callbacks);
+    // Destroying the pool frees its sets.
+    vkDestroyDescriptorPool(vk_device, pool, &callbacks);
+    for (VkDescriptorSetLayout layout : set_layouts)
+    {
+        vkDestroyDescriptorSetLayout(vk_device, layout, &callbacks);
+    }
+}
+
+uint32_t BindlessHeap::allocate(BindlessType type) noexcept
+{
+    const uint32_t index = slots[static_cast<unsigned int>(type)].allocate();
+    if (index == INVALID_BINDLESS_INDEX)
+    {
+        Log::warn(Log::Module::VULKAN, "Bindless %s set is full", TYPE_NAMES[static_cast<unsigned int>(type)]);
+    }
+    return index;
+}
+
+void BindlessHeap::write(BindlessType type, uint32_t index, const VkDescriptorImageInfo *image_info,
+                         const VkDescriptorBufferInfo *buffer_info) noexcept
+{
+    VkWriteDescriptorSet write{};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = sets[static_cast<unsigned int>(type)];
+    write.dstBinding = 0;
+    write.dstArrayElement = index;
+    write.descriptorCount = 1;
+    write.descriptorType = DESCRIPTOR_TYPES[static_cast<unsigned int>(type)];
+    write.pImageInfo = image_info;
+    write.pBufferInfo = buffer_info;
+    vkUpdateDescriptorSets(volkGetLoadedDevice(), 1, &write, 0, nullptr);
+}
+
+uint32_t BindlessHeap::add_sampled_image(VkImageView view, VkImageLayout layout) noexcept
+{
+    const uint32_t index = allocate(BindlessType::SAMPLED_IMAGE);
+    if (index != INVALID_BINDLESS_INDEX)
+    {
+        VkDescriptorImageInfo image_info{};
+        image_info.imageView = view;
+        image_info.imageLayout = layout;
+        write(BindlessType::SAMPLED_IMAGE, index, &image_info, nullptr);
+    }
+    return index;
+}
+
+uint32_t BindlessHeap::add_storage_image(VkImageView view) noexcept
+{
+    const uint32_t index = allocate(BindlessType::STORAGE_IMAGE);
+    if (index != INVALID_BINDLESS_INDEX)
+    {
+        VkDescriptorImageInfo image_info{};
+        image_info.imageView = view;
+        image_info.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+        write(BindlessType::STORAGE_IMAGE, index, &image_info, nullptr);
+    }
+    return index;
+}
+
+uint32_t BindlessHeap::add_storage_buffer(const Buffer &buffer, VkDeviceSize offset, VkDeviceSize range) noexcept
+{
+    const uint32_t index = allocate(BindlessType::STORAGE_BUFFER);
+    if (index != INVALID_BINDLESS_INDEX)
+    {
+        VkDescriptorBufferInfo buffer_info{};
+        buffer_info.buffer = buffer.getBuffer();
+        buffer_info.offset = offset;
+        buffer_info.range = range;
+        write(BindlessType::STORAGE_BUFFER, index, nullptr, &buffer_info);
+    }
+    return index;
+}
+
+uint32_t BindlessHeap::add_sampler(VkSampler sampler) noexcept
+{
+    const uint32_t index = allocate(BindlessType::SAMPLER);
+    if (index != INVALID_BINDLESS_INDEX)
+    {
+        VkDescriptorImageInfo image_info{};
+        image_info.sampler = sampler;
+        write(BindlessType::SAMPLER, index, &image_info, nullptr);
+    }
+    return index;
+}
+
+void BindlessHeap::release(BindlessType type, uint32_t index) noexcept
+{
+    if (index == INVALID_BINDLESS_INDEX)
+    {
+        return;
+    }
+    timeline->defer(free_slot, &slots[static_cast<unsigned int>(type)], index);
+}
+
+void BindlessHeap::free_slot(void *allocator, unsigned int index) noexcept
+{
+    static_cast<BindlessSlotAllocator *>(allocator)->free(index);
+}
+
+void BindlessHeap::bind(CommandBuffer &command_buffer, VkPipelineBindPoint bind_point) const noexcept
+{
+    command_buffer.bindDescriptorSets(bind_point, pipeline_layout, 0, BINDLESS_TYPE_COUNT, sets, 0, nullptr);
+}
+} // namespace LunaVoxelEngine::Renderer
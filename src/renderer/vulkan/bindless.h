@@ -0,0 +1,147 @@
+#ifndef VK_BINDLESS_H
+#define VK_BINDLESS_H
+#include <renderer/vulkan/buffer.h>
+#include <renderer/vulkan/cmd_buffer.h>
+#include <renderer/vulkan/device.h>
+#include <renderer/vulkan/ivulkan.h>
+#include <renderer/vulkan/timeline.h>
+#include <utils/vector.h>
+
+namespace LunaVoxelEngine::Renderer
+{
+/**
+ * @brief The kinds of resource the bindless heap holds. Each has a descriptor set of its own, bound at the set
+ *        number equal to its value, holding one array at binding 0.
+ */
+enum class BindlessType : unsigned int
+{
+    SAMPLED_IMAGE,
+    STORAGE_IMAGE,
+    STORAGE_BUFFER,
+    SAMPLER,
+    COUNT
+};
+
+constexpr unsigned int BINDLESS_TYPE_COUNT = static_cast<unsigned int>(BindlessType::COUNT);
+/// Returned when a set is full.
+constexpr uint32_t INVALID_BINDLESS_INDEX = UINT32_MAX;
+/// Push constant bytes every bindless pipeline layout has, for the indices a draw or dispatch reads.
+constexpr uint32_t BINDLESS_PUSH_CONSTANT_SIZE = 128;
+
+/**
+ * @class BindlessSlotAllocator
+ * @brief Hands out array indices in one bindless set.
+ * @details free() makes an index available straight away, so callers hold it back until the GPU is done with it,
+ *          which BindlessHeap does by deferring the free on the timeline. Without that a new resource could take
+ *          the index while an older frame still samples the old one through it.
+ */
+class [[nodiscard]] BindlessSlotAllocator final
+{
+  public:
+    explicit BindlessSlotAllocator(uint32_t capacity = 0);
+
+    /**
+     * @return A free index, or INVALID_BINDLESS_INDEX if every index is in use.
+     */
+    [[nodiscard]] uint32_t allocate() noexcept;
+    /**
+     * @brief Gives index back for allocate() to hand out again.
+     */
+    void free(uint32_t index) noexcept;
+
+    [[nodiscard]] uint32_t get_capacity() const noexcept
+    {
+        return capacity;
+    }
+    /// Indices allocated and not yet freed.
+    [[nodiscard]] uint32_t get_used() const noexcept
+    {
+        return next - static_cast<uint32_t>(free_slots.size());
+    }
+
+  private:
+    Utils::Vector<uint32_t> free_slots;
+    uint32_t next = 0; ///< Indices from here up have never been handed out.
+    uint32_t capacity;
+};
+
+/**
+ * @class BindlessHeap
+ * @brief Every texture, storage image, storage buffer and sampler the renderer uses, each at a fixed index in one
+ *        large descriptor array per type.
+ * @details Shaders get indices through push constants or buffers and index the arrays themselves, so the sets are
+ *          bound once per command buffer with bind() instead of per draw. The sets are update-after-bind and
+ *          partially bound: adding a resource writes its descriptor straight away, even while the sets are bound,
+ *          and unused indices may hold anything.
+ *
+ * An index stays valid until release(), which defers recycling it on the timeline until the submissions that
+ * may read it have completed. Releasing does not destroy the resource, which must itself live that long.
+ * @warning Not thread-safe.
+ */
+class [[nodiscard]] BindlessHeap final
+{
+  public:
+    /// Descriptors per set before device limits are applied.
+    static constexpr uint32_t DEFAULT_CAPACITY[BINDLESS_TYPE_COUNT] = {16384, 1024, 16384, 256};
+
+    /**
+     * @param device The device whose limits cap each set's size.
+     * @param timeline The timeline of the submissions that read the sets; must outlive the heap.
+     */
+    BindlessHeap(const Device *device, Timeline *timeline);
+    /// Flushes the timeline's deferred deletions, which may recycle indices, so the device must be idle.
+    ~BindlessHeap();
+    BindlessHeap(const BindlessHeap &) = delete;
+    BindlessHeap &operator=(const BindlessHeap &) = delete;
+
+    /**
+     * @return The index shaders read view at, or INVALID_BINDLESS_INDEX if the set is full.
+     */
+    [[nodiscard]] uint32_t add_sampled_image(VkImageView view,
+                                             VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) noexcept;
+    [[nodiscard]] uint32_t add_storage_image(VkImageView view) noexcept;
+    [[nodiscard]] uint32_t add_storage_buffer(const Buffer &buffer, VkDeviceSize offset = 0,
+                                              VkDeviceSize range = VK_WHOLE_SIZE) noexcept;
+    [[nodiscard]] uint32_t add_sampler(VkSampler sampler) noexcept;
+    /**
+     * @brief Stops index being used; it is recycled once the submissions made so far, and the next one, have
+     *        completed.
+     */
+    void release(BindlessType type, uint32_t index) noexcept;
+
+    /**
+     * @brief Binds every set, for every pipeline made with get_pipeline_layout() at bind_point.
+     */
+    void bind(CommandBuffer &command_buffer, VkPipelineBindPoint bind_point) const noexcept;
+
+    /**
+     * @brief A layout with all the sets and BINDLESS_PUSH_CONSTANT_SIZE bytes of push constants for all stages.
+     */
+    [[nodiscard]] VkPipelineLayout get_pipeline_layout() const noexcept
+    {
+        return pipeline_layout;
+    }
+    [[nodiscard]] VkDescriptorSetLayout get_set_layout(BindlessType type) const noexcept
+    {
+        return set_layouts[static_cast<unsigned int>(type)];
+    }
+    [[nodiscard]] const BindlessSlotAllocator &get_slots(BindlessType type) const noexcept
+    {
+        return slots[static_cast<unsigned int>(type)];
+    }
+
+  private:
+    [[nodiscard]] uint32_t allocate(BindlessType type) noexcept;
+    static void free_slot(void *allocator, unsigned int index) noexcept;
+    void write(BindlessType type, uint32_t index, const VkDescriptorImageInfo *image_info,
+               const VkDescriptorBufferInfo *buffer_info) noexcept;
+
+    VkDescriptorPool pool = VK_NULL_HANDLE;
+    VkDescriptorSetLayout set_layouts[BINDLESS_TYPE_COUNT] = {};
+    VkDescriptorSet sets[BINDLESS_TYPE_COUNT] = {};
+    VkPipelineLayout pipeline_layout = VK_NULL_HANDLE;
+    BindlessSlotAllocator slots[BINDLESS_TYPE_COUNT];
+    Timeline *timeline;
+};
+} // namespace LunaVoxelEngine::Renderer
+#endif
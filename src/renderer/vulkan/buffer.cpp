@@ -1,6 +1,7 @@
 #include <platform/log.h>
 #include <renderer/vulkan/buffer.h>
-
+#include <utils/algorithm.h>
+extern VkAllocationCallbacks callbacks;
 
 namespace LunaVoxelEngine::Renderer
 {
@@ -9,9 +10,53 @@ Buffer::Buffer()
 {
 }
 
+Buffer::Buffer(const Device *device, VkDeviceSize size_in, VkBufferUsageFlags usage_in, MemoryUsage memory_usage)
+    : size(size_in)
+    , usage(usage_in)
+    , allocator(device->get_allocator())
+{
+    const VkDevice vk_device = volkGetLoadedDevice();
+
+    VkBufferCreateInfo buffer_info{};
+    buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    buffer_info.size = size;
+    buffer_info.usage = usage;
+    buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    // Uploads may be written by the transfer queue and read by graphics; sharing avoids ownership transfers.
+    const uint32_t families[2] = {device->get_graphics_family_index(), device->get_transfer_family_index()};
+    if (device->has_transfer_queue() && (usage & VK_BUFFER_USAGE_TRANSFER_DST_BIT) != 0)
+    {
+        buffer_info.sharingMode = VK_SHARING_MODE_CONCURRENT;
+        buffer_info.queueFamilyIndexCount = 2;
+        buffer_info.pQueueFamilyIndices = families;
+    }
+    if (vkCreateBuffer(vk_device, &buffer_info, &callbacks, &buffer) != VK_SUCCESS)
+    {
+        Log::fatal("Failed to create %llu byte buffer", static_cast<unsigned long long>(size));
+    }
+
+    VkMemoryRequirements requirements;
+    vkGetBufferMemoryRequirements(vk_device, buffer, &requirements);
+    AllocationRequest request;
+    request.size = requirements.size;
+    request.alignment = requirements.alignment;
+    request.type_bits = requirements.memoryTypeBits;
+    request.usage = memory_usage;
+    memory = allocator->allocate(request);
+    if (!memory.is_valid())
+    {
+        Log::fatal("Failed to allocate memory for %llu byte buffer", static_cast<unsigned long long>(size));
+    }
+    vkBindBufferMemory(vk_device, buffer, to_vk_memory(memory), memory.offset);
+}
+
 void *Buffer::map()
 {
-    return nullptr;
+    if (memory.mapped == nullptr)
+    {
+        Log::fatal("Buffer is not host visible");
+    }
+    return memory.mapped;
 }
 
 void Buffer::unmap()
@@ -20,5 +65,25 @@ void Buffer::unmap()
 
 Buffer::~Buffer()
 {
+    if (buffer != VK_NULL_HANDLE)
+    {
+        vkDestroyBuffer(volkGetLoadedDevice(), buffer, &callbacks);
+        allocator->free(memory);
+    }
+}
+
+Buffer::Buffer(Buffer &&other) noexcept
+{
+    *this = static_cast<Buffer &&>(other);
+}
+
+Buffer &Buffer::operator=(Buffer &&other) noexcept
+{
+    Utils::swap(buffer, other.buffer);
+    Utils::swap(size, other.size);
+    Utils::swap(usage, other.usage);
+    Utils::swap(allocator, other.allocator);
+    Utils::swap(memory, other.memory);
+    return *this;
 }
-} // namespace LunaVoxelEngine::Renderer
\ No newline at end of file
+} // namespace LunaVoxelEngine::Renderer
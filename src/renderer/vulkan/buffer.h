@@ -1,5 +1,6 @@
 #ifndef VK_BUFFER_H
 #define VK_BUFFER_H
+#include <renderer/vulkan/device.h>
 #include <renderer/vulkan/ivulkan.h>
 namespace LunaVoxelEngine::Renderer
 {
@@ -7,19 +8,44 @@ class Buffer final
 {
   public:
     Buffer();
+    /**
+     * @brief Creates a buffer and binds memory from the device's allocator to it.
+     *
+     * @param device The device whose allocator the buffer's memory comes from.
+     * @param size Size of the buffer in bytes.
+     * @param usage How the buffer will be used (e.g., vertex buffer, transfer source).
+     * @param memory_usage Who writes and reads the memory; UPLOAD and READBACK buffers stay mapped.
+     */
+    Buffer(const Device *device, VkDeviceSize size, VkBufferUsageFlags usage,
+           MemoryUsage memory_usage = MemoryUsage::GPU_ONLY);
     /**
      * @brief Maps the buffer for writing.
      *
+     * Host-visible memory is mapped for the buffer's whole life, so this only returns the pointer.
+     *
      * @return A pointer to the mapped memory.
      * @warning the function will crash the engine if the buffer is not mapped or valid.
      */
     void *map();
     /**
-     * @brief Unmaps the buffer.
-     *
-     * @warning the function will crash the engine if the buffer is valid.
+     * @brief Unmaps the buffer. Memory stays mapped until the buffer is destroyed, so this does nothing.
      */
     void unmap();
+    /**
+     * @brief Gets the Vulkan buffer handle.
+     * @return The VkBuffer handle.
+     */
+    VkBuffer getBuffer() const
+    {
+        return buffer;
+    }
+    /**
+     * @brief Gets the size of the buffer in bytes.
+     */
+    VkDeviceSize getSize() const
+    {
+        return size;
+    }
     /**
      * @brief Destructor for Buffer.
      *
@@ -38,6 +64,8 @@ class Buffer final
     VkBuffer buffer = VK_NULL_HANDLE; ///< The Vulkan buffer handle
     VkDeviceSize size = 0;            ///< Size of the buffer in bytes
     VkBufferUsageFlags usage = 0;     ///< Usage flags for the buffer
+    GpuAllocator *allocator = nullptr; ///< Where memory came from
+    GpuAllocation memory;              ///< Memory bound to the buffer
 };
 } // namespace LunaVoxelEngine::Renderer
 #endif
\ No newline at end of file
@@ -0,0 +1,242 @@
+#include <renderer/vulkan/chunk_cull.h>
+#include <utils/algorithm.h>
+
+namespace LunaVoxelEngine::Renderer
+{
+Frustum extract_frustum(const float view_proj[16]) noexcept
+{
+    // Row r of the matrix is view_proj[r], view_proj[4 + r], ... in column-major order. Clip space keeps
+    // -w <= x, y <= w and 0 <= z <= w, and each inequality is one plane.
+    float rows[4][4];
+    for (unsigned int r = 0; r < 4; ++r)
+    {
+        for (unsigned int c = 0; c < 4; ++c)
+        {
+            rows[r][c] = view_proj[c * 4 + r];
+        }
+    }
+    Frustum frustum;
+    for (unsigned int i = 0; i < 4; ++i)
+    {
+        frustum.planes[0][i] = rows[3][i] + rows[0][i];
+        frustum.planes[1][i] = rows[3][i] - rows[0][i];
+        frustum.planes[2][i] = rows[3][i] + rows[1][i];
+        frustum.planes[3][i] = rows[3][i] - rows[1][i];
+        frustum.planes[4][i] = rows[2][i];
+        frustum.planes[5][i] = rows[3][i] - rows[2][i];
+    }
+    return frustum;
+}
+
+bool is_box_visible(const Frustum &frustum, const float bounds_min[3], const float bounds_max[3]) noexcept
+{
+    for (const float *plane : frustum.planes)
+    {
+        float distance = plane[3];
+        for (unsigned int axis = 0; axis < 3; ++axis)
+        {
+            distance += plane[axis] * (plane[axis] >= 0.0f ? bounds_max[axis] : bounds_min[axis]);
+        }
+        if (distance < 0.0f)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+ChunkDrawRecord pack_chunk_record(const float bounds_min[3], const float bounds_max[3],
+                                  unsigned long long vertex_byte_offset, unsigned int vertex_stride,
+                                  unsigned long long index_byte_offset, unsigned int index_count) noexcept
+{
+    ChunkDrawRecord record{};
+    for (unsigned int axis = 0; axis < 3; ++axis)
+    {
+        record.bounds_min[axis] = bounds_min[axis];
+        record.bounds_max[axis] = bounds_max[axis];
+    }
+    record.index_count = index_count;
+    record.first_index = static_cast<unsigned int>(index_byte_offset / sizeof(unsigned int));
+    record.vertex_offset = static_cast<int>(vertex_byte_offset / vertex_stride);
+    record.flags = ChunkDrawRecord::FLAG_LIVE;
+    return record;
+}
+
+unsigned int cull_chunks(const ChunkDrawRecord *records, unsigned int count, const Frustum &frustum,
+                         IndirectDrawCommand *commands) noexcept
+{
+    unsigned int draw_count = 0;
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        const ChunkDrawRecord &record = records[i];
+        if ((record.flags & ChunkDrawRecord::FLAG_LIVE) == 0 ||
+            !is_box_visible(frustum, record.bounds_min, record.bounds_max))
+        {
+            continue;
+        }
+        IndirectDrawCommand &command = commands[draw_count++];
+        command.index_count = record.index_count;
+        command.instance_count = 1;
+        command.first_index = record.first_index;
+        command.vertex_offset = record.vertex_offset;
+        command.first_instance = i;
+    }
+    return draw_count;
+}
+
+void get_pyramid_extent(unsigned int depth_width, unsigned int depth_height, unsigned int &width,
+                        unsigned int &height) noexcept
+{
+    width = Utils::max(1u, depth_width / 2);
+    height = Utils::max(1u, depth_height / 2);
+}
+
+unsigned int get_pyramid_level_count(unsigned int width, unsigned int height) noexcept
+{
+    unsigned int level_count = 1;
+    while ((width > 1 || height > 1) && level_count < MAX_PYRAMID_LEVELS)
+    {
+        width = Utils::max(1u, width / 2);
+        height = Utils::max(1u, height / 2);
+        ++level_count;
+    }
+    return level_count;
+}
+
+void reduce_depth(const float *src, unsigned int src_width, unsigned int src_height, float *dst,
+                  unsigned int dst_width, unsigned int dst_height) noexcept
+{
+    // Destination texel x covers source texels [x * sw / dw, ceil((x + 1) * sw / dw)), so odd sizes fold their
+    // last row or column into the texel beside it rather than dropping it.
+    for (unsigned int y = 0; y < dst_height; ++y)
+    {
+        const unsigned int first_y = y * src_height / dst_height;
+        const unsigned int last_y = ((y + 1) * src_height + dst_height - 1) / dst_height;
+        for (unsigned int x = 0; x < dst_width; ++x)
+        {
+            const unsigned int first_x = x * src_width / dst_width;
+            const unsigned int last_x = ((x + 1) * src_width + dst_width - 1) / dst_width;
+            float depth = 0.0f;
+            for (unsigned int sy = first_y; sy < last_y; ++sy)
+            {
+                for (unsigned int sx = first_x; sx < last_x; ++sx)
+                {
+                    depth = Utils::max(depth, src[static_cast<unsigned long>(sy) * src_width + sx]);
+                }
+            }
+            dst[static_cast<unsigned long>(y) * dst_width + x] = depth;
+        }
+    }
+}
+
+void CpuDepthPyramid::build(const float *depth, unsigned int width, unsigned int height) noexcept
+{
+    get_pyramid_extent(width, height, widths[0], heights[0]);
+    level_count = get_pyramid_level_count(widths[0], heights[0]);
+    unsigned long size = 0;
+    for (unsigned int level = 0; level < level_count; ++level)
+    {
+        if (level > 0)
+        {
+            widths[level] = Utils::max(1u, widths[level - 1] / 2);
+            heights[level] = Utils::max(1u, heights[level - 1] / 2);
+        }
+        offsets[level] = size;
+        size += static_cast<unsigned long>(widths[level]) * heights[level];
+    }
+    texels.resize(size);
+    reduce_depth(depth, width, height, texels.data(), widths[0], heights[0]);
+    for (unsigned int level = 1; level < level_count; ++level)
+    {
+        reduce_depth(texels.data() + offsets[level - 1], widths[level - 1], heights[level - 1],
+                     texels.data() + offsets[level], widths[level], heights[level]);
+    }
+}
+
+bool project_box(const float view_proj[16], const float bounds_min[3], const float bounds_max[3],
+                 ScreenBounds &bounds) noexcept
+{
+    bounds = {{1.0f, 1.0f}, {0.0f, 0.0f}, 1.0f};
+    for (unsigned int i = 0; i < 8; ++i)
+    {
+        const float corner[3] = {(i & 1) != 0 ? bounds_max[0] : bounds_min[0],
+                                 (i & 2) != 0 ? bounds_max[1] : bounds_min[1],
+                                 (i & 4) != 0 ? bounds_max[2] : bounds_min[2]};
+        float clip[4];
+        for (unsigned int r = 0; r < 4; ++r)
+        {
+            clip[r] = view_proj[12 + r];
+            for (unsigned int c = 0; c < 3; ++c)
+            {
+                clip[r] += view_proj[c * 4 + r] * corner[c];
+            }
+        }
+        if (clip[3] <= 0.0f)
+        {
+            return false;
+        }
+        const float depth = clip[2] / clip[3];
+        if (depth < 0.0f)
+        {
+            return false;
+        }
+        for (unsigned int axis = 0; axis < 2; ++axis)
+        {
+            const float uv = clip[axis] / clip[3] * 0.5f + 0.5f;
+            bounds.uv_min[axis] = Utils::min(bounds.uv_min[axis], uv);
+            bounds.uv_max[axis] = Utils::max(bounds.uv_max[axis], uv);
+        }
+        bounds.nearest_depth = Utils::min(bounds.nearest_depth, depth);
+    }
+    for (unsigned int axis = 0; axis < 2; ++axis)
+    {
+        bounds.uv_min[axis] = Utils::max(bounds.uv_min[axis], 0.0f);
+        bounds.uv_max[axis] = Utils::min(bounds.uv_max[axis], 1.0f);
+    }
+    return true;
+}
+
+PyramidFootprint get_pyramid_footprint(const ScreenBounds &bounds, unsigned int width, unsigned int height,
+                                       unsigned int level_count) noexcept
+{
+    // Stepping up one level at a time rather than taking a log2 keeps the shader's choice bit-for-bit the same.
+    PyramidFootprint footprint{};
+    for (;; ++footprint.level)
+    {
+        const unsigned int size[2] = {Utils::max(1u, width >> footprint.level),
+                                      Utils::max(1u, height >> footprint.level)};
+        for (unsigned int axis = 0; axis < 2; ++axis)
+        {
+            const float extent = static_cast<float>(size[axis]);
+            footprint.first[axis] = Utils::min(static_cast<unsigned int>(bounds.uv_min[axis] * extent), size[axis] - 1);
+            footprint.last[axis] = Utils::min(static_cast<unsigned int>(bounds.uv_max[axis] * extent), size[axis] - 1);
+        }
+        if ((footprint.last[0] - footprint.first[0] <= 1 && footprint.last[1] - footprint.first[1] <= 1) ||
+            footprint.level + 1 >= level_count)
+        {
+            return footprint;
+        }
+    }
+}
+
+bool is_box_occluded(const CpuDepthPyramid &pyramid, const float view_proj[16], const float bounds_min[3],
+                     const float bounds_max[3]) noexcept
+{
+    ScreenBounds bounds;
+    if (pyramid.get_level_count() == 0 || !project_box(view_proj, bounds_min, bounds_max, bounds))
+    {
+        return false;
+    }
+    const PyramidFootprint footprint =
+        get_pyramid_footprint(bounds, pyramid.get_width(0), pyramid.get_height(0), pyramid.get_level_count());
+    float farthest = 0.0f;
+    for (unsigned int y = footprint.first[1]; y <= footprint.last[1]; ++y)
+    {
+        for (unsigned int x = footprint.first[0]; x <= footprint.last[0]; ++x)
+        {
+            farthest = Utils::max(farthest, pyramid.get_texel(footprint.level, x, y));
+        }
+    }
+    return bounds.nearest_depth > farthest;
+}
+} // namespace LunaVoxelEngine::Renderer
@@ -0,0 +1,182 @@
+#ifndef VK_CHUNK_CULL_H
+#define VK_CHUNK_CULL_H
+#include <utils/vector.h>
+
+namespace LunaVoxelEngine::Renderer
+{
+/**
+ * @brief One chunk's mesh and bounds, as the culling shader reads it. Matches ChunkDrawRecord in
+ *        assets/chunk_cull.comp under std430 rules.
+ */
+struct ChunkDrawRecord
+{
+    static constexpr unsigned int FLAG_LIVE = 1; ///< Cleared for removed chunks, which are then never drawn.
+
+    float bounds_min[3];
+    unsigned int index_count;
+    float bounds_max[3];
+    unsigned int first_index;
+    int vertex_offset;
+    unsigned int flags;
+    unsigned int padding[2];
+};
+static_assert(sizeof(ChunkDrawRecord) == 48);
+
+/**
+ * @brief Same layout as VkDrawIndexedIndirectCommand, so culling code need not include Vulkan.
+ */
+struct IndirectDrawCommand
+{
+    unsigned int index_count;
+    unsigned int instance_count;
+    unsigned int first_index;
+    int vertex_offset;
+    unsigned int first_instance; ///< The chunk's record index, for shaders that look up per-chunk data.
+};
+static_assert(sizeof(IndirectDrawCommand) == 20);
+
+/**
+ * @brief Six planes (a, b, c, d) with the inside where a*x + b*y + c*z + d >= 0: left, right, bottom, top, near,
+ *        far. Not normalised; only the sign of the distance is used.
+ */
+struct Frustum
+{
+    float planes[6][4];
+};
+
+/**
+ * @brief The frustum of a column-major view-projection matrix with Vulkan's [0, 1] depth range.
+ */
+[[nodiscard]] Frustum extract_frustum(const float view_proj[16]) noexcept;
+
+/**
+ * @brief Whether any part of the box may be inside the frustum. Tests the corner furthest along each plane's
+ *        normal, so boxes near a frustum corner can pass while outside, but a visible box never fails.
+ */
+[[nodiscard]] bool is_box_visible(const Frustum &frustum, const float bounds_min[3],
+                                  const float bounds_max[3]) noexcept;
+
+/**
+ * @brief Packs a chunk's record from where its mesh lives in the arenas.
+ * @param vertex_byte_offset Offset of the mesh's first vertex in the vertex arena.
+ * @param vertex_stride Bytes per vertex.
+ * @param index_byte_offset Offset of the mesh's first 32-bit index in the index arena.
+ */
+[[nodiscard]] ChunkDrawRecord pack_chunk_record(const float bounds_min[3], const float bounds_max[3],
+                                                unsigned long long vertex_byte_offset, unsigned int vertex_stride,
+                                                unsigned long long index_byte_offset,
+                                                unsigned int index_count) noexcept;
+
+/**
+ * @brief What the culling shader computes: one command per live, visible record, in record order, with
+ *        first_instance set to the record index.
+ * @details The shader appends with an atomic counter, so it produces the same commands in another order.
+ * @param commands Room for count commands.
+ * @return The number of commands written.
+ */
+unsigned int cull_chunks(const ChunkDrawRecord *records, unsigned int count, const Frustum &frustum,
+                         IndirectDrawCommand *commands) noexcept;
+
+/// Deepest a depth pyramid gets; enough for a 65536-texel-wide depth buffer.
+constexpr unsigned int MAX_PYRAMID_LEVELS = 16;
+
+/**
+ * @brief The size of level 0 of the depth pyramid over a depth buffer: half of it, rounded down, but at least 1x1.
+ */
+void get_pyramid_extent(unsigned int depth_width, unsigned int depth_height, unsigned int &width,
+                        unsigned int &height) noexcept;
+/**
+ * @brief Levels of a pyramid whose level 0 is width by height, each half the one before, down to 1x1.
+ */
+[[nodiscard]] unsigned int get_pyramid_level_count(unsigned int width, unsigned int height) noexcept;
+
+/**
+ * @brief Shrinks src into dst, each dst texel taking the farthest depth of every src texel it overlaps, so no part
+ *        of src is nearer than the dst texel covering it. What assets/depth_pyramid.comp does for each level.
+ */
+void reduce_depth(const float *src, unsigned int src_width, unsigned int src_height, float *dst,
+                  unsigned int dst_width, unsigned int dst_height) noexcept;
+
+/**
+ * @class CpuDepthPyramid
+ * @brief A depth pyramid built on the CPU, the reference for the one DepthPyramid builds on the GPU.
+ * @details Depth is [0, 1] with less-than testing, so larger is farther. Level 0 is half the depth buffer's size and
+ *          every texel of every level holds the farthest depth under it.
+ */
+class [[nodiscard]] CpuDepthPyramid final
+{
+  public:
+    /**
+     * @param depth width * height depths, row by row.
+     */
+    void build(const float *depth, unsigned int width, unsigned int height) noexcept;
+
+    [[nodiscard]] unsigned int get_level_count() const noexcept
+    {
+        return level_count;
+    }
+    [[nodiscard]] unsigned int get_width(unsigned int level) const noexcept
+    {
+        return widths[level];
+    }
+    [[nodiscard]] unsigned int get_height(unsigned int level) const noexcept
+    {
+        return heights[level];
+    }
+    [[nodiscard]] float get_texel(unsigned int level, unsigned int x, unsigned int y) const noexcept
+    {
+        return texels[offsets[level] + static_cast<unsigned long>(y) * widths[level] + x];
+    }
+
+  private:
+    Utils::Vector<float> texels; ///< Every level, one after another.
+    unsigned long offsets[MAX_PYRAMID_LEVELS] = {};
+    unsigned int widths[MAX_PYRAMID_LEVELS] = {};
+    unsigned int heights[MAX_PYRAMID_LEVELS] = {};
+    unsigned int level_count = 0;
+};
+
+/**
+ * @brief Where a box lands on screen: the [0, 1] texture-space rectangle it covers and its nearest depth.
+ */
+struct ScreenBounds
+{
+    float uv_min[2];
+    float uv_max[2];
+    float nearest_depth;
+};
+
+/**
+ * @brief Projects the box's corners to the screen.
+ * @return False if a corner is behind the eye or in front of the near plane; such boxes cannot be tested and are
+ *         always drawn.
+ */
+[[nodiscard]] bool project_box(const float view_proj[16], const float bounds_min[3], const float bounds_max[3],
+                               ScreenBounds &bounds) noexcept;
+
+/**
+ * @brief The pyramid texels a test reads: the first level at which the rectangle spans at most 2x2 texels, and the
+ *        inclusive texel range there.
+ */
+struct PyramidFootprint
+{
+    unsigned int level;
+    unsigned int first[2];
+    unsigned int last[2];
+};
+
+/**
+ * @param width Width of pyramid level 0; each level is max(1, width >> level) wide.
+ */
+[[nodiscard]] PyramidFootprint get_pyramid_footprint(const ScreenBounds &bounds, unsigned int width,
+                                                     unsigned int height, unsigned int level_count) noexcept;
+
+/**
+ * @brief Whether the box is certainly hidden behind the depth the pyramid was built from: its nearest point is
+ *        farther than the farthest depth over its footprint. What assets/chunk_cull.comp tests.
+ * @param view_proj The matrix the pyramid's depth was rendered with.
+ */
+[[nodiscard]] bool is_box_occluded(const CpuDepthPyramid &pyramid, const float view_proj[16],
+                                   const float bounds_min[3], const float bounds_max[3]) noexcept;
+} // namespace LunaVoxelEngine::Renderer
+#endif
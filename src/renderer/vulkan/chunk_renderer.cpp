@@ -0,0 +1,493 @@
+#include <platform/log.h>
+#include <renderer/vulkan/chunk_renderer.h>
+#include <renderer/vulkan/shader.h>
+#include <utils/algorithm.h>
+extern VkAllocationCallbacks callbacks;
+
+namespace LunaVoxelEngine::Renderer
+{
+namespace
+{
+constexpr const char *CULL_SHADER_PATH = "shaders/chunk_cull.comp.spv";
+constexpr const char *VERTEX_SHADER_PATH = "shaders/chunk.vert.spv";
+constexpr const char *FRAGMENT_SHADER_PATH = "shaders/chunk.frag.spv";
+
+/// Matches Params in assets/chunk_cull.comp.
+struct CullParams
+{
+    static constexpr uint32_t FLAG_HISTORY = 1; ///< The depth pyramid holds last frame's depth; test against it.
+
+    float view_proj[16];
+    float history_view_proj[16];
+    float planes[6][4];
+    uint32_t pyramid_size[2];
+    uint32_t pyramid_levels;
+    uint32_t flags;
+};
+static_assert(sizeof(CullParams) == 240);
+
+/// Matches CullConstants in assets/chunk_cull.comp.
+struct CullConstants
+{
+    uint32_t params_index;
+    uint32_t records_index;
+    uint32_t early_commands_index;
+    uint32_t late_commands_index;
+    uint32_t counts_index;
+    uint32_t occluded_index;
+    uint32_t pyramid_index;
+    uint32_t record_count;
+    uint32_t phase; ///< 0 culls every record, 1 re-tests the chunks phase 0 held back.
+};
+static_assert(sizeof(CullConstants) <= BINDLESS_PUSH_CONSTANT_SIZE);
+
+/// Indices into the counts buffer, as in assets/chunk_cull.comp.
+constexpr unsigned int EARLY_DRAWS = 0;
+constexpr unsigned int LATE_DRAWS = 1;
+constexpr unsigned int OCCLUDED = 2;
+constexpr VkDeviceSize COUNTS_SIZE = 3 * sizeof(uint32_t);
+
+// The draw pipeline points at these while it compiles, so they cannot live on the stack.
+constexpr VkVertexInputBindingDescription VERTEX_BINDING = {0, sizeof(ChunkVertex), VK_VERTEX_INPUT_RATE_VERTEX};
+constexpr VkVertexInputAttributeDescription VERTEX_ATTRIBUTES[] = {
+    {0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0},
+    {1, 0, VK_FORMAT_R8G8B8A8_UNORM, sizeof(ChunkVertex::position)}};
+constexpr VkDynamicState DYNAMIC_STATES[] = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+/// Blending off, writing every channel.
+constexpr VkPipelineColorBlendAttachmentState BLEND_ATTACHMENT = {
+    VK_FALSE,
+    VK_BLEND_FACTOR_ONE,
+    VK_BLEND_FACTOR_ZERO,
+    VK_BLEND_OP_ADD,
+    VK_BLEND_FACTOR_ONE,
+    VK_BLEND_FACTOR_ZERO,
+    VK_BLEND_OP_ADD,
+    VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT};
+} // namespace
+
+ChunkRenderer::ChunkRenderer(const Device *device, UploadQueue *uploads_in, PipelineCompiler *pipelines,
+                             BindlessHeap *bindless_in, ParallelRecorder *recorder_in, const DepthPyramid *pyramid_in,
+                             Timeline *timeline_in, VkPipelineCache cache, VkFormat color_format_in,
+                             unsigned int frames_in_flight_in, unsigned int max_chunks)
+    : uploads(uploads_in)
+    , bindless(bindless_in)
+    , recorder(recorder_in)
+    , pyramid(pyramid_in)
+    , timeline(timeline_in)
+    , vertex_arena(device, VERTEX_ARENA_BYTES, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT)
+    , index_arena(device, INDEX_ARENA_BYTES, VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT)
+    , vertex_ranges(VERTEX_ARENA_BYTES)
+    , index_ranges(INDEX_ARENA_BYTES)
+    , frames_in_flight(frames_in_flight_in)
+    , ids(max_chunks)
+    , color_format(color_format_in)
+{
+    constexpr VkBufferUsageFlags indirect_usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                                                  VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                                                  VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    for (unsigned int i = 0; i < frames_in_flight; ++i)
+    {
+        FrameBuffers &buffers = frame_buffers[i];
+        buffers.params = Buffer(device, sizeof(CullParams), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, MemoryUsage::UPLOAD);
+        buffers.records = Buffer(device, max_chunks * sizeof(ChunkDrawRecord),
+                                 VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+        buffers.commands = Buffer(device, max_chunks * sizeof(IndirectDrawCommand), indirect_usage);
+        buffers.late_commands = Buffer(device, max_chunks * sizeof(IndirectDrawCommand), indirect_usage);
+        buffers.counts = Buffer(device, COUNTS_SIZE, indirect_usage | VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
+        buffers.occluded = Buffer(device, max_chunks * sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+        buffers.readback =
+            Buffer(device, COUNTS_SIZE, VK_BUFFER_USAGE_TRANSFER_DST_BIT, MemoryUsage::READBACK);
+        buffers.params_index = bindless->add_storage_buffer(buffers.params);
+        buffers.records_index = bindless->add_storage_buffer(buffers.records);
+        buffers.commands_index = bindless->add_storage_buffer(buffers.commands);
+        buffers.late_commands_index = bindless->add_storage_buffer(buffers.late_commands);
+        buffers.counts_index = bindless->add_storage_buffer(buffers.counts);
+        buffers.occluded_index = bindless->add_storage_buffer(buffers.occluded);
+    }
+
+    const VkShaderModule cull_shader = load_shader_module(CULL_SHADER_PATH);
+    if (cull_shader != VK_NULL_HANDLE)
+    {
+        VkComputePipelineCreateInfo compute_info{};
+        compute_info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        compute_info.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        compute_info.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        compute_info.stage.module = cull_shader;
+        compute_info.stage.pName = "main";
+        compute_info.layout = bindless->get_pipeline_layout();
+        cull_pipeline = new Pipeline(compute_info, cache);
+        vkDestroyShaderModule(volkGetLoadedDevice(), cull_shader, &callbacks);
+        if (cull_pipeline->handle() == VK_NULL_HANDLE)
+        {
+            delete cull_pipeline;
+            cull_pipeline = nullptr;
+        }
+    }
+    if (cull_pipeline == nullptr)
+    {
+        Log::warn(Log::Module::VULKAN, "Culling chunks on the CPU: no usable culling shader");
+    }
+
+    vertex_shader = load_shader_module(VERTEX_SHADER_PATH);
+    fragment_shader = load_shader_module(FRAGMENT_SHADER_PATH);
+    if (vertex_shader == VK_NULL_HANDLE || fragment_shader == VK_NULL_HANDLE)
+    {
+        Log::warn(Log::Module::VULKAN, "Chunks will not be drawn: their shaders are missing");
+        return;
+    }
+    VkPipelineVertexInputStateCreateInfo vertex_input{};
+    vertex_input.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    vertex_input.vertexBindingDescriptionCount = 1;
+    vertex_input.pVertexBindingDescriptions = &VERTEX_BINDING;
+    vertex_input.vertexAttributeDescriptionCount = 2;
+    vertex_input.pVertexAttributeDescriptions = VERTEX_ATTRIBUTES;
+
+    VkPipelineColorBlendStateCreateInfo color_blending{};
+    color_blending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    color_blending.attachmentCount = 1;
+    color_blending.pAttachments = &BLEND_ATTACHMENT;
+
+    VkPipelineDepthStencilStateCreateInfo depth_stencil{};
+    depth_stencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    depth_stencil.depthTestEnable = VK_TRUE;
+    depth_stencil.depthWriteEnable = VK_TRUE;
+    depth_stencil.depthCompareOp = VK_COMPARE_OP_LESS;
+
+    VkPipelineDynamicStateCreateInfo dynamic_state{};
+    dynamic_state.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamic_state.dynamicStateCount = 2;
+    dynamic_state.pDynamicStates = DYNAMIC_STATES;
+
+    VkPipelineRenderingCreateInfo rendering_info{};
+    rendering_info.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
+    rendering_info.colorAttachmentCount = 1;
+    rendering_info.pColorAttachmentFormats = &color_format;
+    rendering_info.depthAttachmentFormat = DepthPyramid::DEPTH_FORMAT;
+
+    GraphicsPipelineBuilder builder;
+    builder.addShader(VK_SHADER_STAGE_VERTEX_BIT, vertex_shader)
+        .addShader(VK_SHADER_STAGE_FRAGMENT_BIT, fragment_shader)
+        .setLayout(bindless->get_pipeline_layout())
+        .setVertexInputInfo(vertex_input)
+        .setColorBlending(color_blending)
+        .setDepthStencil(depth_stencil)
+        .setDynamicState(dynamic_state)
+        .setRenderingInfo(rendering_info);
+    draw_pipeline = pipelines->request(builder);
+}
+
+ChunkRenderer::~ChunkRenderer()
+{
+    for (unsigned int i = 0; i < frames_in_flight; ++i)
+    {
+        const FrameBuffers &buffers = frame_buffers[i];
+        const uint32_t indices[] = {buffers.params_index,        buffers.records_index, buffers.commands_index,
+                                    buffers.late_commands_index, buffers.counts_index,  buffers.occluded_index};
+        for (const uint32_t index : indices)
+        {
+            bindless->release(BindlessType::STORAGE_BUFFER, index);
+        }
+    }
+    delete cull_pipeline;
+    const VkDevice vk_device = volkGetLoadedDevice();
+    vkDestroyShaderModule(vk_device, vertex_shader, &callbacks);
+    vkDestroyShaderModule(vk_device, fragment_shader, &callbacks);
+    // Removed chunks whose frees are still deferred give their ranges and ids back to members destroyed next.
+    timeline->flush();
+}
+
+unsigned int ChunkRenderer::add_chunk(const ChunkVertex *vertices, unsigned int vertex_count,
+                                      const unsigned int *indices, unsigned int index_count,
+                                      const float bounds_min[3], const float bounds_max[3]) noexcept
+{
+    if (vertex_count == 0 || index_count == 0)
+    {
+        return INVALID_CHUNK;
+    }
+    const unsigned long long vertex_bytes = static_cast<unsigned long long>(vertex_count) * sizeof(ChunkVertex);
+    const unsigned long long index_bytes = static_cast<unsigned long long>(index_count) * sizeof(unsigned int);
+    const Utils::RangeAllocation vertex_range = vertex_ranges.allocate(vertex_bytes, sizeof(ChunkVertex));
+    const Utils::RangeAllocation index_range = index_ranges.allocate(index_bytes, sizeof(unsigned int));
+    const unsigned int chunk = vertex_range.is_valid() && index_range.is_valid() ? ids.allocate() : INVALID_CHUNK;
+    if (chunk == INVALID_CHUNK)
+    {
+        if (vertex_range.is_valid())
+        {
+            vertex_ranges.free(vertex_range);
+        }
+        if (index_range.is_valid())
+        {
+            index_ranges.free(index_range);
+        }
+        return INVALID_CHUNK;
+    }
+    if (chunk >= chunks.size())
+    {
+        chunks.resize(chunk + 1);
+        records.resize(chunk + 1);
+    }
+    record_count = Utils::max(record_count, chunk + 1);
+    Chunk &slot = chunks[chunk];
+    slot.vertices = vertex_range;
+    slot.indices = index_range;
+    const bool uploaded = uploads->upload(vertex_arena, vertex_range.offset, vertices, vertex_bytes) &&
+                          uploads->upload(index_arena, index_range.offset, indices, index_bytes);
+    // A chunk whose mesh did not fit in staging is removed straight away: a copy may already be staged into its
+    // ranges, and every frame's records must learn its id is not live before the id can be handed out again.
+    slot.removed = !uploaded;
+    live_count += uploaded ? 1 : 0;
+    records[chunk] = uploaded ? pack_chunk_record(bounds_min, bounds_max, vertex_range.offset, sizeof(ChunkVertex),
+                                                  index_range.offset, index_count)
+                              : ChunkDrawRecord{};
+    mark_stale(chunk);
+    return uploaded ? chunk : INVALID_CHUNK;
+}
+
+void ChunkRenderer::remove_chunk(unsigned int chunk) noexcept
+{
+    if (chunk >= record_count || chunks[chunk].removed)
+    {
+        return;
+    }
+    chunks[chunk].removed = true;
+    --live_count;
+    records[chunk].flags &= ~ChunkDrawRecord::FLAG_LIVE;
+    mark_stale(chunk);
+}
+
+void ChunkRenderer::mark_stale(unsigned int chunk) noexcept
+{
+    Chunk &slot = chunks[chunk];
+    if (slot.stale_copies == 0)
+    {
+        stale.push_back(chunk);
+    }
+    slot.stale_copies = static_cast<unsigned char>((1u << frames_in_flight) - 1);
+}
+
+void ChunkRenderer::free_chunk(void *renderer, unsigned int id) noexcept
+{
+    ChunkRenderer *self = static_cast<ChunkRenderer *>(renderer);
+    // The slot is untouched until the id is freed, as nothing else can be given it.
+    self->vertex_ranges.free(self->chunks[id].vertices);
+    self->index_ranges.free(self->chunks[id].indices);
+    self->ids.free(id);
+}
+
+void ChunkRenderer::begin_frame(unsigned int frame_index_in) noexcept
+{
+    frame_index = frame_index_in;
+
+    FrameBuffers &buffers = frame_buffers[frame_index];
+    if (buffers.counted)
+    {
+        uint32_t counts[3];
+        Utils::memcpy(counts, buffers.readback.map(), sizeof(counts));
+        stats.tested = buffers.tested;
+        stats.drawn = counts[EARLY_DRAWS] + counts[LATE_DRAWS];
+        stats.occlusion_culled = counts[OCCLUDED] - counts[LATE_DRAWS];
+        stats.frustum_culled = buffers.tested - Utils::min(buffers.tested, counts[EARLY_DRAWS] + counts[OCCLUDED]);
+        buffers.counted = false;
+    }
+
+    // Bring this frame's copy of the records up to date. A chunk removed from every copy can no longer be drawn
+    // by frames from now on, so its mesh and id are freed once the submissions so far, and this frame's, complete.
+    const unsigned char frame_bit = static_cast<unsigned char>(1u << frame_index);
+    bool complete = true;
+    unsigned long kept = 0;
+    for (unsigned long i = 0; i < stale.size(); ++i)
+    {
+        const unsigned int chunk = stale[i];
+        Chunk &slot = chunks[chunk];
+        if ((slot.stale_copies & frame_bit) != 0)
+        {
+            if (complete && uploads->upload(buffers.records, chunk * sizeof(ChunkDrawRecord), &records[chunk],
+                                            sizeof(ChunkDrawRecord)))
+            {
+                slot.stale_copies = static_cast<unsigned char>(slot.stale_copies & ~frame_bit);
+            }
+            else
+            {
+                complete = false;
+            }
+        }
+        if (slot.stale_copies != 0)
+        {
+            stale[kept++] = chunk;
+        }
+        else if (slot.removed)
+        {
+            timeline->defer(free_chunk, this, chunk);
+        }
+    }
+    stale.resize(kept);
+    // Records this copy has never held are garbage, so the copy only covers new ids once they all made it in.
+    // Older ids that missed an upload still hold a record whose mesh is alive, or one that is not live.
+    if (complete)
+    {
+        buffers.record_count = record_count;
+    }
+}
+
+void ChunkRenderer::cull(CommandBuffer &command_buffer, const float view_proj[16]) noexcept
+{
+    const Frustum frustum = extract_frustum(view_proj);
+    late_pass = false;
+    if (cull_pipeline == nullptr)
+    {
+        if (cpu_commands.size() < record_count)
+        {
+            cpu_commands.resize(record_count);
+        }
+        // draw() records these directly, so nothing goes to the GPU until then.
+        const unsigned int draw_count = cull_chunks(records.data(), record_count, frustum, cpu_commands.data());
+        draw_limit = draw_count;
+        stats.tested = live_count;
+        stats.drawn = draw_count;
+        stats.frustum_culled = live_count - draw_count;
+        stats.occlusion_culled = 0;
+        return;
+    }
+
+    // The pyramid last built, if any, is the one the previous frame built under history_view_proj.
+    FrameBuffers &buffers = frame_buffers[frame_index];
+    CullParams params{};
+    Utils::memcpy(params.view_proj, view_proj, sizeof(params.view_proj));
+    Utils::memcpy(params.history_view_proj, history_view_proj, sizeof(params.history_view_proj));
+    Utils::memcpy(params.planes, frustum.planes, sizeof(params.planes));
+    params.pyramid_size[0] = pyramid->get_pyramid_extent().width;
+    params.pyramid_size[1] = pyramid->get_pyramid_extent().height;
+    params.pyramid_levels = pyramid->get_level_count();
+    draw_limit = buffers.record_count;
+    late_pass = is_occlusion_culling() && pyramid->is_built() && draw_limit > 0;
+    params.flags = late_pass ? CullParams::FLAG_HISTORY : 0;
+    Utils::memcpy(buffers.params.map(), &params, sizeof(params));
+    Utils::memcpy(history_view_proj, view_proj, sizeof(history_view_proj));
+    buffers.tested = live_count;
+
+    command_buffer.fillBuffer(buffers.counts, 0, COUNTS_SIZE, 0);
+    command_buffer.memoryBarrier2(VK_PIPELINE_STAGE_2_CLEAR_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                                  VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                                  VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT);
+    if (draw_limit > 0)
+    {
+        dispatch_cull(command_buffer, 0);
+    }
+    command_buffer.memoryBarrier2(VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+                                  VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                                  VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_READ_BIT |
+                                      VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT);
+}
+
+void ChunkRenderer::cull_late(CommandBuffer &command_buffer) noexcept
+{
+    if (cull_pipeline == nullptr)
+    {
+        return;
+    }
+    FrameBuffers &buffers = frame_buffers[frame_index];
+    if (late_pass)
+    {
+        // DepthPyramid::build() made the new pyramid visible to compute; the early pass's counts were made
+        // visible to compute by cull().
+        dispatch_cull(command_buffer, 1);
+    }
+    command_buffer.memoryBarrier2(VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+                                  VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_2_COPY_BIT,
+                                  VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_2_TRANSFER_READ_BIT);
+    const VkBufferCopy region = {0, 0, COUNTS_SIZE};
+    command_buffer.copyBuffer(buffers.counts, buffers.readback, 1, &region);
+    command_buffer.memoryBarrier2(VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                                  VK_PIPELINE_STAGE_2_HOST_BIT, VK_ACCESS_2_HOST_READ_BIT);
+    buffers.counted = true;
+}
+
+void ChunkRenderer::dispatch_cull(CommandBuffer &command_buffer, unsigned int phase) noexcept
+{
+    const FrameBuffers &buffers = frame_buffers[frame_index];
+    const CullConstants constants = {buffers.params_index,
+                                     buffers.records_index,
+                                     buffers.commands_index,
+                                     buffers.late_commands_index,
+                                     buffers.counts_index,
+                                     buffers.occluded_index,
+                                     pyramid->get_pyramid_index(),
+                                     draw_limit,
+                                     phase};
+    command_buffer.bindPipeline(VK_PIPELINE_BIND_POINT_COMPUTE, cull_pipeline);
+    bindless->bind(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE);
+    command_buffer.pushConstants(bindless->get_pipeline_layout(), VK_SHADER_STAGE_ALL, 0, sizeof(constants),
+                                 &constants);
+    // The late pass re-tests at most every record, and reads how many it actually has from the counts.
+    command_buffer.dispatch((draw_limit + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1);
+}
+
+void ChunkRenderer::draw(CommandBuffer &command_buffer, const float view_proj[16]) noexcept
+{
+    if (cull_pipeline == nullptr)
+    {
+        draw_cpu_commands(command_buffer, view_proj);
+        return;
+    }
+    draw_commands(command_buffer, view_proj, frame_buffers[frame_index].commands, EARLY_DRAWS * sizeof(uint32_t));
+}
+
+void ChunkRenderer::draw_late(CommandBuffer &command_buffer, const float view_proj[16]) noexcept
+{
+    if (late_pass)
+    {
+        draw_commands(command_buffer, view_proj, frame_buffers[frame_index].late_commands,
+                      LATE_DRAWS * sizeof(uint32_t));
+    }
+}
+
+void ChunkRenderer::draw_commands(CommandBuffer &command_buffer, const float view_proj[16], const Buffer &commands,
+                                  VkDeviceSize count_offset) noexcept
+{
+    const Pipeline *pipeline = draw_pipeline.get();
+    if (pipeline == nullptr || pipeline->handle() == VK_NULL_HANDLE || draw_limit == 0)
+    {
+        return;
+    }
+    command_buffer.bindPipeline(VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+    command_buffer.bindVertexBuffer(0, vertex_arena, 0);
+    command_buffer.bindIndexBuffer(index_arena, 0, VK_INDEX_TYPE_UINT32);
+    command_buffer.pushConstants(bindless->get_pipeline_layout(), VK_SHADER_STAGE_ALL, 0, 16 * sizeof(float),
+                                 view_proj);
+    command_buffer.drawIndexedIndirectCount(commands, 0, frame_buffers[frame_index].counts, count_offset, draw_limit,
+                                            sizeof(IndirectDrawCommand));
+}
+
+void ChunkRenderer::draw_cpu_commands(CommandBuffer &command_buffer, const float view_proj[16]) noexcept
+{
+    const Pipeline *pipeline = draw_pipeline.get();
+    if (pipeline == nullptr || pipeline->handle() == VK_NULL_HANDLE)
+    {
+        return;
+    }
+    Utils::memcpy(draw_view_proj, view_proj, sizeof(draw_view_proj));
+    SecondaryTarget target;
+    target.color_formats = &color_format;
+    target.color_count = 1;
+    target.depth_format = DepthPyramid::DEPTH_FORMAT;
+    target.extent = pyramid->get_depth().getExtent();
+    recorder->record(command_buffer, target, draw_limit, record_cpu_commands, this);
+}
+
+void ChunkRenderer::record_cpu_commands(CommandBuffer &command_buffer, unsigned int first, unsigned int count,
+                                        void *user) noexcept
+{
+    const ChunkRenderer *renderer = static_cast<const ChunkRenderer *>(user);
+    command_buffer.bindPipeline(VK_PIPELINE_BIND_POINT_GRAPHICS, renderer->draw_pipeline.get());
+    command_buffer.bindVertexBuffer(0, renderer->vertex_arena, 0);
+    command_buffer.bindIndexBuffer(renderer->index_arena, 0, VK_INDEX_TYPE_UINT32);
+    command_buffer.pushConstants(renderer->bindless->get_pipeline_layout(), VK_SHADER_STAGE_ALL, 0,
+                                 16 * sizeof(float), renderer->draw_view_proj);
+    const IndirectDrawCommand *commands = renderer->cpu_commands.data() + first;
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        command_buffer.drawIndexed(commands[i].index_count, commands[i].instance_count, commands[i].first_index,
+                                   commands[i].vertex_offset, commands[i].first_instance);
+    }
+}
+} // namespace LunaVoxelEngine::Renderer
@@ -0,0 +1,238 @@
+#ifndef VK_CHUNK_RENDERER_H
+#define VK_CHUNK_RENDERER_H
+#include <renderer/vulkan/bindless.h>
+#include <renderer/vulkan/buffer.h>
+#include <renderer/vulkan/chunk_cull.h>
+#include <renderer/vulkan/cmd_buffer.h>
+#include <renderer/vulkan/depth_pyramid.h>
+#include <renderer/vulkan/device.h>
+#include <renderer/vulkan/frame_ring.h>
+#include <renderer/vulkan/ivulkan.h>
+#include <renderer/vulkan/parallel_recorder.h>
+#include <renderer/vulkan/pipeline.h>
+#include <renderer/vulkan/pipeline_compiler.h>
+#include <renderer/vulkan/timeline.h>
+#include <renderer/vulkan/upload_queue.h>
+#include <utils/range_allocator.h>
+#include <utils/vector.h>
+
+namespace LunaVoxelEngine::Renderer
+{
+/**
+ * @brief The vertex format of chunk meshes, with positions in world space.
+ */
+struct ChunkVertex
+{
+    float position[3];
+    unsigned int color; ///< R8G8B8A8_UNORM.
+};
+static_assert(sizeof(ChunkVertex) == 16);
+
+/**
+ * @brief What culling did with the chunks of one frame.
+ */
+struct ChunkCullStats
+{
+    unsigned int tested = 0; ///< Live chunks.
+    unsigned int drawn = 0;
+    unsigned int frustum_culled = 0;
+    unsigned int occlusion_culled = 0;
+};
+
+/**
+ * @class ChunkRenderer
+ * @brief Draws every chunk with vkCmdDrawIndexedIndirectCount, after compute passes have culled them on the GPU.
+ * @details Meshes are suballocated from one vertex arena and one index arena, and each chunk has a ChunkDrawRecord
+ *          saying where its mesh is and what it bounds. cull() runs assets/chunk_cull.comp over the records, which
+ *          appends a draw for each chunk inside the frustum and counts them; draw() then issues them all, so the
+ *          CPU cost of a frame does not grow with the number of chunks. If the culling shader cannot be loaded,
+ *          cull_chunks() does the same work on the CPU, without occlusion culling, and draw() records a direct draw
+ *          per chunk kept, split across the ParallelRecorder's threads.
+ *
+ * Occlusion culling takes two phases. cull() also tests each chunk against the depth pyramid built last frame and
+ * holds back those it hides; draw() renders the rest, and once the DepthPyramid has been rebuilt from them,
+ * cull_late() re-tests the held-back chunks against it and draw_late() renders any that are visible after all. A
+ * chunk hidden last frame but not this one is so drawn the same frame it appears.
+ *
+ * Each frame in flight has its own records, commands and count buffers, so a record is never rewritten while a
+ * frame still reads it; a changed record is uploaded into each frame's copy as that frame comes round. A removed
+ * chunk's mesh and id are freed through the timeline once every copy has dropped it, so only after the
+ * submissions that might still draw it have completed.
+ * @warning Not thread-safe.
+ */
+class [[nodiscard]] ChunkRenderer final
+{
+  public:
+    static constexpr unsigned long long VERTEX_ARENA_BYTES = 64ull << 20;
+    static constexpr unsigned long long INDEX_ARENA_BYTES = 32ull << 20;
+    /// Returned by add_chunk() when the chunk could not be added.
+    static constexpr unsigned int INVALID_CHUNK = INVALID_BINDLESS_INDEX;
+    /// Threads per workgroup of the culling shader.
+    static constexpr unsigned int CULL_GROUP_SIZE = 64;
+
+    /**
+     * @param uploads Where mesh and record data is staged; must outlive the renderer.
+     * @param pipelines Compiles the draw pipeline; must be destroyed before the renderer, which owns the shaders.
+     * @param bindless Holds the records, commands and count buffers; must outlive the renderer.
+     * @param recorder Records the draws when culling on the CPU; must outlive the renderer.
+     * @param pyramid Holds the depth attachment chunks are drawn with, and the pyramid occlusion culling reads; must
+     *                outlive the renderer.
+     * @param timeline Where frames are submitted, which removed chunks are freed through; must outlive the renderer.
+     * @param color_format Format of the attachment chunks are drawn to.
+     * @param max_chunks Most chunks there can be at once, removed chunks counting until their ids are recycled.
+     *                   Sizes every frame's records, commands and culling buffers.
+     */
+    ChunkRenderer(const Device *device, UploadQueue *uploads, PipelineCompiler *pipelines, BindlessHeap *bindless,
+                  ParallelRecorder *recorder, const DepthPyramid *pyramid, Timeline *timeline, VkPipelineCache cache,
+                  VkFormat color_format, unsigned int frames_in_flight, unsigned int max_chunks);
+    /// Flushes the timeline's deferred deletions, which may free removed chunks, so the device must be idle.
+    ~ChunkRenderer();
+    ChunkRenderer(const ChunkRenderer &) = delete;
+    ChunkRenderer &operator=(const ChunkRenderer &) = delete;
+
+    /**
+     * @brief Copies a mesh into the arenas and gives it a record.
+     * @param indices 32-bit indices into vertices.
+     * @return The chunk's id, or INVALID_CHUNK if there are max_chunks chunks, an arena is full or this frame's
+     *         staging memory is used up; in the last case try again next frame.
+     */
+    [[nodiscard]] unsigned int add_chunk(const ChunkVertex *vertices, unsigned int vertex_count,
+                                         const unsigned int *indices, unsigned int index_count,
+                                         const float bounds_min[3], const float bounds_max[3]) noexcept;
+    /**
+     * @brief Stops drawing the chunk; its mesh and id are recycled once no frame in flight can use them.
+     */
+    void remove_chunk(unsigned int chunk) noexcept;
+
+    /**
+     * @brief Uploads the records that changed into this frame's copy, defers freeing removed chunks every copy has
+     *        dropped, and reads back the culling stats of the frame that last used this frame index. Call after
+     *        FrameRing::begin_frame(), with its frame index.
+     */
+    void begin_frame(unsigned int frame_index) noexcept;
+    /**
+     * @brief Records the early culling pass; call outside rendering, before draw() in the same command buffer.
+     * @param view_proj Column-major, with Vulkan's [0, 1] depth range.
+     */
+    void cull(CommandBuffer &command_buffer, const float view_proj[16]) noexcept;
+    /**
+     * @brief Draws the chunks cull() kept; call inside rendering. Does nothing until the pipeline has compiled.
+     *        When is_recording_secondary(), the rendering must be begun for secondary command buffers.
+     */
+    void draw(CommandBuffer &command_buffer, const float view_proj[16]) noexcept;
+    /**
+     * @brief Records the late culling pass, which re-tests the chunks cull() held back; call outside rendering,
+     *        after DepthPyramid::build(). Call it even when occlusion culling is off, as it also copies out the stats.
+     */
+    void cull_late(CommandBuffer &command_buffer) noexcept;
+    /**
+     * @brief Draws the chunks cull_late() found visible; call inside rendering, loading what draw() left.
+     */
+    void draw_late(CommandBuffer &command_buffer, const float view_proj[16]) noexcept;
+
+    /// Chunk ids in use, counting removed chunks until their ids are recycled.
+    [[nodiscard]] unsigned int get_chunk_count() const noexcept
+    {
+        return ids.get_used();
+    }
+    [[nodiscard]] const Utils::RangeAllocator &get_vertex_arena() const noexcept
+    {
+        return vertex_ranges;
+    }
+    [[nodiscard]] const Utils::RangeAllocator &get_index_arena() const noexcept
+    {
+        return index_ranges;
+    }
+    /// Whether culling runs on the GPU, or on the CPU for want of the shader.
+    [[nodiscard]] bool is_gpu_culling() const noexcept
+    {
+        return cull_pipeline != nullptr;
+    }
+    /// Whether draw() records into secondary command buffers, which is what it does when culling on the CPU.
+    [[nodiscard]] bool is_recording_secondary() const noexcept
+    {
+        return cull_pipeline == nullptr;
+    }
+    /// Whether cull() tests chunks against the depth pyramid, so draw_late() may have chunks to draw.
+    [[nodiscard]] bool is_occlusion_culling() const noexcept
+    {
+        return cull_pipeline != nullptr && pyramid->is_enabled();
+    }
+    /// Stats of the latest frame whose culling results have been read back, frames_in_flight frames ago on the GPU.
+    [[nodiscard]] const ChunkCullStats &get_cull_stats() const noexcept
+    {
+        return stats;
+    }
+
+  private:
+    struct Chunk
+    {
+        Utils::RangeAllocation vertices;
+        Utils::RangeAllocation indices;
+        unsigned char stale_copies = 0; ///< One bit per frame whose records buffer is out of date.
+        bool removed = true; ///< Also true of ids never handed out.
+    };
+
+    struct FrameBuffers
+    {
+        Buffer params; ///< Mapped CullParams.
+        Buffer records;
+        Buffer commands;
+        Buffer late_commands;
+        Buffer counts;   ///< Early draws, late draws and chunks held back by the early pass.
+        Buffer occluded; ///< Ids of the chunks held back.
+        Buffer readback; ///< Mapped copy of counts, for the stats.
+        uint32_t params_index = INVALID_BINDLESS_INDEX;
+        uint32_t records_index = INVALID_BINDLESS_INDEX;
+        uint32_t commands_index = INVALID_BINDLESS_INDEX;
+        uint32_t late_commands_index = INVALID_BINDLESS_INDEX;
+        uint32_t counts_index = INVALID_BINDLESS_INDEX;
+        uint32_t occluded_index = INVALID_BINDLESS_INDEX;
+        unsigned int record_count = 0; ///< Records [0, record_count) of this copy are all valid.
+        unsigned int tested = 0;       ///< Live chunks when the counts being read back were made.
+        bool counted = false;          ///< Whether readback will hold counts once the frame completes.
+    };
+
+    void mark_stale(unsigned int chunk) noexcept;
+    static void free_chunk(void *renderer, unsigned int id) noexcept;
+    void dispatch_cull(CommandBuffer &command_buffer, unsigned int phase) noexcept;
+    void draw_commands(CommandBuffer &command_buffer, const float view_proj[16], const Buffer &commands,
+                       VkDeviceSize count_offset) noexcept;
+    void draw_cpu_commands(CommandBuffer &command_buffer, const float view_proj[16]) noexcept;
+    static void record_cpu_commands(CommandBuffer &command_buffer, unsigned int first, unsigned int count,
+                                    void *user) noexcept;
+
+    UploadQueue *uploads;
+    BindlessHeap *bindless;
+    ParallelRecorder *recorder;
+    const DepthPyramid *pyramid;
+    Timeline *timeline;
+    Buffer vertex_arena;
+    Buffer index_arena;
+    Utils::RangeAllocator vertex_ranges;
+    Utils::RangeAllocator index_ranges;
+    FrameBuffers frame_buffers[MAX_FRAMES_IN_FLIGHT];
+    unsigned int frames_in_flight;
+    unsigned int frame_index = 0;
+
+    BindlessSlotAllocator ids; ///< Chunk ids, which are also record indices.
+    Utils::Vector<Chunk> chunks;
+    Utils::Vector<ChunkDrawRecord> records; ///< What every frame's records buffer will hold once brought up to date.
+    Utils::Vector<unsigned int> stale;      ///< Chunks with a stale_copies bit set.
+    unsigned int record_count = 0; ///< One past the highest id handed out; the culling pass covers [0, record_count).
+    unsigned int live_count = 0;
+    unsigned int draw_limit = 0; ///< Most draws the last cull() can have produced.
+    bool late_pass = false;      ///< Whether the last cull() held chunks back for cull_late() to re-test.
+    float history_view_proj[16] = {}; ///< What the depth pyramid was last built under.
+    Utils::Vector<IndirectDrawCommand> cpu_commands; ///< [0, draw_limit) are the draws of the last CPU cull().
+    float draw_view_proj[16] = {}; ///< What the CPU draws are recorded with, read by every recording thread.
+    ChunkCullStats stats;
+
+    Pipeline *cull_pipeline = nullptr;
+    PipelineHandle draw_pipeline;
+    VkShaderModule vertex_shader = VK_NULL_HANDLE;
+    VkShaderModule fragment_shader = VK_NULL_HANDLE;
+    VkFormat color_format; ///< Pointed to by the draw pipeline's rendering info while it compiles.
+};
+} // namespace LunaVoxelEngine::Renderer
+#endif
@@ -3,10 +3,26 @@
 namespace LunaVoxelEngine::Renderer
 {
 CommandBuffer::CommandBuffer(VkCommandPool commandPool, VkCommandBufferLevel level)
-{
+    : command_pool(commandPool)
+    , command_buffer(VK_NULL_HANDLE)
+{
+    VkCommandBufferAllocateInfo allocate_info{};
+    allocate_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocate_info.commandPool = command_pool;
+    allocate_info.level = level;
+    allocate_info.commandBufferCount = 1;
+
+    if (vkAllocateCommandBuffers(volkGetLoadedDevice(), &allocate_info, &command_buffer) != VK_SUCCESS)
+    {
+        Log::fatal("Failed to allocate command buffer");
+    }
 }
 CommandBuffer::~CommandBuffer()
 {
+    if (command_buffer != VK_NULL_HANDLE)
+    {
+        vkFreeCommandBuffers(volkGetLoadedDevice(), command_pool, 1, &command_buffer);
+    }
 }
 void CommandBuffer::begin(const VkCommandBufferUsageFlags usage)
 {
@@ -16,6 +32,15 @@ void CommandBuffer::begin(const VkCommandBufferUsageFlags usage)
 
     vkBeginCommandBuffer(command_buffer, &begin_info);
 }
+void CommandBuffer::begin(VkCommandBufferUsageFlags usage, const VkCommandBufferInheritanceInfo *pInheritanceInfo)
+{
+    VkCommandBufferBeginInfo begin_info{};
+    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    begin_info.flags = usage;
+    begin_info.pInheritanceInfo = pInheritanceInfo;
+
+    vkBeginCommandBuffer(command_buffer, &begin_info);
+}
 void CommandBuffer::end()
 {
     vkEndCommandBuffer(command_buffer);
@@ -37,21 +62,21 @@ void CommandBuffer::drawIndexed(uint32_t indexCount, uint32_t instanceCount, uin
 {
     vkCmdDrawIndexed(command_buffer, indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
 }
-void CommandBuffer::drawIndirect(Buffer buffer, VkDeviceSize offset, uint32_t drawCount, uint32_t stride)
+void CommandBuffer::drawIndirect(const Buffer &buffer, VkDeviceSize offset, uint32_t drawCount, uint32_t stride)
 {
     vkCmdDrawIndirect(command_buffer, buffer.buffer, offset, drawCount, stride);
 }
-void CommandBuffer::drawIndexedIndirect(Buffer buffer, VkDeviceSize offset, uint32_t drawCount, uint32_t stride)
+void CommandBuffer::drawIndexedIndirect(const Buffer &buffer, VkDeviceSize offset, uint32_t drawCount, uint32_t stride)
 {
     vkCmdDrawIndexedIndirect(command_buffer, buffer.buffer, offset, drawCount, stride);
 }
-void CommandBuffer::drawIndirectCount(Buffer buffer, VkDeviceSize offset, Buffer countBuffer,
+void CommandBuffer::drawIndirectCount(const Buffer &buffer, VkDeviceSize offset, const Buffer &countBuffer,
                                       VkDeviceSize countBufferOffset, uint32_t maxDrawCount, uint32_t stride)
 {
     vkCmdDrawIndirectCount(command_buffer, buffer.buffer, offset, countBuffer.buffer, countBufferOffset, maxDrawCount,
                            stride);
 }
-void CommandBuffer::drawIndexedIndirectCount(Buffer buffer, VkDeviceSize offset, Buffer countBuffer,
+void CommandBuffer::drawIndexedIndirectCount(const Buffer &buffer, VkDeviceSize offset, const Buffer &countBuffer,
                                              VkDeviceSize countBufferOffset, uint32_t maxDrawCount, uint32_t stride)
 {
     vkCmdDrawIndexedIndirectCount(command_buffer, buffer.buffer, offset, countBuffer.buffer, countBufferOffset,
@@ -61,7 +86,7 @@ void CommandBuffer::dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_
 {
     vkCmdDispatch(command_buffer, groupCountX, groupCountY, groupCountZ);
 }
-void CommandBuffer::dispatchIndirect(Buffer buffer, VkDeviceSize offset)
+void CommandBuffer::dispatchIndirect(const Buffer &buffer, VkDeviceSize offset)
 {
     vkCmdDispatchIndirect(command_buffer, buffer.buffer, offset);
 }
@@ -222,7 +247,7 @@ void CommandBuffer::bindVertexBuffer(uint32_t firstBinding, const Buffer &buffer
     VkDeviceSize offsets[] = {offset};
     vkCmdBindVertexBuffers(command_buffer, firstBinding, 1, buffers, offsets);
 }
-void CommandBuffer::bindIndexBuffer(Buffer buffer, VkDeviceSize offset, VkIndexType indexType)
+void CommandBuffer::bindIndexBuffer(const Buffer &buffer, VkDeviceSize offset, VkIndexType indexType)
 {
     vkCmdBindIndexBuffer(command_buffer, buffer.buffer, offset, indexType);
 }
@@ -245,6 +270,21 @@ void CommandBuffer::pipelineBarrier2(const VkDependencyInfo *pDependencyInfo)
 {
     vkCmdPipelineBarrier2(command_buffer, pDependencyInfo);
 }
+void CommandBuffer::memoryBarrier2(VkPipelineStageFlags2 srcStageMask, VkAccessFlags2 srcAccessMask,
+                                   VkPipelineStageFlags2 dstStageMask, VkAccessFlags2 dstAccessMask)
+{
+    VkMemoryBarrier2 barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+    barrier.srcStageMask = srcStageMask;
+    barrier.srcAccessMask = srcAccessMask;
+    barrier.dstStageMask = dstStageMask;
+    barrier.dstAccessMask = dstAccessMask;
+    VkDependencyInfo dependency{};
+    dependency.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    dependency.memoryBarrierCount = 1;
+    dependency.pMemoryBarriers = &barrier;
+    vkCmdPipelineBarrier2(command_buffer, &dependency);
+}
 void CommandBuffer::beginQuery(VkQueryPool queryPool, uint32_t query, VkQueryControlFlags flags)
 {
     vkCmdBeginQuery(command_buffer, queryPool, query, flags);
@@ -281,7 +321,12 @@ void CommandBuffer::clearDepthStencilImage(VkImage image, VkImageLayout imageLay
 {
     vkCmdClearDepthStencilImage(command_buffer, image, imageLayout, pDepthStencil, rangeCount, pRanges);
 }
-void CommandBuffer::copyBuffer(Buffer srcBuffer, Buffer dstBuffer, uint32_t regionCount, const VkBufferCopy *pRegions)
+void CommandBuffer::fillBuffer(const Buffer &dstBuffer, VkDeviceSize dstOffset, VkDeviceSize size, uint32_t data)
+{
+    vkCmdFillBuffer(command_buffer, dstBuffer.buffer, dstOffset, size, data);
+}
+void CommandBuffer::copyBuffer(const Buffer &srcBuffer, const Buffer &dstBuffer, uint32_t regionCount,
+                               const VkBufferCopy *pRegions)
 {
     vkCmdCopyBuffer(command_buffer, srcBuffer.buffer, dstBuffer.buffer, regionCount, pRegions);
 }
@@ -298,7 +343,7 @@ void CommandBuffer::copyImage2(const VkCopyImageInfo2 *pCopyImageInfo)
 {
     vkCmdCopyImage2(command_buffer, pCopyImageInfo);
 }
-void CommandBuffer::copyBufferToImage(Buffer srcBuffer, VkImage dstImage, VkImageLayout dstImageLayout,
+void CommandBuffer::copyBufferToImage(const Buffer &srcBuffer, VkImage dstImage, VkImageLayout dstImageLayout,
                                       uint32_t regionCount, const VkBufferImageCopy *pRegions)
 {
     vkCmdCopyBufferToImage(command_buffer, srcBuffer.buffer, dstImage, dstImageLayout, regionCount, pRegions);
@@ -307,7 +352,7 @@ void CommandBuffer::copyBufferToImage2(const VkCopyBufferToImageInfo2 *pCopyBuff
 {
     vkCmdCopyBufferToImage2(command_buffer, pCopyBufferToImageInfo);
 }
-void CommandBuffer::copyImageToBuffer(VkImage srcImage, VkImageLayout srcImageLayout, Buffer dstBuffer,
+void CommandBuffer::copyImageToBuffer(VkImage srcImage, VkImageLayout srcImageLayout, const Buffer &dstBuffer,
                                       uint32_t regionCount, const VkBufferImageCopy *pRegions)
 {
     vkCmdCopyImageToBuffer(command_buffer, srcImage, srcImageLayout, dstBuffer.buffer, regionCount, pRegions);
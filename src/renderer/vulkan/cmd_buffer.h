@@ -34,6 +34,8 @@ class [[nodiscard]] CommandBuffer final
     ~CommandBuffer();
     // Core Command Buffer Operations
     void begin(const VkCommandBufferUsageFlags usage = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+    /// For secondary buffers, which must say what they inherit from the primary that executes them.
+    void begin(VkCommandBufferUsageFlags usage, const VkCommandBufferInheritanceInfo *pInheritanceInfo);
     void end();
     void reset(VkCommandBufferResetFlags flags);
     void executeCommands(uint32_t commandBufferCount, const VkCommandBuffer *pCommandBuffers);
@@ -42,14 +44,15 @@ class [[nodiscard]] CommandBuffer final
     void draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance);
     void drawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset,
                      uint32_t firstInstance);
-    void drawIndirect(Buffer buffer, VkDeviceSize offset, uint32_t drawCount, uint32_t stride);
-    void drawIndexedIndirect(Buffer buffer, VkDeviceSize offset, uint32_t drawCount, uint32_t stride);
-    void drawIndirectCount(Buffer buffer, VkDeviceSize offset, Buffer countBuffer, VkDeviceSize countBufferOffset,
+    void drawIndirect(const Buffer &buffer, VkDeviceSize offset, uint32_t drawCount, uint32_t stride);
+    void drawIndexedIndirect(const Buffer &buffer, VkDeviceSize offset, uint32_t drawCount, uint32_t stride);
+    void drawIndirectCount(const Buffer &buffer, VkDeviceSize offset, const Buffer &countBuffer,
+                           VkDeviceSize countBufferOffset,
                            uint32_t maxDrawCount, uint32_t stride);
-    void drawIndexedIndirectCount(Buffer buffer, VkDeviceSize offset, Buffer countBuffer,
+    void drawIndexedIndirectCount(const Buffer &buffer, VkDeviceSize offset, const Buffer &countBuffer,
                                   VkDeviceSize countBufferOffset, uint32_t maxDrawCount, uint32_t stride);
     void dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ);
-    void dispatchIndirect(Buffer buffer, VkDeviceSize offset);
+    void dispatchIndirect(const Buffer &buffer, VkDeviceSize offset);
     void dispatchBase(uint32_t baseGroupX, uint32_t baseGroupY, uint32_t baseGroupZ, uint32_t groupCountX,
                       uint32_t groupCountY, uint32_t groupCountZ);
 
@@ -101,7 +104,7 @@ class [[nodiscard]] CommandBuffer final
                             uint32_t descriptorSetCount, const VkDescriptorSet *pDescriptorSets,
                             uint32_t dynamicOffsetCount, const uint32_t *pDynamicOffsets);
     void bindVertexBuffer(uint32_t firstBinding, const Buffer &buffer, VkDeviceSize offset);
-    void bindIndexBuffer(Buffer buffer, VkDeviceSize offset, VkIndexType indexType);
+    void bindIndexBuffer(const Buffer &buffer, VkDeviceSize offset, VkIndexType indexType);
     void pushConstants(VkPipelineLayout layout, VkShaderStageFlags stageFlags, uint32_t offset, uint32_t size,
                        const void *pValues);
 
@@ -112,6 +115,9 @@ class [[nodiscard]] CommandBuffer final
                          const VkBufferMemoryBarrier *pBufferMemoryBarriers, uint32_t imageMemoryBarrierCount,
                          const VkImageMemoryBarrier *pImageMemoryBarriers);
     void pipelineBarrier2(const VkDependencyInfo *pDependencyInfo);
+    /// One global VkMemoryBarrier2, for dependencies between passes that need no layout transition.
+    void memoryBarrier2(VkPipelineStageFlags2 srcStageMask, VkAccessFlags2 srcAccessMask,
+                        VkPipelineStageFlags2 dstStageMask, VkAccessFlags2 dstAccessMask);
 
     // Query Commands
     void beginQuery(VkQueryPool queryPool, uint32_t query, VkQueryControlFlags flags);
@@ -127,17 +133,21 @@ class [[nodiscard]] CommandBuffer final
                          const VkImageSubresourceRange *pRanges);
     void clearDepthStencilImage(VkImage image, VkImageLayout imageLayout, const VkClearDepthStencilValue *pDepthStencil,
                                 uint32_t rangeCount, const VkImageSubresourceRange *pRanges);
+    void fillBuffer(const Buffer &dstBuffer, VkDeviceSize dstOffset, VkDeviceSize size, uint32_t data);
 
     // Copy Commands
-    void copyBuffer(Buffer srcBuffer, Buffer dstBuffer, uint32_t regionCount, const VkBufferCopy *pRegions);
+    void copyBuffer(const Buffer &srcBuffer, const Buffer &dstBuffer, uint32_t regionCount,
+                    const VkBufferCopy *pRegions);
     void copyBuffer2(const VkCopyBufferInfo2 *pCopyBufferInfo);
     void copyImage(VkImage srcImage, VkImageLayout srcImageLayout, VkImage dstImage, VkImageLayout dstImageLayout,
                    uint32_t regionCount, const VkImageCopy *pRegions);
     void copyImage2(const VkCopyImageInfo2 *pCopyImageInfo);
-    void copyBufferToImage(Buffer srcBuffer, VkImage dstImage, VkImageLayout dstImageLayout, uint32_t regionCount,
+    void copyBufferToImage(const Buffer &srcBuffer, VkImage dstImage, VkImageLayout dstImageLayout,
+                           uint32_t regionCount,
                            const VkBufferImageCopy *pRegions);
     void copyBufferToImage2(const VkCopyBufferToImageInfo2 *pCopyBufferToImageInfo);
-    void copyImageToBuffer(VkImage srcImage, VkImageLayout srcImageLayout, Buffer dstBuffer, uint32_t regionCount,
+    void copyImageToBuffer(VkImage srcImage, VkImageLayout srcImageLayout, const Buffer &dstBuffer,
+                           uint32_t regionCount,
                            const VkBufferImageCopy *pRegions);
     void copyImageToBuffer2(const VkCopyImageToBufferInfo2 *pCopyImageToBufferInfo);
 
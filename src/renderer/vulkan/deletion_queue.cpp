@@ -0,0 +1,70 @@
+#include <renderer/vulkan/deletion_queue.h>
+
+namespace LunaVoxelEngine::Renderer
+{
+DeletionQueue::~DeletionQueue()
+{
+    flush();
+}
+
+void DeletionQueue::push(unsigned long long value, DestroyFunction destroy, void *object, void *user) noexcept
+{
+    if (head < deletions.size() && value < deletions[deletions.size() - 1].value)
+    {
+        value = deletions[deletions.size() - 1].value;
+    }
+    deletions.push_back({value, destroy, nullptr, object, user, 0});
+}
+
+void DeletionQueue::push(unsigned long long value, ReleaseFunction release, void *owner, unsigned int index) noexcept
+{
+    if (head < deletions.size() && value < deletions[deletions.size() - 1].value)
+    {
+        value = deletions[deletions.size() - 1].value;
+    }
+    deletions.push_back({value, nullptr, release, owner, nullptr, index});
+}
+
+unsigned int DeletionQueue::retire(unsigned long long completed) noexcept
+{
+    unsigned int count = 0;
+    while (head < deletions.size() && deletions[head].value <= completed)
+    {
+        // Copied first: destroying may push a deletion of its own, which can move the storage.
+        const Deletion deletion = deletions[head++];
+        if (deletion.destroy != nullptr)
+        {
+            deletion.destroy(deletion.object, deletion.user);
+        }
+        else
+        {
+            deletion.release(deletion.object, deletion.index);
+        }
+        ++count;
+    }
+    // Both keep the storage, so a steady trickle of deletions does not reallocate. Compacting once more than half
+    // has been destroyed bounds the queue at twice what is pending even if it never drains.
+    if (head == deletions.size())
+    {
+        deletions.resize(0);
+        head = 0;
+    }
+    else if (head > deletions.size() / 2)
+    {
+        const unsigned long pending = deletions.size() - head;
+        for (unsigned long i = 0; i < pending; ++i)
+        {
+            deletions[i] = deletions[head + i];
+        }
+        deletions.resize(pending);
+        head = 0;
+    }
+    destroyed += count;
+    return count;
+}
+
+void DeletionQueue::flush() noexcept
+{
+    retire(~0ull);
+}
+} // namespace LunaVoxelEngine::Renderer
@@ -0,0 +1,82 @@
+#ifndef VK_DELETION_QUEUE_H
+#define VK_DELETION_QUEUE_H
+#include <utils/vector.h>
+
+// Free of Vulkan, like StagingRing: deletions wait for a value on a timeline that only grows, so a test can retire
+// them against a simulated timeline and no GPU.
+namespace LunaVoxelEngine::Renderer
+{
+/**
+ * @class DeletionQueue
+ * @brief Holds resources the GPU may still be using and destroys each once the submission it waits for completes.
+ * @details Deletions are destroyed in the order they were pushed. A deletion pushed with a smaller value than the
+ *          one before it waits for the larger value instead, which only ever destroys it later than asked, so
+ *          retire() stops at the first deletion not yet due.
+ * @warning Not thread-safe.
+ */
+class DeletionQueue final
+{
+  public:
+    /// Destroys object; user is what was passed to push().
+    using DestroyFunction = void (*)(void *object, void *user);
+    /// Gives index back to owner, for resources that are slots in something rather than objects of their own.
+    using ReleaseFunction = void (*)(void *owner, unsigned int index);
+
+    DeletionQueue() = default;
+    ~DeletionQueue();
+    DeletionQueue(const DeletionQueue &) = delete;
+    DeletionQueue &operator=(const DeletionQueue &) = delete;
+
+    /**
+     * @brief Destroys object once value has completed.
+     */
+    void push(unsigned long long value, DestroyFunction destroy, void *object, void *user = nullptr) noexcept;
+    /**
+     * @brief Releases index to owner once value has completed.
+     */
+    void push(unsigned long long value, ReleaseFunction release, void *owner, unsigned int index) noexcept;
+    /**
+     * @brief Deletes object, which was allocated with new, once value has completed.
+     */
+    template<typename T> void push_delete(unsigned long long value, T *object) noexcept
+    {
+        push(value, [](void *pointer, void *) { delete static_cast<T *>(pointer); }, object);
+    }
+
+    /**
+     * @brief Destroys every deletion whose value is at most completed.
+     * @return How many were destroyed.
+     */
+    unsigned int retire(unsigned long long completed) noexcept;
+    /**
+     * @brief Destroys everything pending; only once the device is idle.
+     */
+    void flush() noexcept;
+
+    [[nodiscard]] unsigned long get_pending() const noexcept
+    {
+        return deletions.size() - head;
+    }
+    /// Deletions destroyed over the queue's life.
+    [[nodiscard]] unsigned long long get_destroyed() const noexcept
+    {
+        return destroyed;
+    }
+
+  private:
+    struct Deletion
+    {
+        unsigned long long value;
+        DestroyFunction destroy; ///< Null for a release.
+        ReleaseFunction release;
+        void *object; ///< The owner, for a release.
+        void *user;
+        unsigned int index;
+    };
+
+    Utils::Vector<Deletion> deletions; ///< In push order, from head on.
+    unsigned long head = 0;
+    unsigned long long destroyed = 0;
+};
+} // namespace LunaVoxelEngine::Renderer
+#endif
@@ -0,0 +1,165 @@
+#include <platform/log.h>
+#include <renderer/vulkan/depth_pyramid.h>
+#include <renderer/vulkan/shader.h>
+extern VkAllocationCallbacks callbacks;
+
+namespace LunaVoxelEngine::Renderer
+{
+namespace
+{
+constexpr const char *PYRAMID_SHADER_PATH = "shaders/depth_pyramid.comp.spv";
+
+/// Matches ReduceConstants in assets/depth_pyramid.comp.
+struct ReduceConstants
+{
+    uint32_t src_size[2];
+    uint32_t dst_size[2];
+    uint32_t src_index;
+    uint32_t dst_index;
+    uint32_t src_is_depth; ///< Level 0 reads the depth buffer as a sampled image, the rest a storage image.
+};
+static_assert(sizeof(ReduceConstants) <= BINDLESS_PUSH_CONSTANT_SIZE);
+
+VkImageMemoryBarrier2 image_barrier(const Image &image, VkImageAspectFlags aspect, VkPipelineStageFlags2 src_stage,
+                                    VkAccessFlags2 src_access, VkPipelineStageFlags2 dst_stage,
+                                    VkAccessFlags2 dst_access, VkImageLayout old_layout,
+                                    VkImageLayout new_layout) noexcept
+{
+    VkImageMemoryBarrier2 barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+    barrier.srcStageMask = src_stage;
+    barrier.srcAccessMask = src_access;
+    barrier.dstStageMask = dst_stage;
+    barrier.dstAccessMask = dst_access;
+    barrier.oldLayout = old_layout;
+    barrier.newLayout = new_layout;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image.getImage();
+    barrier.subresourceRange.aspectMask = aspect;
+    barrier.subresourceRange.levelCount = image.getMipLevels();
+    barrier.subresourceRange.layerCount = 1;
+    return barrier;
+}
+
+void image_barriers(CommandBuffer &command_buffer, const VkImageMemoryBarrier2 *barriers, uint32_t count) noexcept
+{
+    VkDependencyInfo dependency_info{};
+    dependency_info.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    dependency_info.imageMemoryBarrierCount = count;
+    dependency_info.pImageMemoryBarriers = barriers;
+    command_buffer.pipelineBarrier2(&dependency_info);
+}
+} // namespace
+
+DepthPyramid::DepthPyramid(const Device *device, BindlessHeap *bindless_in, VkPipelineCache cache,
+                           VkExtent2D extent)
+    : bindless(bindless_in)
+    , depth(device, extent.width, extent.height, DEPTH_FORMAT,
+            VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_DEPTH_BIT)
+{
+    unsigned int width;
+    unsigned int height;
+    Renderer::get_pyramid_extent(extent.width, extent.height, width, height);
+    const unsigned int level_count = get_pyramid_level_count(width, height);
+    pyramid = Image(device, width, height, VK_FORMAT_R32_SFLOAT,
+                    VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT, level_count);
+
+    const VkDevice vk_device = volkGetLoadedDevice();
+    for (unsigned int level = 0; level < level_count; ++level)
+    {
+        VkImageViewCreateInfo view_info{};
+        view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        view_info.image = pyramid.getImage();
+        view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        view_info.format = VK_FORMAT_R32_SFLOAT;
+        view_info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        view_info.subresourceRange.baseMipLevel = level;
+        view_info.subresourceRange.levelCount = 1;
+        view_info.subresourceRange.layerCount = 1;
+        if (vkCreateImageView(vk_device, &view_info, &callbacks, &level_views[level]) != VK_SUCCESS)
+        {
+            Log::fatal("Failed to create depth pyramid level %u view", level);
+        }
+        level_indices[level] = bindless->add_storage_image(level_views[level]);
+    }
+    depth_index = bindless->add_sampled_image(depth.getImageView());
+    pyramid_index = bindless->add_sampled_image(pyramid.getImageView(), VK_IMAGE_LAYOUT_GENERAL);
+
+    const VkShaderModule shader = load_shader_module(PYRAMID_SHADER_PATH);
+    if (shader != VK_NULL_HANDLE)
+    {
+        VkComputePipelineCreateInfo compute_info{};
+        compute_info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        compute_info.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        compute_info.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        compute_info.stage.module = shader;
+        compute_info.stage.pName = "main";
+        compute_info.layout = bindless->get_pipeline_layout();
+        pipeline = new Pipeline(compute_info, cache);
+        vkDestroyShaderModule(vk_device, shader, &callbacks);
+        if (pipeline->handle() == VK_NULL_HANDLE)
+        {
+            delete pipeline;
+            pipeline = nullptr;
+        }
+    }
+    if (pipeline == nullptr)
+    {
+        Log::warn(Log::Module::VULKAN, "Occlusion culling is off: no usable depth pyramid shader");
+    }
+}
+
+DepthPyramid::~DepthPyramid()
+{
+    const VkDevice vk_device = volkGetLoadedDevice();
+    for (unsigned int level = 0; level < pyramid.getMipLevels(); ++level)
+    {
+        bindless->release(BindlessType::STORAGE_IMAGE, level_indices[level]);
+        vkDestroyImageView(vk_device, level_views[level], &callbacks);
+    }
+    bindless->release(BindlessType::SAMPLED_IMAGE, depth_index);
+    bindless->release(BindlessType::SAMPLED_IMAGE, pyramid_index);
+    delete pipeline;
+}
+
+void DepthPyramid::build(CommandBuffer &command_buffer) noexcept
+{
+    if (pipeline == nullptr)
+    {
+        return;
+    }
+    // The pyramid's old contents were last read by this frame's early culling pass, or by nothing at all.
+    const VkImageMemoryBarrier2 before =
+        image_barrier(pyramid, VK_IMAGE_ASPECT_COLOR_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_NONE,
+                      VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+                      built ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
+    image_barriers(command_buffer, &before, 1);
+
+    command_buffer.bindPipeline(VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    bindless->bind(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE);
+    const VkExtent2D depth_extent = depth.getExtent();
+    ReduceConstants constants{{depth_extent.width, depth_extent.height}, {}, depth_index, 0, 1};
+    VkExtent2D level_extent = pyramid.getExtent();
+    for (unsigned int level = 0; level < pyramid.getMipLevels(); ++level)
+    {
+        constants.dst_size[0] = level_extent.width;
+        constants.dst_size[1] = level_extent.height;
+        constants.dst_index = level_indices[level];
+        command_buffer.pushConstants(bindless->get_pipeline_layout(), VK_SHADER_STAGE_ALL, 0, sizeof(constants),
+                                     &constants);
+        command_buffer.dispatch((level_extent.width + GROUP_SIZE - 1) / GROUP_SIZE,
+                                (level_extent.height + GROUP_SIZE - 1) / GROUP_SIZE, 1);
+        // Each level reads the one before; the last barrier also covers the late culling pass's reads.
+        command_buffer.memoryBarrier2(VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+                                      VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                                      VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_SAMPLED_READ_BIT);
+        constants.src_size[0] = level_extent.width;
+        constants.src_size[1] = level_extent.height;
+        constants.src_index = level_indices[level];
+        constants.src_is_depth = 0;
+        level_extent = {Utils::max(1u, level_extent.width / 2), Utils::max(1u, level_extent.height / 2)};
+    }
+    built = true;
+}
+} // namespace LunaVoxelEngine::Renderer
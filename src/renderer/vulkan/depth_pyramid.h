@@ -0,0 +1,89 @@
+#ifndef VK_DEPTH_PYRAMID_H
+#define VK_DEPTH_PYRAMID_H
+#include <renderer/vulkan/bindless.h>
+#include <renderer/vulkan/chunk_cull.h>
+#include <renderer/vulkan/cmd_buffer.h>
+#include <renderer/vulkan/device.h>
+#include <renderer/vulkan/image.h>
+#include <renderer/vulkan/ivulkan.h>
+#include <renderer/vulkan/pipeline.h>
+
+namespace LunaVoxelEngine::Renderer
+{
+/**
+ * @class DepthPyramid
+ * @brief The depth buffer chunks are drawn with, and a hierarchical-Z pyramid built from it for occlusion culling.
+ * @details build() reduces the depth buffer with assets/depth_pyramid.comp into an R32_SFLOAT image whose mips each
+ *          hold the farthest depth of the texels under them, one dispatch per level, as CpuDepthPyramid does on the
+ *          CPU. The culling shader samples the whole pyramid through get_pyramid_index(); the pyramid stays in the
+ *          GENERAL layout so it can be written and read without transitions.
+ *
+ * Without its shader the pyramid is never built, and the depth buffer is only a depth buffer.
+ * @warning Not thread-safe.
+ */
+class [[nodiscard]] DepthPyramid final
+{
+  public:
+    static constexpr VkFormat DEPTH_FORMAT = VK_FORMAT_D32_SFLOAT;
+    /// Threads per workgroup side of the reduction shader.
+    static constexpr unsigned int GROUP_SIZE = 8;
+
+    /**
+     * @param bindless Holds the depth buffer and pyramid views; must outlive the pyramid.
+     * @param extent Size of the depth buffer, which must match the color attachment it is drawn with.
+     */
+    DepthPyramid(const Device *device, BindlessHeap *bindless, VkPipelineCache cache, VkExtent2D extent);
+    ~DepthPyramid();
+    DepthPyramid(const DepthPyramid &) = delete;
+    DepthPyramid &operator=(const DepthPyramid &) = delete;
+
+    /**
+     * @brief Records the reduction of the depth buffer into the pyramid; call outside rendering, after the depth
+     *        buffer has been drawn. The depth buffer must already be in SHADER_READ_ONLY_OPTIMAL and visible to
+     *        compute shaders, as a RenderGraph pass sampling it in compute leaves it. Does nothing if the shader
+     *        is missing.
+     */
+    void build(CommandBuffer &command_buffer) noexcept;
+
+    /// Whether build() can run at all.
+    [[nodiscard]] bool is_enabled() const noexcept
+    {
+        return pipeline != nullptr;
+    }
+    /// Whether the pyramid holds depth from an earlier build(), rather than garbage.
+    [[nodiscard]] bool is_built() const noexcept
+    {
+        return built;
+    }
+    [[nodiscard]] const Image &get_depth() const noexcept
+    {
+        return depth;
+    }
+    /// The pyramid's sampled image index in the bindless heap, read in the GENERAL layout.
+    [[nodiscard]] uint32_t get_pyramid_index() const noexcept
+    {
+        return pyramid_index;
+    }
+    /// Size of level 0, half the depth buffer's.
+    [[nodiscard]] VkExtent2D get_pyramid_extent() const noexcept
+    {
+        return pyramid.getExtent();
+    }
+    [[nodiscard]] uint32_t get_level_count() const noexcept
+    {
+        return pyramid.getMipLevels();
+    }
+
+  private:
+    BindlessHeap *bindless;
+    Image depth;
+    Image pyramid;
+    VkImageView level_views[MAX_PYRAMID_LEVELS] = {};
+    uint32_t level_indices[MAX_PYRAMID_LEVELS] = {}; ///< Storage image index of each level's view.
+    uint32_t depth_index = INVALID_BINDLESS_INDEX;
+    uint32_t pyramid_index = INVALID_BINDLESS_INDEX;
+    Pipeline *pipeline = nullptr;
+    bool built = false;
+};
+} // namespace LunaVoxelEngine::Renderer
+#endif
@@ -1,12 +1,13 @@
 #include <platform/log.h>
 #include <renderer/vulkan/device.h>
+#include <utils/algorithm.h>
 #include <utils/new.h>
-#include <utils/string.h>
+#include <utils/string_view.h>
 #include <cstddef>
 
 using namespace LunaVoxelEngine;
 
-static Utils::String msgTypeToString(VkDebugUtilsMessageTypeFlagsEXT type) noexcept
+static const char *msgTypeToString(VkDebugUtilsMessageTypeFlagsEXT type) noexcept
 {
     switch (type)
     {
@@ -74,13 +75,14 @@ void VKAPI_PTR customInternalAllocationNotification(void *pUserData, size_t size
                                                     VkInternalAllocationType allocationType,
                                                     VkSystemAllocationScope allocationScope)
 {
-    Log::debug("Vulkan:Internal allocation of size %d in scope %s", size, scopeToString(allocationScope));
+    LUNA_LOG_DEBUG(VULKAN, "Vulkan:Internal allocation of size %zu in scope %s", size,
+                   scopeToString(allocationScope));
 }
 
 void VKAPI_PTR customInternalFreeNotification(void *pUserData, size_t size, VkInternalAllocationType allocationType,
                                               VkSystemAllocationScope allocationScope)
 {
-    Log::debug("Vulkan:Internal free of size %d in scope %s", size, scopeToString(allocationScope));
+    LUNA_LOG_DEBUG(VULKAN, "Vulkan:Internal free of size %zu in scope %s", size, scopeToString(allocationScope));
 }
 
 VkAllocationCallbacks callbacks = {.pUserData = nullptr,
@@ -90,38 +92,55 @@ VkAllocationCallbacks callbacks = {.pUserData = nullptr,
                                    .pfnInternalAllocation = customInternalAllocationNotification,
                                    .pfnInternalFree = customInternalFreeNotification};
 
+// The layers repeat a message every frame until its cause is fixed, so each message ID is throttled.
+static Log::LogThrottle validation_throttle;
+
 static VKAPI_ATTR VkBool32 VKAPI_CALL debugCallback(VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
                                                     VkDebugUtilsMessageTypeFlagsEXT messageType,
                                                     const VkDebugUtilsMessengerCallbackDataEXT *pCallbackData,
                                                     void *) noexcept
 {
-    const auto type = msgTypeToString(messageType);
+    Log::Level level;
     switch (messageSeverity)
     {
-    case VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT: {
-        auto str = type.throw_away();
-        Log::error("Validation layer: <TYPE:%s> %s", str.c_str(), pCallbackData->pMessage);
+    case VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT:
+        level = Log::Level::LOG_ERROR;
         break;
-    }
-    case VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT: {
-        auto str = type.throw_away();
-        Log::warn("Validation layer: <TYPE:%s> %s", str.c_str(), pCallbackData->pMessage);
+    case VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT:
+        level = Log::Level::LOG_WARN;
         break;
-    }
-    case VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT: {
-        auto str = type.throw_away();
-        Log::debug("Validation layer: <TYPE:%s> %s", str.c_str(), pCallbackData->pMessage);
+    case VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT:
+        level = Log::Level::LOG_DEBUG;
         break;
-    }
-    case VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT: {
-        auto str = type.throw_away();
-        Log::trace("Validation layer: <TYPE:%s> %s", str.c_str(), pCallbackData->pMessage);
+    case VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT:
+        level = Log::Level::LOG_TRACE;
         break;
-    }
     case VK_DEBUG_UTILS_MESSAGE_SEVERITY_FLAG_BITS_MAX_ENUM_EXT:
         [[fallthrough]];
     default:
-        break;
+        return VK_FALSE;
+    }
+    if (!Log::is_enabled(Log::Module::VULKAN, level))
+    {
+        return VK_FALSE;
+    }
+    const unsigned long long key =
+        static_cast<unsigned long long>(static_cast<unsigned int>(pCallbackData->messageIdNumber)) << 8 |
+        static_cast<unsigned long long>(level);
+    const Log::ThrottleResult admitted = validation_throttle.admit(key);
+    if (!admitted.allowed)
+    {
+        return VK_FALSE;
+    }
+    const auto type = msgTypeToString(messageType);
+    if (admitted.suppressed > 0)
+    {
+        Log::write(level, Log::Module::VULKAN, "Validation layer: <TYPE:%s> %s (%u repeats suppressed)", type,
+                   pCallbackData->pMessage, admitted.suppressed);
+    }
+    else
+    {
+        Log::write(level, Log::Module::VULKAN, "Validation layer: <TYPE:%s> %s", type, pCallbackData->pMessage);
     }
     return VK_FALSE;
 }
@@ -188,12 +207,23 @@ static void *pick_physical_device(const VkPhysicalDevice devices[], const uint32
     return VK_NULL_HANDLE;
 }
 
-static uint32_t find_queue_families(VkPhysicalDevice device) noexcept
+static uint32_t find_queue_families(VkPhysicalDevice device, uint32_t *transfer_family) noexcept
 {
     uint32_t queue_family_count = 0;
     vkGetPhysicalDeviceQueueFamilyProperties(device, &queue_family_count, nullptr);
     Platform::ScopedHeap<VkQueueFamilyProperties> queue_families(queue_family_count);   
     vkGetPhysicalDeviceQueueFamilyProperties(device, &queue_family_count, &queue_families);
+    // A family that can only transfer is a DMA engine, which copies without taking time from graphics work.
+    *transfer_family = UINT32_MAX;
+    for (uint32_t i = 0; i < queue_family_count; ++i)
+    {
+        if ((queue_families[i].queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT)) ==
+            VK_QUEUE_TRANSFER_BIT)
+        {
+            *transfer_family = i;
+            break;
+        }
+    }
     for (uint32_t i = 0; i < queue_family_count; ++i)
     {
         if (queue_families[i].queueFlags & VK_QUEUE_GRAPHICS_BIT)
@@ -204,11 +234,74 @@ static uint32_t find_queue_families(VkPhysicalDevice device) noexcept
     return UINT32_MAX;
 }
 
+static bool has_device_extension(VkPhysicalDevice device, const char *name) noexcept
+{
+    uint32_t count = 0;
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &count, nullptr);
+    Platform::ScopedHeap<VkExtensionProperties> properties(count);
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &count, &properties);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (Utils::StringView(properties[i].extensionName) == name)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// The GpuAllocator backend. Memory handles are VkDeviceMemory; user is the physical device.
+static unsigned long long allocate_device_memory(void *, unsigned int type, unsigned long long size) noexcept
+{
+    VkMemoryAllocateInfo allocate_info{};
+    allocate_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocate_info.allocationSize = size;
+    allocate_info.memoryTypeIndex = type;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    if (vkAllocateMemory(volkGetLoadedDevice(), &allocate_info, &callbacks, &memory) != VK_SUCCESS)
+    {
+        return 0;
+    }
+    return reinterpret_cast<unsigned long long>(memory);
+}
+
+static void free_device_memory(void *, unsigned long long memory) noexcept
+{
+    vkFreeMemory(volkGetLoadedDevice(), reinterpret_cast<VkDeviceMemory>(memory), &callbacks);
+}
+
+static void *map_device_memory(void *, unsigned long long memory) noexcept
+{
+    void *data = nullptr;
+    if (vkMapMemory(volkGetLoadedDevice(), reinterpret_cast<VkDeviceMemory>(memory), 0, VK_WHOLE_SIZE, 0, &data) !=
+        VK_SUCCESS)
+    {
+        return nullptr;
+    }
+    return data;
+}
+
+static bool query_memory_budget(void *user, unsigned long long *usage, unsigned long long *budget) noexcept
+{
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT budget_properties{};
+    budget_properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+    VkPhysicalDeviceMemoryProperties2 properties{};
+    properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+    properties.pNext = &budget_properties;
+    vkGetPhysicalDeviceMemoryProperties2(static_cast<VkPhysicalDevice>(user), &properties);
+    for (uint32_t i = 0; i < properties.memoryProperties.memoryHeapCount; ++i)
+    {
+        usage[i] = budget_properties.heapUsage[i];
+        budget[i] = budget_properties.heapBudget[i];
+    }
+    return true;
+}
+
 namespace LunaVoxelEngine
 {
 namespace Renderer
 { 
-    Device::Device(const bool debug)
+    Device::Device(const bool debug, const bool headless)
 {
     VkInstance instance;
     {
@@ -223,21 +316,26 @@ namespace Renderer
         app_info.pEngineName = "LunaVoxelEngine";
         app_info.engineVersion = VK_MAKE_VERSION(1, 0, 0);
         app_info.apiVersion = VK_API_VERSION_1_3;
-        const char *extensions[3] = {VK_KHR_SURFACE_EXTENSION_NAME,
+        const char *extensions[3] = {};
+        uint32_t extension_count = 0;
+        // Without a window there is no surface, so the surface extensions, which need a display, are skipped.
+        if (!headless)
+        {
+            extensions[extension_count++] = VK_KHR_SURFACE_EXTENSION_NAME;
 #if defined(ON_WINDOWS) || defined(ON_XBOX)
-                                     VK_KHR_WIN32_SURFACE_EXTENSION_NAME,
+            extensions[extension_count++] = VK_KHR_WIN32_SURFACE_EXTENSION_NAME;
 #endif
 #if defined(ON_ANDROID)
-                                     VK_KHR_ANDROID_SURFACE_EXTENSION_NAME,
+            extensions[extension_count++] = VK_KHR_ANDROID_SURFACE_EXTENSION_NAME;
 #endif
 #if defined(ON_LINUX)
 #    if defined(USE_WAYLAND)
-                                     VK_KHR_WAYLAND_SURFACE_EXTENSION_NAME,
+            extensions[extension_count++] = VK_KHR_WAYLAND_SURFACE_EXTENSION_NAME;
 #    else
-                                     VK_KHR_XCB_SURFACE_EXTENSION_NAME,
+            extensions[extension_count++] = VK_KHR_XCB_SURFACE_EXTENSION_NAME;
 #    endif
 #endif
-                                     ""};
+        }
         VkInstanceCreateInfo create_info = {};
         create_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
         create_info.pApplicationInfo = &app_info;
@@ -246,8 +344,7 @@ namespace Renderer
         VkDebugUtilsMessengerCreateInfoEXT debug_info{};
         if (debug)
         {
-            extensions[2] = reinterpret_cast<const char *>(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
-            create_info.enabledExtensionCount = 3;
+            extensions[extension_count++] = reinterpret_cast<const char *>(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
             create_info.enabledLayerCount = 1;
             const char *debug_layer_name = "VK_LAYER_KHRONOS_validation";
             create_info.ppEnabledLayerNames = &debug_layer_name;
@@ -261,10 +358,7 @@ namespace Renderer
             debug_info.pfnUserCallback = debugCallback;
             create_info.pNext = reinterpret_cast<VkDebugUtilsMessengerCreateInfoEXT *>(&debug_info);
         }
-        else
-        {
-            create_info.enabledExtensionCount = 2;
-        }
+        create_info.enabledExtensionCount = extension_count;
         create_info.ppEnabledExtensionNames = extensions;
 
         if (auto result = vkCreateInstance(&create_info, &callbacks, &instance); result != VK_SUCCESS)
@@ -293,34 +387,102 @@ namespace Renderer
     }
     physical_device_ = static_cast<VkPhysicalDevice>(pd);
     float queue_priority = 1.0f;
-    VkDeviceQueueCreateInfo queue_create_info{};
+    uint32_t transfer_family = UINT32_MAX;
+    VkDeviceQueueCreateInfo queue_create_infos[2] = {};
+    VkDeviceQueueCreateInfo &queue_create_info = queue_create_infos[0];
     queue_create_info.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-    queue_create_info.queueFamilyIndex = graphics_family_index_ = find_queue_families(physical_device_);
+    graphics_family_index_ = find_queue_families(physical_device_, &transfer_family);
+    queue_create_info.queueFamilyIndex = graphics_family_index_;
     queue_create_info.queueCount = 1;
     queue_create_info.pQueuePriorities = &queue_priority;
+    uint32_t queue_create_info_count = 1;
+    transfer_family_index_ = graphics_family_index_;
+    if (transfer_family != UINT32_MAX)
+    {
+        queue_create_infos[1] = queue_create_info;
+        queue_create_infos[1].queueFamilyIndex = transfer_family_index_ = transfer_family;
+        queue_create_info_count = 2;
+    }
 
     VkPhysicalDeviceFeatures device_features{};
     device_features.samplerAnisotropy = VK_TRUE;
     device_features.geometryShader = VK_TRUE;
     device_features.tessellationShader = VK_TRUE;
+    // Chunks are drawn from one indirect buffer, each draw reading its record through firstInstance.
+    device_features.multiDrawIndirect = VK_TRUE;
+    device_features.drawIndirectFirstInstance = VK_TRUE;
 
     VkDeviceCreateInfo device_create_info{};
     device_create_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-    device_create_info.queueCreateInfoCount = 1;
-    device_create_info.pQueueCreateInfos = &queue_create_info;
+    device_create_info.queueCreateInfoCount = queue_create_info_count;
+    device_create_info.pQueueCreateInfos = queue_create_infos;
     device_create_info.pEnabledFeatures = &device_features;
-    const char *extensions[2] = {
-        VK_KHR_SWAPCHAIN_EXTENSION_NAME,
-        VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME,
-    };
-    device_create_info.enabledExtensionCount = 2;
+    const char *extensions[3] = {VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME};
+    uint32_t extension_count = 1;
+    if (!headless)
+    {
+        extensions[extension_count++] = VK_KHR_SWAPCHAIN_EXTENSION_NAME;
+    }
+    // Lets the allocator see how much memory the driver would rather the process used, other processes included.
+    const bool memory_budget = has_device_extension(physical_device_, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    if (memory_budget)
+    {
+        extensions[extension_count++] = VK_EXT_MEMORY_BUDGET_EXTENSION_NAME;
+    }
+    device_create_info.enabledExtensionCount = extension_count;
     device_create_info.ppEnabledExtensionNames = &extensions[0];
     device_create_info.enabledLayerCount = 0;
 
-    VkPhysicalDeviceDynamicRenderingFeatures dr_features = {};
-    dr_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES;
-    dr_features.dynamicRendering = VK_TRUE;
-    device_create_info.pNext = &dr_features;
+    // Bindless resources need descriptor indexing: large update-after-bind arrays, indexed freely by shaders.
+    VkPhysicalDeviceVulkan12Features supported_12{};
+    supported_12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    VkPhysicalDeviceFeatures2 supported{};
+    supported.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    supported.pNext = &supported_12;
+    vkGetPhysicalDeviceFeatures2(physical_device_, &supported);
+    if (!supported_12.descriptorIndexing || !supported_12.runtimeDescriptorArray ||
+        !supported_12.descriptorBindingPartiallyBound || !supported_12.descriptorBindingUpdateUnusedWhilePending ||
+        !supported_12.descriptorBindingSampledImageUpdateAfterBind ||
+        !supported_12.descriptorBindingStorageImageUpdateAfterBind ||
+        !supported_12.descriptorBindingStorageBufferUpdateAfterBind ||
+        !supported_12.shaderSampledImageArrayNonUniformIndexing)
+    {
+        Log::fatal("The GPU does not support the descriptor indexing features bindless resources need");
+    }
+    // The draw count of culled chunks is written by the GPU, so the CPU never waits to read it back.
+    if (!supported_12.drawIndirectCount || !supported.features.multiDrawIndirect ||
+        !supported.features.drawIndirectFirstInstance)
+    {
+        Log::fatal("The GPU does not support the indirect draw features chunk rendering needs");
+    }
+    // Submissions are tracked by points on a timeline semaphore per queue, rather than by a fence each.
+    if (!supported_12.timelineSemaphore)
+    {
+        Log::fatal("The GPU does not support timeline semaphores");
+    }
+
+    VkPhysicalDeviceVulkan12Features features_12{};
+    features_12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    features_12.descriptorIndexing = VK_TRUE;
+    features_12.runtimeDescriptorArray = VK_TRUE;
+    features_12.descriptorBindingPartiallyBound = VK_TRUE;
+    features_12.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+    features_12.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+    features_12.descriptorBindingStorageImageUpdateAfterBind = VK_TRUE;
+    features_12.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+    features_12.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+    features_12.drawIndirectCount = VK_TRUE;
+    features_12.timelineSemaphore = VK_TRUE;
+    features_12.shaderStorageBufferArrayNonUniformIndexing = supported_12.shaderStorageBufferArrayNonUniformIndexing;
+    features_12.shaderStorageImageArrayNonUniformIndexing = supported_12.shaderStorageImageArrayNonUniformIndexing;
+
+    // Dynamic rendering and synchronization2 are core in 1.3, but still have to be enabled.
+    VkPhysicalDeviceVulkan13Features features_13{};
+    features_13.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+    features_13.pNext = &features_12;
+    features_13.dynamicRendering = VK_TRUE;
+    features_13.synchronization2 = VK_TRUE;
+    device_create_info.pNext = &features_13;
 
     VkDevice device;
     if (auto result = vkCreateDevice(physical_device_, &device_create_info, &callbacks, &device); result != VK_SUCCESS)
@@ -329,12 +491,49 @@ namespace Renderer
     }
     volkLoadDevice(device);
     vkGetDeviceQueue(device, queue_create_info.queueFamilyIndex, 0, &graphics_queue_);
+
+    VkPhysicalDeviceMemoryProperties mem_properties;
+    vkGetPhysicalDeviceMemoryProperties(physical_device_, &mem_properties);
+    MemoryProperties memory_properties;
+    memory_properties.type_count = mem_properties.memoryTypeCount;
+    for (uint32_t i = 0; i < mem_properties.memoryTypeCount; ++i)
+    {
+        memory_properties.type_properties[i] = mem_properties.memoryTypes[i].propertyFlags;
+        memory_properties.type_heap[i] = mem_properties.memoryTypes[i].heapIndex;
+    }
+    memory_properties.heap_count = mem_properties.memoryHeapCount;
+    for (uint32_t i = 0; i < mem_properties.memoryHeapCount; ++i)
+    {
+        memory_properties.heap_size[i] = mem_properties.memoryHeaps[i].size;
+    }
+    MemoryBackend backend;
+    backend.user = physical_device_;
+    backend.allocate = allocate_device_memory;
+    backend.free = free_device_memory;
+    backend.map = map_device_memory;
+    backend.query_budget = memory_budget ? query_memory_budget : nullptr;
+    allocator_ = new GpuAllocator(memory_properties, backend);
+}
+
+uint32_t Device::find_memory_type(uint32_t type_bits, VkMemoryPropertyFlags properties) const noexcept
+{
+    VkPhysicalDeviceMemoryProperties mem_properties;
+    vkGetPhysicalDeviceMemoryProperties(physical_device_, &mem_properties);
+    for (uint32_t i = 0; i < mem_properties.memoryTypeCount; ++i)
+    {
+        if ((type_bits & (1u << i)) && (mem_properties.memoryTypes[i].propertyFlags & properties) == properties)
+        {
+            return i;
+        }
+    }
+    return UINT32_MAX;
 }
 
 Device::~Device()
 {
     auto instance = volkGetLoadedInstance();
     auto device = volkGetLoadedDevice();
+    delete allocator_;
     vkDestroyDevice(device, &callbacks);
     if (debug_messenger_ != VK_NULL_HANDLE)
     {
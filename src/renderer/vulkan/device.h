@@ -1,5 +1,6 @@
 #ifndef VK_DEVICE_H
 #define VK_DEVICE_H
+#include <renderer/vulkan/gpu_allocator.h>
 #include <renderer/vulkan/ivulkan.h>
 
 namespace LunaVoxelEngine::Renderer
@@ -14,9 +15,10 @@ class Device final
   public:
     /**
      * @brief  Constructor.
-     * @param  debug  If true, enable vulkan debug messages.
+     * @param  debug     If true, enable vulkan debug messages.
+     * @param  headless  If true, enable no surface or swapchain extensions, so no display is needed.
      */
-    Device(const bool debug);
+    Device(const bool debug, const bool headless = false);
 
     /**
      * @brief  Destructor.
@@ -50,6 +52,39 @@ class Device final
         return graphics_family_index_;
     }
 
+    /**
+     * @brief  Get the family uploads are submitted to: a transfer-only family if the device has one, else the
+     *         graphics family.
+     * @return The transfer family index.
+     */
+    [[nodiscard]] uint32_t get_transfer_family_index() const
+    {
+        return transfer_family_index_;
+    }
+
+    /**
+     * @brief  Whether uploads run on a queue family of their own, so buffers they write are shared with it.
+     */
+    [[nodiscard]] bool has_transfer_queue() const
+    {
+        return transfer_family_index_ != graphics_family_index_;
+    }
+
+    /**
+     * @brief  Find a memory type allowed by type_bits that has all of properties.
+     * @return The memory type index, or UINT32_MAX if there is none.
+     */
+    [[nodiscard]] uint32_t find_memory_type(uint32_t type_bits, VkMemoryPropertyFlags properties) const noexcept;
+
+    /**
+     * @brief  Get the allocator that buffers and images take their memory from.
+     * @return The device memory allocator.
+     */
+    [[nodiscard]] GpuAllocator *get_allocator() const
+    {
+        return allocator_;
+    }
+
   private:
     /** The vulkan debug utils messenger. */
     VkDebugUtilsMessengerEXT debug_messenger_ = VK_NULL_HANDLE;
@@ -59,6 +94,18 @@ class Device final
     VkQueue graphics_queue_;
     /** The graphics family index. */
     uint32_t graphics_family_index_ = 0;
+    /** The transfer family index; the graphics family if there is no transfer-only family. */
+    uint32_t transfer_family_index_ = 0;
+    /** Sub-allocates device memory for buffers and images. */
+    GpuAllocator *allocator_ = nullptr;
 };
+
+/**
+ * @brief  The VkDeviceMemory behind an allocation's backend handle.
+ */
+inline VkDeviceMemory to_vk_memory(const GpuAllocation &allocation) noexcept
+{
+    return reinterpret_cast<VkDeviceMemory>(allocation.memory);
+}
 } // namespace LunaVoxelEngine::Renderer
 #endif
\ No newline at end of file
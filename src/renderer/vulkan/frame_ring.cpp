@@ -0,0 +1,87 @@
+#include <platform/log.h>
+#include <platform/profiler.h>
+#include <platform/time.h>
+#include <renderer/vulkan/frame_ring.h>
+extern VkAllocationCallbacks callbacks;
+
+namespace LunaVoxelEngine::Renderer
+{
+FrameRing::FrameRing(const Device *device, Timeline *timeline_in, unsigned int swapchain_images,
+                     unsigned int frames_in_flight)
+    : timeline(timeline_in)
+    , render_finished(swapchain_images, VK_NULL_HANDLE)
+    , frame_count(frames_in_flight < 1                      ? 1
+                  : frames_in_flight > MAX_FRAMES_IN_FLIGHT ? MAX_FRAMES_IN_FLIGHT
+                                                            : frames_in_flight)
+{
+    const VkDevice vk_device = volkGetLoadedDevice();
+
+    VkCommandPoolCreateInfo pool_info{};
+    pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    // Buffers are re-recorded every time the frame comes round, so the pool is reset as a whole.
+    pool_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    pool_info.queueFamilyIndex = device->get_graphics_family_index();
+
+    VkSemaphoreCreateInfo semaphore_info{};
+    semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    for (unsigned int i = 0; i < frame_count; ++i)
+    {
+        FrameContext &frame = frames[i];
+        if (vkCreateCommandPool(vk_device, &pool_info, &callbacks, &frame.command_pool) != VK_SUCCESS)
+        {
+            Log::fatal("Failed to create the command pool for frame %u", i);
+        }
+        frame.command_buffer = new CommandBuffer(frame.command_pool);
+        if (vkCreateSemaphore(vk_device, &semaphore_info, &callbacks, &frame.image_available) != VK_SUCCESS)
+        {
+            Log::fatal("Failed to create the synchronisation objects for frame %u", i);
+        }
+    }
+    for (VkSemaphore &semaphore : render_finished)
+    {
+        if (vkCreateSemaphore(vk_device, &semaphore_info, &callbacks, &semaphore) != VK_SUCCESS)
+        {
+            Log::fatal("Failed to create a render finished semaphore");
+        }
+    }
+}
+
+FrameRing::~FrameRing()
+{
+    const VkDevice vk_device = volkGetLoadedDevice();
+    for (unsigned int i = 0; i < frame_count; ++i)
+    {
+        FrameContext &frame = frames[i];
+        delete frame.command_buffer;
+        vkDestroySemaphore(vk_device, frame.image_available, &callbacks);
+        vkDestroyCommandPool(vk_device, frame.command_pool, &callbacks);
+    }
+    for (VkSemaphore semaphore : render_finished)
+    {
+        vkDestroySemaphore(vk_device, semaphore, &callbacks);
+    }
+}
+
+FrameContext &FrameRing::begin_frame() noexcept
+{
+    FrameContext &frame = frames[current];
+    const VkDevice vk_device = volkGetLoadedDevice();
+    {
+        // A frame not yet submitted waits for point 0, which is already reached.
+        LUNA_PROFILE_SCOPE("wait for frame");
+        const unsigned long long start = Platform::time_now_ns();
+        timeline->wait(frame.submitted);
+        wait_stats.add(Platform::time_now_ns() - start);
+    }
+    vkResetCommandPool(vk_device, frame.command_pool, 0);
+    frame.arena.rewind();
+    return frame;
+}
+
+void FrameRing::end_frame(unsigned long long submitted) noexcept
+{
+    frames[current].submitted = submitted;
+    current = current + 1 == frame_count ? 0 : current + 1;
+}
+} // namespace LunaVoxelEngine::Renderer
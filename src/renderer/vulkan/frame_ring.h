@@ -0,0 +1,100 @@
+#ifndef VK_FRAME_RING_H
+#define VK_FRAME_RING_H
+#include <platform/frame_loop.h>
+#include <renderer/vulkan/cmd_buffer.h>
+#include <renderer/vulkan/device.h>
+#include <renderer/vulkan/ivulkan.h>
+#include <renderer/vulkan/timeline.h>
+#include <utils/arena.h>
+#include <utils/vector.h>
+
+namespace LunaVoxelEngine::Renderer
+{
+constexpr unsigned int DEFAULT_FRAMES_IN_FLIGHT = 2;
+constexpr unsigned int MAX_FRAMES_IN_FLIGHT = 4;
+
+/**
+ * @brief Everything one frame in flight records into. None of it is touched again until submitted is reached.
+ */
+struct FrameContext
+{
+    VkCommandPool command_pool = VK_NULL_HANDLE;
+    CommandBuffer *command_buffer = nullptr;
+    VkSemaphore image_available = VK_NULL_HANDLE; ///< Signalled by acquire, waited on by the frame's submit.
+    unsigned long long submitted = 0;             ///< The graphics timeline point of the frame's last submit.
+    Utils::Arena arena;                           ///< Per-frame scratch memory, rewound when the frame is reused.
+};
+
+/**
+ * @class FrameRing
+ * @brief Lets the CPU record frame N+1 while the GPU is still drawing frame N, up to a fixed number of frames.
+ * @details begin_frame() waits for the oldest frame's point on the graphics timeline, so the CPU never runs more
+ *          than frames_in_flight frames ahead. The time spent in that wait is how long the CPU sat idle waiting on
+ *          the GPU.
+ *
+ * Render-finished semaphores belong to swapchain images rather than to frames: present does not signal anything
+ * the CPU can wait on, so the only proof a present has consumed its semaphore is that the same image has been
+ * acquired again.
+ */
+class [[nodiscard]] FrameRing final
+{
+  public:
+    /**
+     * @param device The device whose graphics queue the frames are submitted to.
+     * @param timeline The graphics queue's timeline, which the frames' submits signal.
+     * @param swapchain_images Number of swapchain images, one render-finished semaphore each; 0 when headless.
+     * @param frames_in_flight Clamped to [1, MAX_FRAMES_IN_FLIGHT].
+     */
+    FrameRing(const Device *device, Timeline *timeline, unsigned int swapchain_images,
+              unsigned int frames_in_flight = DEFAULT_FRAMES_IN_FLIGHT);
+    ~FrameRing();
+    FrameRing(const FrameRing &) = delete;
+    FrameRing &operator=(const FrameRing &) = delete;
+
+    /**
+     * @brief Waits until the next frame's previous submission has finished, then resets its pool and arena.
+     */
+    FrameContext &begin_frame() noexcept;
+
+    /**
+     * @brief Moves to the next frame.
+     * @param submitted The timeline point of the current frame's submit.
+     */
+    void end_frame(unsigned long long submitted) noexcept;
+
+    [[nodiscard]] VkSemaphore get_render_finished(uint32_t image_index) const noexcept
+    {
+        return render_finished[image_index];
+    }
+
+    /**
+     * @brief Which of the frames begin_frame() last returned, in [0, get_frames_in_flight()).
+     */
+    [[nodiscard]] unsigned int get_frame_index() const noexcept
+    {
+        return current;
+    }
+
+    [[nodiscard]] unsigned int get_frames_in_flight() const noexcept
+    {
+        return frame_count;
+    }
+
+    /**
+     * @brief CPU time spent blocked in begin_frame() over the last FrameStats::WINDOW frames.
+     */
+    [[nodiscard]] const Platform::FrameStats &get_wait_stats() const noexcept
+    {
+        return wait_stats;
+    }
+
+  private:
+    FrameContext frames[MAX_FRAMES_IN_FLIGHT];
+    Timeline *timeline;
+    Utils::Vector<VkSemaphore> render_finished;
+    Platform::FrameStats wait_stats;
+    unsigned int frame_count;
+    unsigned int current = 0;
+};
+} // namespace LunaVoxelEngine::Renderer
+#endif
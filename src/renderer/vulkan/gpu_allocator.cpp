@@ -0,0 +1,366 @@
+#include <platform/log.h>
+#include <renderer/vulkan/gpu_allocator.h>
+#include <utils/bits.h>
+
+namespace LunaVoxelEngine::Renderer
+{
+namespace
+{
+constexpr unsigned int NO_BLOCK = GpuAllocation::DEDICATED;
+constexpr unsigned long long MB = 1ULL << 20;
+/// Heaps this small, such as the 256 MB BAR window without resizable BAR, get blocks of an eighth of the heap.
+constexpr unsigned int SMALL_HEAP_BLOCKS = 8;
+} // namespace
+
+GpuAllocator::GpuAllocator(const MemoryProperties &properties_in, const MemoryBackend &backend_in)
+    : properties(properties_in)
+    , backend(backend_in)
+{
+    for (unsigned int heap = 0; heap < properties.heap_count; ++heap)
+    {
+        Log::debug(Log::Module::VULKAN, "GPU heap %u: %llu MB", heap, properties.heap_size[heap] / MB);
+    }
+}
+
+GpuAllocator::~GpuAllocator()
+{
+    for (unsigned int heap = 0; heap < properties.heap_count; ++heap)
+    {
+        if (allocation_bytes[heap] != 0)
+        {
+            Log::warn(Log::Module::VULKAN, "GPU heap %u: %llu bytes still allocated at shutdown", heap,
+                      allocation_bytes[heap]);
+        }
+    }
+    for (Block &block : blocks)
+    {
+        if (block.memory != 0)
+        {
+            backend.free(backend.user, block.memory);
+            delete block.ranges;
+        }
+    }
+}
+
+unsigned int GpuAllocator::find_memory_type(unsigned int type_bits, MemoryUsage usage) const noexcept
+{
+    unsigned int required = 0;
+    unsigned int preferred = 0;
+    unsigned int avoided = 0;
+    switch (usage)
+    {
+    case MemoryUsage::GPU_ONLY:
+        required = MEMORY_DEVICE_LOCAL;
+        avoided = MEMORY_HOST_VISIBLE;
+        break;
+    case MemoryUsage::UPLOAD:
+        // Device-local host-visible memory is the small BAR window on most discrete GPUs; leave it to others.
+        required = MEMORY_HOST_VISIBLE | MEMORY_HOST_COHERENT;
+        avoided = MEMORY_DEVICE_LOCAL | MEMORY_HOST_CACHED;
+        break;
+    case MemoryUsage::READBACK:
+        required = MEMORY_HOST_VISIBLE | MEMORY_HOST_COHERENT;
+        preferred = MEMORY_HOST_CACHED;
+        avoided = MEMORY_DEVICE_LOCAL;
+        break;
+    }
+    unsigned int best = MAX_MEMORY_TYPES;
+    int best_score = 0;
+    for (unsigned int type = 0; type < properties.type_count; ++type)
+    {
+        const unsigned int flags = properties.type_properties[type];
+        if ((type_bits & (1u << type)) == 0 || (flags & required) != required)
+        {
+            continue;
+        }
+        const int score = Utils::popcount32(flags & preferred) - Utils::popcount32(flags & avoided);
+        if (best == MAX_MEMORY_TYPES || score > best_score)
+        {
+            best = type;
+            best_score = score;
+        }
+    }
+    return best;
+}
+
+unsigned long long GpuAllocator::get_block_size(unsigned int type) const noexcept
+{
+    const unsigned long long heap_size = properties.heap_size[properties.type_heap[type]];
+    const unsigned long long small_heap_block = heap_size / SMALL_HEAP_BLOCKS;
+    return small_heap_block < DEFAULT_BLOCK_SIZE ? small_heap_block : DEFAULT_BLOCK_SIZE;
+}
+
+GpuAllocation GpuAllocator::allocate(const AllocationRequest &request) noexcept
+{
+    const unsigned int type = find_memory_type(request.type_bits, request.usage);
+    if (type == MAX_MEMORY_TYPES)
+    {
+        Log::warn(Log::Module::VULKAN, "No memory type suits usage %u in type bits 0x%x",
+                  static_cast<unsigned int>(request.usage), request.type_bits);
+        return GpuAllocation();
+    }
+    if (request.dedicated || request.size >= get_block_size(type) / 2)
+    {
+        return allocate_dedicated(request.size, type);
+    }
+    GpuAllocation allocation = allocate_from_blocks(request, type, NO_BLOCK);
+    if (!allocation.is_valid())
+    {
+        // A whole block did not fit; the request alone may.
+        allocation = allocate_dedicated(request.size, type);
+    }
+    return allocation;
+}
+
+GpuAllocation GpuAllocator::allocate_from_blocks(const AllocationRequest &request, unsigned int type,
+                                                 unsigned int skip_block) noexcept
+{
+    GpuAllocation allocation;
+    allocation.size = request.size;
+    allocation.alignment = request.alignment;
+    allocation.type = type;
+    unsigned int free_slot = NO_BLOCK;
+    for (unsigned int i = 0; i < blocks.size(); ++i)
+    {
+        Block &block = blocks[i];
+        if (block.memory == 0)
+        {
+            free_slot = free_slot == NO_BLOCK ? i : free_slot;
+            continue;
+        }
+        if (i == skip_block || block.type != type || block.optimal_image != request.optimal_image)
+        {
+            continue;
+        }
+        allocation.range = block.ranges->allocate(request.size, request.alignment);
+        if (allocation.range.is_valid())
+        {
+            allocation.block = i;
+            break;
+        }
+    }
+
+    // Defragmentation only fills the blocks that exist.
+    if (!allocation.range.is_valid() && skip_block == NO_BLOCK)
+    {
+        Block block;
+        block.type = type;
+        block.optimal_image = request.optimal_image;
+        block.memory = allocate_memory(type, get_block_size(type), &block.mapped);
+        if (block.memory == 0)
+        {
+            return GpuAllocation();
+        }
+        block.ranges = new Utils::RangeAllocator(get_block_size(type));
+        allocation.range = block.ranges->allocate(request.size, request.alignment);
+        if (free_slot == NO_BLOCK)
+        {
+            free_slot = static_cast<unsigned int>(blocks.size());
+            blocks.push_back(block);
+        }
+        else
+        {
+            blocks[free_slot] = block;
+        }
+        allocation.block = free_slot;
+    }
+    if (!allocation.range.is_valid())
+    {
+        return GpuAllocation();
+    }
+
+    const Block &block = blocks[allocation.block];
+    allocation.memory = block.memory;
+    allocation.offset = allocation.range.offset;
+    allocation.mapped = block.mapped != nullptr ? static_cast<unsigned char *>(block.mapped) + allocation.offset
+                                                : nullptr;
+    allocation_bytes[properties.type_heap[type]] += request.size;
+    return allocation;
+}
+
+GpuAllocation GpuAllocator::allocate_dedicated(unsigned long long size, unsigned int type) noexcept
+{
+    GpuAllocation allocation;
+    allocation.memory = allocate_memory(type, size, &allocation.mapped);
+    if (allocation.memory == 0)
+    {
+        return GpuAllocation();
+    }
+    allocation.size = size;
+    allocation.type = type;
+    allocation_bytes[properties.type_heap[type]] += size;
+    return allocation;
+}
+
+unsigned long long GpuAllocator::allocate_memory(unsigned int type, unsigned long long size, void **mapped) noexcept
+{
+    const unsigned long long memory = backend.allocate(backend.user, type, size);
+    if (memory == 0)
+    {
+        Log::warn(Log::Module::VULKAN, "Out of device memory allocating %llu KB of type %u", size / 1024, type);
+        return 0;
+    }
+    *mapped = nullptr;
+    if ((properties.type_properties[type] & MEMORY_HOST_VISIBLE) != 0)
+    {
+        *mapped = backend.map(backend.user, memory);
+        if (*mapped == nullptr)
+        {
+            backend.free(backend.user, memory);
+            Log::warn(Log::Module::VULKAN, "Failed to map %llu KB of type %u", size / 1024, type);
+            return 0;
+        }
+    }
+    ++memory_objects;
+    const unsigned int heap = properties.type_heap[type];
+    block_bytes[heap] += size;
+
+    const HeapBudget budget = get_heap_budget(heap);
+    if (budget.usage > budget.budget && (over_budget & (1u << heap)) == 0)
+    {
+        Log::warn(Log::Module::VULKAN, "GPU heap %u is over budget: %llu of %llu MB used", heap, budget.usage / MB,
+                  budget.budget / MB);
+    }
+    over_budget = budget.usage > budget.budget ? over_budget | (1u << heap) : over_budget & ~(1u << heap);
+    return memory;
+}
+
+void GpuAllocator::free_memory(unsigned int type, unsigned long long memory, unsigned long long size) noexcept
+{
+    // Freeing memory unmaps it as well.
+    backend.free(backend.user, memory);
+    --memory_objects;
+    block_bytes[properties.type_heap[type]] -= size;
+}
+
+void GpuAllocator::free(GpuAllocation &allocation) noexcept
+{
+    if (!allocation.is_valid())
+    {
+        return;
+    }
+    allocation_bytes[properties.type_heap[allocation.type]] -= allocation.size;
+    if (allocation.block == GpuAllocation::DEDICATED)
+    {
+        free_memory(allocation.type, allocation.memory, allocation.size);
+    }
+    else
+    {
+        blocks[allocation.block].ranges->free(allocation.range);
+        release_if_unused(allocation.block);
+    }
+    allocation = GpuAllocation();
+}
+
+void GpuAllocator::release_if_unused(unsigned int index) noexcept
+{
+    Block &block = blocks[index];
+    if (!block.ranges->is_empty())
+    {
+        return;
+    }
+    for (unsigned int i = 0; i < blocks.size(); ++i)
+    {
+        const Block &other = blocks[i];
+        if (i != index && other.memory != 0 && other.type == block.type &&
+            other.optimal_image == block.optimal_image && other.ranges->is_empty())
+        {
+            free_memory(block.type, block.memory, block.ranges->get_capacity());
+            delete block.ranges;
+            block = Block();
+            return;
+        }
+    }
+}
+
+unsigned int GpuAllocator::begin_defragment(GpuAllocation *const *allocations, unsigned int count,
+                                            DefragmentMove *moves, unsigned int max_moves) noexcept
+{
+    unsigned int move_count = 0;
+    for (unsigned int source = 0; source < blocks.size() && move_count < max_moves; ++source)
+    {
+        const Block &block = blocks[source];
+        if (block.memory == 0 || block.ranges->is_empty())
+        {
+            continue;
+        }
+        // Only the least used block of its kind is emptied, and only into others of the same kind.
+        const unsigned long long used = block.ranges->get_capacity() - block.ranges->get_free_bytes();
+        bool is_least_used = true;
+        bool has_other = false;
+        for (unsigned int i = 0; i < blocks.size(); ++i)
+        {
+            const Block &other = blocks[i];
+            if (i == source || other.memory == 0 || other.type != block.type ||
+                other.optimal_image != block.optimal_image || other.ranges->is_empty())
+            {
+                continue;
+            }
+            has_other = true;
+            const unsigned long long other_used = other.ranges->get_capacity() - other.ranges->get_free_bytes();
+            if (other_used < used || (other_used == used && i < source))
+            {
+                is_least_used = false;
+                break;
+            }
+        }
+        if (!has_other || !is_least_used)
+        {
+            continue;
+        }
+
+        AllocationRequest request;
+        request.optimal_image = block.optimal_image;
+        for (unsigned int i = 0; i < count && move_count < max_moves; ++i)
+        {
+            GpuAllocation *allocation = allocations[i];
+            if (!allocation->is_valid() || allocation->block != source)
+            {
+                continue;
+            }
+            request.size = allocation->size;
+            request.alignment = allocation->alignment;
+            const GpuAllocation destination = allocate_from_blocks(request, block.type, source);
+            if (destination.is_valid())
+            {
+                moves[move_count++] = {allocation, destination};
+            }
+        }
+    }
+    return move_count;
+}
+
+void GpuAllocator::end_defragment(DefragmentMove *moves, unsigned int count) noexcept
+{
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        free(*moves[i].allocation);
+        *moves[i].allocation = moves[i].destination;
+    }
+}
+
+HeapBudget GpuAllocator::get_heap_budget(unsigned int heap) const noexcept
+{
+    HeapBudget result;
+    result.block_bytes = block_bytes[heap];
+    result.allocation_bytes = allocation_bytes[heap];
+    unsigned long long usage[MAX_MEMORY_HEAPS] = {};
+    unsigned long long budget[MAX_MEMORY_HEAPS] = {};
+    if (backend.query_budget != nullptr && backend.query_budget(backend.user, usage, budget))
+    {
+        result.usage = usage[heap];
+        result.budget = budget[heap];
+    }
+    else
+    {
+        // Without the driver's numbers, leave room for other processes and the driver's own allocations.
+        result.usage = block_bytes[heap];
+        result.budget = properties.heap_size[heap] / 10 * 8;
+    }
+    if (budget_limit != 0 && budget_limit < result.budget)
+    {
+        result.budget = budget_limit;
+    }
+    return result;
+}
+} // namespace LunaVoxelEngine::Renderer
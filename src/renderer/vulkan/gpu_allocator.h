@@ -0,0 +1,195 @@
+#ifndef VK_GPU_ALLOCATOR_H
+#define VK_GPU_ALLOCATOR_H
+#include <utils/range_allocator.h>
+#include <utils/vector.h>
+
+// Deliberately free of Vulkan types: the device hands the allocator a memory table and a backend, so the
+// allocation policy can be exercised against a fake table on a machine without a GPU.
+namespace LunaVoxelEngine::Renderer
+{
+/// Same values as VkMemoryPropertyFlagBits.
+enum MemoryPropertyBits : unsigned int
+{
+    MEMORY_DEVICE_LOCAL = 0x1,
+    MEMORY_HOST_VISIBLE = 0x2,
+    MEMORY_HOST_COHERENT = 0x4,
+    MEMORY_HOST_CACHED = 0x8
+};
+
+constexpr unsigned int MAX_MEMORY_TYPES = 32;
+constexpr unsigned int MAX_MEMORY_HEAPS = 16;
+
+/**
+ * @brief The device's memory types and heaps, as in VkPhysicalDeviceMemoryProperties.
+ */
+struct MemoryProperties
+{
+    unsigned int type_count = 0;
+    unsigned int type_properties[MAX_MEMORY_TYPES] = {}; ///< MemoryPropertyBits of each type.
+    unsigned int type_heap[MAX_MEMORY_TYPES] = {};       ///< The heap each type allocates from.
+    unsigned int heap_count = 0;
+    unsigned long long heap_size[MAX_MEMORY_HEAPS] = {};
+};
+
+/**
+ * @brief How the allocator gets memory from the device. On Vulkan a handle is a VkDeviceMemory; 0 means none.
+ */
+struct MemoryBackend
+{
+    void *user = nullptr;
+    /// @return A handle, or 0 if the device is out of memory.
+    unsigned long long (*allocate)(void *user, unsigned int type, unsigned long long size) = nullptr;
+    void (*free)(void *user, unsigned long long memory) = nullptr;
+    /// Maps the whole of memory for as long as it lives. @return null on failure.
+    void *(*map)(void *user, unsigned long long memory) = nullptr;
+    /// Optional. Fills the driver's usage and budget for each heap, both counting other processes' use too.
+    bool (*query_budget)(void *user, unsigned long long *usage, unsigned long long *budget) = nullptr;
+};
+
+enum class MemoryUsage : unsigned char
+{
+    GPU_ONLY, ///< Device local; filled by transfers or rendering.
+    UPLOAD,   ///< Host visible and coherent, written by the CPU and read by the GPU, such as staging buffers.
+    READBACK  ///< Host visible and coherent, preferably cached, written by the GPU and read by the CPU.
+};
+
+struct AllocationRequest
+{
+    unsigned long long size = 0;
+    unsigned long long alignment = 1;
+    unsigned int type_bits = ~0u; ///< memoryTypeBits from the resource's memory requirements.
+    MemoryUsage usage = MemoryUsage::GPU_ONLY;
+    /// Optimal-tiling images get blocks of their own, so bufferImageGranularity never applies within a block.
+    bool optimal_image = false;
+    /// Gives the resource its own memory, as drivers prefer for render targets.
+    bool dedicated = false;
+};
+
+struct GpuAllocation
+{
+    static constexpr unsigned int DEDICATED = ~0u;
+
+    unsigned long long memory = 0; ///< The backend handle to bind; 0 if the allocation failed.
+    unsigned long long offset = 0;
+    unsigned long long size = 0;
+    unsigned long long alignment = 1; ///< Kept so defragmentation can honour it at the new offset.
+    void *mapped = nullptr; ///< Where offset is mapped, for host-visible memory; stays valid until freed.
+    unsigned int block = DEDICATED;
+    unsigned int type = 0;
+    Utils::RangeAllocation range;
+
+    [[nodiscard]] bool is_valid() const noexcept
+    {
+        return memory != 0;
+    }
+};
+
+/**
+ * @brief One allocation to move during defragmentation. The caller copies size bytes from *allocation to
+ *        destination, recreates or rebinds the resource, and once the GPU is done passes the move back.
+ */
+struct DefragmentMove
+{
+    GpuAllocation *allocation;
+    GpuAllocation destination;
+};
+
+struct HeapBudget
+{
+    unsigned long long block_bytes = 0;      ///< Device memory held by this allocator.
+    unsigned long long allocation_bytes = 0; ///< The part of block_bytes handed out.
+    unsigned long long usage = 0;            ///< The driver's figure if known, else block_bytes.
+    unsigned long long budget = 0;           ///< How much the process should use; see set_budget_limit().
+};
+
+/**
+ * @class GpuAllocator
+ * @brief Sub-allocates device memory from large blocks, one set of blocks per memory type.
+ * @details Drivers cap the number of live VkDeviceMemory objects (often at 4096) and allocating one is slow,
+ *          so resources share blocks, carved up by a RangeAllocator. Resources of half a block or more, and
+ *          those that ask, get dedicated memory. Host-visible memory is mapped once when allocated and stays
+ *          mapped. Emptied blocks are returned to the device, except one spare per type against churn.
+ * @warning Not thread-safe.
+ */
+class GpuAllocator final
+{
+  public:
+    static constexpr unsigned long long DEFAULT_BLOCK_SIZE = 64ULL << 20;
+
+    GpuAllocator(const MemoryProperties &properties, const MemoryBackend &backend);
+    ~GpuAllocator();
+    GpuAllocator(const GpuAllocator &) = delete;
+    GpuAllocator &operator=(const GpuAllocator &) = delete;
+
+    /**
+     * @return The memory type in type_bits that suits usage best, or MAX_MEMORY_TYPES if none is allowed.
+     */
+    [[nodiscard]] unsigned int find_memory_type(unsigned int type_bits, MemoryUsage usage) const noexcept;
+
+    /**
+     * @return An invalid allocation if no suitable memory type exists or the device is out of memory.
+     */
+    [[nodiscard]] GpuAllocation allocate(const AllocationRequest &request) noexcept;
+    void free(GpuAllocation &allocation) noexcept;
+
+    /**
+     * @brief Plans moves that empty the least used block of each memory type into the others.
+     * @param allocations The allocations that may move; others are left where they are.
+     * @return The number of moves written to moves, at most max_moves. Their destinations are already reserved.
+     */
+    unsigned int begin_defragment(GpuAllocation *const *allocations, unsigned int count, DefragmentMove *moves,
+                                  unsigned int max_moves) noexcept;
+    /**
+     * @brief Frees the sources of moves whose data has been copied and points each allocation at its destination.
+     */
+    void end_defragment(DefragmentMove *moves, unsigned int count) noexcept;
+
+    /**
+     * @brief Caps the budget of every heap at bytes; 0 leaves it to the driver or 80% of the heap.
+     */
+    void set_budget_limit(unsigned long long bytes) noexcept
+    {
+        budget_limit = bytes;
+    }
+    [[nodiscard]] HeapBudget get_heap_budget(unsigned int heap) const noexcept;
+    [[nodiscard]] unsigned int get_heap_count() const noexcept
+    {
+        return properties.heap_count;
+    }
+    [[nodiscard]] unsigned long long get_block_size(unsigned int type) const noexcept;
+    /// Live VkDeviceMemory objects, blocks and dedicated allocations together.
+    [[nodiscard]] unsigned int get_memory_object_count() const noexcept
+    {
+        return memory_objects;
+    }
+
+  private:
+    struct Block
+    {
+        unsigned long long memory = 0; ///< 0 for a free slot.
+        void *mapped = nullptr;
+        Utils::RangeAllocator *ranges = nullptr;
+        unsigned int type = 0;
+        bool optimal_image = false;
+    };
+
+    MemoryProperties properties;
+    MemoryBackend backend;
+    Utils::Vector<Block> blocks;
+    unsigned long long block_bytes[MAX_MEMORY_HEAPS] = {};
+    unsigned long long allocation_bytes[MAX_MEMORY_HEAPS] = {};
+    unsigned long long budget_limit = 0;
+    unsigned int memory_objects = 0;
+    unsigned int over_budget = 0; ///< Bit per heap, so crossing the budget is reported once.
+
+    [[nodiscard]] GpuAllocation allocate_from_blocks(const AllocationRequest &request, unsigned int type,
+                                                     unsigned int skip_block) noexcept;
+    [[nodiscard]] GpuAllocation allocate_dedicated(unsigned long long size, unsigned int type) noexcept;
+    [[nodiscard]] unsigned long long allocate_memory(unsigned int type, unsigned long long size,
+                                                     void **mapped) noexcept;
+    void free_memory(unsigned int type, unsigned long long memory, unsigned long long size) noexcept;
+    /// Returns block to the device if it is empty and another empty block of its kind exists.
+    void release_if_unused(unsigned int block) noexcept;
+};
+} // namespace LunaVoxelEngine::Renderer
+#endif
@@ -1,7 +1,8 @@
 #include "image.h"
 #include <platform/log.h>
 #include <renderer/vulkan/image.h>
-
+#include <utils/algorithm.h>
+extern VkAllocationCallbacks callbacks;
 
 namespace LunaVoxelEngine::Renderer
 {
@@ -9,6 +10,66 @@ Image::Image()
 {
 }
 
+Image::Image(const Device *device, uint32_t width, uint32_t height, VkFormat format, VkImageUsageFlags usage,
+             VkImageAspectFlags aspectMask, uint32_t mipLevels)
+    : format_(format)
+    , width_(width)
+    , height_(height)
+    , mip_levels_(mipLevels)
+{
+    const VkDevice vk_device = volkGetLoadedDevice();
+
+    VkImageCreateInfo image_info{};
+    image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    image_info.imageType = VK_IMAGE_TYPE_2D;
+    image_info.format = format;
+    image_info.extent = {width, height, 1};
+    image_info.mipLevels = mipLevels;
+    image_info.arrayLayers = 1;
+    image_info.samples = VK_SAMPLE_COUNT_1_BIT;
+    image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+    image_info.usage = usage;
+    image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    if (vkCreateImage(vk_device, &image_info, &callbacks, &image_) != VK_SUCCESS)
+    {
+        Log::fatal("Failed to create %ux%u image", width, height);
+    }
+
+    VkMemoryRequirements requirements;
+    vkGetImageMemoryRequirements(vk_device, image_, &requirements);
+    AllocationRequest request;
+    request.size = requirements.size;
+    request.alignment = requirements.alignment;
+    request.type_bits = requirements.memoryTypeBits;
+    request.usage = MemoryUsage::GPU_ONLY;
+    request.optimal_image = true;
+    request.dedicated =
+        (usage & (VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT)) != 0;
+    allocator_ = device->get_allocator();
+    memory_ = allocator_->allocate(request);
+    if (!memory_.is_valid())
+    {
+        Log::fatal("Failed to allocate memory for %ux%u image", width, height);
+    }
+    vkBindImageMemory(vk_device, image_, to_vk_memory(memory_), memory_.offset);
+
+    VkImageViewCreateInfo view_info{};
+    view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    view_info.image = image_;
+    view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    view_info.format = format;
+    view_info.subresourceRange.aspectMask = aspectMask;
+    view_info.subresourceRange.baseMipLevel = 0;
+    view_info.subresourceRange.levelCount = mipLevels;
+    view_info.subresourceRange.baseArrayLayer = 0;
+    view_info.subresourceRange.layerCount = 1;
+    if (vkCreateImageView(vk_device, &view_info, &callbacks, &imageView_) != VK_SUCCESS)
+    {
+        Log::fatal("Failed to create image view");
+    }
+}
+
 void *Image::map()
 {
     return nullptr;
@@ -62,7 +123,31 @@ Image::~Image()
 {
     if (imageView_ != VK_NULL_HANDLE)
     {
-        vkDestroyImageView(volkGetLoadedDevice(), imageView_, nullptr);
+        vkDestroyImageView(volkGetLoadedDevice(), imageView_, &callbacks);
     }
+    // Images without memory of their own, such as swapchain images, are not ours to destroy.
+    if (memory_.is_valid())
+    {
+        vkDestroyImage(volkGetLoadedDevice(), image_, &callbacks);
+        allocator_->free(memory_);
+    }
+}
+
+Image::Image(Image &&other) noexcept
+{
+    *this = static_cast<Image &&>(other);
+}
+
+Image &Image::operator=(Image &&other) noexcept
+{
+    Utils::swap(image_, other.image_);
+    Utils::swap(imageView_, other.imageView_);
+    Utils::swap(allocator_, other.allocator_);
+    Utils::swap(memory_, other.memory_);
+    Utils::swap(format_, other.format_);
+    Utils::swap(width_, other.width_);
+    Utils::swap(height_, other.height_);
+    Utils::swap(mip_levels_, other.mip_levels_);
+    return *this;
 }
 } // namespace LunaVoxelEngine::Renderer
\ No newline at end of file
@@ -2,6 +2,7 @@
 #define VK_IMAGE_H
 
 #include <renderer/vulkan/cmd_buffer.h>
+#include <renderer/vulkan/device.h>
 #include <renderer/vulkan/ivulkan.h>
 
 
@@ -11,6 +12,20 @@ class Image final
 {
   public:
     Image();
+    /**
+     * @brief Creates a device-local 2D image and a view of all its mip levels, such as an offscreen render target.
+     *
+     * @param device The device whose allocator the image's memory comes from. Attachments get memory of
+     *               their own; other images share blocks.
+     * @param width The width in pixels.
+     * @param height The height in pixels.
+     * @param format The image format.
+     * @param usage How the image will be used (e.g., color attachment, transfer source).
+     * @param aspectMask The aspect of the image the view covers.
+     * @param mipLevels The number of mip levels, each half the size of the one before.
+     */
+    Image(const Device *device, uint32_t width, uint32_t height, VkFormat format, VkImageUsageFlags usage,
+          VkImageAspectFlags aspectMask = VK_IMAGE_ASPECT_COLOR_BIT, uint32_t mipLevels = 1);
     void *map();
     void unmap();
     /**
@@ -39,6 +54,21 @@ class Image final
     {
         return imageView_;
     }
+    /**
+     * @brief Gets the size of the image.
+     * @return The width and height of the image.
+     */
+    VkExtent2D getExtent() const
+    {
+        return {width_, height_};
+    }
+    /**
+     * @brief Gets the number of mip levels.
+     */
+    uint32_t getMipLevels() const
+    {
+        return mip_levels_;
+    }
     /**
      * @brief Destructor for Image.
      *
@@ -55,9 +85,12 @@ class Image final
   private:
     VkImage image_ = VK_NULL_HANDLE;         ///< The Vulkan image handle
     VkImageView imageView_ = VK_NULL_HANDLE; ///< The Vulkan image view handle
+    GpuAllocator *allocator_ = nullptr;      ///< Where memory_ came from; null if the image owns no memory
+    GpuAllocation memory_;                   ///< Memory backing the image, if the image owns it
     VkFormat format_ = VK_FORMAT_UNDEFINED;  ///< Format of the image
     uint32_t width_ = 0;                     ///< Width of the image
     uint32_t height_ = 0;                    ///< Height of the image
+    uint32_t mip_levels_ = 1;                ///< Mip levels of the image, all covered by the view
 };
 } // namespace LunaVoxelEngine::Renderer
 #endif
@@ -0,0 +1,195 @@
+#include <platform/log.h>
+#include <platform/profiler.h>
+#include <platform/time.h>
+#include <renderer/vulkan/parallel_recorder.h>
+extern VkAllocationCallbacks callbacks;
+
+namespace LunaVoxelEngine::Renderer
+{
+ParallelRecorder::ParallelRecorder(uint32_t queue_family_index, unsigned int worker_count_in,
+                                   unsigned int frames_in_flight_in)
+    : worker_count(worker_count_in < MAX_WORKERS ? worker_count_in : MAX_WORKERS)
+    , frames_in_flight(frames_in_flight_in)
+{
+    VkCommandPoolCreateInfo pool_info{};
+    pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    // Buffers are re-recorded every time the frame comes round, so the pool is reset as a whole.
+    pool_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    pool_info.queueFamilyIndex = queue_family_index;
+    const VkDevice vk_device = volkGetLoadedDevice();
+    for (unsigned int frame = 0; frame < frames_in_flight; ++frame)
+    {
+        for (unsigned int thread = 0; thread <= worker_count; ++thread)
+        {
+            if (vkCreateCommandPool(vk_device, &pool_info, &callbacks, &pools[frame][thread].pool) != VK_SUCCESS)
+            {
+                Log::fatal("Failed to create the command pool for recording thread %u", thread);
+            }
+        }
+    }
+    for (unsigned int i = 0; i < worker_count; ++i)
+    {
+        workers[i] = {this, i + 1};
+        threads[i] = new Platform::Thread(worker_main, &workers[i]);
+    }
+}
+
+ParallelRecorder::~ParallelRecorder()
+{
+    {
+        Platform::GuardLock guard(mutex);
+        stopping = true;
+    }
+    started.broadcast();
+    for (unsigned int i = 0; i < worker_count; ++i)
+    {
+        threads[i]->wait();
+        delete threads[i];
+    }
+    const VkDevice vk_device = volkGetLoadedDevice();
+    for (unsigned int frame = 0; frame < frames_in_flight; ++frame)
+    {
+        for (unsigned int thread = 0; thread <= worker_count; ++thread)
+        {
+            ThreadPool &pool = pools[frame][thread];
+            for (CommandBuffer *buffer : pool.buffers)
+            {
+                delete buffer;
+            }
+            vkDestroyCommandPool(vk_device, pool.pool, &callbacks);
+        }
+    }
+}
+
+size_t ParallelRecorder::worker_main(void *param)
+{
+    Platform::profiler_set_thread_name("command recorder");
+    const Worker *worker = static_cast<Worker *>(param);
+    worker->recorder->run(worker->thread);
+    return 0;
+}
+
+void ParallelRecorder::run(unsigned int thread) noexcept
+{
+    unsigned long long seen = 0;
+    while (true)
+    {
+        {
+            Platform::GuardLock guard(mutex);
+            while (generation == seen && !stopping)
+            {
+                started.wait(&mutex);
+            }
+            if (stopping)
+            {
+                return;
+            }
+            seen = generation;
+        }
+        // Runs short of MIN_BATCH leave the last workers without a batch.
+        if (thread < batch_count)
+        {
+            record_batch(thread);
+        }
+        bool last;
+        {
+            Platform::GuardLock guard(mutex);
+            last = --pending == 0;
+        }
+        if (last)
+        {
+            finished.signal();
+        }
+    }
+}
+
+void ParallelRecorder::begin_frame(unsigned int frame_index_in) noexcept
+{
+    frame_index = frame_index_in;
+    const VkDevice vk_device = volkGetLoadedDevice();
+    for (unsigned int thread = 0; thread <= worker_count; ++thread)
+    {
+        ThreadPool &pool = pools[frame_index][thread];
+        if (pool.used > 0)
+        {
+            vkResetCommandPool(vk_device, pool.pool, 0);
+            pool.used = 0;
+        }
+    }
+}
+
+void ParallelRecorder::record(CommandBuffer &primary, const SecondaryTarget &target_in, unsigned int count_in,
+                              RecordFunction function_in, void *user_in) noexcept
+{
+    if (count_in == 0)
+    {
+        return;
+    }
+    LUNA_PROFILE_SCOPE("record in parallel");
+    const unsigned long long start = Platform::time_now_ns();
+    target = &target_in;
+    function = function_in;
+    user = user_in;
+    count = count_in;
+    batch_count = get_batch_count(count, worker_count + 1);
+    if (batch_count > 1)
+    {
+        {
+            Platform::GuardLock guard(mutex);
+            pending = worker_count;
+            ++generation;
+        }
+        started.broadcast();
+    }
+    record_batch(0);
+    if (batch_count > 1)
+    {
+        Platform::GuardLock guard(mutex);
+        while (pending > 0)
+        {
+            finished.wait(&mutex);
+        }
+    }
+    primary.executeCommands(batch_count, batches);
+    record_stats.add(Platform::time_now_ns() - start);
+}
+
+void ParallelRecorder::record_batch(unsigned int thread) noexcept
+{
+    LUNA_PROFILE_SCOPE("record batch");
+    ThreadPool &pool = pools[frame_index][thread];
+    if (pool.used == pool.buffers.size())
+    {
+        pool.buffers.push_back(new CommandBuffer(pool.pool, VK_COMMAND_BUFFER_LEVEL_SECONDARY));
+    }
+    CommandBuffer &command_buffer = *pool.buffers[pool.used++];
+
+    VkCommandBufferInheritanceRenderingInfo rendering_info{};
+    rendering_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO;
+    rendering_info.colorAttachmentCount = target->color_count;
+    rendering_info.pColorAttachmentFormats = target->color_formats;
+    rendering_info.depthAttachmentFormat = target->depth_format;
+    rendering_info.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+    VkCommandBufferInheritanceInfo inheritance_info{};
+    inheritance_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritance_info.pNext = &rendering_info;
+    command_buffer.begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT,
+                         &inheritance_info);
+
+    // Dynamic state is not inherited, so every batch sets its own.
+    VkViewport viewport{};
+    viewport.width = static_cast<float>(target->extent.width);
+    viewport.height = static_cast<float>(target->extent.height);
+    viewport.maxDepth = 1.0f;
+    command_buffer.setViewport(0, 1, &viewport);
+    VkRect2D scissor{};
+    scissor.extent = target->extent;
+    command_buffer.setScissor(0, 1, &scissor);
+
+    const unsigned int first = get_batch_start(count, batch_count, thread);
+    const unsigned int last = get_batch_start(count, batch_count, thread + 1);
+    function(command_buffer, first, last - first, user);
+    command_buffer.end();
+    batches[thread] = command_buffer.handle();
+}
+} // namespace LunaVoxelEngine::Renderer
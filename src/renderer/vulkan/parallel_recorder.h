@@ -0,0 +1,141 @@
+#ifndef VK_PARALLEL_RECORDER_H
+#define VK_PARALLEL_RECORDER_H
+#include <platform/frame_loop.h>
+#include <platform/thread.h>
+#include <renderer/vulkan/cmd_buffer.h>
+#include <renderer/vulkan/frame_ring.h>
+#include <renderer/vulkan/ivulkan.h>
+#include <utils/vector.h>
+
+namespace LunaVoxelEngine::Renderer
+{
+/**
+ * @brief The attachments of the rendering that secondary buffers are executed in, which they must declare.
+ */
+struct SecondaryTarget
+{
+    const VkFormat *color_formats = nullptr;
+    uint32_t color_count = 0;
+    VkFormat depth_format = VK_FORMAT_UNDEFINED;
+    VkExtent2D extent = {}; ///< Each secondary buffer sets its viewport and scissor to cover it.
+};
+
+/**
+ * @class ParallelRecorder
+ * @brief Records a run of draws into secondary command buffers on several threads at once.
+ * @details record() splits [0, count) into one contiguous batch per thread, at least MIN_BATCH items each, so
+ *          small runs do not wake threads for nothing. The calling thread records the first batch and worker
+ *          threads the rest, each into a secondary buffer from a command pool of its own; the primary buffer then
+ *          executes the batches in order, so the draws land as if recorded by one thread.
+ *
+ * Every thread has a pool per frame in flight, reset by begin_frame() once FrameRing has seen the frame complete,
+ * and the secondary buffers allocated from it are kept for reuse. With no workers, record() still records into a
+ * secondary buffer, on the calling thread, so callers begin rendering the same way either way.
+ * @warning record() and begin_frame() must be called from one thread.
+ */
+class [[nodiscard]] ParallelRecorder final
+{
+  public:
+    static constexpr unsigned int MAX_WORKERS = 15;
+    /// Fewest items worth handing a thread of its own.
+    static constexpr unsigned int MIN_BATCH = 512;
+
+    /// Records items [first, first + count) into command_buffer, which is inside rendering and has its viewport
+    /// and scissor set but nothing bound. Runs on several threads at once, so must only read shared state.
+    using RecordFunction = void (*)(CommandBuffer &command_buffer, unsigned int first, unsigned int count,
+                                    void *user);
+
+    /**
+     * @param queue_family_index Family of the queue the primary buffers are submitted to.
+     * @param worker_count Threads besides the caller, at most MAX_WORKERS.
+     */
+    ParallelRecorder(uint32_t queue_family_index, unsigned int worker_count, unsigned int frames_in_flight);
+    ~ParallelRecorder();
+    ParallelRecorder(const ParallelRecorder &) = delete;
+    ParallelRecorder &operator=(const ParallelRecorder &) = delete;
+
+    /**
+     * @brief Resets the frame's pools; call after FrameRing::begin_frame(), with its frame index.
+     */
+    void begin_frame(unsigned int frame_index) noexcept;
+    /**
+     * @brief Records count items across the threads and executes them into primary. Call inside rendering begun
+     *        with VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT; returns once every batch is recorded.
+     */
+    void record(CommandBuffer &primary, const SecondaryTarget &target, unsigned int count, RecordFunction function,
+                void *user) noexcept;
+
+    /**
+     * @brief How many batches record() splits count items into on thread_count threads: as many as hold MIN_BATCH
+     *        items each, at least one, but no more than there are threads.
+     */
+    [[nodiscard]] static constexpr unsigned int get_batch_count(unsigned int count, unsigned int thread_count) noexcept
+    {
+        const unsigned int wanted = count / MIN_BATCH > 1 ? count / MIN_BATCH : 1;
+        return wanted < thread_count ? wanted : thread_count;
+    }
+    /**
+     * @brief The first item of a batch. Batch b covers [get_batch_start(b), get_batch_start(b + 1)), so the batches
+     *        are contiguous and in item order, and their sizes differ by at most one.
+     */
+    [[nodiscard]] static constexpr unsigned int get_batch_start(unsigned int count, unsigned int batch_count,
+                                                                unsigned int batch) noexcept
+    {
+        return static_cast<unsigned int>(static_cast<unsigned long long>(count) * batch / batch_count);
+    }
+
+    /// Threads record() can use, counting the caller.
+    [[nodiscard]] unsigned int get_thread_count() const noexcept
+    {
+        return worker_count + 1;
+    }
+    /// CPU time of each record() call that recorded anything, from the first batch starting to the last ending.
+    [[nodiscard]] const Platform::FrameStats &get_record_stats() const noexcept
+    {
+        return record_stats;
+    }
+
+  private:
+    struct ThreadPool
+    {
+        VkCommandPool pool = VK_NULL_HANDLE;
+        Utils::Vector<CommandBuffer *> buffers; ///< Allocated from pool; [0, used) are recorded this frame.
+        unsigned int used = 0;
+    };
+
+    struct Worker
+    {
+        ParallelRecorder *recorder;
+        unsigned int thread; ///< Index into pools and batches; the caller is 0.
+    };
+
+    static size_t worker_main(void *param);
+    void run(unsigned int thread) noexcept;
+    void record_batch(unsigned int thread) noexcept;
+
+    ThreadPool pools[MAX_FRAMES_IN_FLIGHT][MAX_WORKERS + 1];
+    Platform::Thread *threads[MAX_WORKERS] = {};
+    Worker workers[MAX_WORKERS];
+    unsigned int worker_count;
+    unsigned int frames_in_flight;
+    unsigned int frame_index = 0;
+
+    Platform::Mutex mutex;               ///< Guards generation, pending and stopping.
+    Platform::ConditionVariable started; ///< Broadcast when a record() has batches for the workers, or on stopping.
+    Platform::ConditionVariable finished; ///< Signalled when the last worker is done with its batch.
+    unsigned long long generation = 0; ///< Counts record() calls that used the workers.
+    unsigned int pending = 0;          ///< Workers yet to finish this generation.
+    bool stopping = false;
+
+    // What the current record() call records; written before the workers are started.
+    const SecondaryTarget *target = nullptr;
+    RecordFunction function = nullptr;
+    void *user = nullptr;
+    unsigned int count = 0;
+    unsigned int batch_count = 0;
+    VkCommandBuffer batches[MAX_WORKERS + 1] = {};
+
+    Platform::FrameStats record_stats;
+};
+} // namespace LunaVoxelEngine::Renderer
+#endif
@@ -1,29 +1,259 @@
+#include <platform/log.h>
 #include <renderer/vulkan/pipeline.h>
+#include <utils/algorithm.h>
+#include <utils/hash.h>
+#include <utils/string_view.h>
 extern VkAllocationCallbacks callbacks;
 namespace LunaVoxelEngine::Renderer
 {
-Pipeline::Pipeline(const GraphicsPipelineBuilder* builder)
+namespace
+{
+unsigned long long handle_bits(const void *handle) noexcept
+{
+    return reinterpret_cast<unsigned long long>(handle);
+}
+
+bool has_dynamic_state(const VkPipelineDynamicStateCreateInfo &dynamic_state, VkDynamicState state) noexcept
+{
+    for (uint32_t i = 0; i < dynamic_state.dynamicStateCount; ++i)
+    {
+        if (dynamic_state.pDynamicStates[i] == state)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void add_stencil(PipelineKey &key, const VkStencilOpState &op) noexcept
+{
+    key.add(op.failOp);
+    key.add(op.passOp);
+    key.add(op.depthFailOp);
+    key.add(op.compareOp);
+    key.add(op.compareMask);
+    key.add(op.writeMask);
+    key.add(op.reference);
+}
+} // namespace
+
+void PipelineKey::add_bytes(const void *data, unsigned long size) noexcept
+{
+    add64(size);
+    const unsigned long first = words.size();
+    words.resize(first + (size + sizeof(unsigned int) - 1) / sizeof(unsigned int), 0);
+    Utils::memcpy(words.data() + first, data, size);
+}
+
+void PipelineKey::sort_from(unsigned long first) noexcept
+{
+    Utils::quicksort(words.begin() + first, words.end(), [](unsigned int a, unsigned int b) { return a < b; });
+}
+
+void PipelineKey::finish() noexcept
+{
+    hash = Utils::xxhash64(reinterpret_cast<const char *>(words.data()), words.size() * sizeof(unsigned int));
+}
+
+PipelineKey GraphicsPipelineBuilder::key() const noexcept
+{
+    // Only values that reach the driver count: sType is fixed per struct and pNext chains are not used. Counts
+    // go in ahead of arrays so that, say, two stages then nothing differs from one stage then one more.
+    PipelineKey key;
+    key.add(static_cast<unsigned int>(shader_stages.size()));
+    for (const VkPipelineShaderStageCreateInfo &stage : shader_stages)
+    {
+        key.add(stage.stage);
+        key.add64(handle_bits(stage.module));
+        key.add_bytes(stage.pName, Utils::StringView(stage.pName).size());
+        key.add(stage.pSpecializationInfo != nullptr);
+        if (stage.pSpecializationInfo != nullptr)
+        {
+            const VkSpecializationInfo &specialization = *stage.pSpecializationInfo;
+            key.add(specialization.mapEntryCount);
+            for (uint32_t i = 0; i < specialization.mapEntryCount; ++i)
+            {
+                key.add(specialization.pMapEntries[i].constantID);
+                key.add(specialization.pMapEntries[i].offset);
+                key.add64(specialization.pMapEntries[i].size);
+            }
+            key.add_bytes(specialization.pData, specialization.dataSize);
+        }
+    }
+
+    // Dynamic states first, since they decide which of the values below matter.
+    const unsigned long dynamic_first = key.size() + 1;
+    key.add(dynamic_state.dynamicStateCount);
+    for (uint32_t i = 0; i < dynamic_state.dynamicStateCount; ++i)
+    {
+        key.add(dynamic_state.pDynamicStates[i]);
+    }
+    key.sort_from(dynamic_first);
+
+    const bool dynamic_stride = has_dynamic_state(dynamic_state, VK_DYNAMIC_STATE_VERTEX_INPUT_BINDING_STRIDE);
+    key.add(vertex_input_info.vertexBindingDescriptionCount);
+    for (uint32_t i = 0; i < vertex_input_info.vertexBindingDescriptionCount; ++i)
+    {
+        const VkVertexInputBindingDescription &binding = vertex_input_info.pVertexBindingDescriptions[i];
+        key.add(binding.binding);
+        key.add(dynamic_stride ? 0 : binding.stride);
+        key.add(binding.inputRate);
+    }
+    key.add(vertex_input_info.vertexAttributeDescriptionCount);
+    for (uint32_t i = 0; i < vertex_input_info.vertexAttributeDescriptionCount; ++i)
+    {
+        const VkVertexInputAttributeDescription &attribute = vertex_input_info.pVertexAttributeDescriptions[i];
+        key.add(attribute.location);
+        key.add(attribute.binding);
+        key.add(attribute.format);
+        key.add(attribute.offset);
+    }
+
+    key.add(input_assembly.topology);
+    key.add(input_assembly.primitiveRestartEnable);
+
+    key.add(viewport_state.viewportCount);
+    key.add(viewport_state.scissorCount);
+    const bool static_viewports = viewport_state.pViewports != nullptr &&
+                                  !has_dynamic_state(dynamic_state, VK_DYNAMIC_STATE_VIEWPORT);
+    key.add(static_viewports);
+    for (uint32_t i = 0; static_viewports && i < viewport_state.viewportCount; ++i)
+    {
+        const VkViewport &viewport = viewport_state.pViewports[i];
+        key.add_float(viewport.x);
+        key.add_float(viewport.y);
+        key.add_float(viewport.width);
+        key.add_float(viewport.height);
+        key.add_float(viewport.minDepth);
+        key.add_float(viewport.maxDepth);
+    }
+    const bool static_scissors = viewport_state.pScissors != nullptr &&
+                                 !has_dynamic_state(dynamic_state, VK_DYNAMIC_STATE_SCISSOR);
+    key.add(static_scissors);
+    for (uint32_t i = 0; static_scissors && i < viewport_state.scissorCount; ++i)
+    {
+        const VkRect2D &scissor = viewport_state.pScissors[i];
+        key.add(static_cast<unsigned int>(scissor.offset.x));
+        key.add(static_cast<unsigned int>(scissor.offset.y));
+        key.add(scissor.extent.width);
+        key.add(scissor.extent.height);
+    }
+
+    key.add(rasterizer.depthClampEnable);
+    key.add(rasterizer.rasterizerDiscardEnable);
+    key.add(rasterizer.polygonMode);
+    key.add(rasterizer.cullMode);
+    key.add(rasterizer.frontFace);
+    key.add(rasterizer.depthBiasEnable);
+    if (rasterizer.depthBiasEnable && !has_dynamic_state(dynamic_state, VK_DYNAMIC_STATE_DEPTH_BIAS))
+    {
+        key.add_float(rasterizer.depthBiasConstantFactor);
+        key.add_float(rasterizer.depthBiasClamp);
+        key.add_float(rasterizer.depthBiasSlopeFactor);
+    }
+    key.add_float(rasterizer.lineWidth);
+
+    key.add(multi_sampling.rasterizationSamples);
+    key.add(multi_sampling.sampleShadingEnable);
+    key.add_float(multi_sampling.sampleShadingEnable ? multi_sampling.minSampleShading : 0.0f);
+    // A null mask is all ones.
+    for (unsigned int i = 0; i < (static_cast<unsigned int>(multi_sampling.rasterizationSamples) + 31) / 32; ++i)
+    {
+        key.add(multi_sampling.pSampleMask != nullptr ? multi_sampling.pSampleMask[i] : ~0u);
+    }
+    key.add(multi_sampling.alphaToCoverageEnable);
+    key.add(multi_sampling.alphaToOneEnable);
+
+    key.add(depth_stencil.depthTestEnable);
+    key.add(depth_stencil.depthWriteEnable);
+    key.add(depth_stencil.depthTestEnable ? depth_stencil.depthCompareOp : 0);
+    key.add(depth_stencil.depthBoundsTestEnable);
+    if (depth_stencil.depthBoundsTestEnable)
+    {
+        key.add_float(depth_stencil.minDepthBounds);
+        key.add_float(depth_stencil.maxDepthBounds);
+    }
+    key.add(depth_stencil.stencilTestEnable);
+    if (depth_stencil.stencilTestEnable)
+    {
+        add_stencil(key, depth_stencil.front);
+        add_stencil(key, depth_stencil.back);
+    }
+
+    key.add(color_blending.logicOpEnable);
+    key.add(color_blending.logicOpEnable ? color_blending.logicOp : 0);
+    key.add(color_blending.attachmentCount);
+    key.add(color_blending.pAttachments != nullptr);
+    bool blending = false;
+    for (uint32_t i = 0; color_blending.pAttachments != nullptr && i < color_blending.attachmentCount; ++i)
+    {
+        const VkPipelineColorBlendAttachmentState &attachment = color_blending.pAttachments[i];
+        key.add(attachment.blendEnable);
+        key.add(attachment.colorWriteMask);
+        if (attachment.blendEnable)
+        {
+            key.add(attachment.srcColorBlendFactor);
+            key.add(attachment.dstColorBlendFactor);
+            key.add(attachment.colorBlendOp);
+            key.add(attachment.srcAlphaBlendFactor);
+            key.add(attachment.dstAlphaBlendFactor);
+            key.add(attachment.alphaBlendOp);
+            blending = true;
+        }
+    }
+    if (blending && !has_dynamic_state(dynamic_state, VK_DYNAMIC_STATE_BLEND_CONSTANTS))
+    {
+        for (float constant : color_blending.blendConstants)
+        {
+            key.add_float(constant);
+        }
+    }
+
+    key.add(rendering_info.viewMask);
+    key.add(rendering_info.colorAttachmentCount);
+    for (uint32_t i = 0; i < rendering_info.colorAttachmentCount; ++i)
+    {
+        key.add(rendering_info.pColorAttachmentFormats[i]);
+    }
+    key.add(rendering_info.depthAttachmentFormat);
+    key.add(rendering_info.stencilAttachmentFormat);
+
+    key.add64(handle_bits(layout));
+    key.finish();
+    return key;
+}
+
+Pipeline::Pipeline(const GraphicsPipelineBuilder *builder, VkPipelineCache cache)
     : type(PipelineType::GRAPHICS)
 {
     VkGraphicsPipelineCreateInfo graphics = builder->build();
-    vkCreateGraphicsPipelines(volkGetLoadedDevice(), VK_NULL_HANDLE, 1, &graphics, &callbacks, &pipeline);
+    if (vkCreateGraphicsPipelines(volkGetLoadedDevice(), cache, 1, &graphics, &callbacks, &pipeline) != VK_SUCCESS)
+    {
+        Log::warn(Log::Module::VULKAN, "Failed to create graphics pipeline");
+    }
 }
 
-Pipeline::Pipeline(const VkComputePipelineCreateInfo &compute)
+Pipeline::Pipeline(const VkComputePipelineCreateInfo &compute, VkPipelineCache cache)
     : type(PipelineType::COMPUTE)
 {
-    vkCreateComputePipelines(volkGetLoadedDevice(), VK_NULL_HANDLE, 1, &compute, &callbacks, &pipeline);
+    if (vkCreateComputePipelines(volkGetLoadedDevice(), cache, 1, &compute, &callbacks, &pipeline) != VK_SUCCESS)
+    {
+        Log::warn(Log::Module::VULKAN, "Failed to create compute pipeline");
+    }
 }
 
-Pipeline::Pipeline(const VkRayTracingPipelineCreateInfoKHR &ray_tracing)
+Pipeline::Pipeline(const VkRayTracingPipelineCreateInfoKHR &ray_tracing, VkPipelineCache cache)
     : type(PipelineType::RAY_TRACING)
 {
-    vkCreateRayTracingPipelinesKHR(volkGetLoadedDevice(), VK_NULL_HANDLE, VK_NULL_HANDLE, 1, &ray_tracing, &callbacks,
-                                   &pipeline);
+    if (vkCreateRayTracingPipelinesKHR(volkGetLoadedDevice(), VK_NULL_HANDLE, cache, 1, &ray_tracing, &callbacks,
+                                       &pipeline) != VK_SUCCESS)
+    {
+        Log::warn(Log::Module::VULKAN, "Failed to create ray tracing pipeline");
+    }
 }
 
 Pipeline::~Pipeline()
 {
-    vkDestroyPipeline(volkGetLoadedDevice(), pipeline, nullptr);
+    vkDestroyPipeline(volkGetLoadedDevice(), pipeline, &callbacks);
 }
-} // namespace LunaVoxelEngine::Renderer
\ No newline at end of file
+} // namespace LunaVoxelEngine::Renderer
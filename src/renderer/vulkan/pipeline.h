@@ -1,6 +1,7 @@
 #ifndef PIPELINE_H
 #define PIPELINE_H
 #include <renderer/vulkan/ivulkan.h>
+#include <utils/algorithm.h>
 #include <utils/vector.h>
 namespace LunaVoxelEngine::Renderer
 {
@@ -11,6 +12,54 @@ enum class PipelineType
     RAY_TRACING
 };
 
+/**
+ * @class PipelineKey
+ * @brief Pipeline state flattened into 32-bit words, so hashing and comparing it never follows a pointer.
+ */
+class [[nodiscard]] PipelineKey final
+{
+  public:
+    void add(unsigned int word) noexcept
+    {
+        words.push_back(word);
+    }
+    void add64(unsigned long long value) noexcept
+    {
+        words.push_back(static_cast<unsigned int>(value));
+        words.push_back(static_cast<unsigned int>(value >> 32));
+    }
+    void add_float(float value) noexcept
+    {
+        unsigned int bits;
+        Utils::memcpy(&bits, &value, sizeof(bits));
+        words.push_back(bits);
+    }
+    /// Adds size bytes, zero-padded to whole words, after their length.
+    void add_bytes(const void *data, unsigned long size) noexcept;
+    /// Sorts the words from first on, for state whose order does not matter.
+    void sort_from(unsigned long first) noexcept;
+    /// Computes the hash; call once every word has been added.
+    void finish() noexcept;
+
+    [[nodiscard]] unsigned long size() const noexcept
+    {
+        return words.size();
+    }
+    [[nodiscard]] unsigned long long get_hash() const noexcept
+    {
+        return hash;
+    }
+    [[nodiscard]] bool operator==(const PipelineKey &other) const noexcept
+    {
+        return hash == other.hash && words.size() == other.words.size() &&
+               Utils::memcmp(words.data(), other.words.data(), words.size() * sizeof(unsigned int)) == 0;
+    }
+
+  private:
+    Utils::Vector<unsigned int> words;
+    unsigned long long hash = 0;
+};
+
 class [[nodiscard]] GraphicsPipelineBuilder final
 {
     Utils::Vector<VkPipelineShaderStageCreateInfo> shader_stages;
@@ -160,14 +209,33 @@ class [[nodiscard]] GraphicsPipelineBuilder final
         pipeline_info.pNext = &rendering_info;
         return pipeline_info;
     }
+
+    /**
+     * @brief The canonical form of the state build() describes, following its pointers.
+     * @details Two builders get equal keys if they would create the same pipeline, even if their arrays live at
+     *          different addresses or hold state the pipeline ignores. Dynamic states are sorted, and values that
+     *          are dynamic or disabled are left out: viewports and scissors when dynamic, blend factors of
+     *          attachments with blending off, stencil state with the stencil test off, and so on.
+     */
+    [[nodiscard]] PipelineKey key() const noexcept;
+
+    [[nodiscard]] unsigned long long hash() const noexcept
+    {
+        return key().get_hash();
+    }
+
+    [[nodiscard]] bool operator==(const GraphicsPipelineBuilder &other) const noexcept
+    {
+        return key() == other.key();
+    }
 };
 
 class [[nodiscard]] Pipeline final
 {
   public:
-    Pipeline(const GraphicsPipelineBuilder *graphics);
-    Pipeline(const VkComputePipelineCreateInfo &compute);
-    Pipeline(const VkRayTracingPipelineCreateInfoKHR &ray_tracing);
+    Pipeline(const GraphicsPipelineBuilder *graphics, VkPipelineCache cache = VK_NULL_HANDLE);
+    Pipeline(const VkComputePipelineCreateInfo &compute, VkPipelineCache cache = VK_NULL_HANDLE);
+    Pipeline(const VkRayTracingPipelineCreateInfoKHR &ray_tracing, VkPipelineCache cache = VK_NULL_HANDLE);
     ~Pipeline();
 
     [[nodiscard]] VkPipeline handle() const noexcept
@@ -180,7 +248,7 @@ class [[nodiscard]] Pipeline final
     }
 
   private:
-    VkPipeline pipeline;
+    VkPipeline pipeline = VK_NULL_HANDLE; ///< Stays null if creation failed.
     PipelineType type;
 };
 } // namespace LunaVoxelEngine::Renderer
@@ -0,0 +1,125 @@
+#include <platform/file.h>
+#include <platform/log.h>
+#include <renderer/vulkan/pipeline_cache.h>
+#include <utils/algorithm.h>
+#include <utils/hash.h>
+#include <utils/vector.h>
+extern VkAllocationCallbacks callbacks;
+
+namespace LunaVoxelEngine::Renderer
+{
+namespace
+{
+/// The driver's header: headerSize, headerVersion, vendorID, deviceID and the UUID, all little-endian.
+constexpr unsigned long DRIVER_HEADER_SIZE = 16 + VK_UUID_SIZE;
+
+unsigned int read_u32(const unsigned char *p) noexcept
+{
+    return static_cast<unsigned int>(p[0]) | static_cast<unsigned int>(p[1]) << 8 |
+           static_cast<unsigned int>(p[2]) << 16 | static_cast<unsigned int>(p[3]) << 24;
+}
+} // namespace
+
+const unsigned char *validate_pipeline_cache(const unsigned char *file, unsigned long size, unsigned int vendor_id,
+                                             unsigned int device_id, const unsigned char *uuid) noexcept
+{
+    PipelineCacheFileHeader header;
+    if (size < sizeof(header))
+    {
+        return nullptr;
+    }
+    Utils::memcpy(&header, file, sizeof(header));
+    const unsigned char *data = file + sizeof(header);
+    if (header.magic != PipelineCacheFileHeader::MAGIC || header.version != PipelineCacheFileHeader::VERSION ||
+        header.data_size != size - sizeof(header) || header.data_size < DRIVER_HEADER_SIZE ||
+        header.data_hash !=
+            Utils::xxhash64(reinterpret_cast<const char *>(data), static_cast<unsigned long>(header.data_size)))
+    {
+        return nullptr;
+    }
+    if (read_u32(data) < DRIVER_HEADER_SIZE || read_u32(data + 4) != VK_PIPELINE_CACHE_HEADER_VERSION_ONE ||
+        read_u32(data + 8) != vendor_id || read_u32(data + 12) != device_id ||
+        Utils::memcmp(data + 16, uuid, VK_UUID_SIZE) != 0)
+    {
+        return nullptr;
+    }
+    return data;
+}
+
+PipelineCache::PipelineCache(const Device *device, const char *path_in)
+    : path(path_in)
+{
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(device->get_physical_device(), &properties);
+
+    VkPipelineCacheCreateInfo cache_info{};
+    cache_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    Platform::MappedFile file(path);
+    if (file.is_open())
+    {
+        const unsigned char *bytes = reinterpret_cast<const unsigned char *>(file.data());
+        const unsigned char *data = validate_pipeline_cache(bytes, file.size(), properties.vendorID,
+                                                            properties.deviceID, properties.pipelineCacheUUID);
+        if (data != nullptr)
+        {
+            cache_info.initialDataSize = file.size() - sizeof(PipelineCacheFileHeader);
+            cache_info.pInitialData = data;
+            saved_hash = reinterpret_cast<const PipelineCacheFileHeader *>(bytes)->data_hash;
+            loaded = true;
+        }
+        else
+        {
+            Log::info(Log::Module::VULKAN, "Ignoring pipeline cache %s: written by another driver or damaged", path);
+        }
+    }
+    if (vkCreatePipelineCache(volkGetLoadedDevice(), &cache_info, &callbacks, &cache) != VK_SUCCESS)
+    {
+        Log::fatal("Failed to create the pipeline cache");
+    }
+    Log::debug(Log::Module::VULKAN, "Pipeline cache: %llu KB from %s",
+               static_cast<unsigned long long>(cache_info.initialDataSize) / 1024, path);
+}
+
+PipelineCache::~PipelineCache()
+{
+    vkDestroyPipelineCache(volkGetLoadedDevice(), cache, &callbacks);
+}
+
+bool PipelineCache::save() noexcept
+{
+    const VkDevice vk_device = volkGetLoadedDevice();
+    size_t size = 0;
+    if (vkGetPipelineCacheData(vk_device, cache, &size, nullptr) != VK_SUCCESS)
+    {
+        return false;
+    }
+    Utils::Vector<unsigned char> bytes(sizeof(PipelineCacheFileHeader) + size);
+    if (vkGetPipelineCacheData(vk_device, cache, &size, bytes.data() + sizeof(PipelineCacheFileHeader)) !=
+        VK_SUCCESS)
+    {
+        return false;
+    }
+    PipelineCacheFileHeader header;
+    header.magic = PipelineCacheFileHeader::MAGIC;
+    header.version = PipelineCacheFileHeader::VERSION;
+    header.data_size = size;
+    header.data_hash =
+        Utils::xxhash64(reinterpret_cast<const char *>(bytes.data() + sizeof(PipelineCacheFileHeader)), size);
+    if (header.data_hash == saved_hash)
+    {
+        return true;
+    }
+    Utils::memcpy(bytes.data(), &header, sizeof(header));
+
+    Platform::File file(path, Platform::FileMode::FILE_WRITE);
+    if (!file.write(bytes.data(), sizeof(header) + size))
+    {
+        Log::warn(Log::Module::VULKAN, "Failed to write pipeline cache %s", path);
+        return false;
+    }
+    saved_hash = header.data_hash;
+    Log::debug(Log::Module::VULKAN, "Saved %llu KB of pipeline cache to %s",
+               static_cast<unsigned long long>(size) / 1024, path);
+    return true;
+}
+} // namespace LunaVoxelEngine::Renderer
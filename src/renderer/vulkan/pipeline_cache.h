@@ -0,0 +1,78 @@
+#ifndef VK_PIPELINE_CACHE_H
+#define VK_PIPELINE_CACHE_H
+#include <renderer/vulkan/device.h>
+#include <renderer/vulkan/ivulkan.h>
+
+namespace LunaVoxelEngine::Renderer
+{
+constexpr const char *DEFAULT_PIPELINE_CACHE_PATH = "pipeline_cache.bin";
+
+/**
+ * @brief The header written in front of the driver's cache data, so a truncated or corrupted file is caught before
+ *        the driver parses it.
+ */
+struct PipelineCacheFileHeader
+{
+    static constexpr unsigned int MAGIC = 0x4350564C; ///< "LVPC"
+    static constexpr unsigned int VERSION = 1;
+
+    unsigned int magic;
+    unsigned int version;
+    unsigned long long data_size; ///< Bytes of driver data after the header.
+    unsigned long long data_hash; ///< xxhash64 of the driver data.
+};
+
+/**
+ * @brief Whether a cache file can be handed to this device: the file header matches, and the driver's own header
+ *        names the same vendor, device and pipeline cache UUID.
+ * @details A cache written by another driver version is rejected rather than passed on, since some drivers
+ *          handle stale data badly.
+ * @param uuid VK_UUID_SIZE bytes.
+ * @return The driver data in file, or null if the file is not usable.
+ */
+[[nodiscard]] const unsigned char *validate_pipeline_cache(const unsigned char *file, unsigned long size,
+                                                           unsigned int vendor_id, unsigned int device_id,
+                                                           const unsigned char *uuid) noexcept;
+
+/**
+ * @class PipelineCache
+ * @brief A VkPipelineCache that is loaded from disk at startup and written back by save(), so pipelines compiled
+ *        in one run come from the cache in the next.
+ * @details The cache is internally synchronised, so pipelines may be compiled into it from several threads.
+ */
+class [[nodiscard]] PipelineCache final
+{
+  public:
+    /**
+     * @param path Where the cache is read from and saved to. A missing or stale file starts an empty cache. Must
+     *             outlive the cache.
+     */
+    PipelineCache(const Device *device, const char *path);
+    ~PipelineCache();
+    PipelineCache(const PipelineCache &) = delete;
+    PipelineCache &operator=(const PipelineCache &) = delete;
+
+    /**
+     * @brief Writes the cache to its path if it has changed since it was loaded or last saved.
+     * @return false if the file could not be written.
+     */
+    bool save() noexcept;
+
+    [[nodiscard]] VkPipelineCache handle() const noexcept
+    {
+        return cache;
+    }
+    /// Whether the cache started from a valid file rather than empty.
+    [[nodiscard]] bool was_loaded() const noexcept
+    {
+        return loaded;
+    }
+
+  private:
+    VkPipelineCache cache = VK_NULL_HANDLE;
+    const char *path;
+    unsigned long long saved_hash = 0; ///< data_hash of the file on disk, to skip saving an unchanged cache.
+    bool loaded = false;
+};
+} // namespace LunaVoxelEngine::Renderer
+#endif
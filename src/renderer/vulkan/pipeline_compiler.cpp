@@ -0,0 +1,120 @@
+#include <platform/log.h>
+#include <platform/profiler.h>
+#include <platform/time.h>
+#include <renderer/vulkan/pipeline_compiler.h>
+
+namespace LunaVoxelEngine::Renderer
+{
+PipelineCompiler::PipelineCompiler(VkPipelineCache cache_in, unsigned int thread_count_in)
+    : cache(cache_in)
+    , thread_count(thread_count_in < MAX_THREADS ? thread_count_in : MAX_THREADS)
+{
+    for (unsigned int i = 0; i < thread_count; ++i)
+    {
+        threads[i] = new Platform::Thread(worker_main, this);
+    }
+}
+
+PipelineCompiler::~PipelineCompiler()
+{
+    {
+        Platform::GuardLock guard(mutex);
+        stopping = true;
+    }
+    queued.broadcast();
+    for (unsigned int i = 0; i < thread_count; ++i)
+    {
+        threads[i]->wait();
+        delete threads[i];
+    }
+    registry.for_each([](PipelineJob *job) { delete job->pipeline; });
+}
+
+size_t PipelineCompiler::worker_main(void *param)
+{
+    Platform::profiler_set_thread_name("pipeline compiler");
+    static_cast<PipelineCompiler *>(param)->run();
+    return 0;
+}
+
+void PipelineCompiler::run() noexcept
+{
+    while (true)
+    {
+        PipelineJob *job;
+        {
+            Platform::GuardLock guard(mutex);
+            while (queue_head == queue.size() && !stopping)
+            {
+                queued.wait(&mutex);
+            }
+            // Jobs still queued are dropped; nobody is left to draw with them.
+            if (stopping)
+            {
+                return;
+            }
+            job = queue[queue_head++];
+            if (queue_head == queue.size())
+            {
+                queue.resize(0);
+                queue_head = 0;
+            }
+        }
+        compile(job);
+    }
+}
+
+void PipelineCompiler::compile(PipelineJob *job) noexcept
+{
+    LUNA_PROFILE_SCOPE("compile pipeline");
+    const unsigned long long start = Platform::time_now_ns();
+    job->pipeline = new Pipeline(&job->builder, cache);
+    const unsigned long long elapsed = Platform::time_now_ns() - start;
+
+    unsigned long long longest = longest_compile_ns.load(Utils::MemoryOrder::RELAXED);
+    while (elapsed > longest && !longest_compile_ns.compare_exchange(longest, elapsed, Utils::MemoryOrder::RELAXED))
+    {
+    }
+    compiled_count.fetch_add(1, Utils::MemoryOrder::RELAXED);
+    {
+        // Set under the mutex so that wait() cannot check it and then miss the broadcast.
+        Platform::GuardLock guard(mutex);
+        job->ready.store(1, Utils::MemoryOrder::RELEASE);
+    }
+    done.broadcast();
+}
+
+void PipelineCompiler::wait(PipelineJob *job) noexcept
+{
+    LUNA_PROFILE_SCOPE("wait for pipeline");
+    Platform::GuardLock guard(mutex);
+    while (job->ready.load(Utils::MemoryOrder::ACQUIRE) == 0)
+    {
+        done.wait(&mutex);
+    }
+}
+
+PipelineHandle PipelineCompiler::request(const GraphicsPipelineBuilder &builder) noexcept
+{
+    bool created;
+    PipelineJob *job = registry.insert(builder, builder.key(), created);
+    if (!created)
+    {
+        reused_count.fetch_add(1, Utils::MemoryOrder::RELAXED);
+        return PipelineHandle(this, job);
+    }
+    if (thread_count > 0)
+    {
+        {
+            Platform::GuardLock guard(mutex);
+            queue.push_back(job);
+        }
+        queued.signal();
+    }
+    else
+    {
+        compile(job);
+    }
+    return PipelineHandle(this, job);
+}
+} // namespace LunaVoxelEngine::Renderer
@@ -0,0 +1,137 @@
+#ifndef VK_PIPELINE_COMPILER_H
+#define VK_PIPELINE_COMPILER_H
+#include <platform/thread.h>
+#include <renderer/vulkan/ivulkan.h>
+#include <renderer/vulkan/pipeline.h>
+#include <renderer/vulkan/pipeline_registry.h>
+#include <utils/atomic.h>
+#include <utils/vector.h>
+
+namespace LunaVoxelEngine::Renderer
+{
+class PipelineCompiler;
+
+/**
+ * @class PipelineHandle
+ * @brief Refers to a pipeline that may still be compiling, like a future that can be polled every frame.
+ * @details Handles are cheap to copy and stay valid until the compiler that made them is destroyed.
+ */
+class PipelineHandle final
+{
+  public:
+    PipelineHandle() = default;
+
+    [[nodiscard]] bool is_valid() const noexcept
+    {
+        return job != nullptr;
+    }
+    [[nodiscard]] bool is_ready() const noexcept
+    {
+        return job != nullptr && job->ready.load(Utils::MemoryOrder::ACQUIRE) != 0;
+    }
+    /**
+     * @return The pipeline, or null while it is compiling; draws that need it should be skipped until then.
+     */
+    [[nodiscard]] Pipeline *get() const noexcept
+    {
+        return is_ready() ? job->pipeline : nullptr;
+    }
+    /**
+     * @brief Blocks until the pipeline is compiled, for the few that a frame cannot do without.
+     */
+    Pipeline *wait() const noexcept;
+
+  private:
+    friend class PipelineCompiler;
+    PipelineHandle(PipelineCompiler *compiler_in, PipelineJob *job_in)
+        : compiler(compiler_in)
+        , job(job_in)
+    {
+    }
+
+    PipelineCompiler *compiler = nullptr;
+    PipelineJob *job = nullptr;
+};
+
+/**
+ * @class PipelineCompiler
+ * @brief Compiles graphics pipelines on worker threads, so a new pipeline costs the frame that asks for it nothing.
+ * @details Requests for a builder whose key() matches an earlier request return the earlier pipeline, whether it
+ *          is still queued, compiling or done, so each distinct pipeline is compiled once. Pipelines live until the
+ *          compiler is destroyed.
+ *
+ * Builders are copied, but the arrays their create infos point to (dynamic states, blend attachments, vertex
+ * descriptions, attachment formats) are not, and must outlive the compile.
+ */
+class [[nodiscard]] PipelineCompiler final
+{
+  public:
+    static constexpr unsigned int MAX_THREADS = 8;
+
+    /**
+     * @param cache The pipeline cache compiles read and fill; may be VK_NULL_HANDLE.
+     * @param thread_count Worker threads, at most MAX_THREADS. With none, request() compiles on the calling thread.
+     */
+    PipelineCompiler(VkPipelineCache cache, unsigned int thread_count);
+    ~PipelineCompiler();
+    PipelineCompiler(const PipelineCompiler &) = delete;
+    PipelineCompiler &operator=(const PipelineCompiler &) = delete;
+
+    /**
+     * @brief Queues builder for compiling, unless an identical pipeline was requested before.
+     */
+    [[nodiscard]] PipelineHandle request(const GraphicsPipelineBuilder &builder) noexcept;
+
+    /// Distinct pipelines requested, compiled or not.
+    [[nodiscard]] unsigned int get_pipeline_count() const noexcept
+    {
+        return registry.size();
+    }
+    [[nodiscard]] unsigned int get_compiled_count() const noexcept
+    {
+        return compiled_count.load(Utils::MemoryOrder::RELAXED);
+    }
+    /// Requests answered by an earlier request.
+    [[nodiscard]] unsigned long long get_reused_count() const noexcept
+    {
+        return reused_count.load(Utils::MemoryOrder::RELAXED);
+    }
+    [[nodiscard]] unsigned long long get_longest_compile_ns() const noexcept
+    {
+        return longest_compile_ns.load(Utils::MemoryOrder::RELAXED);
+    }
+
+  private:
+    friend class PipelineHandle;
+    static size_t worker_main(void *param);
+    void run() noexcept;
+    void compile(PipelineJob *job) noexcept;
+    void wait(PipelineJob *job) noexcept;
+
+    VkPipelineCache cache;
+    Platform::Thread *threads[MAX_THREADS] = {};
+    unsigned int thread_count;
+    PipelineRegistry registry;
+
+    Platform::Mutex mutex;               ///< Guards everything below up to the statistics.
+    Platform::ConditionVariable queued;  ///< Signalled when a job is queued or the compiler stops.
+    Platform::ConditionVariable done;    ///< Broadcast when a job becomes ready.
+    Utils::Vector<PipelineJob *> queue;  ///< Jobs waiting for a thread, from queue_head on.
+    unsigned long queue_head = 0;
+    bool stopping = false;
+
+    Utils::Atomic<unsigned int> compiled_count = 0;
+    Utils::Atomic<unsigned long long> longest_compile_ns = 0;
+    Utils::Atomic<unsigned long long> reused_count = 0;
+};
+
+inline Pipeline *PipelineHandle::wait() const noexcept
+{
+    if (!is_ready())
+    {
+        compiler->wait(job);
+    }
+    return job->pipeline;
+}
+} // namespace LunaVoxelEngine::Renderer
+#endif
@@ -0,0 +1,84 @@
+#include <renderer/vulkan/pipeline_registry.h>
+
+namespace LunaVoxelEngine::Renderer
+{
+namespace
+{
+constexpr unsigned long INITIAL_TABLE_SIZE = 64;
+} // namespace
+
+PipelineRegistry::PipelineRegistry()
+    : table(INITIAL_TABLE_SIZE, nullptr)
+{
+}
+
+PipelineRegistry::~PipelineRegistry()
+{
+    for (PipelineJob *job : table)
+    {
+        delete job;
+    }
+}
+
+unsigned long PipelineRegistry::find_slot(const PipelineKey &key) const noexcept
+{
+    const unsigned long mask = table.size() - 1;
+    unsigned long slot = static_cast<unsigned long>(key.get_hash()) & mask;
+    while (table[slot] != nullptr && !(table[slot]->key == key))
+    {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+void PipelineRegistry::grow() noexcept
+{
+    Utils::Vector<PipelineJob *> old = static_cast<Utils::Vector<PipelineJob *> &&>(table);
+    table = Utils::Vector<PipelineJob *>(old.size() * 2, nullptr);
+    for (PipelineJob *job : old)
+    {
+        if (job != nullptr)
+        {
+            table[find_slot(job->key)] = job;
+        }
+    }
+}
+
+PipelineJob *PipelineRegistry::find(const PipelineKey &key) noexcept
+{
+    lock.read_lock();
+    PipelineJob *job = table[find_slot(key)];
+    lock.read_unlock();
+    return job;
+}
+
+PipelineJob *PipelineRegistry::insert(const GraphicsPipelineBuilder &builder, PipelineKey &&key,
+                                      bool &created) noexcept
+{
+    created = false;
+    if (PipelineJob *job = find(key))
+    {
+        return job;
+    }
+
+    lock.write_lock();
+    // Another thread may have added the key between the two locks.
+    const unsigned long slot = find_slot(key);
+    PipelineJob *job = table[slot];
+    if (job == nullptr)
+    {
+        job = new PipelineJob();
+        job->builder = builder;
+        job->key = static_cast<PipelineKey &&>(key);
+        table[slot] = job;
+        created = true;
+        // Keep the table at most half full so probes stay short.
+        if (count.fetch_add(1, Utils::MemoryOrder::RELAXED) + 1 > table.size() / 2)
+        {
+            grow();
+        }
+    }
+    lock.write_unlock();
+    return job;
+}
+} // namespace LunaVoxelEngine::Renderer
@@ -0,0 +1,77 @@
+#ifndef VK_PIPELINE_REGISTRY_H
+#define VK_PIPELINE_REGISTRY_H
+#include <platform/thread.h>
+#include <renderer/vulkan/pipeline.h>
+#include <utils/atomic.h>
+#include <utils/vector.h>
+
+namespace LunaVoxelEngine::Renderer
+{
+/**
+ * @brief One requested pipeline: the builder it is compiled from and, once ready is set, the result.
+ */
+struct PipelineJob
+{
+    GraphicsPipelineBuilder builder;
+    PipelineKey key;
+    Pipeline *pipeline = nullptr;
+    Utils::Atomic<unsigned int> ready = 0; ///< Set, with release order, after pipeline is written.
+};
+
+/**
+ * @class PipelineRegistry
+ * @brief Maps pipeline keys to the one job that builds each, safe to use from any thread.
+ * @details Lookups of known keys, the common case once a level has loaded, only take the read lock. Keys are
+ *          compared in full, so two states whose hashes collide still get their own jobs. The registry owns its
+ *          jobs but not their pipelines, and makes no Vulkan calls.
+ */
+class [[nodiscard]] PipelineRegistry final
+{
+  public:
+    PipelineRegistry();
+    ~PipelineRegistry();
+    PipelineRegistry(const PipelineRegistry &) = delete;
+    PipelineRegistry &operator=(const PipelineRegistry &) = delete;
+
+    /**
+     * @return The job for key, or null if there is none yet.
+     */
+    [[nodiscard]] PipelineJob *find(const PipelineKey &key) noexcept;
+    /**
+     * @brief Returns the job for key, adding one for builder if there is none yet.
+     * @param created Set to whether the job was added by this call, in which case the caller must build it. Of
+     *                several threads inserting the same key at once, exactly one sees true.
+     */
+    [[nodiscard]] PipelineJob *insert(const GraphicsPipelineBuilder &builder, PipelineKey &&key,
+                                      bool &created) noexcept;
+
+    [[nodiscard]] unsigned int size() const noexcept
+    {
+        return count.load(Utils::MemoryOrder::RELAXED);
+    }
+
+    /**
+     * @brief Calls func on every job. Not safe against concurrent inserts; meant for shutdown.
+     */
+    template <typename Func> void for_each(Func &&func) noexcept
+    {
+        for (PipelineJob *job : table)
+        {
+            if (job != nullptr)
+            {
+                func(job);
+            }
+        }
+    }
+
+  private:
+    /// The slot holding key, or the empty slot where it belongs. Called with the lock held.
+    [[nodiscard]] unsigned long find_slot(const PipelineKey &key) const noexcept;
+    void grow() noexcept;
+
+    Platform::RWLock lock;
+    Utils::Vector<PipelineJob *> table; ///< Open addressing on the key hash; null slots are empty.
+    Utils::Atomic<unsigned int> count = 0;
+};
+} // namespace LunaVoxelEngine::Renderer
+#endif
@@ -0,0 +1,572 @@
+#include <platform/log.h>
+#include <renderer/vulkan/render_graph.h>
+#include <utils/algorithm.h>
+extern VkAllocationCallbacks callbacks;
+
+namespace LunaVoxelEngine::Renderer
+{
+namespace
+{
+constexpr VkPipelineStageFlags2 FRAGMENT_TESTS =
+    VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT;
+constexpr VkAccessFlags2 DEPTH_READ_WRITE =
+    VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+// Depth attachment writes also read, for the depth test, but only what the pass itself cleared to.
+constexpr RenderAccessInfo ACCESS_INFO[static_cast<unsigned int>(RenderAccess::COUNT)] = {
+    {VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+     VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, false},
+    {VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+     VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+     VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, true},
+    {FRAGMENT_TESTS, DEPTH_READ_WRITE, VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+     VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL, false},
+    {FRAGMENT_TESTS, DEPTH_READ_WRITE, VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+     VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL, true},
+    {VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, VK_ACCESS_2_NONE,
+     VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, true},
+    {VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, VK_ACCESS_2_NONE,
+     VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, true},
+    {VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT, VK_ACCESS_2_NONE,
+     VK_IMAGE_LAYOUT_GENERAL, true},
+    {VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+     VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL, false},
+    {VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+     VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+     VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL, true},
+    {VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT, VK_ACCESS_2_NONE,
+     VK_IMAGE_LAYOUT_UNDEFINED, true},
+    {VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_READ_BIT, VK_ACCESS_2_NONE,
+     VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, true},
+    {VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT,
+     VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, false},
+};
+
+/// Where a resource stands between passes while barriers are planned.
+struct ResourceState
+{
+    VkImageLayout layout;
+    VkPipelineStageFlags2 write_stages; ///< Of the last write or layout transition.
+    VkAccessFlags2 write_access;        ///< Of the last write, still to be made visible.
+    VkPipelineStageFlags2 read_stages;  ///< Reads since the last write, which the next write must wait for.
+    VkPipelineStageFlags2 visible_stages; ///< Where the last write has been made visible.
+    VkAccessFlags2 visible_access;
+};
+
+unsigned long long align_up(unsigned long long value, unsigned long long alignment) noexcept
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+} // namespace
+
+const RenderAccessInfo &get_render_access_info(RenderAccess access) noexcept
+{
+    return ACCESS_INFO[static_cast<unsigned int>(access)];
+}
+
+RenderGraph::~RenderGraph()
+{
+    destroy_transients();
+}
+
+RenderResource RenderGraph::import_image(const char *name, const ImportedImage &import) noexcept
+{
+    Resource resource{};
+    resource.name = name;
+    resource.kind = ResourceKind::IMPORTED_IMAGE;
+    resource.import = import;
+    resources.push_back(resource);
+    return static_cast<RenderResource>(resources.size() - 1);
+}
+
+RenderResource RenderGraph::import_buffer(const char *name) noexcept
+{
+    Resource resource{};
+    resource.name = name;
+    resource.kind = ResourceKind::IMPORTED_BUFFER;
+    resources.push_back(resource);
+    return static_cast<RenderResource>(resources.size() - 1);
+}
+
+RenderResource RenderGraph::add_transient_image(const char *name, const TransientImage &image) noexcept
+{
+    Resource resource{};
+    resource.name = name;
+    resource.kind = ResourceKind::TRANSIENT_IMAGE;
+    resource.transient = image;
+    resources.push_back(resource);
+    return static_cast<RenderResource>(resources.size() - 1);
+}
+
+void RenderGraph::set_memory_requirements(RenderResource resource, unsigned long long size,
+                                          unsigned long long alignment) noexcept
+{
+    resources[resource].memory_size = size;
+    resources[resource].memory_alignment = Utils::max(1ull, alignment);
+}
+
+RenderPass RenderGraph::add_pass(const char *name, RecordFunction record, void *user, bool side_effects) noexcept
+{
+    Pass pass{};
+    pass.name = name;
+    pass.record = record;
+    pass.user = user;
+    pass.side_effects = side_effects;
+    passes.push_back(pass);
+    return static_cast<RenderPass>(passes.size() - 1);
+}
+
+void RenderGraph::use(RenderPass pass_id, RenderResource resource, RenderAccess access) noexcept
+{
+    const RenderAccessInfo &info = get_render_access_info(access);
+    Pass &pass = passes[pass_id];
+    for (Use &use : pass.uses)
+    {
+        if (use.resource != resource)
+        {
+            continue;
+        }
+        if (is_image(resource) && use.layout != info.layout)
+        {
+            pass.invalid = true;
+        }
+        use.stages |= info.stages;
+        use.access |= info.access;
+        use.write_access |= info.write_access;
+        use.reads_contents = use.reads_contents || info.reads_contents;
+        return;
+    }
+    pass.uses.push_back({resource, info.stages, info.access, info.write_access, info.layout, info.reads_contents});
+}
+
+void RenderGraph::cull_passes() noexcept
+{
+    // Walking backwards, a resource is needed if a pass kept later reads what is in it now. A pass that
+    // overwrites it without reading makes it unneeded again for the passes before.
+    Utils::Vector<bool> needed(resources.size(), false);
+    for (unsigned long i = 0; i < resources.size(); ++i)
+    {
+        needed[i] = resources[i].kind == ResourceKind::IMPORTED_IMAGE && resources[i].import.output;
+    }
+    for (unsigned long i = passes.size(); i-- > 0;)
+    {
+        Pass &pass = passes[i];
+        pass.culled = !pass.side_effects;
+        for (const Use &use : pass.uses)
+        {
+            if (use.write_access != VK_ACCESS_2_NONE && needed[use.resource])
+            {
+                pass.culled = false;
+            }
+        }
+        if (pass.culled)
+        {
+            continue;
+        }
+        for (const Use &use : pass.uses)
+        {
+            if (!use.reads_contents)
+            {
+                needed[use.resource] = false;
+            }
+        }
+        for (const Use &use : pass.uses)
+        {
+            if (use.reads_contents)
+            {
+                needed[use.resource] = true;
+            }
+        }
+    }
+}
+
+void RenderGraph::place_transients() noexcept
+{
+    // Largest first, each at the lowest offset clear of every image already placed whose lifetime overlaps its own.
+    Utils::Vector<RenderResource> transients;
+    for (unsigned long i = 0; i < resources.size(); ++i)
+    {
+        if (resources[i].kind == ResourceKind::TRANSIENT_IMAGE && resources[i].used)
+        {
+            transients.push_back(static_cast<RenderResource>(i));
+        }
+    }
+    Utils::quicksort(transients.begin(), transients.end(), [this](RenderResource a, RenderResource b) {
+        return resources[a].memory_size > resources[b].memory_size ||
+               (resources[a].memory_size == resources[b].memory_size && a < b);
+    });
+
+    transient_bytes = 0;
+    unaliased_bytes = 0;
+    Utils::Vector<RenderResource> blocking;
+    for (unsigned long i = 0; i < transients.size(); ++i)
+    {
+        Resource &resource = resources[transients[i]];
+        blocking.resize(0);
+        for (unsigned long j = 0; j < i; ++j)
+        {
+            const Resource &placed = resources[transients[j]];
+            if (placed.first_use <= resource.last_use && resource.first_use <= placed.last_use)
+            {
+                blocking.push_back(transients[j]);
+            }
+        }
+        Utils::quicksort(blocking.begin(), blocking.end(), [this](RenderResource a, RenderResource b) {
+            return resources[a].memory_offset < resources[b].memory_offset;
+        });
+        unsigned long long offset = 0;
+        for (const RenderResource other : blocking)
+        {
+            const Resource &placed = resources[other];
+            if (offset + resource.memory_size <= placed.memory_offset)
+            {
+                break;
+            }
+            offset = align_up(Utils::max(offset, placed.memory_offset + placed.memory_size), resource.memory_alignment);
+        }
+        resource.memory_offset = offset;
+        transient_bytes = Utils::max(transient_bytes, offset + resource.memory_size);
+        unaliased_bytes = align_up(unaliased_bytes, resource.memory_alignment) + resource.memory_size;
+    }
+}
+
+bool RenderGraph::plan_barriers() noexcept
+{
+    Utils::Vector<ResourceState> states(resources.size());
+    for (unsigned long i = 0; i < resources.size(); ++i)
+    {
+        const Resource &resource = resources[i];
+        ResourceState &state = states[i];
+        state = {VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE, VK_PIPELINE_STAGE_2_NONE,
+                 VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE};
+        if (resource.kind == ResourceKind::IMPORTED_IMAGE)
+        {
+            state.layout = resource.import.initial_layout;
+            state.write_stages = resource.import.initial_stages;
+            state.write_access = resource.import.initial_write_access;
+        }
+        else if (resource.kind == ResourceKind::TRANSIENT_IMAGE && resource.used)
+        {
+            // The memory was last used by whichever image sharing it ran last, this frame or the one before;
+            // waiting for every use of every image that overlaps it covers both without tracking which.
+            for (const Resource &other : resources)
+            {
+                if (other.kind == ResourceKind::TRANSIENT_IMAGE && other.used &&
+                    other.memory_offset < resource.memory_offset + resource.memory_size &&
+                    resource.memory_offset < other.memory_offset + other.memory_size)
+                {
+                    state.write_stages |= other.all_stages;
+                    state.write_access |= other.all_write_access;
+                }
+            }
+        }
+    }
+
+    batches.resize(0);
+    batches.resize(order.size() + 1);
+    for (unsigned long i = 0; i < order.size(); ++i)
+    {
+        RenderBarrierBatch &batch = batches[i];
+        for (const Use &use : passes[order[i]].uses)
+        {
+            ResourceState &state = states[use.resource];
+            const bool image = is_image(use.resource);
+            const bool transition = image && (use.layout != state.layout || state.layout == VK_IMAGE_LAYOUT_UNDEFINED);
+            VkPipelineStageFlags2 src_stages;
+            VkAccessFlags2 src_access;
+            if (!transition && use.write_access == VK_ACCESS_2_NONE)
+            {
+                // A read waits for the last write only, and not at all if an earlier barrier already made the
+                // write visible where this read happens.
+                state.read_stages |= use.stages;
+                if (state.write_stages == VK_PIPELINE_STAGE_2_NONE ||
+                    ((use.stages & ~state.visible_stages) == 0 && (use.access & ~state.visible_access) == 0))
+                {
+                    continue;
+                }
+                src_stages = state.write_stages;
+                src_access = state.write_access;
+                state.visible_stages |= use.stages;
+                state.visible_access |= use.access;
+            }
+            else
+            {
+                // A write or a layout transition waits for the last write and every read since.
+                src_stages = state.write_stages | state.read_stages;
+                src_access = state.write_access;
+                state.write_stages = use.stages;
+                state.write_access = use.write_access;
+                state.read_stages = use.write_access == VK_ACCESS_2_NONE ? use.stages : VK_PIPELINE_STAGE_2_NONE;
+                state.visible_stages = use.stages;
+                state.visible_access = use.access;
+                if (!transition && src_stages == VK_PIPELINE_STAGE_2_NONE)
+                {
+                    continue;
+                }
+            }
+
+            if (!image)
+            {
+                batch.memory_src_stages |= src_stages;
+                batch.memory_src_access |= src_access;
+                batch.memory_dst_stages |= use.stages;
+                batch.memory_dst_access |= use.access;
+                continue;
+            }
+            // Contents nobody reads are discarded rather than carried through the transition.
+            const VkImageLayout old_layout =
+                transition && !use.reads_contents ? VK_IMAGE_LAYOUT_UNDEFINED : state.layout;
+            batch.images.push_back({use.resource, src_stages, src_access, use.stages, use.access, old_layout,
+                                    use.layout});
+            state.layout = use.layout;
+        }
+    }
+
+    RenderBarrierBatch &final_batch = batches[order.size()];
+    for (unsigned long i = 0; i < resources.size(); ++i)
+    {
+        const Resource &resource = resources[i];
+        if (resource.kind != ResourceKind::IMPORTED_IMAGE || resource.import.final_layout == VK_IMAGE_LAYOUT_UNDEFINED)
+        {
+            continue;
+        }
+        const ResourceState &state = states[i];
+        final_batch.images.push_back({static_cast<RenderResource>(i), state.write_stages | state.read_stages,
+                                      state.write_access, resource.import.final_stages, resource.import.final_access,
+                                      state.layout, resource.import.final_layout});
+    }
+    return true;
+}
+
+bool RenderGraph::compile() noexcept
+{
+    for (const Pass &pass : passes)
+    {
+        if (pass.invalid)
+        {
+            Log::warn(Log::Module::VULKAN, "Render pass %s uses an image in two layouts", pass.name);
+            return false;
+        }
+    }
+    cull_passes();
+
+    order.resize(0);
+    for (Resource &resource : resources)
+    {
+        resource.used = false;
+        resource.all_stages = VK_PIPELINE_STAGE_2_NONE;
+        resource.all_write_access = VK_ACCESS_2_NONE;
+    }
+    for (unsigned long i = 0; i < passes.size(); ++i)
+    {
+        if (passes[i].culled)
+        {
+            continue;
+        }
+        for (const Use &use : passes[i].uses)
+        {
+            Resource &resource = resources[use.resource];
+            if (!resource.used)
+            {
+                if (resource.kind == ResourceKind::TRANSIENT_IMAGE && use.reads_contents)
+                {
+                    Log::warn(Log::Module::VULKAN, "Render pass %s reads transient %s before anything writes it",
+                              passes[i].name, resource.name);
+                    return false;
+                }
+                resource.used = true;
+                resource.first_use = order.size();
+            }
+            resource.last_use = order.size();
+            resource.all_stages |= use.stages;
+            resource.all_write_access |= use.write_access;
+        }
+        order.push_back(static_cast<RenderPass>(i));
+    }
+    place_transients();
+    return plan_barriers();
+}
+
+bool RenderGraph::build(const Device *device) noexcept
+{
+    destroy_transients();
+    allocator = device->get_allocator();
+    const VkDevice vk_device = volkGetLoadedDevice();
+    for (Resource &resource : resources)
+    {
+        if (resource.kind != ResourceKind::TRANSIENT_IMAGE)
+        {
+            continue;
+        }
+        VkImageCreateInfo image_info{};
+        image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        image_info.imageType = VK_IMAGE_TYPE_2D;
+        image_info.format = resource.transient.format;
+        image_info.extent = {resource.transient.width, resource.transient.height, 1};
+        image_info.mipLevels = 1;
+        image_info.arrayLayers = 1;
+        image_info.samples = VK_SAMPLE_COUNT_1_BIT;
+        image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+        image_info.usage = resource.transient.usage;
+        image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        if (vkCreateImage(vk_device, &image_info, &callbacks, &resource.image) != VK_SUCCESS)
+        {
+            Log::fatal("Failed to create transient image %s", resource.name);
+        }
+        VkMemoryRequirements requirements;
+        vkGetImageMemoryRequirements(vk_device, resource.image, &requirements);
+        resource.memory_size = requirements.size;
+        resource.memory_alignment = requirements.alignment;
+        resource.memory_type_bits = requirements.memoryTypeBits;
+    }
+    if (!compile())
+    {
+        destroy_transients();
+        return false;
+    }
+
+    AllocationRequest request;
+    request.size = transient_bytes;
+    request.optimal_image = true;
+    request.dedicated = true;
+    for (Resource &resource : resources)
+    {
+        if (resource.kind != ResourceKind::TRANSIENT_IMAGE)
+        {
+            continue;
+        }
+        if (!resource.used)
+        {
+            vkDestroyImage(vk_device, resource.image, &callbacks);
+            resource.image = VK_NULL_HANDLE;
+            continue;
+        }
+        request.alignment = Utils::max(request.alignment, resource.memory_alignment);
+        request.type_bits &= resource.memory_type_bits;
+    }
+    if (transient_bytes == 0)
+    {
+        return true;
+    }
+    transient_memory = allocator->allocate(request);
+    if (!transient_memory.is_valid())
+    {
+        Log::fatal("Failed to allocate %llu KB for transient images", transient_bytes >> 10);
+    }
+    for (Resource &resource : resources)
+    {
+        if (resource.kind != ResourceKind::TRANSIENT_IMAGE || !resource.used)
+        {
+            continue;
+        }
+        vkBindImageMemory(vk_device, resource.image, to_vk_memory(transient_memory),
+                          transient_memory.offset + resource.memory_offset);
+        VkImageViewCreateInfo view_info{};
+        view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        view_info.image = resource.image;
+        view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        view_info.format = resource.transient.format;
+        view_info.subresourceRange.aspectMask = resource.transient.aspect;
+        view_info.subresourceRange.levelCount = 1;
+        view_info.subresourceRange.layerCount = 1;
+        if (vkCreateImageView(vk_device, &view_info, &callbacks, &resource.view) != VK_SUCCESS)
+        {
+            Log::fatal("Failed to create transient image %s view", resource.name);
+        }
+    }
+    Log::info(Log::Module::VULKAN, "Render graph: %lu of %lu passes kept, transient images in %llu KB of %llu KB",
+              order.size(), passes.size(), transient_bytes >> 10, unaliased_bytes >> 10);
+    return true;
+}
+
+void RenderGraph::destroy_transients() noexcept
+{
+    const VkDevice vk_device = allocator != nullptr ? volkGetLoadedDevice() : VK_NULL_HANDLE;
+    for (Resource &resource : resources)
+    {
+        if (resource.kind != ResourceKind::TRANSIENT_IMAGE)
+        {
+            continue;
+        }
+        if (resource.view != VK_NULL_HANDLE)
+        {
+            vkDestroyImageView(vk_device, resource.view, &callbacks);
+            resource.view = VK_NULL_HANDLE;
+        }
+        if (resource.image != VK_NULL_HANDLE)
+        {
+            vkDestroyImage(vk_device, resource.image, &callbacks);
+            resource.image = VK_NULL_HANDLE;
+        }
+    }
+    if (transient_memory.is_valid())
+    {
+        allocator->free(transient_memory);
+    }
+}
+
+void RenderGraph::set_image(RenderResource resource, VkImage image, VkImageView view) noexcept
+{
+    resources[resource].image = image;
+    resources[resource].view = view;
+}
+
+void RenderGraph::set_buffer(RenderResource resource, VkBuffer buffer) noexcept
+{
+    resources[resource].buffer = buffer;
+}
+
+void RenderGraph::execute(CommandBuffer &command_buffer) noexcept
+{
+    for (unsigned long i = 0; i <= order.size(); ++i)
+    {
+        const RenderBarrierBatch &batch = batches[i];
+        if (!batch.empty())
+        {
+            image_barriers.resize(batch.images.size());
+            for (unsigned long j = 0; j < batch.images.size(); ++j)
+            {
+                const RenderImageBarrier &planned = batch.images[j];
+                const Resource &resource = resources[planned.resource];
+                VkImageMemoryBarrier2 &barrier = image_barriers[j];
+                barrier = {};
+                barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+                barrier.srcStageMask = planned.src_stages;
+                barrier.srcAccessMask = planned.src_access;
+                barrier.dstStageMask = planned.dst_stages;
+                barrier.dstAccessMask = planned.dst_access;
+                barrier.oldLayout = planned.old_layout;
+                barrier.newLayout = planned.new_layout;
+                barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                barrier.image = resource.image;
+                barrier.subresourceRange.aspectMask = resource.kind == ResourceKind::TRANSIENT_IMAGE
+                                                          ? resource.transient.aspect
+                                                          : resource.import.aspect;
+                barrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+                barrier.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+            }
+            VkMemoryBarrier2 memory_barrier{};
+            memory_barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+            memory_barrier.srcStageMask = batch.memory_src_stages;
+            memory_barrier.srcAccessMask = batch.memory_src_access;
+            memory_barrier.dstStageMask = batch.memory_dst_stages;
+            memory_barrier.dstAccessMask = batch.memory_dst_access;
+
+            VkDependencyInfo dependency_info{};
+            dependency_info.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+            dependency_info.memoryBarrierCount = batch.memory_dst_stages != VK_PIPELINE_STAGE_2_NONE ? 1 : 0;
+            dependency_info.pMemoryBarriers = &memory_barrier;
+            dependency_info.imageMemoryBarrierCount = static_cast<uint32_t>(batch.images.size());
+            dependency_info.pImageMemoryBarriers = image_barriers.data();
+            command_buffer.pipelineBarrier2(&dependency_info);
+        }
+        if (i < order.size())
+        {
+            const Pass &pass = passes[order[i]];
+            pass.record(command_buffer, *this, pass.user);
+        }
+    }
+}
+} // namespace LunaVoxelEngine::Renderer
@@ -0,0 +1,288 @@
+#ifndef VK_RENDER_GRAPH_H
+#define VK_RENDER_GRAPH_H
+#include <renderer/vulkan/cmd_buffer.h>
+#include <renderer/vulkan/device.h>
+#include <renderer/vulkan/gpu_allocator.h>
+#include <renderer/vulkan/ivulkan.h>
+#include <utils/vector.h>
+
+namespace LunaVoxelEngine::Renderer
+{
+/// A resource added to a RenderGraph, numbered in the order it was added.
+using RenderResource = uint32_t;
+/// A pass added to a RenderGraph, numbered in the order it was added.
+using RenderPass = uint32_t;
+constexpr uint32_t INVALID_RENDER_RESOURCE = UINT32_MAX;
+
+/**
+ * @brief How a pass uses a resource. Attachment writes that do not say READ_WRITE clear or overwrite the whole
+ *        attachment, so what was there before is not needed.
+ */
+enum class RenderAccess : unsigned char
+{
+    COLOR_ATTACHMENT_WRITE,
+    COLOR_ATTACHMENT_READ_WRITE,
+    DEPTH_ATTACHMENT_WRITE,
+    DEPTH_ATTACHMENT_READ_WRITE,
+    SAMPLED_FRAGMENT,
+    SAMPLED_COMPUTE,
+    STORAGE_READ_COMPUTE,
+    STORAGE_WRITE_COMPUTE,
+    STORAGE_READ_WRITE_COMPUTE,
+    INDIRECT_READ,
+    TRANSFER_READ,
+    TRANSFER_WRITE,
+    COUNT
+};
+
+/**
+ * @brief The synchronisation an access needs: where it happens, what it does and, for images, the layout it needs.
+ */
+struct RenderAccessInfo
+{
+    VkPipelineStageFlags2 stages;
+    VkAccessFlags2 access;
+    VkAccessFlags2 write_access; ///< The part of access that writes; 0 for reads.
+    VkImageLayout layout;
+    bool reads_contents; ///< Whether the access needs what earlier passes left in the resource.
+};
+
+[[nodiscard]] const RenderAccessInfo &get_render_access_info(RenderAccess access) noexcept;
+
+/**
+ * @brief The state an imported image is in before the graph runs, and the one it must be left in.
+ */
+struct ImportedImage
+{
+    VkImageAspectFlags aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+    VkImageLayout initial_layout = VK_IMAGE_LAYOUT_UNDEFINED; ///< UNDEFINED discards the contents.
+    /// Work that must finish before the first use: the last frame's use, or a semaphore wait's stage.
+    VkPipelineStageFlags2 initial_stages = VK_PIPELINE_STAGE_2_NONE;
+    VkAccessFlags2 initial_write_access = VK_ACCESS_2_NONE;
+    /// Left in the last layout used if UNDEFINED, with no barrier after the last pass.
+    VkImageLayout final_layout = VK_IMAGE_LAYOUT_UNDEFINED;
+    VkPipelineStageFlags2 final_stages = VK_PIPELINE_STAGE_2_NONE;
+    VkAccessFlags2 final_access = VK_ACCESS_2_NONE;
+    /// Whether something after the graph reads the image, so the passes writing it are kept.
+    bool output = false;
+};
+
+/**
+ * @brief A 2D image the graph creates for itself and that lives only within a frame.
+ */
+struct TransientImage
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    VkImageUsageFlags usage = 0;
+    VkImageAspectFlags aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+};
+
+/**
+ * @brief One image barrier the graph records; resource is resolved to a VkImage when it runs.
+ */
+struct RenderImageBarrier
+{
+    RenderResource resource;
+    VkPipelineStageFlags2 src_stages;
+    VkAccessFlags2 src_access;
+    VkPipelineStageFlags2 dst_stages;
+    VkAccessFlags2 dst_access;
+    VkImageLayout old_layout;
+    VkImageLayout new_layout;
+};
+
+/**
+ * @brief Everything recorded in one vkCmdPipelineBarrier2: buffer hazards merged into a single global memory
+ *        barrier, and one barrier per image that needs one.
+ */
+struct RenderBarrierBatch
+{
+    Utils::Vector<RenderImageBarrier> images;
+    VkPipelineStageFlags2 memory_src_stages = VK_PIPELINE_STAGE_2_NONE;
+    VkAccessFlags2 memory_src_access = VK_ACCESS_2_NONE;
+    VkPipelineStageFlags2 memory_dst_stages = VK_PIPELINE_STAGE_2_NONE;
+    VkAccessFlags2 memory_dst_access = VK_ACCESS_2_NONE;
+
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return images.size() == 0 && memory_dst_stages == VK_PIPELINE_STAGE_2_NONE;
+    }
+};
+
+/**
+ * @class RenderGraph
+ * @brief The passes of a frame and the resources they use, from which the barriers between them are worked out.
+ * @details Passes are added in the order they run, each declaring what it reads and writes. compile() then:
+ *          - culls passes whose writes nothing later reads, unless they have side effects outside the graph;
+ *          - works out, for each pass kept, the fewest barriers that make it safe, batched into one
+ *            vkCmdPipelineBarrier2. Reads after reads need nothing, and layouts change only when a use needs it;
+ *          - places transient images in one block of memory, overlapping those whose lifetimes do not.
+ *
+ * compile() only touches the CPU-side description, so a graph can be checked without a device. build() creates
+ * the transient images and compiles; execute() then records the passes and barriers every frame. Imported
+ * resources keep their ids across frames, and set_image() or set_buffer() points them at this frame's handles.
+ * @warning Not thread-safe.
+ */
+class [[nodiscard]] RenderGraph final
+{
+  public:
+    /// Records a pass's commands. The graph has recorded the barriers it needs.
+    using RecordFunction = void (*)(CommandBuffer &command_buffer, const RenderGraph &graph, void *user);
+
+    RenderGraph() = default;
+    ~RenderGraph();
+    RenderGraph(const RenderGraph &) = delete;
+    RenderGraph &operator=(const RenderGraph &) = delete;
+
+    RenderResource import_image(const char *name, const ImportedImage &import) noexcept;
+    /**
+     * @brief Adds a buffer the graph does not own; buffers keep their contents and are always in a usable state.
+     */
+    RenderResource import_buffer(const char *name) noexcept;
+    RenderResource add_transient_image(const char *name, const TransientImage &image) noexcept;
+    /**
+     * @brief Sets how much memory a transient image needs. build() does this itself; graphs compiled without a
+     *        device set it by hand.
+     */
+    void set_memory_requirements(RenderResource resource, unsigned long long size,
+                                 unsigned long long alignment) noexcept;
+
+    /**
+     * @param side_effects Whether the pass does something the graph cannot see, so it is never culled.
+     */
+    RenderPass add_pass(const char *name, RecordFunction record, void *user, bool side_effects = false) noexcept;
+    /**
+     * @brief Declares that pass uses resource. A pass may use a resource several ways, but in one image layout.
+     */
+    void use(RenderPass pass, RenderResource resource, RenderAccess access) noexcept;
+
+    /**
+     * @brief Culls passes, works out barriers and places transient images. Pure CPU work.
+     * @return False, after a warning, if the graph is invalid: a transient read before it is written, or a pass
+     *         using an image in two layouts.
+     */
+    [[nodiscard]] bool compile() noexcept;
+    /**
+     * @brief Creates the transient images, compiles, and binds the images kept to one allocation.
+     * @return False if compile() failed; the device running out of memory is fatal.
+     */
+    [[nodiscard]] bool build(const Device *device) noexcept;
+    /**
+     * @brief Records every pass kept, each after its barriers, then the barriers into the final layouts.
+     */
+    void execute(CommandBuffer &command_buffer) noexcept;
+
+    void set_image(RenderResource resource, VkImage image, VkImageView view) noexcept;
+    void set_buffer(RenderResource resource, VkBuffer buffer) noexcept;
+    [[nodiscard]] VkImage get_image(RenderResource resource) const noexcept
+    {
+        return resources[resource].image;
+    }
+    [[nodiscard]] VkImageView get_image_view(RenderResource resource) const noexcept
+    {
+        return resources[resource].view;
+    }
+
+    /// The passes compile() kept, in the order they run.
+    [[nodiscard]] const Utils::Vector<RenderPass> &get_pass_order() const noexcept
+    {
+        return order;
+    }
+    /// The barriers recorded before get_pass_order()[index]; index == its size gives the final barriers.
+    [[nodiscard]] const RenderBarrierBatch &get_barriers(unsigned long index) const noexcept
+    {
+        return batches[index];
+    }
+    [[nodiscard]] bool is_culled(RenderPass pass) const noexcept
+    {
+        return passes[pass].culled;
+    }
+    /// Offset of a transient image in the shared allocation.
+    [[nodiscard]] unsigned long long get_memory_offset(RenderResource resource) const noexcept
+    {
+        return resources[resource].memory_offset;
+    }
+    /// Size of the allocation every transient image kept shares.
+    [[nodiscard]] unsigned long long get_transient_bytes() const noexcept
+    {
+        return transient_bytes;
+    }
+    /// What the transient images kept would take without aliasing.
+    [[nodiscard]] unsigned long long get_unaliased_bytes() const noexcept
+    {
+        return unaliased_bytes;
+    }
+
+  private:
+    enum class ResourceKind : unsigned char
+    {
+        IMPORTED_IMAGE,
+        IMPORTED_BUFFER,
+        TRANSIENT_IMAGE
+    };
+
+    struct Resource
+    {
+        const char *name;
+        ResourceKind kind;
+        ImportedImage import;
+        TransientImage transient;
+        unsigned long long memory_size = 0;
+        unsigned long long memory_alignment = 1;
+        unsigned int memory_type_bits = ~0u;
+        unsigned long long memory_offset = 0;
+        unsigned long first_use = 0; ///< Index into order of the first pass kept using it.
+        unsigned long last_use = 0;
+        bool used = false;
+        VkPipelineStageFlags2 all_stages = VK_PIPELINE_STAGE_2_NONE; ///< Every stage the frame uses it in.
+        VkAccessFlags2 all_write_access = VK_ACCESS_2_NONE;
+        VkImage image = VK_NULL_HANDLE;
+        VkImageView view = VK_NULL_HANDLE;
+        VkBuffer buffer = VK_NULL_HANDLE;
+    };
+
+    /// One pass's uses of one resource, merged.
+    struct Use
+    {
+        RenderResource resource;
+        VkPipelineStageFlags2 stages;
+        VkAccessFlags2 access;
+        VkAccessFlags2 write_access;
+        VkImageLayout layout;
+        bool reads_contents;
+    };
+
+    struct Pass
+    {
+        const char *name;
+        RecordFunction record;
+        void *user;
+        bool side_effects;
+        bool culled = false;
+        bool invalid = false; ///< Used an image in two layouts.
+        Utils::Vector<Use> uses;
+    };
+
+    [[nodiscard]] bool is_image(RenderResource resource) const noexcept
+    {
+        return resources[resource].kind != ResourceKind::IMPORTED_BUFFER;
+    }
+    void cull_passes() noexcept;
+    void place_transients() noexcept;
+    [[nodiscard]] bool plan_barriers() noexcept;
+    void destroy_transients() noexcept;
+
+    Utils::Vector<Resource> resources;
+    Utils::Vector<Pass> passes;
+    Utils::Vector<RenderPass> order;
+    Utils::Vector<RenderBarrierBatch> batches;
+    unsigned long long transient_bytes = 0;
+    unsigned long long unaliased_bytes = 0;
+    GpuAllocator *allocator = nullptr;
+    GpuAllocation transient_memory;
+    Utils::Vector<VkImageMemoryBarrier2> image_barriers; ///< Scratch for execute(), kept to avoid reallocating.
+};
+} // namespace LunaVoxelEngine::Renderer
+#endif
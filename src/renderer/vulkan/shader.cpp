@@ -0,0 +1,41 @@
+#include <platform/file.h>
+#include <platform/log.h>
+#include <renderer/vulkan/shader.h>
+extern VkAllocationCallbacks callbacks;
+
+namespace LunaVoxelEngine::Renderer
+{
+namespace
+{
+constexpr unsigned int SPIRV_MAGIC = 0x07230203;
+} // namespace
+
+VkShaderModule load_shader_module(const char *path) noexcept
+{
+    Platform::MappedFile file(path);
+    if (!file.is_open())
+    {
+        Log::warn(Log::Module::VULKAN, "Shader %s not found", path);
+        return VK_NULL_HANDLE;
+    }
+    // Mapped files start on a page boundary, so the words can be read in place.
+    const uint32_t *code = reinterpret_cast<const uint32_t *>(file.data());
+    if (file.size() < sizeof(uint32_t) || file.size() % sizeof(uint32_t) != 0 || code[0] != SPIRV_MAGIC)
+    {
+        Log::warn(Log::Module::VULKAN, "Shader %s is not SPIR-V", path);
+        return VK_NULL_HANDLE;
+    }
+
+    VkShaderModuleCreateInfo module_info{};
+    module_info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    module_info.codeSize = file.size();
+    module_info.pCode = code;
+    VkShaderModule module = VK_NULL_HANDLE;
+    if (vkCreateShaderModule(volkGetLoadedDevice(), &module_info, &callbacks, &module) != VK_SUCCESS)
+    {
+        Log::warn(Log::Module::VULKAN, "Failed to create a shader module from %s", path);
+        return VK_NULL_HANDLE;
+    }
+    return module;
+}
+} // namespace LunaVoxelEngine::Renderer
@@ -0,0 +1,15 @@
+#ifndef VK_SHADER_H
+#define VK_SHADER_H
+#include <renderer/vulkan/ivulkan.h>
+
+namespace LunaVoxelEngine::Renderer
+{
+/**
+ * @brief Creates a shader module from a SPIR-V file. The build compiles assets/<name> to shaders/<name>.spv in the
+ *        build directory.
+ * @return VK_NULL_HANDLE, after a warning, if the file is missing or is not SPIR-V; the caller decides whether it
+ *         can do without the shader.
+ */
+[[nodiscard]] VkShaderModule load_shader_module(const char *path) noexcept;
+} // namespace LunaVoxelEngine::Renderer
+#endif
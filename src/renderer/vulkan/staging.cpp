@@ -0,0 +1,208 @@
+#include <renderer/vulkan/staging.h>
+#include <utils/algorithm.h>
+
+namespace LunaVoxelEngine::Renderer
+{
+StagingRing::StagingRing(unsigned long long capacity_in) noexcept
+{
+    reset(capacity_in);
+}
+
+void StagingRing::reset(unsigned long long capacity_in) noexcept
+{
+    capacity = capacity_in;
+    head = 0;
+    tail = 0;
+    submitted = 0;
+    pending_first = 0;
+    pending_count = 0;
+}
+
+bool StagingRing::allocate(unsigned long long size, unsigned long long alignment, unsigned long long &offset) noexcept
+{
+    if (capacity == 0 || size > capacity)
+    {
+        return false;
+    }
+    unsigned long long start = head % capacity;
+    unsigned long long padding = ((start + alignment - 1) & ~(alignment - 1)) - start;
+    if (start + padding + size > capacity)
+    {
+        // Skip to the start of the buffer, which is always aligned.
+        padding = capacity - start;
+        start = 0;
+    }
+    else
+    {
+        start += padding;
+    }
+    if (head + padding + size - tail > capacity)
+    {
+        return false;
+    }
+    head += padding + size;
+    offset = start;
+    return true;
+}
+
+bool StagingRing::submit(unsigned long long value) noexcept
+{
+    if (head == submitted)
+    {
+        return true;
+    }
+    if (pending_count == MAX_PENDING_SUBMITS)
+    {
+        return false;
+    }
+    pending[(pending_first + pending_count) % MAX_PENDING_SUBMITS] = {head, value};
+    ++pending_count;
+    submitted = head;
+    return true;
+}
+
+void StagingRing::retire(unsigned long long completed) noexcept
+{
+    while (pending_count > 0 && pending[pending_first].value <= completed)
+    {
+        tail = pending[pending_first].end;
+        pending_first = (pending_first + 1) % MAX_PENDING_SUBMITS;
+        --pending_count;
+    }
+}
+
+void UploadBatcher::add(unsigned long long dst, unsigned long long dst_offset, unsigned long long src_offset,
+                        unsigned long long size)
+{
+    uploads.push_back({dst, {src_offset, dst_offset, size}, static_cast<unsigned int>(uploads.size())});
+    upload_bytes += size;
+}
+
+void UploadBatcher::build()
+{
+    regions.resize(0);
+    batches.resize(0);
+    Utils::quicksort(uploads.begin(), uploads.end(), [](const Upload &a, const Upload &b) {
+        if (a.dst != b.dst)
+        {
+            return a.dst < b.dst;
+        }
+        return a.region.dst_offset < b.region.dst_offset ||
+               (a.region.dst_offset == b.region.dst_offset && a.sequence < b.sequence);
+    });
+    unsigned long begin = 0;
+    while (begin < uploads.size())
+    {
+        const unsigned long long dst = uploads[begin].dst;
+        unsigned long long reach = uploads[begin].region.dst_offset + uploads[begin].region.size;
+        bool overlapping = false;
+        unsigned long end = begin + 1;
+        for (; end < uploads.size() && uploads[end].dst == dst; ++end)
+        {
+            const BufferCopyRegion &region = uploads[end].region;
+            overlapping = overlapping || region.dst_offset < reach;
+            reach = Utils::max(reach, region.dst_offset + region.size);
+        }
+
+        batches.push_back({dst, static_cast<unsigned int>(regions.size()), 0});
+        if (overlapping)
+        {
+            resolve_overlaps(begin, end);
+            for (const BufferCopyRegion &region : resolved)
+            {
+                add_region(region);
+            }
+        }
+        else
+        {
+            for (unsigned long i = begin; i < end; ++i)
+            {
+                add_region(uploads[i].region);
+            }
+        }
+        begin = end;
+    }
+}
+
+void UploadBatcher::add_region(const BufferCopyRegion &region)
+{
+    BufferCopyBatch &batch = batches[batches.size() - 1];
+    if (batch.region_count > 0)
+    {
+        BufferCopyRegion &last = regions[regions.size() - 1];
+        if (last.dst_offset + last.size == region.dst_offset && last.src_offset + last.size == region.src_offset)
+        {
+            last.size += region.size;
+            return;
+        }
+    }
+    regions.push_back(region);
+    ++batch.region_count;
+}
+
+void UploadBatcher::resolve_overlaps(unsigned long begin, unsigned long end)
+{
+    resolved.resize(0);
+    covered.resize(0);
+    // Latest first, so each upload keeps only the bytes no later one writes. Rare enough that quadratic is fine.
+    Utils::quicksort(uploads.begin() + begin, uploads.begin() + end,
+                     [](const Upload &a, const Upload &b) { return a.sequence > b.sequence; });
+    for (unsigned long i = begin; i < end; ++i)
+    {
+        const BufferCopyRegion &upload = uploads[i].region;
+        const unsigned long long upload_end = upload.dst_offset + upload.size;
+        unsigned long long cursor = upload.dst_offset;
+        for (const BufferCopyRegion &later : covered)
+        {
+            if (later.dst_offset >= upload_end)
+            {
+                break;
+            }
+            if (later.dst_offset > cursor)
+            {
+                resolved.push_back(
+                    {upload.src_offset + (cursor - upload.dst_offset), cursor, later.dst_offset - cursor});
+            }
+            cursor = Utils::max(cursor, later.dst_offset + later.size);
+        }
+        if (cursor < upload_end)
+        {
+            resolved.push_back({upload.src_offset + (cursor - upload.dst_offset), cursor, upload_end - cursor});
+        }
+
+        // Keep covered sorted and disjoint: add this upload's range and merge it with the ones it touches.
+        covered.push_back(upload);
+        Utils::quicksort(covered.begin(), covered.end(), [](const BufferCopyRegion &a, const BufferCopyRegion &b) {
+            return a.dst_offset < b.dst_offset;
+        });
+        unsigned long merged = 0;
+        for (unsigned long j = 1; j < covered.size(); ++j)
+        {
+            BufferCopyRegion &last = covered[merged];
+            if (covered[j].dst_offset <= last.dst_offset + last.size)
+            {
+                const unsigned long long last_end =
+                    Utils::max(last.dst_offset + last.size, covered[j].dst_offset + covered[j].size);
+                last.size = last_end - last.dst_offset;
+            }
+            else
+            {
+                covered[++merged] = covered[j];
+            }
+        }
+        covered.resize(merged + 1);
+    }
+    Utils::quicksort(resolved.begin(), resolved.end(), [](const BufferCopyRegion &a, const BufferCopyRegion &b) {
+        return a.dst_offset < b.dst_offset;
+    });
+}
+
+void UploadBatcher::clear() noexcept
+{
+    // resize(0) rather than clear(), which frees: the same vectors are refilled every frame.
+    uploads.resize(0);
+    regions.resize(0);
+    batches.resize(0);
+    upload_bytes = 0;
+}
+} // namespace LunaVoxelEngine::Renderer
@@ -0,0 +1,159 @@
+#ifndef VK_STAGING_H
+#define VK_STAGING_H
+#include <utils/vector.h>
+
+// The bookkeeping half of uploads, free of Vulkan: submissions are identified by values on a timeline that only
+// grows, so a test can drive it with a simulated timeline and no GPU.
+namespace LunaVoxelEngine::Renderer
+{
+/**
+ * @class StagingRing
+ * @brief Hands out space in a persistently mapped staging buffer in order, and takes it back once the GPU has
+ *        finished the submission that read it.
+ * @details Space is allocated at the head and retired from the tail, so allocation is a pointer bump and there
+ *          is no fragmentation. An allocation never wraps: one that would cross the end of the buffer starts
+ *          again at offset 0, and the skipped bytes are retired with it.
+ * @warning Not thread-safe.
+ */
+class StagingRing final
+{
+  public:
+    static constexpr unsigned int MAX_PENDING_SUBMITS = 16;
+
+    explicit StagingRing(unsigned long long capacity = 0) noexcept;
+
+    void reset(unsigned long long capacity) noexcept;
+
+    /**
+     * @param alignment A power of two.
+     * @param offset Set to the allocation's offset in the buffer.
+     * @return false if the space still in use by the GPU leaves no room; retire() and try again later. Always false
+     *         for a ring with no capacity.
+     */
+    [[nodiscard]] bool allocate(unsigned long long size, unsigned long long alignment,
+                                unsigned long long &offset) noexcept;
+
+    /**
+     * @brief Closes the space allocated since the last submit; it is retired once value has completed.
+     * @param value Larger than any value submitted before.
+     * @return false if MAX_PENDING_SUBMITS are already pending; wait for one and retire it first.
+     */
+    bool submit(unsigned long long value) noexcept;
+
+    /**
+     * @brief Frees the space of every submission whose value is at most completed.
+     */
+    void retire(unsigned long long completed) noexcept;
+
+    [[nodiscard]] unsigned long long get_capacity() const noexcept
+    {
+        return capacity;
+    }
+    /// Bytes allocated and not yet retired, padding included.
+    [[nodiscard]] unsigned long long get_used() const noexcept
+    {
+        return head - tail;
+    }
+    [[nodiscard]] unsigned int get_pending_submits() const noexcept
+    {
+        return pending_count;
+    }
+    /// The value of the oldest submission not yet retired; only meaningful if get_pending_submits() > 0.
+    [[nodiscard]] unsigned long long get_oldest_pending() const noexcept
+    {
+        return pending[pending_first].value;
+    }
+
+  private:
+    struct Pending
+    {
+        unsigned long long end; ///< head when the submission was closed.
+        unsigned long long value;
+    };
+
+    unsigned long long capacity = 0;
+    unsigned long long head = 0; ///< Bytes ever allocated; the next allocation starts at head % capacity.
+    unsigned long long tail = 0; ///< Bytes ever retired.
+    unsigned long long submitted = 0; ///< head at the last submit.
+    Pending pending[MAX_PENDING_SUBMITS];
+    unsigned int pending_first = 0;
+    unsigned int pending_count = 0;
+};
+
+/// One copy from the staging buffer into a destination buffer.
+struct BufferCopyRegion
+{
+    unsigned long long src_offset;
+    unsigned long long dst_offset;
+    unsigned long long size;
+};
+
+/// The regions of one copy command: regions[first_region, first_region + region_count) all go to dst.
+struct BufferCopyBatch
+{
+    unsigned long long dst;
+    unsigned int first_region;
+    unsigned int region_count;
+};
+
+/**
+ * @class UploadBatcher
+ * @brief Collects many small uploads and turns them into one copy command per destination buffer.
+ * @details Uploads are sorted by destination and offset, and neighbours that are contiguous in both the staging
+ *          buffer and the destination merge into a single region. Where uploads to one destination overlap, the
+ *          one added last wins and the others are trimmed to the bytes it leaves, as if they had been copied in
+ *          order; the regions of a copy command never overlap, since their order of execution is undefined.
+ *          Destinations are opaque handles; on Vulkan they are VkBuffers.
+ */
+class UploadBatcher final
+{
+  public:
+    void add(unsigned long long dst, unsigned long long dst_offset, unsigned long long src_offset,
+             unsigned long long size);
+
+    /**
+     * @brief Sorts and merges everything added since the last clear() into get_batches() and get_regions().
+     */
+    void build();
+    void clear() noexcept;
+
+    [[nodiscard]] const Utils::Vector<BufferCopyBatch> &get_batches() const noexcept
+    {
+        return batches;
+    }
+    [[nodiscard]] const Utils::Vector<BufferCopyRegion> &get_regions() const noexcept
+    {
+        return regions;
+    }
+    [[nodiscard]] unsigned long get_upload_count() const noexcept
+    {
+        return uploads.size();
+    }
+    [[nodiscard]] unsigned long long get_upload_bytes() const noexcept
+    {
+        return upload_bytes;
+    }
+
+  private:
+    struct Upload
+    {
+        unsigned long long dst;
+        BufferCopyRegion region;
+        unsigned int sequence; ///< Order of add(), which decides overlaps.
+    };
+
+    Utils::Vector<Upload> uploads;
+    Utils::Vector<BufferCopyRegion> regions;
+    Utils::Vector<BufferCopyBatch> batches;
+    /// Scratch for resolve_overlaps(): what survives of each upload, and the bytes later uploads cover.
+    Utils::Vector<BufferCopyRegion> resolved;
+    Utils::Vector<BufferCopyRegion> covered;
+    unsigned long long upload_bytes = 0;
+
+    /// Appends region to the last batch, merging it into the previous region where both sides are contiguous.
+    void add_region(const BufferCopyRegion &region);
+    /// Fills resolved, sorted by offset, with what survives of uploads[begin, end), which share a destination.
+    void resolve_overlaps(unsigned long begin, unsigned long end);
+};
+} // namespace LunaVoxelEngine::Renderer
+#endif
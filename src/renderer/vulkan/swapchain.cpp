@@ -202,7 +202,8 @@ namespace LunaVoxelEngine
 {
 namespace Renderer
 {
-SwapChain::SwapChain(const Device *device, Platform::NativeWindow native_window)
+SwapChain::SwapChain(const Device *device, Platform::NativeWindow native_window,
+                     VkPresentModeKHR preferred_present_mode)
 {
 #if defined(ON_WINDOWS) || defined(ON_XBOX)
     VkWin32SurfaceCreateInfoKHR create_info = {};
@@ -213,7 +214,7 @@ SwapChain::SwapChain(const Device *device, Platform::NativeWindow native_window)
     if (auto result = vkCreateWin32SurfaceKHR(volkGetLoadedInstance(), &create_info, &callbacks, &surface);
         result != VK_SUCCESS)
     {
-        Log::error("Failed to create win32 surface %s", string_VkResult(result));
+        Log::error(Log::Module::VULKAN, "Failed to create win32 surface %s", string_VkResult(result));
     }
 #endif
 #if defined(ON_ANDROID)
@@ -229,7 +230,7 @@ SwapChain::SwapChain(const Device *device, Platform::NativeWindow native_window)
     if (auto result = vkCreateAndroidSurfaceKHR(volkGetLoadedInstance(), &create_info, &callbacks, &surface);
         result != VK_SUCCESS)
     {
-        Log::error("Failed to create android surface");
+        Log::error(Log::Module::VULKAN, "Failed to create android surface");
     }
 #endif
 #if defined(ON_LINUX)
@@ -242,7 +243,7 @@ SwapChain::SwapChain(const Device *device, Platform::NativeWindow native_window)
     if (auto result = vkCreateWaylandSurfaceKHR(volkGetLoadedInstance(), &create_info, &callbacks, &surface);
         result != VK_SUCCESS)
     {
-        Log::error("Failed to create wayland surface %s", string_VkResult(result));
+        Log::error(Log::Module::VULKAN, "Failed to create wayland surface %s", string_VkResult(result));
     }
 #    else
     VkXcbSurfaceCreateInfoKHR create_info = {};
@@ -253,7 +254,7 @@ SwapChain::SwapChain(const Device *device, Platform::NativeWindow native_window)
     if (auto result = vkCreateXcbSurfaceKHR(volkGetLoadedInstance(), &create_info, &callbacks, &surface);
         result != VK_SUCCESS)
     {
-        Log::error("Failed to create xcb surface");
+        Log::error(Log::Module::VULKAN, "Failed to create xcb surface");
     }
 #    endif
 #endif
@@ -282,7 +283,7 @@ SwapChain::SwapChain(const Device *device, Platform::NativeWindow native_window)
     auto chose_present_mode = [&]() {
         for (uint32_t i = 0; i < present_mode_count; i++)
         {
-            if (present_modes[i] == VK_PRESENT_MODE_MAILBOX_KHR)
+            if (present_modes[i] == preferred_present_mode)
             {
                 return present_modes[i];
             }
@@ -296,7 +297,7 @@ SwapChain::SwapChain(const Device *device, Platform::NativeWindow native_window)
     if (auto result = create_swap_chain(device, &swap_chain, surface, image_format, present_mode, &extent);
         result != VK_SUCCESS)
     {
-        Log::error("Failed to create swapchain %s", string_VkResult(result));
+        Log::error(Log::Module::VULKAN, "Failed to create swapchain %s", string_VkResult(result));
     }
     create_image_views(swap_chain, image_format, &images, &image_views);
 }
@@ -15,8 +15,10 @@ class [[nodiscard]] SwapChain final
   public:
     /*@brief Constructor *@details Creates a new swap chain with the given device and native window
      *@param[in] device The Vulkan device *@param[in] native_window The native window
+     *@param[in] preferred_present_mode Used if the surface supports it, otherwise FIFO, which all surfaces do
      */
-    SwapChain(const Device *device, Platform::NativeWindow native_window);
+    SwapChain(const Device *device, Platform::NativeWindow native_window,
+              VkPresentModeKHR preferred_present_mode = VK_PRESENT_MODE_MAILBOX_KHR);
     void resize(const Device *device);
     ~SwapChain();
 
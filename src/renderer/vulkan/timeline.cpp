@@ -0,0 +1,99 @@
+#include <platform/log.h>
+#include <renderer/vulkan/timeline.h>
+#include <utils/algorithm.h>
+extern VkAllocationCallbacks callbacks;
+
+namespace LunaVoxelEngine::Renderer
+{
+Timeline::Timeline(const char *name_in) : name(name_in)
+{
+    VkSemaphoreTypeCreateInfo type_info{};
+    type_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    type_info.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    type_info.initialValue = 0;
+    VkSemaphoreCreateInfo semaphore_info{};
+    semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphore_info.pNext = &type_info;
+    if (vkCreateSemaphore(volkGetLoadedDevice(), &semaphore_info, &callbacks, &semaphore) != VK_SUCCESS)
+    {
+        Log::fatal("Failed to create the %s timeline semaphore", name);
+    }
+}
+
+Timeline::~Timeline()
+{
+    deletions.flush();
+    vkDestroySemaphore(volkGetLoadedDevice(), semaphore, &callbacks);
+}
+
+unsigned long long Timeline::submit(Queue &queue, VkSubmitInfo2 &submit_info, VkPipelineStageFlags2 stages) noexcept
+{
+    if (submit_info.signalSemaphoreInfoCount > MAX_SIGNALS)
+    {
+        Log::fatal("A %s submission signals %u semaphores; at most %u fit beside the timeline", name,
+                   submit_info.signalSemaphoreInfoCount, MAX_SIGNALS);
+    }
+    VkSemaphoreSubmitInfo signal_infos[MAX_SIGNALS + 1];
+    for (uint32_t i = 0; i < submit_info.signalSemaphoreInfoCount; ++i)
+    {
+        signal_infos[i] = submit_info.pSignalSemaphoreInfos[i];
+    }
+    const unsigned long long point = last_submitted + 1;
+    VkSemaphoreSubmitInfo &timeline_info = signal_infos[submit_info.signalSemaphoreInfoCount];
+    timeline_info = {};
+    timeline_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+    timeline_info.semaphore = semaphore;
+    timeline_info.value = point;
+    timeline_info.stageMask = stages;
+
+    VkSubmitInfo2 timeline_submit = submit_info;
+    timeline_submit.signalSemaphoreInfoCount = submit_info.signalSemaphoreInfoCount + 1;
+    timeline_submit.pSignalSemaphoreInfos = signal_infos;
+    if (queue.submit2(timeline_submit) != VK_SUCCESS)
+    {
+        Log::fatal("Failed to submit to the %s queue", name);
+    }
+    last_submitted = point;
+    return point;
+}
+
+unsigned long long Timeline::get_completed() noexcept
+{
+    uint64_t value;
+    if (vkGetSemaphoreCounterValue(volkGetLoadedDevice(), semaphore, &value) != VK_SUCCESS)
+    {
+        Log::fatal("Failed to read the %s timeline; the device was probably lost", name);
+    }
+    completed = Utils::max(completed, static_cast<unsigned long long>(value));
+    return completed;
+}
+
+void Timeline::wait(unsigned long long point) noexcept
+{
+    if (point <= completed)
+    {
+        return;
+    }
+    const uint64_t value = point;
+    VkSemaphoreWaitInfo semaphore_wait{};
+    semaphore_wait.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    semaphore_wait.semaphoreCount = 1;
+    semaphore_wait.pSemaphores = &semaphore;
+    semaphore_wait.pValues = &value;
+    if (vkWaitSemaphores(volkGetLoadedDevice(), &semaphore_wait, UINT64_MAX) != VK_SUCCESS)
+    {
+        Log::fatal("Failed to wait for the %s timeline; the device was probably lost", name);
+    }
+    completed = point;
+}
+
+VkSemaphoreSubmitInfo Timeline::wait_info(unsigned long long point, VkPipelineStageFlags2 stages) const noexcept
+{
+    VkSemaphoreSubmitInfo info{};
+    info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+    info.semaphore = semaphore;
+    info.value = point;
+    info.stageMask = stages;
+    return info;
+}
+} // namespace LunaVoxelEngine::Renderer
@@ -0,0 +1,121 @@
+#ifndef VK_TIMELINE_H
+#define VK_TIMELINE_H
+#include <renderer/vulkan/deletion_queue.h>
+#include <renderer/vulkan/ivulkan.h>
+#include <renderer/vulkan/queue.h>
+
+namespace LunaVoxelEngine::Renderer
+{
+/**
+ * @class Timeline
+ * @brief The submissions to one queue, numbered by a timeline semaphore that each of them signals in turn.
+ * @details submit() adds a signal of the next point to a submission and returns the point, so the CPU can wait on
+ *          any submission, and other queues can wait on it with wait_info(), without a fence or binary semaphore
+ *          per submission. Point 0 is where the timeline starts and counts as complete.
+ *
+ * Resources the GPU may still be using are handed to defer(), which destroys them from collect() once the
+ * submissions recorded so far have completed. Binary semaphores are still needed for the swapchain, which cannot
+ * wait on or signal a timeline.
+ * @warning Not thread-safe.
+ */
+class [[nodiscard]] Timeline final
+{
+  public:
+    /// Signals a submission may carry besides the timeline's own.
+    static constexpr unsigned int MAX_SIGNALS = 3;
+
+    /**
+     * @param name Which queue it is, for messages.
+     */
+    explicit Timeline(const char *name);
+    /// Destroys every deferred resource, so the device must be idle.
+    ~Timeline();
+    Timeline(const Timeline &) = delete;
+    Timeline &operator=(const Timeline &) = delete;
+
+    /**
+     * @brief Submits submit_info to queue with a signal of the next point added once stages have finished.
+     * @return The point, which is reached when the submission completes.
+     */
+    unsigned long long submit(Queue &queue, VkSubmitInfo2 &submit_info,
+                              VkPipelineStageFlags2 stages = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT) noexcept;
+
+    /**
+     * @brief Asks the semaphore which point the queue has reached.
+     */
+    [[nodiscard]] unsigned long long get_completed() noexcept;
+    [[nodiscard]] bool is_complete(unsigned long long point) noexcept
+    {
+        return point <= completed || point <= get_completed();
+    }
+    /**
+     * @brief Blocks until point is reached; the device being lost is fatal.
+     */
+    void wait(unsigned long long point) noexcept;
+    /**
+     * @brief What a submission to another queue waits on so that stages start after point is reached.
+     */
+    [[nodiscard]] VkSemaphoreSubmitInfo wait_info(unsigned long long point,
+                                                  VkPipelineStageFlags2 stages) const noexcept;
+
+    /**
+     * @brief Destroys object once every submission made so far, and the next one, has completed. Anything
+     *        recorded for the next submission may still use it.
+     */
+    void defer(DeletionQueue::DestroyFunction destroy, void *object, void *user = nullptr) noexcept
+    {
+        deletions.push(last_submitted + 1, destroy, object, user);
+    }
+    /**
+     * @brief Releases index to owner when defer() would destroy an object.
+     */
+    void defer(DeletionQueue::ReleaseFunction release, void *owner, unsigned int index) noexcept
+    {
+        deletions.push(last_submitted + 1, release, owner, index);
+    }
+    /**
+     * @brief Deletes object, which was allocated with new, as defer() would destroy it.
+     */
+    template<typename T> void defer_delete(T *object) noexcept
+    {
+        deletions.push_delete(last_submitted + 1, object);
+    }
+    /**
+     * @brief Destroys the deferred resources whose submissions have completed.
+     * @return How many were destroyed.
+     */
+    unsigned int collect() noexcept
+    {
+        return deletions.retire(get_completed());
+    }
+    /**
+     * @brief Destroys every deferred resource now; only once the device is idle.
+     */
+    void flush() noexcept
+    {
+        deletions.flush();
+    }
+
+    [[nodiscard]] VkSemaphore get_semaphore() const noexcept
+    {
+        return semaphore;
+    }
+    /// The point of the last submit(), or 0 before the first.
+    [[nodiscard]] unsigned long long get_last_submitted() const noexcept
+    {
+        return last_submitted;
+    }
+    [[nodiscard]] const DeletionQueue &get_deletions() const noexcept
+    {
+        return deletions;
+    }
+
+  private:
+    const char *name;
+    VkSemaphore semaphore = VK_NULL_HANDLE;
+    unsigned long long last_submitted = 0;
+    unsigned long long completed = 0; ///< The last point the semaphore was seen to have reached.
+    DeletionQueue deletions;
+};
+} // namespace LunaVoxelEngine::Renderer
+#endif
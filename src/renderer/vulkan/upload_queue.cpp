@@ -0,0 +1,145 @@
+#include <platform/log.h>
+#include <platform/profiler.h>
+#include <renderer/vulkan/upload_queue.h>
+#include <utils/algorithm.h>
+extern VkAllocationCallbacks callbacks;
+
+namespace LunaVoxelEngine::Renderer
+{
+UploadQueue::UploadQueue(const Device *device, unsigned long long staging_bytes, unsigned int frames_in_flight)
+    : staging(device, staging_bytes, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, MemoryUsage::UPLOAD)
+    , staging_memory(static_cast<unsigned char *>(staging.map()))
+    , ring(staging_bytes)
+    , queue(device->get_transfer_family_index())
+    , timeline("upload")
+    , frame_budget(staging_bytes / (frames_in_flight < 1 ? 1 : frames_in_flight))
+{
+    const VkDevice vk_device = volkGetLoadedDevice();
+
+    VkCommandPoolCreateInfo pool_info{};
+    pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    // Slots are re-recorded one at a time while others are still in flight.
+    pool_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    pool_info.queueFamilyIndex = device->get_transfer_family_index();
+    if (vkCreateCommandPool(vk_device, &pool_info, &callbacks, &command_pool) != VK_SUCCESS)
+    {
+        Log::fatal("Failed to create the upload command pool");
+    }
+    for (CommandBuffer *&command_buffer : command_buffers)
+    {
+        command_buffer = new CommandBuffer(command_pool);
+    }
+    Log::debug(Log::Module::VULKAN, "Upload queue: %llu MB staging, %llu MB per frame, %s queue", staging_bytes >> 20,
+               frame_budget >> 20, device->has_transfer_queue() ? "transfer" : "graphics");
+}
+
+UploadQueue::~UploadQueue()
+{
+    for (CommandBuffer *command_buffer : command_buffers)
+    {
+        delete command_buffer;
+    }
+    vkDestroyCommandPool(volkGetLoadedDevice(), command_pool, &callbacks);
+}
+
+void *UploadQueue::upload(const Buffer &dst, VkDeviceSize dst_offset, VkDeviceSize size) noexcept
+{
+    if (frame_bytes + size > frame_budget)
+    {
+        return nullptr;
+    }
+    unsigned long long offset;
+    if (!ring.allocate(size, UPLOAD_ALIGNMENT, offset))
+    {
+        retire_completed();
+        if (!ring.allocate(size, UPLOAD_ALIGNMENT, offset))
+        {
+            return nullptr;
+        }
+    }
+    frame_bytes += size;
+    batcher.add(reinterpret_cast<unsigned long long>(dst.getBuffer()), dst_offset, offset, size);
+    return staging_memory + offset;
+}
+
+bool UploadQueue::upload(const Buffer &dst, VkDeviceSize dst_offset, const void *data, VkDeviceSize size) noexcept
+{
+    void *memory = upload(dst, dst_offset, size);
+    if (memory == nullptr)
+    {
+        return false;
+    }
+    Utils::memcpy(memory, data, size);
+    return true;
+}
+
+void UploadQueue::retire_completed() noexcept
+{
+    ring.retire(timeline.get_completed());
+}
+
+unsigned long long UploadQueue::flush() noexcept
+{
+    LUNA_PROFILE_SCOPE("flush uploads");
+    frame_bytes = 0;
+    last_flush_bytes = batcher.get_upload_bytes();
+    last_flush_regions = 0;
+    if (batcher.get_upload_count() == 0)
+    {
+        return 0;
+    }
+    batcher.build();
+
+    const unsigned long long point = timeline.get_last_submitted() + 1;
+    // Every slot in flight: wait for the oldest, which owns the slot this submission needs.
+    if (point > SUBMIT_SLOTS)
+    {
+        timeline.wait(point - SUBMIT_SLOTS);
+    }
+    retire_completed();
+
+    CommandBuffer &command_buffer = *command_buffers[point % SUBMIT_SLOTS];
+    command_buffer.reset(0);
+    command_buffer.begin();
+    const Utils::Vector<BufferCopyRegion> &regions = batcher.get_regions();
+    copy_regions.resize(regions.size());
+    for (unsigned long i = 0; i < regions.size(); ++i)
+    {
+        VkBufferCopy2 &copy = copy_regions[i];
+        copy = {};
+        copy.sType = VK_STRUCTURE_TYPE_BUFFER_COPY_2;
+        copy.srcOffset = regions[i].src_offset;
+        copy.dstOffset = regions[i].dst_offset;
+        copy.size = regions[i].size;
+    }
+    for (const BufferCopyBatch &batch : batcher.get_batches())
+    {
+        VkCopyBufferInfo2 copy_info{};
+        copy_info.sType = VK_STRUCTURE_TYPE_COPY_BUFFER_INFO_2;
+        copy_info.srcBuffer = staging.getBuffer();
+        copy_info.dstBuffer = reinterpret_cast<VkBuffer>(batch.dst);
+        copy_info.regionCount = batch.region_count;
+        copy_info.pRegions = &copy_regions[batch.first_region];
+        command_buffer.copyBuffer2(&copy_info);
+    }
+    command_buffer.end();
+
+    VkCommandBufferSubmitInfo cmd_submit_info{};
+    cmd_submit_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO;
+    cmd_submit_info.commandBuffer = command_buffer.handle();
+
+    VkSubmitInfo2 submit_info{};
+    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
+    submit_info.commandBufferInfoCount = 1;
+    submit_info.pCommandBufferInfos = &cmd_submit_info;
+    timeline.submit(queue, submit_info, VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT);
+    // Cannot fail: a slot is only reused once its submission has been retired.
+    if (!ring.submit(point))
+    {
+        Log::fatal("Staging ring has more pending submissions than upload slots");
+    }
+    last_flush_regions = static_cast<unsigned int>(regions.size());
+    batcher.clear();
+    return point;
+}
+} // namespace LunaVoxelEngine::Renderer
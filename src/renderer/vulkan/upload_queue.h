@@ -0,0 +1,108 @@
+#ifndef VK_UPLOAD_QUEUE_H
+#define VK_UPLOAD_QUEUE_H
+#include <renderer/vulkan/buffer.h>
+#include <renderer/vulkan/cmd_buffer.h>
+#include <renderer/vulkan/device.h>
+#include <renderer/vulkan/ivulkan.h>
+#include <renderer/vulkan/queue.h>
+#include <renderer/vulkan/staging.h>
+#include <renderer/vulkan/timeline.h>
+#include <utils/vector.h>
+
+namespace LunaVoxelEngine::Renderer
+{
+/// The stages a frame must hold back until the uploads flushed for it have landed.
+constexpr VkPipelineStageFlags2 UPLOAD_WAIT_STAGES =
+    VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_2_VERTEX_INPUT_BIT |
+    VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+
+/**
+ * @class UploadQueue
+ * @brief Streams data into device-local buffers through a persistently mapped staging ring.
+ * @details Callers write into the space upload() returns; flush() then copies everything written since the last
+ *          flush with one vkCmdCopyBuffer2 per destination buffer, on the transfer queue if the device has one.
+ *          Staging space comes back once the submission that read it has reached its point on the queue's
+ *          timeline; the staging ring's values are those points.
+ *
+ * Each frame may use at most the staging size divided by the frames in flight, so one frame of heavy streaming
+ * cannot starve the next ones.
+ * @warning Not thread-safe.
+ */
+class [[nodiscard]] UploadQueue final
+{
+  public:
+    /// Submissions that may be in flight at once; the oldest is waited for when all are.
+    static constexpr unsigned int SUBMIT_SLOTS = StagingRing::MAX_PENDING_SUBMITS;
+    /// Keeps staging offsets aligned for copies of 32-bit data.
+    static constexpr VkDeviceSize UPLOAD_ALIGNMENT = 4;
+
+    /**
+     * @param device The device whose transfer queue, or graphics queue without one, the copies are submitted to.
+     * @param staging_bytes Size of the staging buffer.
+     * @param frames_in_flight How many frames share the staging buffer.
+     */
+    UploadQueue(const Device *device, unsigned long long staging_bytes, unsigned int frames_in_flight);
+    ~UploadQueue();
+    UploadQueue(const UploadQueue &) = delete;
+    UploadQueue &operator=(const UploadQueue &) = delete;
+
+    /**
+     * @brief Reserves size bytes of staging memory to be copied to dst at dst_offset by the next flush().
+     * @return Where to write the data, or nullptr if this frame's share of the staging buffer is used up; try again
+     *         next frame.
+     */
+    [[nodiscard]] void *upload(const Buffer &dst, VkDeviceSize dst_offset, VkDeviceSize size) noexcept;
+
+    /**
+     * @brief Copies data into staging memory for the next flush().
+     * @return false if it did not fit this frame.
+     */
+    [[nodiscard]] bool upload(const Buffer &dst, VkDeviceSize dst_offset, const void *data, VkDeviceSize size) noexcept;
+
+    /**
+     * @brief Submits the copies for everything uploaded since the last flush.
+     * @return The point on get_timeline() the frame's submit must wait for at UPLOAD_WAIT_STAGES, or 0 if there
+     *         was nothing to copy.
+     */
+    [[nodiscard]] unsigned long long flush() noexcept;
+
+    /// Bytes flushed and regions copied by the last flush(), after merging.
+    [[nodiscard]] unsigned long long get_last_flush_bytes() const noexcept
+    {
+        return last_flush_bytes;
+    }
+    [[nodiscard]] unsigned int get_last_flush_regions() const noexcept
+    {
+        return last_flush_regions;
+    }
+    [[nodiscard]] const StagingRing &get_ring() const noexcept
+    {
+        return ring;
+    }
+    [[nodiscard]] const Timeline &get_timeline() const noexcept
+    {
+        return timeline;
+    }
+
+  private:
+    /**
+     * @brief Retires every submission the timeline has reached.
+     */
+    void retire_completed() noexcept;
+
+    Buffer staging;
+    unsigned char *staging_memory;
+    StagingRing ring;
+    UploadBatcher batcher;
+    Queue queue;
+    Timeline timeline;
+    VkCommandPool command_pool = VK_NULL_HANDLE;
+    CommandBuffer *command_buffers[SUBMIT_SLOTS] = {}; ///< The submission at point p records into p % SUBMIT_SLOTS.
+    Utils::Vector<VkBufferCopy2> copy_regions;
+    unsigned long long frame_budget;
+    unsigned long long frame_bytes = 0;
+    unsigned long long last_flush_bytes = 0;
+    unsigned int last_flush_regions = 0;
+};
+} // namespace LunaVoxelEngine::Renderer
+#endif
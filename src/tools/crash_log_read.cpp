@@ -0,0 +1,85 @@
+// LunaCrashLog: prints the text kept in a crash log file (see Log::open_crash_log()).
+//
+//     LunaCrashLog file [megabytes]
+//
+// Writes the newest `megabytes` of the log, or all of it, to standard output, oldest line first.
+#include <platform/common_crash_log.h>
+#include <platform/common_log.h>
+#include <platform/log.h>
+#include <tools/file_input.h>
+#include <utils/algorithm.h>
+
+using namespace LunaVoxelEngine;
+using namespace LunaVoxelEngine::Log;
+
+namespace
+{
+bool parse_megabytes(const char *text, unsigned long long &megabytes)
+{
+    megabytes = 0;
+    if (*text == '\0')
+    {
+        return false;
+    }
+    for (; *text != '\0'; ++text)
+    {
+        if (*text < '0' || *text > '9' || megabytes > (1ULL << 40))
+        {
+            return false;
+        }
+        megabytes = megabytes * 10 + static_cast<unsigned long long>(*text - '0');
+    }
+    return true;
+}
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        error("Usage: LunaCrashLog file [megabytes]");
+        return 1;
+    }
+    unsigned long long megabytes = ~0ULL >> 20;
+    if (argc > 2 && !parse_megabytes(argv[2], megabytes))
+    {
+        error("Invalid size %s", argv[2]);
+        return 1;
+    }
+    Tools::FileInput input;
+    if (!Tools::read_file(argv[1], input))
+    {
+        error("Cannot open %s", argv[1]);
+        return 1;
+    }
+
+    const CrashLogHeader *header = reinterpret_cast<const CrashLogHeader *>(input.data);
+    if (input.size < sizeof(CrashLogHeader) || Utils::memcmp(header->magic, CRASH_LOG_MAGIC, 8) != 0 ||
+        header->capacity == 0 || (header->capacity & (header->capacity - 1)) != 0 ||
+        input.size - sizeof(CrashLogHeader) < header->capacity)
+    {
+        error("%s is not a crash log", argv[1]);
+        return 1;
+    }
+    const unsigned long long capacity = header->capacity;
+    const unsigned long long head = header->head.load(Utils::MemoryOrder::RELAXED);
+    const char *data = reinterpret_cast<const char *>(input.data + sizeof(CrashLogHeader));
+
+    unsigned long long length = Utils::min(Utils::min(head, capacity), megabytes << 20);
+    unsigned long long start = head - length;
+    // Unless the stream starts at its first byte, the oldest line has been partly overwritten.
+    if (start > 0)
+    {
+        while (length > 0 && data[start++ & (capacity - 1)] != '\n')
+        {
+            --length;
+        }
+        length -= length > 0 ? 1 : 0;
+    }
+
+    const size_t offset = start & (capacity - 1);
+    const size_t first = static_cast<size_t>(Utils::min(length, capacity - offset));
+    const LogSlice slices[2] = {{data + offset, first}, {data, static_cast<size_t>(length) - first}};
+    sink_write(slices, 2);
+    return 0;
+}
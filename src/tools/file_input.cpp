@@ -0,0 +1,86 @@
+#include <tools/file_input.h>
+#include <utils/algorithm.h>
+#include <utils/new.h>
+#if defined(ON_LINUX)
+#    include <fcntl.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+#elif defined(ON_WINDOWS)
+#    include <windows.h>
+#endif
+
+namespace LunaVoxelEngine::Tools
+{
+namespace
+{
+constexpr unsigned long READ_CHUNK = 64 * 1024;
+} // namespace
+
+FileInput::~FileInput()
+{
+    delete[] data;
+}
+
+unsigned char *FileInput::reserve(unsigned long extra)
+{
+    if (size + extra > capacity)
+    {
+        unsigned long new_capacity = capacity == 0 ? READ_CHUNK : capacity * 2;
+        while (new_capacity < size + extra)
+        {
+            new_capacity *= 2;
+        }
+        unsigned char *new_data = new unsigned char[new_capacity];
+        Utils::memcpy(new_data, data, size);
+        delete[] data;
+        data = new_data;
+        capacity = new_capacity;
+    }
+    return data + size;
+}
+
+bool read_file(const char *path, FileInput &input)
+{
+#if defined(ON_LINUX)
+    const int fd = path != nullptr ? static_cast<int>(syscall(SYS_openat, AT_FDCWD, path, O_RDONLY)) : 0;
+    if (fd < 0)
+    {
+        return false;
+    }
+    while (true)
+    {
+        const long got = syscall(SYS_read, fd, input.reserve(READ_CHUNK), READ_CHUNK);
+        if (got <= 0)
+        {
+            break;
+        }
+        input.size += static_cast<unsigned long>(got);
+    }
+    if (path != nullptr)
+    {
+        syscall(SYS_close, fd);
+    }
+    return true;
+#elif defined(ON_WINDOWS)
+    HANDLE handle = path != nullptr ? CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                                  FILE_ATTRIBUTE_NORMAL, nullptr)
+                                    : GetStdHandle(STD_INPUT_HANDLE);
+    if (handle == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    DWORD got = 0;
+    while (ReadFile(handle, input.reserve(READ_CHUNK), READ_CHUNK, &got, nullptr) && got > 0)
+    {
+        input.size += got;
+    }
+    if (path != nullptr)
+    {
+        CloseHandle(handle);
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+} // namespace LunaVoxelEngine::Tools
@@ -0,0 +1,31 @@
+#ifndef FILE_INPUT_H
+#define FILE_INPUT_H
+namespace LunaVoxelEngine::Tools
+{
+/**
+ * @brief A whole input file in one growable buffer.
+ */
+struct FileInput
+{
+    unsigned char *data = nullptr;
+    unsigned long size = 0;
+    unsigned long capacity = 0;
+
+    FileInput() noexcept = default;
+    ~FileInput();
+    FileInput(const FileInput &) = delete;
+    FileInput &operator=(const FileInput &) = delete;
+
+    /**
+     * @brief Makes room for extra more bytes and returns where they go.
+     */
+    unsigned char *reserve(unsigned long extra);
+};
+
+/**
+ * @brief Reads all of path, or standard input when path is null, into input.
+ * @return false if the file cannot be opened.
+ */
+bool read_file(const char *path, FileInput &input);
+} // namespace LunaVoxelEngine::Tools
+#endif
@@ -0,0 +1,84 @@
+// LunaLogDecode: formats a LogEncoding::ENCODING_BINARY stream back into the engine's text log.
+//
+//     LunaLogDecode [file]
+//
+// Reads standard input when no file is given and writes the text to standard output.
+#include <platform/common_binary_log.h>
+#include <platform/log.h>
+#include <tools/file_input.h>
+#include <utils/algorithm.h>
+
+using namespace LunaVoxelEngine;
+using namespace LunaVoxelEngine::Log;
+
+int main(int argc, char *argv[])
+{
+    const char *path = argc > 1 ? argv[1] : nullptr;
+    Tools::FileInput input;
+    if (!Tools::read_file(path, input))
+    {
+        error("Cannot open %s", path != nullptr ? path : "standard input");
+        return 1;
+    }
+
+    FormatDictionary dictionary;
+    Utils::FormatArg args[MAX_BINARY_SEGMENTS];
+    unsigned long unknown = 0;
+    unsigned long pos = 0;
+    while (input.size - pos >= sizeof(BinaryEntry))
+    {
+        const unsigned char *at = input.data + pos;
+        if (Utils::memcmp(at, BINARY_LOG_MAGIC, sizeof(BINARY_LOG_MAGIC)) == 0)
+        {
+            pos += sizeof(BINARY_LOG_MAGIC);
+            continue;
+        }
+        BinaryEntry entry;
+        Utils::memcpy(&entry, at, sizeof(entry));
+        if (entry.size < sizeof(BinaryEntry) || entry.size % 8 != 0 || entry.size > input.size - pos ||
+            entry.level > Level::LOG_FATAL)
+        {
+            error("Corrupt entry at offset %lu", pos);
+            return 1;
+        }
+        const unsigned char *payload = at + sizeof(BinaryEntry);
+        const unsigned long payload_size = entry.size - sizeof(BinaryEntry);
+
+        if (entry.kind == BinaryEntryKind::ENTRY_FORMAT)
+        {
+            const char *text = reinterpret_cast<const char *>(payload);
+            if (entry.info > payload_size || dictionary.insert(entry.format_id, text, entry.info, true) == nullptr)
+            {
+                warn("Invalid format entry at offset %lu", pos);
+            }
+        }
+        else if (entry.kind == BinaryEntryKind::ENTRY_RECORD)
+        {
+            const Utils::FormatView *format = dictionary.find(entry.format_id);
+            if (format == nullptr || !decode_args(payload, payload_size, *format, entry.info, args))
+            {
+                ++unknown;
+            }
+            else
+            {
+                write_formatted(entry.level, *format, args);
+            }
+        }
+        else
+        {
+            error("Unknown entry kind %u at offset %lu", static_cast<unsigned int>(entry.kind), pos);
+            return 1;
+        }
+        pos += entry.size;
+    }
+
+    if (unknown > 0)
+    {
+        warn("%lu records had an unknown format or a short payload", unknown);
+    }
+    if (pos != input.size)
+    {
+        warn("%lu trailing bytes are not a complete entry", input.size - pos);
+    }
+    return 0;
+}
@@ -44,8 +44,22 @@ template<typename T> constexpr void swap(T &a, T &b) noexcept
 
 template<typename Iterator, typename Compare> Iterator partition(Iterator beg, Iterator end, Compare cmp)
 {
-    // Using the last element as the pivot
+    // Using the median of the first, middle and last elements as the pivot, moved to the end, so input that is
+    // already sorted, the common case, does not degrade to quadratic time
     Iterator pivot = end - 1;
+    Iterator middle = beg + (end - beg) / 2;
+    if (cmp(*middle, *beg))
+    {
+        swap(*middle, *beg);
+    }
+    if (cmp(*pivot, *beg))
+    {
+        swap(*pivot, *beg);
+    }
+    if (cmp(*middle, *pivot))
+    {
+        swap(*middle, *pivot);
+    }
     Iterator i = beg - 1;
 
     for (Iterator j = beg; j < pivot; ++j)
@@ -64,15 +78,23 @@ template<typename Iterator, typename Compare> Iterator partition(Iterator beg, I
 
 template<typename Iterator, typename Compare> void quicksort(Iterator beg, Iterator end, Compare cmp)
 {
-    if (beg >= end)
-        return;
-
-    // Partition the range [beg, end) and get the pivot element's position
-    Iterator pivot = partition(beg, end, cmp);
-
-    // Recursively sort the two halves
-    quicksort(beg, pivot, cmp);     // Sort the left half
-    quicksort(pivot + 1, end, cmp); // Sort the right half
+    while (end - beg > 1)
+    {
+        // Partition the range [beg, end) and get the pivot element's position
+        Iterator pivot = partition(beg, end, cmp);
+
+        // Recurse into the smaller half and loop on the larger, so the stack stays logarithmic
+        if (pivot - beg < end - pivot)
+        {
+            quicksort(beg, pivot, cmp);
+            beg = pivot + 1;
+        }
+        else
+        {
+            quicksort(pivot + 1, end, cmp);
+            end = pivot;
+        }
+    }
 }
 
 inline int memcmp(const void *aptr, const void *bptr, unsigned long size)
@@ -0,0 +1,101 @@
+#include <cstdint>
+#include <utils/algorithm.h>
+#include <utils/arena.h>
+
+namespace LunaVoxelEngine::Utils
+{
+static inline uintptr_t align_up(uintptr_t value, unsigned long alignment) noexcept
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+Arena::~Arena()
+{
+    reset();
+}
+
+void *Arena::allocate(unsigned long size, unsigned long alignment)
+{
+    uintptr_t address = reinterpret_cast<uintptr_t>(cursor);
+    uintptr_t aligned = align_up(address, alignment);
+    if (cursor != nullptr && aligned + size <= reinterpret_cast<uintptr_t>(limit))
+    {
+        cursor = reinterpret_cast<char *>(aligned + size);
+        bytes_used += size;
+        return reinterpret_cast<void *>(aligned);
+    }
+    return allocate_block(size, alignment);
+}
+
+char *Arena::copy_string(const char *str, unsigned long len)
+{
+    char *result = static_cast<char *>(allocate(len + 1, 1));
+    memcpy(result, str, len);
+    result[len] = '\0';
+    return result;
+}
+
+void Arena::reset() noexcept
+{
+    Block *block = head;
+    while (block != nullptr)
+    {
+        Block *next = block->next;
+        delete[] reinterpret_cast<char *>(block);
+        block = next;
+    }
+    head = nullptr;
+    cursor = nullptr;
+    limit = nullptr;
+    bytes_used = 0;
+    bytes_reserved = 0;
+}
+
+void Arena::rewind()
+{
+    if (head == nullptr)
+    {
+        return;
+    }
+    if (head->next != nullptr)
+    {
+        const unsigned long reserved = bytes_reserved;
+        reset();
+        char *memory = new char[reserved];
+        head = reinterpret_cast<Block *>(memory);
+        head->next = nullptr;
+        head->size = reserved;
+        limit = memory + reserved;
+        bytes_reserved = reserved;
+    }
+    cursor = reinterpret_cast<char *>(head) + sizeof(Block);
+    bytes_used = 0;
+}
+
+void *Arena::allocate_block(unsigned long size, unsigned long alignment)
+{
+    unsigned long header = static_cast<unsigned long>(align_up(sizeof(Block), alignment));
+    unsigned long payload = max(block_size, size + alignment);
+    char *memory = new char[header + payload];
+    Block *block = reinterpret_cast<Block *>(memory);
+    block->size = header + payload;
+    bytes_reserved += block->size;
+
+    char *start = reinterpret_cast<char *>(align_up(reinterpret_cast<uintptr_t>(memory + sizeof(Block)), alignment));
+    if (size + alignment > block_size && head != nullptr)
+    {
+        // Oversized request: keep bump-allocating from the current block and chain this one behind it.
+        block->next = head->next;
+        head->next = block;
+    }
+    else
+    {
+        block->next = head;
+        head = block;
+        limit = memory + block->size;
+        cursor = start + size;
+    }
+    bytes_used += size;
+    return start;
+}
+} // namespace LunaVoxelEngine::Utils
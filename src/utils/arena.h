@@ -0,0 +1,83 @@
+#ifndef ARENA_H
+#define ARENA_H
+#include <utils/new.h>
+namespace LunaVoxelEngine
+{
+namespace Utils
+{
+/**
+ * @class Arena
+ * @brief A bump allocator that hands out memory from large blocks and only frees it all at once.
+ *
+ * Allocation is a pointer bump within the current block. Requests larger than the block size get a block of
+ * their own. Pointers stay valid until reset() or destruction; nothing is ever moved.
+ * @warning Not thread-safe. Callers that share an arena must serialise access themselves.
+ */
+class Arena final
+{
+  public:
+    static constexpr unsigned long DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+    explicit Arena(unsigned long block_size_in = DEFAULT_BLOCK_SIZE) noexcept
+        : block_size(block_size_in)
+    {
+    }
+    ~Arena();
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    /**
+     * @brief Returns size bytes aligned to alignment (a power of two no larger than the block size).
+     */
+    void *allocate(unsigned long size, unsigned long alignment = sizeof(void *));
+
+    template<typename T> T *allocate_array(unsigned long count)
+    {
+        return static_cast<T *>(allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    /**
+     * @brief Copies len bytes into the arena and appends a null terminator.
+     */
+    char *copy_string(const char *str, unsigned long len);
+
+    /**
+     * @brief Releases every block. All pointers previously returned become invalid.
+     */
+    void reset() noexcept;
+
+    /**
+     * @brief Invalidates every allocation but keeps the memory, for arenas emptied on a cycle such as a frame.
+     * @details Several blocks are merged into one that holds them all, so a steady workload stops allocating
+     *          blocks after the first cycle.
+     */
+    void rewind();
+
+    [[nodiscard]] unsigned long get_bytes_used() const noexcept
+    {
+        return bytes_used;
+    }
+    [[nodiscard]] unsigned long get_bytes_reserved() const noexcept
+    {
+        return bytes_reserved;
+    }
+
+  private:
+    struct Block
+    {
+        Block *next;
+        unsigned long size;
+    };
+
+    Block *head = nullptr;
+    char *cursor = nullptr;
+    char *limit = nullptr;
+    unsigned long block_size;
+    unsigned long bytes_used = 0;
+    unsigned long bytes_reserved = 0;
+
+    void *allocate_block(unsigned long size, unsigned long alignment);
+};
+} // namespace Utils
+} // namespace LunaVoxelEngine
+#endif
@@ -0,0 +1,182 @@
+#ifndef ATOMIC_H
+#define ATOMIC_H
+#if defined(_MSC_VER)
+#    include <intrin.h>
+#endif
+namespace LunaVoxelEngine
+{
+namespace Utils
+{
+enum class MemoryOrder
+{
+    RELAXED,
+    ACQUIRE,
+    RELEASE,
+    ACQ_REL,
+    SEQ_CST
+};
+
+/**
+ * @class Atomic
+ * @brief A minimal atomic for 32- and 64-bit integers and pointers.
+ *
+ * Maps onto the GCC/Clang __atomic builtins, or the Interlocked intrinsics on MSVC, where plain aligned
+ * loads and stores on x86/x64 already have acquire/release semantics.
+ */
+template<typename T> class Atomic final
+{
+    static_assert(sizeof(T) == 4 || sizeof(T) == 8, "Atomic supports 32- and 64-bit types only");
+
+  public:
+    constexpr Atomic() noexcept = default;
+    constexpr Atomic(T value_in) noexcept
+        : value(value_in)
+    {
+    }
+    Atomic(const Atomic &) = delete;
+    Atomic &operator=(const Atomic &) = delete;
+
+    T load(MemoryOrder order = MemoryOrder::SEQ_CST) const noexcept
+    {
+#if defined(_MSC_VER)
+        T result = *const_cast<const volatile T *>(&value);
+        if (order == MemoryOrder::SEQ_CST)
+            _ReadWriteBarrier();
+        return result;
+#else
+        return __atomic_load_n(&value, to_builtin(order));
+#endif
+    }
+
+    void store(T desired, MemoryOrder order = MemoryOrder::SEQ_CST) noexcept
+    {
+#if defined(_MSC_VER)
+        if (order == MemoryOrder::SEQ_CST)
+            exchange(desired);
+        else
+            *const_cast<volatile T *>(&value) = desired;
+#else
+        __atomic_store_n(&value, desired, to_builtin(order));
+#endif
+    }
+
+    T exchange(T desired, MemoryOrder order = MemoryOrder::SEQ_CST) noexcept
+    {
+#if defined(_MSC_VER)
+        (void)order;
+        if constexpr (sizeof(T) == 8)
+            return from_bits(_InterlockedExchange64(reinterpret_cast<volatile __int64 *>(&value), to_bits(desired)));
+        else
+            return from_bits(_InterlockedExchange(reinterpret_cast<volatile long *>(&value), to_bits(desired)));
+#else
+        return __atomic_exchange_n(&value, desired, to_builtin(order));
+#endif
+    }
+
+    /**
+     * @brief Strong compare-and-swap. On failure, expected receives the current value.
+     */
+    bool compare_exchange(T &expected, T desired, MemoryOrder order = MemoryOrder::SEQ_CST) noexcept
+    {
+#if defined(_MSC_VER)
+        (void)order;
+        T previous;
+        if constexpr (sizeof(T) == 8)
+            previous = from_bits(_InterlockedCompareExchange64(reinterpret_cast<volatile __int64 *>(&value),
+                                                               to_bits(desired), to_bits(expected)));
+        else
+            previous = from_bits(_InterlockedCompareExchange(reinterpret_cast<volatile long *>(&value),
+                                                             to_bits(desired), to_bits(expected)));
+        if (previous == expected)
+            return true;
+        expected = previous;
+        return false;
+#else
+        return __atomic_compare_exchange_n(&value, &expected, desired, false, to_builtin(order),
+                                           failure_order(order));
+#endif
+    }
+
+    T fetch_add(T delta, MemoryOrder order = MemoryOrder::SEQ_CST) noexcept
+    {
+#if defined(_MSC_VER)
+        (void)order;
+        if constexpr (sizeof(T) == 8)
+            return from_bits(_InterlockedExchangeAdd64(reinterpret_cast<volatile __int64 *>(&value), to_bits(delta)));
+        else
+            return from_bits(_InterlockedExchangeAdd(reinterpret_cast<volatile long *>(&value), to_bits(delta)));
+#else
+        return __atomic_fetch_add(&value, delta, to_builtin(order));
+#endif
+    }
+
+    T fetch_sub(T delta, MemoryOrder order = MemoryOrder::SEQ_CST) noexcept
+    {
+        return fetch_add(static_cast<T>(0) - delta, order);
+    }
+
+  private:
+    alignas(sizeof(T)) T value{};
+
+#if defined(_MSC_VER)
+    static auto to_bits(T v) noexcept
+    {
+        if constexpr (sizeof(T) == 8)
+            return (__int64)v;
+        else
+            return (long)v;
+    }
+    static T from_bits(__int64 v) noexcept
+    {
+        return (T)v;
+    }
+#else
+    static constexpr int to_builtin(MemoryOrder order) noexcept
+    {
+        switch (order)
+        {
+        case MemoryOrder::RELAXED:
+            return __ATOMIC_RELAXED;
+        case MemoryOrder::ACQUIRE:
+            return __ATOMIC_ACQUIRE;
+        case MemoryOrder::RELEASE:
+            return __ATOMIC_RELEASE;
+        case MemoryOrder::ACQ_REL:
+            return __ATOMIC_ACQ_REL;
+        default:
+            return __ATOMIC_SEQ_CST;
+        }
+    }
+    static constexpr int failure_order(MemoryOrder order) noexcept
+    {
+        switch (order)
+        {
+        case MemoryOrder::RELEASE:
+        case MemoryOrder::RELAXED:
+            return __ATOMIC_RELAXED;
+        case MemoryOrder::ACQ_REL:
+        case MemoryOrder::ACQUIRE:
+            return __ATOMIC_ACQUIRE;
+        default:
+            return __ATOMIC_SEQ_CST;
+        }
+    }
+#endif
+};
+
+/**
+ * @brief Hint to the CPU that the caller is spinning.
+ */
+inline void cpu_relax() noexcept
+{
+#if defined(_MSC_VER)
+    _mm_pause();
+#elif defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+} // namespace Utils
+} // namespace LunaVoxelEngine
+#endif
@@ -0,0 +1,104 @@
+#ifndef BITS_H
+#define BITS_H
+#if defined(_MSC_VER)
+#    include <intrin.h>
+#endif
+namespace LunaVoxelEngine
+{
+namespace Utils
+{
+// Bit-scan and population-count helpers. The hardware instructions are only used when the target is known
+// to have them: without -mpopcnt GCC lowers __builtin_popcount to a libgcc call, and the engine links
+// without libgcc (-nodefaultlibs).
+
+constexpr int popcount64(unsigned long long value) noexcept
+{
+#if defined(__POPCNT__) && !defined(_MSC_VER)
+    return __builtin_popcountll(value);
+#else
+#    if defined(_MSC_VER) && defined(__AVX2__)
+    if (!__builtin_is_constant_evaluated())
+    {
+        return static_cast<int>(__popcnt64(value));
+    }
+#    endif
+    value = value - ((value >> 1) & 0x5555555555555555ULL);
+    value = (value & 0x3333333333333333ULL) + ((value >> 2) & 0x3333333333333333ULL);
+    value = (value + (value >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return static_cast<int>((value * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+constexpr int popcount32(unsigned int value) noexcept
+{
+    return popcount64(value);
+}
+
+/**
+ * @brief Index of the lowest set bit; 64 when value is zero.
+ */
+constexpr int count_trailing_zeros64(unsigned long long value) noexcept
+{
+    if (value == 0)
+    {
+        return 64;
+    }
+#if defined(_MSC_VER)
+    if (!__builtin_is_constant_evaluated())
+    {
+        unsigned long index;
+        _BitScanForward64(&index, value);
+        return static_cast<int>(index);
+    }
+    int count = 0;
+    while ((value & 1) == 0)
+    {
+        value >>= 1;
+        ++count;
+    }
+    return count;
+#else
+    return __builtin_ctzll(value);
+#endif
+}
+
+/**
+ * @brief Number of zero bits above the highest set bit; 64 when value is zero.
+ */
+constexpr int count_leading_zeros64(unsigned long long value) noexcept
+{
+    if (value == 0)
+    {
+        return 64;
+    }
+#if defined(_MSC_VER)
+    if (!__builtin_is_constant_evaluated())
+    {
+        unsigned long index;
+        _BitScanReverse64(&index, value);
+        return 63 - static_cast<int>(index);
+    }
+    int count = 0;
+    while ((value & (1ULL << 63)) == 0)
+    {
+        value <<= 1;
+        ++count;
+    }
+    return count;
+#else
+    return __builtin_clzll(value);
+#endif
+}
+
+/**
+ * @brief Mask with bits [begin, end) set, for 0 <= begin <= end <= 64.
+ */
+constexpr unsigned long long bit_range_mask(unsigned int begin, unsigned int end) noexcept
+{
+    unsigned long long high = end >= 64 ? ~0ULL : ((1ULL << end) - 1);
+    unsigned long long low = begin >= 64 ? ~0ULL : ((1ULL << begin) - 1);
+    return high & ~low;
+}
+} // namespace Utils
+} // namespace LunaVoxelEngine
+#endif
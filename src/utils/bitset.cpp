@@ -0,0 +1,371 @@
+#include <utils/bitset.h>
+#if defined(__AVX2__)
+#    include <immintrin.h>
+#endif
+
+namespace LunaVoxelEngine::Utils
+{
+namespace BitOps
+{
+#if defined(__AVX2__)
+// Four words per 256-bit lane; the scalar loops below finish the tail.
+template<typename Op>
+static inline unsigned long binary_avx2(word_type *dst, const word_type *src, unsigned long words, Op op) noexcept
+{
+    unsigned long i = 0;
+    for (; i + 4 <= words; i += 4)
+    {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), op(a, b));
+    }
+    return i;
+}
+
+// Mula's nibble lookup popcount: two pshufb per 32 bytes, summed with psadbw.
+static inline unsigned long count_avx2(const word_type *src, unsigned long words, unsigned long &i) noexcept
+{
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1,
+                                            2, 2, 3, 2, 3, 3, 4);
+    const __m256i low_mask = _mm256_set1_epi8(0x0F);
+    __m256i total = _mm256_setzero_si256();
+    for (; i + 4 <= words; i += 4)
+    {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        __m256i low = _mm256_and_si256(block, low_mask);
+        __m256i high = _mm256_and_si256(_mm256_srli_epi16(block, 4), low_mask);
+        __m256i counts = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, low), _mm256_shuffle_epi8(lookup, high));
+        total = _mm256_add_epi64(total, _mm256_sad_epu8(counts, _mm256_setzero_si256()));
+    }
+    return static_cast<unsigned long>(_mm256_extract_epi64(total, 0) + _mm256_extract_epi64(total, 1) +
+                                      _mm256_extract_epi64(total, 2) + _mm256_extract_epi64(total, 3));
+}
+#endif
+
+void and_words(word_type *dst, const word_type *src, unsigned long words) noexcept
+{
+    unsigned long i = 0;
+#if defined(__AVX2__)
+    i = binary_avx2(dst, src, words, [](__m256i a, __m256i b) { return _mm256_and_si256(a, b); });
+#endif
+    for (; i < words; ++i)
+    {
+        dst[i] &= src[i];
+    }
+}
+
+void or_words(word_type *dst, const word_type *src, unsigned long words) noexcept
+{
+    unsigned long i = 0;
+#if defined(__AVX2__)
+    i = binary_avx2(dst, src, words, [](__m256i a, __m256i b) { return _mm256_or_si256(a, b); });
+#endif
+    for (; i < words; ++i)
+    {
+        dst[i] |= src[i];
+    }
+}
+
+void xor_words(word_type *dst, const word_type *src, unsigned long words) noexcept
+{
+    unsigned long i = 0;
+#if defined(__AVX2__)
+    i = binary_avx2(dst, src, words, [](__m256i a, __m256i b) { return _mm256_xor_si256(a, b); });
+#endif
+    for (; i < words; ++i)
+    {
+        dst[i] ^= src[i];
+    }
+}
+
+void and_not_words(word_type *dst, const word_type *src, unsigned long words) noexcept
+{
+    unsigned long i = 0;
+#if defined(__AVX2__)
+    // _mm256_andnot_si256 computes ~first & second.
+    i = binary_avx2(dst, src, words, [](__m256i a, __m256i b) { return _mm256_andnot_si256(b, a); });
+#endif
+    for (; i < words; ++i)
+    {
+        dst[i] &= ~src[i];
+    }
+}
+
+void not_words(word_type *dst, unsigned long words) noexcept
+{
+    for (unsigned long i = 0; i < words; ++i)
+    {
+        dst[i] = ~dst[i];
+    }
+}
+
+unsigned long count_words(const word_type *src, unsigned long words) noexcept
+{
+    unsigned long i = 0;
+    unsigned long total = 0;
+#if defined(__AVX2__)
+    total = count_avx2(src, words, i);
+#endif
+    for (; i < words; ++i)
+    {
+        total += static_cast<unsigned long>(popcount64(src[i]));
+    }
+    return total;
+}
+
+bool any_words(const word_type *src, unsigned long words) noexcept
+{
+    unsigned long i = 0;
+#if defined(__AVX2__)
+    for (; i + 4 <= words; i += 4)
+    {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        if (!_mm256_testz_si256(block, block))
+        {
+            return true;
+        }
+    }
+#endif
+    for (; i < words; ++i)
+    {
+        if (src[i] != 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool equal_words(const word_type *a, const word_type *b, unsigned long words) noexcept
+{
+    unsigned long i = 0;
+#if defined(__AVX2__)
+    for (; i + 4 <= words; i += 4)
+    {
+        __m256i diff = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i)),
+                                        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i)));
+        if (!_mm256_testz_si256(diff, diff))
+        {
+            return false;
+        }
+    }
+#endif
+    for (; i < words; ++i)
+    {
+        if (a[i] != b[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void assign_range(word_type *dst, unsigned long begin, unsigned long end, bool value) noexcept
+{
+    if (begin >= end)
+    {
+        return;
+    }
+    unsigned long first = begin / 64;
+    unsigned long last = (end - 1) / 64;
+    unsigned int begin_bit = static_cast<unsigned int>(begin % 64);
+    unsigned int end_bit = static_cast<unsigned int>((end - 1) % 64) + 1;
+    if (first == last)
+    {
+        word_type mask = bit_range_mask(begin_bit, end_bit);
+        dst[first] = value ? (dst[first] | mask) : (dst[first] & ~mask);
+        return;
+    }
+    word_type head = bit_range_mask(begin_bit, 64);
+    word_type tail = bit_range_mask(0, end_bit);
+    dst[first] = value ? (dst[first] | head) : (dst[first] & ~head);
+    if (last > first + 1)
+    {
+        memset(dst + first + 1, value ? 0xFF : 0, (last - first - 1) * sizeof(word_type));
+    }
+    dst[last] = value ? (dst[last] | tail) : (dst[last] & ~tail);
+}
+
+unsigned long find_next_set(const word_type *src, unsigned long bits, unsigned long start) noexcept
+{
+    if (start >= bits)
+    {
+        return npos;
+    }
+    unsigned long words = (bits + 63) / 64;
+    unsigned long w = start / 64;
+    // Mask off the bits below start in the first word, then scan whole words.
+    word_type word = src[w] & (~0ULL << (start % 64));
+    while (true)
+    {
+        if (word != 0)
+        {
+            unsigned long index = w * 64 + static_cast<unsigned long>(count_trailing_zeros64(word));
+            return index < bits ? index : npos;
+        }
+        if (++w >= words)
+        {
+            return npos;
+        }
+        word = src[w];
+    }
+}
+
+unsigned long find_next_unset(const word_type *src, unsigned long bits, unsigned long start) noexcept
+{
+    if (start >= bits)
+    {
+        return npos;
+    }
+    unsigned long words = (bits + 63) / 64;
+    unsigned long w = start / 64;
+    word_type word = ~src[w] & (~0ULL << (start % 64));
+    while (true)
+    {
+        if (word != 0)
+        {
+            unsigned long index = w * 64 + static_cast<unsigned long>(count_trailing_zeros64(word));
+            return index < bits ? index : npos;
+        }
+        if (++w >= words)
+        {
+            return npos;
+        }
+        word = ~src[w];
+    }
+}
+} // namespace BitOps
+
+BitVector::BitVector(size_type bits, bool value)
+{
+    resize(bits, value);
+}
+
+BitVector::BitVector(const BitVector &other)
+{
+    reserve_words(other.word_count());
+    memcpy(words, other.words, other.word_count() * sizeof(word_type));
+    bit_count = other.bit_count;
+}
+
+BitVector::BitVector(BitVector &&other) noexcept
+    : words(other.words)
+    , bit_count(other.bit_count)
+    , word_capacity(other.word_capacity)
+{
+    other.words = nullptr;
+    other.bit_count = 0;
+    other.word_capacity = 0;
+}
+
+BitVector::~BitVector()
+{
+    delete[] words;
+}
+
+BitVector &BitVector::operator=(const BitVector &other)
+{
+    if (this != &other)
+    {
+        reserve_words(other.word_count());
+        memcpy(words, other.words, other.word_count() * sizeof(word_type));
+        bit_count = other.bit_count;
+    }
+    return *this;
+}
+
+BitVector &BitVector::operator=(BitVector &&other) noexcept
+{
+    if (this != &other)
+    {
+        delete[] words;
+        words = other.words;
+        bit_count = other.bit_count;
+        word_capacity = other.word_capacity;
+        other.words = nullptr;
+        other.bit_count = 0;
+        other.word_capacity = 0;
+    }
+    return *this;
+}
+
+void BitVector::resize(size_type bits, bool value)
+{
+    size_type old_bits = bit_count;
+    size_type new_words = (bits + WORD_BITS - 1) / WORD_BITS;
+    reserve_words(new_words);
+    if (bits > old_bits)
+    {
+        // Everything past old_bits is already clear, so only a set needs writing.
+        size_type old_words = word_count();
+        if (new_words > old_words)
+        {
+            memset(words + old_words, 0, (new_words - old_words) * sizeof(word_type));
+        }
+        bit_count = bits;
+        if (value)
+        {
+            BitOps::assign_range(words, old_bits, bits, true);
+        }
+    }
+    else
+    {
+        bit_count = bits;
+        clear_tail();
+    }
+}
+
+void BitVector::push_back(bool value)
+{
+    if (bit_count % WORD_BITS == 0)
+    {
+        size_type needed = bit_count / WORD_BITS + 1;
+        if (needed > word_capacity)
+        {
+            reserve_words(word_capacity == 0 ? 4 : word_capacity * 2);
+        }
+        words[bit_count / WORD_BITS] = 0;
+    }
+    if (value)
+    {
+        set(bit_count);
+    }
+    ++bit_count;
+}
+
+void BitVector::flip_all() noexcept
+{
+    BitOps::not_words(words, word_count());
+    clear_tail();
+}
+
+void BitVector::reserve_words(size_type new_words)
+{
+    if (new_words <= word_capacity)
+    {
+        return;
+    }
+    word_type *new_ptr = new word_type[new_words];
+    if (words != nullptr)
+    {
+        memcpy(new_ptr, words, word_count() * sizeof(word_type));
+        delete[] words;
+    }
+    words = new_ptr;
+    word_capacity = new_words;
+}
+
+void BitVector::clear_tail() noexcept
+{
+    size_type total = word_count();
+    if (total > 0 && bit_count % WORD_BITS != 0)
+    {
+        words[total - 1] &= (1ULL << (bit_count % WORD_BITS)) - 1;
+    }
+    // Words beyond the new end may hold stale bits from before a shrink.
+    if (total < word_capacity)
+    {
+        memset(words + total, 0, (word_capacity - total) * sizeof(word_type));
+    }
+}
+} // namespace LunaVoxelEngine::Utils
@@ -0,0 +1,448 @@
+#ifndef BITSET_H
+#define BITSET_H
+#include <utils/algorithm.h>
+#include <utils/bits.h>
+#include <utils/new.h>
+namespace LunaVoxelEngine
+{
+namespace Utils
+{
+/**
+ * @brief Bulk kernels over arrays of 64-bit words, shared by BitSet and BitVector.
+ * @details Vectorised with AVX2 when it is enabled; the scalar versions process one word per step.
+ */
+namespace BitOps
+{
+using word_type = unsigned long long;
+static constexpr unsigned long npos = static_cast<unsigned long>(-1);
+
+void and_words(word_type *dst, const word_type *src, unsigned long words) noexcept;
+void or_words(word_type *dst, const word_type *src, unsigned long words) noexcept;
+void xor_words(word_type *dst, const word_type *src, unsigned long words) noexcept;
+void and_not_words(word_type *dst, const word_type *src, unsigned long words) noexcept;
+void not_words(word_type *dst, unsigned long words) noexcept;
+unsigned long count_words(const word_type *src, unsigned long words) noexcept;
+bool any_words(const word_type *src, unsigned long words) noexcept;
+bool equal_words(const word_type *a, const word_type *b, unsigned long words) noexcept;
+
+/**
+ * @brief Sets (value == true) or clears bits [begin, end).
+ */
+void assign_range(word_type *dst, unsigned long begin, unsigned long end, bool value) noexcept;
+
+/**
+ * @brief Index of the first set bit at or after start, or npos.
+ */
+unsigned long find_next_set(const word_type *src, unsigned long bits, unsigned long start) noexcept;
+
+/**
+ * @brief Index of the first clear bit at or after start, or npos.
+ */
+unsigned long find_next_unset(const word_type *src, unsigned long bits, unsigned long start) noexcept;
+} // namespace BitOps
+
+/**
+ * @class BitSet
+ * @brief A fixed-size set of N bits stored inline, e.g. BitSet<32 * 32 * 32> for a chunk's occupancy.
+ *
+ * Bits past N in the last word are kept clear so count(), any() and comparisons need no masking.
+ */
+template<unsigned long N> class BitSet final
+{
+    static_assert(N > 0, "BitSet needs at least one bit");
+
+  public:
+    using word_type = BitOps::word_type;
+    using size_type = unsigned long;
+    static constexpr size_type npos = BitOps::npos;
+    static constexpr size_type WORD_BITS = 64;
+    static constexpr size_type WORDS = (N + WORD_BITS - 1) / WORD_BITS;
+
+    constexpr BitSet() noexcept = default;
+
+    [[nodiscard]] static constexpr size_type size() noexcept
+    {
+        return N;
+    }
+
+    [[nodiscard]] constexpr bool test(size_type index) const noexcept
+    {
+        return (words[index / WORD_BITS] >> (index % WORD_BITS)) & 1;
+    }
+    [[nodiscard]] constexpr bool operator[](size_type index) const noexcept
+    {
+        return test(index);
+    }
+    constexpr void set(size_type index) noexcept
+    {
+        words[index / WORD_BITS] |= 1ULL << (index % WORD_BITS);
+    }
+    constexpr void set(size_type index, bool value) noexcept
+    {
+        value ? set(index) : reset(index);
+    }
+    constexpr void reset(size_type index) noexcept
+    {
+        words[index / WORD_BITS] &= ~(1ULL << (index % WORD_BITS));
+    }
+    constexpr void flip(size_type index) noexcept
+    {
+        words[index / WORD_BITS] ^= 1ULL << (index % WORD_BITS);
+    }
+
+    void set_all() noexcept
+    {
+        memset(words, 0xFF, sizeof(words));
+        clear_tail();
+    }
+    void reset_all() noexcept
+    {
+        memset(words, 0, sizeof(words));
+    }
+    void flip_all() noexcept
+    {
+        BitOps::not_words(words, WORDS);
+        clear_tail();
+    }
+    /**
+     * @brief Sets bits [begin, end).
+     */
+    void set_range(size_type begin, size_type end) noexcept
+    {
+        BitOps::assign_range(words, begin, end, true);
+    }
+    /**
+     * @brief Clears bits [begin, end).
+     */
+    void reset_range(size_type begin, size_type end) noexcept
+    {
+        BitOps::assign_range(words, begin, end, false);
+    }
+
+    [[nodiscard]] size_type count() const noexcept
+    {
+        if constexpr (WORDS == 1)
+        {
+            return static_cast<size_type>(popcount64(words[0]));
+        }
+        return BitOps::count_words(words, WORDS);
+    }
+    [[nodiscard]] bool any() const noexcept
+    {
+        if constexpr (WORDS == 1)
+        {
+            return words[0] != 0;
+        }
+        return BitOps::any_words(words, WORDS);
+    }
+    [[nodiscard]] bool none() const noexcept
+    {
+        return !any();
+    }
+    [[nodiscard]] bool all() const noexcept
+    {
+        return find_first_unset() == npos;
+    }
+
+    [[nodiscard]] size_type find_first() const noexcept
+    {
+        if constexpr (WORDS == 1)
+        {
+            return words[0] != 0 ? static_cast<size_type>(count_trailing_zeros64(words[0])) : npos;
+        }
+        return BitOps::find_next_set(words, N, 0);
+    }
+    /**
+     * @brief First set bit after index (exclusive), or npos.
+     */
+    [[nodiscard]] size_type find_next(size_type index) const noexcept
+    {
+        return BitOps::find_next_set(words, N, index + 1);
+    }
+    [[nodiscard]] size_type find_first_unset() const noexcept
+    {
+        return BitOps::find_next_unset(words, N, 0);
+    }
+    [[nodiscard]] size_type find_next_unset(size_type index) const noexcept
+    {
+        return BitOps::find_next_unset(words, N, index + 1);
+    }
+
+    /**
+     * @brief Calls func(index) for every set bit in ascending order.
+     */
+    template<typename Func> void for_each_set(Func &&func) const
+    {
+        for (size_type w = 0; w < WORDS; ++w)
+        {
+            word_type word = words[w];
+            while (word != 0)
+            {
+                func(w * WORD_BITS + static_cast<size_type>(count_trailing_zeros64(word)));
+                word &= word - 1;
+            }
+        }
+    }
+
+    BitSet &operator&=(const BitSet &other) noexcept
+    {
+        BitOps::and_words(words, other.words, WORDS);
+        return *this;
+    }
+    BitSet &operator|=(const BitSet &other) noexcept
+    {
+        BitOps::or_words(words, other.words, WORDS);
+        return *this;
+    }
+    BitSet &operator^=(const BitSet &other) noexcept
+    {
+        BitOps::xor_words(words, other.words, WORDS);
+        return *this;
+    }
+    /**
+     * @brief Clears every bit that is set in other.
+     */
+    BitSet &and_not(const BitSet &other) noexcept
+    {
+        BitOps::and_not_words(words, other.words, WORDS);
+        return *this;
+    }
+    [[nodiscard]] BitSet operator&(const BitSet &other) const noexcept
+    {
+        BitSet result = *this;
+        return result &= other;
+    }
+    [[nodiscard]] BitSet operator|(const BitSet &other) const noexcept
+    {
+        BitSet result = *this;
+        return result |= other;
+    }
+    [[nodiscard]] BitSet operator^(const BitSet &other) const noexcept
+    {
+        BitSet result = *this;
+        return result ^= other;
+    }
+    [[nodiscard]] BitSet operator~() const noexcept
+    {
+        BitSet result = *this;
+        result.flip_all();
+        return result;
+    }
+    [[nodiscard]] bool operator==(const BitSet &other) const noexcept
+    {
+        return BitOps::equal_words(words, other.words, WORDS);
+    }
+    [[nodiscard]] bool operator!=(const BitSet &other) const noexcept
+    {
+        return !(*this == other);
+    }
+
+    [[nodiscard]] word_type *data() noexcept
+    {
+        return words;
+    }
+    [[nodiscard]] const word_type *data() const noexcept
+    {
+        return words;
+    }
+    [[nodiscard]] static constexpr size_type word_count() noexcept
+    {
+        return WORDS;
+    }
+
+  private:
+    alignas(32) word_type words[WORDS] = {};
+
+    constexpr void clear_tail() noexcept
+    {
+        if constexpr (N % WORD_BITS != 0)
+        {
+            words[WORDS - 1] &= (1ULL << (N % WORD_BITS)) - 1;
+        }
+    }
+};
+
+/**
+ * @class BitVector
+ * @brief A heap-allocated, resizable bit array with the same operations as BitSet.
+ *
+ * Binary operations require both operands to have the same size. Bits past size() are kept clear.
+ */
+class BitVector final
+{
+  public:
+    using word_type = BitOps::word_type;
+    using size_type = unsigned long;
+    static constexpr size_type npos = BitOps::npos;
+    static constexpr size_type WORD_BITS = 64;
+
+    BitVector() noexcept = default;
+    explicit BitVector(size_type bits, bool value = false);
+    BitVector(const BitVector &other);
+    BitVector(BitVector &&other) noexcept;
+    ~BitVector();
+    BitVector &operator=(const BitVector &other);
+    BitVector &operator=(BitVector &&other) noexcept;
+
+    [[nodiscard]] size_type size() const noexcept
+    {
+        return bit_count;
+    }
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return bit_count == 0;
+    }
+    [[nodiscard]] size_type word_count() const noexcept
+    {
+        return (bit_count + WORD_BITS - 1) / WORD_BITS;
+    }
+
+    /**
+     * @brief Grows or shrinks to bits, filling new bits with value.
+     */
+    void resize(size_type bits, bool value = false);
+    void push_back(bool value);
+    void clear() noexcept
+    {
+        bit_count = 0;
+    }
+
+    [[nodiscard]] bool test(size_type index) const noexcept
+    {
+        return (words[index / WORD_BITS] >> (index % WORD_BITS)) & 1;
+    }
+    [[nodiscard]] bool operator[](size_type index) const noexcept
+    {
+        return test(index);
+    }
+    void set(size_type index) noexcept
+    {
+        words[index / WORD_BITS] |= 1ULL << (index % WORD_BITS);
+    }
+    void set(size_type index, bool value) noexcept
+    {
+        value ? set(index) : reset(index);
+    }
+    void reset(size_type index) noexcept
+    {
+        words[index / WORD_BITS] &= ~(1ULL << (index % WORD_BITS));
+    }
+    void flip(size_type index) noexcept
+    {
+        words[index / WORD_BITS] ^= 1ULL << (index % WORD_BITS);
+    }
+
+    void set_all() noexcept
+    {
+        set_range(0, bit_count);
+    }
+    void reset_all() noexcept
+    {
+        memset(words, 0, word_count() * sizeof(word_type));
+    }
+    void flip_all() noexcept;
+    void set_range(size_type begin, size_type end) noexcept
+    {
+        BitOps::assign_range(words, begin, end, true);
+    }
+    void reset_range(size_type begin, size_type end) noexcept
+    {
+        BitOps::assign_range(words, begin, end, false);
+    }
+
+    [[nodiscard]] size_type count() const noexcept
+    {
+        return BitOps::count_words(words, word_count());
+    }
+    [[nodiscard]] bool any() const noexcept
+    {
+        return BitOps::any_words(words, word_count());
+    }
+    [[nodiscard]] bool none() const noexcept
+    {
+        return !any();
+    }
+    [[nodiscard]] bool all() const noexcept
+    {
+        return find_first_unset() == npos;
+    }
+    [[nodiscard]] size_type find_first() const noexcept
+    {
+        return BitOps::find_next_set(words, bit_count, 0);
+    }
+    [[nodiscard]] size_type find_next(size_type index) const noexcept
+    {
+        return BitOps::find_next_set(words, bit_count, index + 1);
+    }
+    [[nodiscard]] size_type find_first_unset() const noexcept
+    {
+        return BitOps::find_next_unset(words, bit_count, 0);
+    }
+    [[nodiscard]] size_type find_next_unset(size_type index) const noexcept
+    {
+        return BitOps::find_next_unset(words, bit_count, index + 1);
+    }
+
+    template<typename Func> void for_each_set(Func &&func) const
+    {
+        const size_type total = word_count();
+        for (size_type w = 0; w < total; ++w)
+        {
+            word_type word = words[w];
+            while (word != 0)
+            {
+                func(w * WORD_BITS + static_cast<size_type>(count_trailing_zeros64(word)));
+                word &= word - 1;
+            }
+        }
+    }
+
+    BitVector &operator&=(const BitVector &other) noexcept
+    {
+        BitOps::and_words(words, other.words, word_count());
+        return *this;
+    }
+    BitVector &operator|=(const BitVector &other) noexcept
+    {
+        BitOps::or_words(words, other.words, word_count());
+        return *this;
+    }
+    BitVector &operator^=(const BitVector &other) noexcept
+    {
+        BitOps::xor_words(words, other.words, word_count());
+        return *this;
+    }
+    BitVector &and_not(const BitVector &other) noexcept
+    {
+        BitOps::and_not_words(words, other.words, word_count());
+        return *this;
+    }
+    [[nodiscard]] bool operator==(const BitVector &other) const noexcept
+    {
+        return bit_count == other.bit_count && BitOps::equal_words(words, other.words, word_count());
+    }
+    [[nodiscard]] bool operator!=(const BitVector &other) const noexcept
+    {
+        return !(*this == other);
+    }
+
+    [[nodiscard]] word_type *data() noexcept
+    {
+        return words;
+    }
+    [[nodiscard]] const word_type *data() const noexcept
+    {
+        return words;
+    }
+
+  private:
+    word_type *words = nullptr;
+    size_type bit_count = 0;
+    size_type word_capacity = 0;
+
+    void reserve_words(size_type new_words);
+    void clear_tail() noexcept;
+};
+} // namespace Utils
+} // namespace LunaVoxelEngine
+#endif
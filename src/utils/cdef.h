@@ -1,5 +1,7 @@
 #ifndef CDEF_H
 #    define CDEF_H
+// ::size_t for the headers that use it unqualified, which is most of the platform layer.
+#    include <stddef.h>
 namespace LunaVoxelEngine
 {
 namespace Utils
@@ -0,0 +1,460 @@
+#ifndef FORMAT_H
+#define FORMAT_H
+#include <utils/hash.h>
+#include <utils/string_view.h>
+namespace LunaVoxelEngine
+{
+namespace Utils
+{
+template<typename T> struct type_identity
+{
+    using type = T;
+};
+template<typename T> using type_identity_t = typename type_identity<T>::type;
+
+template<typename T> struct remove_cvref
+{
+    using type = T;
+};
+template<typename T> struct remove_cvref<const T>
+{
+    using type = T;
+};
+template<typename T> struct remove_cvref<volatile T>
+{
+    using type = T;
+};
+template<typename T> struct remove_cvref<const volatile T>
+{
+    using type = T;
+};
+template<typename T> struct remove_cvref<T &>
+{
+    using type = typename remove_cvref<T>::type;
+};
+template<typename T> struct remove_cvref<T &&>
+{
+    using type = typename remove_cvref<T>::type;
+};
+template<typename T> using remove_cvref_t = typename remove_cvref<T>::type;
+
+/**
+ * @brief What a single conversion in a format string prints, with the operand width already resolved.
+ */
+enum class FormatSpec : unsigned char
+{
+    NONE, ///< Literal text only (the tail of the string, or the text before an escaped %%).
+    I32,
+    U32,
+    I64,
+    U64,
+    HEX32,
+    HEX64,
+    FLOAT,
+    CHAR,
+    STRING,
+    POINTER
+};
+
+/**
+ * @brief The C++ category of an argument, as seen by the format checker.
+ */
+enum class FormatArgType : unsigned char
+{
+    I32,
+    U32,
+    I64,
+    U64,
+    FLOAT,
+    CHAR,
+    STRING,
+    POINTER
+};
+
+/**
+ * @brief Literal text [offset, offset + length) followed by one conversion.
+ */
+struct FormatSegment
+{
+    unsigned short offset;
+    unsigned short length;
+    FormatSpec spec;
+};
+
+/**
+ * @brief A type-erased argument. Strings always carry their length so %s never needs a strlen; a float sets
+ *        length to sizeof(float) so %f prints it at single precision.
+ */
+struct FormatArg
+{
+    union {
+        long long i;
+        unsigned long long u;
+        double f;
+        const char *s;
+        const void *p;
+    };
+    unsigned long length;
+};
+
+/**
+ * @brief A compiled format string as consumed by the log backends.
+ */
+struct FormatView
+{
+    const char *text;
+    const FormatSegment *segments;
+    unsigned int segment_count;
+    unsigned int arg_count;
+    unsigned int length;
+    /// FNV-1a of the text; identifies the format in binary log streams across runs.
+    unsigned long long id;
+};
+
+template<typename T> struct FormatArgTraits;
+
+#define LUNA_FORMAT_ARG(TYPE, KIND)                                                                                  \
+    template<> struct FormatArgTraits<TYPE>                                                                          \
+    {                                                                                                                \
+        static constexpr FormatArgType type = FormatArgType::KIND;                                                   \
+    };
+LUNA_FORMAT_ARG(bool, I32)
+LUNA_FORMAT_ARG(char, CHAR)
+LUNA_FORMAT_ARG(signed char, I32)
+LUNA_FORMAT_ARG(short, I32)
+LUNA_FORMAT_ARG(int, I32)
+LUNA_FORMAT_ARG(unsigned char, U32)
+LUNA_FORMAT_ARG(unsigned short, U32)
+LUNA_FORMAT_ARG(unsigned int, U32)
+LUNA_FORMAT_ARG(long long, I64)
+LUNA_FORMAT_ARG(unsigned long long, U64)
+LUNA_FORMAT_ARG(float, FLOAT)
+LUNA_FORMAT_ARG(double, FLOAT)
+LUNA_FORMAT_ARG(char *, STRING)
+LUNA_FORMAT_ARG(const char *, STRING)
+LUNA_FORMAT_ARG(StringView, STRING)
+LUNA_FORMAT_ARG(decltype(nullptr), POINTER)
+#undef LUNA_FORMAT_ARG
+
+// long is 64-bit on LP64 (Linux, macOS) and 32-bit on LLP64 (Windows).
+template<> struct FormatArgTraits<long>
+{
+    static constexpr FormatArgType type = sizeof(long) == 8 ? FormatArgType::I64 : FormatArgType::I32;
+};
+template<> struct FormatArgTraits<unsigned long>
+{
+    static constexpr FormatArgType type = sizeof(long) == 8 ? FormatArgType::U64 : FormatArgType::U32;
+};
+template<unsigned long N> struct FormatArgTraits<char[N]>
+{
+    static constexpr FormatArgType type = FormatArgType::STRING;
+};
+template<unsigned long N> struct FormatArgTraits<const char[N]>
+{
+    static constexpr FormatArgType type = FormatArgType::STRING;
+};
+template<typename T> struct FormatArgTraits<T *>
+{
+    static constexpr FormatArgType type = FormatArgType::POINTER;
+};
+template<typename T> struct FormatArgTraits<const T *>
+{
+    static constexpr FormatArgType type = FormatArgType::POINTER;
+};
+
+template<typename T> inline constexpr FormatArgType format_arg_type_v = FormatArgTraits<remove_cvref_t<T>>::type;
+
+template<typename T> constexpr FormatArg make_format_arg(const T &value) noexcept
+{
+    FormatArg arg{};
+    constexpr FormatArgType type = format_arg_type_v<T>;
+    if constexpr (type == FormatArgType::I32 || type == FormatArgType::I64 || type == FormatArgType::CHAR)
+    {
+        arg.i = static_cast<long long>(value);
+    }
+    else if constexpr (type == FormatArgType::U32 || type == FormatArgType::U64)
+    {
+        arg.u = static_cast<unsigned long long>(value);
+    }
+    else if constexpr (type == FormatArgType::FLOAT)
+    {
+        arg.f = static_cast<double>(value);
+        arg.length = sizeof(value) == sizeof(float) ? sizeof(float) : 0;
+    }
+    else if constexpr (type == FormatArgType::STRING)
+    {
+        const StringView view(value);
+        arg.s = view.data();
+        arg.length = view.size();
+    }
+    else
+    {
+        arg.p = static_cast<const void *>(value);
+    }
+    return arg;
+}
+
+namespace detail
+{
+// Deliberately not constexpr: reaching one of these during constant evaluation turns a bad format string into a
+// compile error whose message names the problem.
+void format_error_unknown_conversion();
+void format_error_too_few_arguments();
+void format_error_too_many_arguments();
+void format_error_argument_type_mismatch();
+void format_error_too_many_escapes();
+
+constexpr bool spec_accepts(FormatSpec spec, FormatArgType type) noexcept
+{
+    switch (spec)
+    {
+    case FormatSpec::I32:
+        return type == FormatArgType::I32;
+    case FormatSpec::U32:
+        return type == FormatArgType::U32;
+    case FormatSpec::I64:
+        return type == FormatArgType::I64;
+    case FormatSpec::U64:
+        return type == FormatArgType::U64;
+    case FormatSpec::HEX32:
+        return type == FormatArgType::I32 || type == FormatArgType::U32;
+    case FormatSpec::HEX64:
+        return type == FormatArgType::I64 || type == FormatArgType::U64;
+    case FormatSpec::FLOAT:
+        return type == FormatArgType::FLOAT;
+    case FormatSpec::CHAR:
+        return type == FormatArgType::CHAR || type == FormatArgType::I32;
+    case FormatSpec::STRING:
+        return type == FormatArgType::STRING;
+    case FormatSpec::POINTER:
+        return type == FormatArgType::POINTER || type == FormatArgType::STRING;
+    default:
+        return false;
+    }
+}
+
+constexpr FormatSpec width_spec(int longs, FormatSpec narrow, FormatSpec wide) noexcept
+{
+    if (longs == 2 || (longs == 1 && sizeof(long) == 8))
+    {
+        return wide;
+    }
+    return narrow;
+}
+} // namespace detail
+
+enum class FormatParseError : unsigned char
+{
+    NONE,
+    UNKNOWN_CONVERSION,
+    TOO_MANY_SEGMENTS
+};
+
+/**
+ * @brief Splits str into literal runs and width-resolved conversions.
+ * @details Shared by the consteval FormatString constructor and by readers of binary log streams, which only
+ *          have the text. Argument types are not checked here.
+ */
+constexpr FormatParseError parse_format(const char *str, unsigned long len, FormatSegment *segments,
+                                        unsigned int max_segments, unsigned int &segment_count) noexcept
+{
+    segment_count = 0;
+    auto push = [&](unsigned long offset, unsigned long length, FormatSpec spec) {
+        if (segment_count >= max_segments)
+        {
+            return false;
+        }
+        segments[segment_count++] =
+            FormatSegment{static_cast<unsigned short>(offset), static_cast<unsigned short>(length), spec};
+        return true;
+    };
+    unsigned long literal_start = 0;
+    unsigned long i = 0;
+    while (i < len)
+    {
+        if (str[i] != '%')
+        {
+            ++i;
+            continue;
+        }
+        if (i + 1 >= len)
+        {
+            return FormatParseError::UNKNOWN_CONVERSION;
+        }
+        if (str[i + 1] == '%')
+        {
+            // Keep the first '%' in the literal run and restart the text after the second.
+            if (!push(literal_start, i + 1 - literal_start, FormatSpec::NONE))
+            {
+                return FormatParseError::TOO_MANY_SEGMENTS;
+            }
+            i += 2;
+            literal_start = i;
+            continue;
+        }
+
+        unsigned long end = i + 1;
+        int longs = 0;
+        bool size_modifier = false;
+        while (end < len && str[end] == 'l' && longs < 2)
+        {
+            ++longs;
+            ++end;
+        }
+        if (end < len && longs == 0 && str[end] == 'z')
+        {
+            size_modifier = true;
+            ++end;
+        }
+        if (end >= len)
+        {
+            return FormatParseError::UNKNOWN_CONVERSION;
+        }
+        FormatSpec spec = FormatSpec::NONE;
+        switch (str[end])
+        {
+        case 'd':
+        case 'i':
+            spec = size_modifier ? (sizeof(void *) == 8 ? FormatSpec::I64 : FormatSpec::I32)
+                                 : detail::width_spec(longs, FormatSpec::I32, FormatSpec::I64);
+            break;
+        case 'u':
+            spec = size_modifier ? (sizeof(void *) == 8 ? FormatSpec::U64 : FormatSpec::U32)
+                                 : detail::width_spec(longs, FormatSpec::U32, FormatSpec::U64);
+            break;
+        case 'x':
+        case 'X':
+            spec = size_modifier ? (sizeof(void *) == 8 ? FormatSpec::HEX64 : FormatSpec::HEX32)
+                                 : detail::width_spec(longs, FormatSpec::HEX32, FormatSpec::HEX64);
+            break;
+        case 'f':
+            spec = FormatSpec::FLOAT;
+            break;
+        case 'c':
+            spec = FormatSpec::CHAR;
+            break;
+        case 's':
+            spec = FormatSpec::STRING;
+            break;
+        case 'p':
+            spec = FormatSpec::POINTER;
+            break;
+        default:
+            return FormatParseError::UNKNOWN_CONVERSION;
+        }
+        if ((longs != 0 || size_modifier) && (spec == FormatSpec::FLOAT || spec == FormatSpec::CHAR ||
+                                              spec == FormatSpec::STRING || spec == FormatSpec::POINTER))
+        {
+            return FormatParseError::UNKNOWN_CONVERSION;
+        }
+        if (!push(literal_start, i - literal_start, spec))
+        {
+            return FormatParseError::TOO_MANY_SEGMENTS;
+        }
+        i = end + 1;
+        literal_start = i;
+    }
+    if (literal_start < len && !push(literal_start, len - literal_start, FormatSpec::NONE))
+    {
+        return FormatParseError::TOO_MANY_SEGMENTS;
+    }
+    return FormatParseError::NONE;
+}
+
+/**
+ * @brief Number of conversions (arguments) in a parsed format.
+ */
+constexpr unsigned int count_conversions(const FormatSegment *segments, unsigned int segment_count) noexcept
+{
+    unsigned int count = 0;
+    for (unsigned int i = 0; i < segment_count; ++i)
+    {
+        count += segments[i].spec != FormatSpec::NONE;
+    }
+    return count;
+}
+
+/**
+ * @class FormatString
+ * @brief A printf-style format string compiled and type checked against Args at compile time.
+ *
+ * Supported conversions: %d %i %u %x with optional l, ll or z length modifiers, %f, %c, %s (C strings and
+ * StringView), %p and %%. %f prints the shortest decimal that reads back as the argument (see
+ * Utils::double_to_chars), not printf's fixed six places. The consteval constructor splits the string into
+ * literal runs and width-resolved conversions, so formatting never parses at runtime, and rejects unknown
+ * conversions, argument count mismatches and width or type mismatches such as %d given a size_t.
+ */
+template<typename... Args> class FormatString final
+{
+  public:
+    static constexpr unsigned int ARG_COUNT = sizeof...(Args);
+    /// Each %% costs a segment; a handful is plenty for log messages.
+    static constexpr unsigned int MAX_ESCAPES = 4;
+    static constexpr unsigned int MAX_SEGMENTS = ARG_COUNT + MAX_ESCAPES + 1;
+
+    template<unsigned long N>
+    consteval FormatString(const char (&str)[N])
+        : text(str)
+        , id(fnv1a_64(str, N - 1))
+    {
+        static_assert(N - 1 < 0xFFFF, "Format strings are limited to 64 KiB");
+        constexpr FormatArgType arg_types[ARG_COUNT + 1] = {format_arg_type_v<Args>..., FormatArgType::I32};
+        switch (parse_format(str, N - 1, segments, MAX_SEGMENTS, segment_count))
+        {
+        case FormatParseError::UNKNOWN_CONVERSION:
+            detail::format_error_unknown_conversion();
+            break;
+        case FormatParseError::TOO_MANY_SEGMENTS:
+            detail::format_error_too_many_escapes();
+            break;
+        default:
+            break;
+        }
+        unsigned int arg_index = 0;
+        for (unsigned int i = 0; i < segment_count; ++i)
+        {
+            if (segments[i].spec == FormatSpec::NONE)
+            {
+                continue;
+            }
+            if (arg_index >= ARG_COUNT)
+            {
+                detail::format_error_too_few_arguments();
+            }
+            if (!detail::spec_accepts(segments[i].spec, arg_types[arg_index]))
+            {
+                detail::format_error_argument_type_mismatch();
+            }
+            ++arg_index;
+        }
+        if (arg_index != ARG_COUNT)
+        {
+            detail::format_error_too_many_arguments();
+        }
+        length = N - 1;
+    }
+
+    [[nodiscard]] constexpr FormatView view() const noexcept
+    {
+        return FormatView{text, segments, segment_count, ARG_COUNT, length, id};
+    }
+    [[nodiscard]] constexpr const char *c_str() const noexcept
+    {
+        return text;
+    }
+
+  private:
+    const char *text;
+    unsigned long long id;
+    FormatSegment segments[MAX_SEGMENTS] = {};
+    unsigned int segment_count = 0;
+    unsigned int length = 0;
+};
+
+/**
+ * @brief Spelling for parameters that take a compiled format string for the deduced Args.
+ */
+template<typename... Args> using FormatFor = FormatString<type_identity_t<Args>...>;
+} // namespace Utils
+} // namespace LunaVoxelEngine
+#endif
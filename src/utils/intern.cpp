@@ -0,0 +1,258 @@
+#include <platform/log.h>
+#include <platform/thread.h>
+#include <utils/algorithm.h>
+#include <utils/arena.h>
+#include <utils/atomic.h>
+#include <utils/hash.h>
+#include <utils/intern.h>
+
+namespace LunaVoxelEngine::Utils
+{
+namespace
+{
+// StringView's operator== stays byte-wise so it can be constexpr; keys here are compared a word at a time.
+static inline bool equal_bytes(const char *a, const char *b, unsigned long len) noexcept
+{
+    unsigned long i = 0;
+    for (; i + 8 <= len; i += 8)
+    {
+        if (detail::read64(a + i) != detail::read64(b + i))
+        {
+            return false;
+        }
+    }
+    for (; i < len; ++i)
+    {
+        if (a[i] != b[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+struct Entry
+{
+    const char *ptr;
+    unsigned int len;
+    unsigned int hash;
+};
+
+/**
+ * Open-addressed table of (hash << 32 | id) words. Readers probe it without locking; the single writer
+ * (holding the mutex) fills a slot with a release store after the entry it points to is complete, and grows
+ * by publishing a new table. Retired tables are leaked, like the strings, since a reader may still hold one.
+ */
+struct SlotTable
+{
+    static constexpr unsigned long long EMPTY = ~0ULL;
+
+    unsigned int mask;
+    unsigned int count;
+    Atomic<unsigned long long> slots[1];
+
+    static SlotTable *create(unsigned int capacity)
+    {
+        unsigned long bytes = sizeof(SlotTable) + sizeof(Atomic<unsigned long long>) * (capacity - 1);
+        SlotTable *table = reinterpret_cast<SlotTable *>(new char[bytes]);
+        table->mask = capacity - 1;
+        table->count = 0;
+        memset(static_cast<void *>(table->slots), 0xFF, sizeof(Atomic<unsigned long long>) * capacity);
+        return table;
+    }
+};
+
+/**
+ * Entries are stored in fixed-size chunks that never move once allocated, so an id can be resolved without
+ * taking the lock: whoever handed the id to the caller has already synchronised with the insert that
+ * created it.
+ */
+class InternPool final
+{
+  public:
+    static constexpr unsigned int CHUNK_SHIFT = 12;
+    static constexpr unsigned int CHUNK_SIZE = 1u << CHUNK_SHIFT;
+    static constexpr unsigned int MAX_CHUNKS = 1024;
+    static constexpr unsigned int INITIAL_SLOTS = 1024;
+
+    InternPool()
+    {
+        table.store(SlotTable::create(INITIAL_SLOTS), MemoryOrder::RELEASE);
+        // Id 0 is the empty string so that a default-constructed handle is meaningful.
+        insert(StringView("", 0), fold_hash32(xxhash64("", 0)));
+    }
+
+    unsigned int intern(StringView str)
+    {
+        unsigned int hash = fold_hash32(xxhash64(str));
+        unsigned int id = lookup(str, hash);
+        if (id != InternedString::INVALID_ID)
+        {
+            return id;
+        }
+
+        Platform::GuardLock guard(write_mutex);
+        // Another thread may have inserted it since the lock-free probe.
+        id = lookup(str, hash);
+        if (id == InternedString::INVALID_ID)
+        {
+            id = insert(str, hash);
+        }
+        return id;
+    }
+
+    unsigned int find(StringView str) const noexcept
+    {
+        return lookup(str, fold_hash32(xxhash64(str)));
+    }
+
+    const Entry &get(unsigned int id) const noexcept
+    {
+        return chunks[id >> CHUNK_SHIFT][id & (CHUNK_SIZE - 1)];
+    }
+
+    unsigned int size() const noexcept
+    {
+        return count.load(MemoryOrder::RELAXED);
+    }
+
+    unsigned long bytes()
+    {
+        Platform::GuardLock guard(write_mutex);
+        return arena.get_bytes_used();
+    }
+
+  private:
+    Platform::Mutex write_mutex;
+    Arena arena;
+    Entry *chunks[MAX_CHUNKS] = {};
+    Atomic<SlotTable *> table;
+    Atomic<unsigned int> count;
+
+    unsigned int lookup(StringView str, unsigned int hash) const noexcept
+    {
+        const SlotTable *current = table.load(MemoryOrder::ACQUIRE);
+        for (unsigned int i = hash & current->mask;; i = (i + 1) & current->mask)
+        {
+            unsigned long long slot = current->slots[i].load(MemoryOrder::ACQUIRE);
+            if (slot == SlotTable::EMPTY)
+            {
+                return InternedString::INVALID_ID;
+            }
+            if (static_cast<unsigned int>(slot >> 32) == hash)
+            {
+                unsigned int id = static_cast<unsigned int>(slot);
+                const Entry &entry = get(id);
+                if (entry.len == str.size() && equal_bytes(entry.ptr, str.data(), entry.len))
+                {
+                    return id;
+                }
+            }
+        }
+    }
+
+    unsigned int insert(StringView str, unsigned int hash)
+    {
+        unsigned int id = count.load(MemoryOrder::RELAXED);
+        unsigned int chunk = id >> CHUNK_SHIFT;
+        if (chunk >= MAX_CHUNKS)
+        {
+            Log::fatal("Intern pool exhausted (%u strings)", id);
+        }
+        if (chunks[chunk] == nullptr)
+        {
+            chunks[chunk] = arena.allocate_array<Entry>(CHUNK_SIZE);
+        }
+        Entry &entry = chunks[chunk][id & (CHUNK_SIZE - 1)];
+        entry.ptr = arena.copy_string(str.data(), str.size());
+        entry.len = static_cast<unsigned int>(str.size());
+        entry.hash = hash;
+
+        SlotTable *current = table.load(MemoryOrder::RELAXED);
+        // Keep the load factor at or below one half.
+        if ((current->count + 1) * 2 > current->mask + 1)
+        {
+            current = grow(current);
+        }
+        place(current, id, hash);
+        count.store(id + 1, MemoryOrder::RELEASE);
+        return id;
+    }
+
+    static void place(SlotTable *target, unsigned int id, unsigned int hash) noexcept
+    {
+        unsigned int i = hash & target->mask;
+        while (target->slots[i].load(MemoryOrder::RELAXED) != SlotTable::EMPTY)
+        {
+            i = (i + 1) & target->mask;
+        }
+        target->slots[i].store((static_cast<unsigned long long>(hash) << 32) | id, MemoryOrder::RELEASE);
+        ++target->count;
+    }
+
+    SlotTable *grow(SlotTable *old_table)
+    {
+        SlotTable *new_table = SlotTable::create((old_table->mask + 1) * 2);
+        for (unsigned int i = 0; i <= old_table->mask; ++i)
+        {
+            unsigned long long slot = old_table->slots[i].load(MemoryOrder::RELAXED);
+            if (slot != SlotTable::EMPTY)
+            {
+                place(new_table, static_cast<unsigned int>(slot), static_cast<unsigned int>(slot >> 32));
+            }
+        }
+        table.store(new_table, MemoryOrder::RELEASE);
+        return new_table;
+    }
+};
+
+// The pool is deliberately never destroyed: handles may be resolved from static destructors and from
+// threads still running at exit.
+alignas(InternPool) unsigned char pool_storage[sizeof(InternPool)];
+
+InternPool &get_pool()
+{
+    static InternPool *pool = new (pool_storage) InternPool();
+    return *pool;
+}
+} // namespace
+
+InternedString::InternedString(StringView str)
+    : id(get_pool().intern(str))
+{
+}
+
+InternedString InternedString::find(StringView str)
+{
+    return InternedString(get_pool().find(str));
+}
+
+StringView InternedString::view() const noexcept
+{
+    if (id == INVALID_ID)
+    {
+        return StringView();
+    }
+    const Entry &entry = get_pool().get(id);
+    return StringView(entry.ptr, entry.len);
+}
+
+unsigned int InternedString::hash() const noexcept
+{
+    if (id == INVALID_ID)
+    {
+        return 0;
+    }
+    return get_pool().get(id).hash;
+}
+
+unsigned int intern_pool_size()
+{
+    return get_pool().size();
+}
+
+unsigned long intern_pool_bytes()
+{
+    return get_pool().bytes();
+}
+} // namespace LunaVoxelEngine::Utils
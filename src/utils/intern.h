@@ -0,0 +1,87 @@
+#ifndef INTERN_H
+#define INTERN_H
+#include <utils/string_view.h>
+namespace LunaVoxelEngine
+{
+namespace Utils
+{
+/**
+ * @class InternedString
+ * @brief A 32-bit handle to a string stored once in the global intern pool.
+ *
+ * Two handles are equal exactly when their strings are equal, so comparison is a single integer compare and
+ * hash() returns a value computed once at intern time. The characters live in arena storage that is never
+ * freed, so view() and c_str() stay valid for the lifetime of the process and may be called from any thread
+ * without locking. The default handle is the empty string.
+ */
+class InternedString final
+{
+  public:
+    constexpr InternedString() noexcept = default;
+    /**
+     * @brief Looks str up in the pool, adding it on first use. Thread-safe.
+     */
+    explicit InternedString(StringView str);
+
+    /**
+     * @brief Looks str up without adding it.
+     * @return The handle, or an invalid handle (valid() == false) if str was never interned.
+     */
+    static InternedString find(StringView str);
+
+    [[nodiscard]] StringView view() const noexcept;
+    [[nodiscard]] const char *c_str() const noexcept
+    {
+        return view().data();
+    }
+    [[nodiscard]] unsigned int hash() const noexcept;
+    [[nodiscard]] constexpr unsigned int get_id() const noexcept
+    {
+        return id;
+    }
+    [[nodiscard]] constexpr bool valid() const noexcept
+    {
+        return id != INVALID_ID;
+    }
+    [[nodiscard]] constexpr bool empty() const noexcept
+    {
+        return id == 0;
+    }
+
+    [[nodiscard]] constexpr bool operator==(InternedString other) const noexcept
+    {
+        return id == other.id;
+    }
+    [[nodiscard]] constexpr bool operator!=(InternedString other) const noexcept
+    {
+        return id != other.id;
+    }
+    /// Orders by id (interning order), not lexicographically.
+    [[nodiscard]] constexpr bool operator<(InternedString other) const noexcept
+    {
+        return id < other.id;
+    }
+
+    static constexpr unsigned int INVALID_ID = 0xFFFFFFFF;
+
+  private:
+    constexpr explicit InternedString(unsigned int id_in) noexcept
+        : id(id_in)
+    {
+    }
+
+    unsigned int id = 0;
+};
+
+/**
+ * @brief Number of distinct strings interned so far.
+ */
+unsigned int intern_pool_size();
+
+/**
+ * @brief Bytes of string storage held by the intern pool.
+ */
+unsigned long intern_pool_bytes();
+} // namespace Utils
+} // namespace LunaVoxelEngine
+#endif
@@ -0,0 +1,194 @@
+#ifndef PACKED_ARRAY_H
+#define PACKED_ARRAY_H
+#include <utils/algorithm.h>
+#include <utils/bits.h>
+#include <utils/new.h>
+namespace LunaVoxelEngine
+{
+namespace Utils
+{
+/**
+ * @class PackedArray
+ * @brief A fixed-length array of Bits-wide unsigned integers (1-16 bits) packed into 64-bit words.
+ *
+ * Intended for palette indices: a 32^3 chunk with a 16 entry palette takes 16 KiB at 4 bits per voxel
+ * instead of 64 KiB of shorts. Entries never straddle a word (64 / Bits entries per word, the leftover high
+ * bits unused), so get() and set() are a divide by a constant, a shift and a mask.
+ */
+template<unsigned int Bits> class PackedArray final
+{
+    static_assert(Bits >= 1 && Bits <= 16, "PackedArray supports 1 to 16 bits per entry");
+
+  public:
+    using word_type = unsigned long long;
+    using size_type = unsigned long;
+    using value_type = unsigned int;
+    static constexpr unsigned int BITS = Bits;
+    static constexpr size_type PER_WORD = 64 / Bits;
+    static constexpr word_type MASK = (1ULL << Bits) - 1;
+    static constexpr value_type MAX_VALUE = static_cast<value_type>(MASK);
+
+    PackedArray() noexcept = default;
+    explicit PackedArray(size_type count, value_type value = 0)
+        : words(count > 0 ? new word_type[words_for(count)] : nullptr)
+        , entry_count(count)
+    {
+        fill(value);
+    }
+
+    /**
+     * @brief Repacks from a different width, e.g. when a palette outgrows its index size.
+     * @warning Values wider than Bits are truncated.
+     */
+    template<unsigned int OtherBits>
+    explicit PackedArray(const PackedArray<OtherBits> &other)
+        : PackedArray(other.size())
+    {
+        for (size_type i = 0; i < entry_count; ++i)
+        {
+            set(i, other.get(i));
+        }
+    }
+
+    PackedArray(const PackedArray &other)
+        : words(other.entry_count > 0 ? new word_type[words_for(other.entry_count)] : nullptr)
+        , entry_count(other.entry_count)
+    {
+        if (words != nullptr)
+        {
+            memcpy(words, other.words, word_count() * sizeof(word_type));
+        }
+    }
+
+    PackedArray(PackedArray &&other) noexcept
+        : words(other.words)
+        , entry_count(other.entry_count)
+    {
+        other.words = nullptr;
+        other.entry_count = 0;
+    }
+
+    ~PackedArray()
+    {
+        delete[] words;
+    }
+
+    PackedArray &operator=(const PackedArray &other)
+    {
+        if (this != &other)
+        {
+            PackedArray temp(other);
+            swap(temp);
+        }
+        return *this;
+    }
+
+    PackedArray &operator=(PackedArray &&other) noexcept
+    {
+        if (this != &other)
+        {
+            swap(other);
+        }
+        return *this;
+    }
+
+    [[nodiscard]] size_type size() const noexcept
+    {
+        return entry_count;
+    }
+    [[nodiscard]] size_type word_count() const noexcept
+    {
+        return words_for(entry_count);
+    }
+    [[nodiscard]] static constexpr size_type words_for(size_type count) noexcept
+    {
+        return (count + PER_WORD - 1) / PER_WORD;
+    }
+
+    [[nodiscard]] value_type get(size_type index) const noexcept
+    {
+        const size_type shift = (index % PER_WORD) * Bits;
+        return static_cast<value_type>((words[index / PER_WORD] >> shift) & MASK);
+    }
+    [[nodiscard]] value_type operator[](size_type index) const noexcept
+    {
+        return get(index);
+    }
+
+    void set(size_type index, value_type value) noexcept
+    {
+        const size_type shift = (index % PER_WORD) * Bits;
+        word_type &word = words[index / PER_WORD];
+        word = (word & ~(MASK << shift)) | ((static_cast<word_type>(value) & MASK) << shift);
+    }
+
+    /**
+     * @brief Sets every entry to value, a whole word at a time.
+     */
+    void fill(value_type value) noexcept
+    {
+        const word_type pattern = broadcast(value);
+        const size_type total = word_count();
+        for (size_type i = 0; i < total; ++i)
+        {
+            words[i] = pattern;
+        }
+    }
+
+    /**
+     * @brief Counts entries equal to value by comparing whole words.
+     */
+    [[nodiscard]] size_type count(value_type value) const noexcept
+    {
+        // SWAR zero-field test: a field of word ^ pattern is non-zero iff its top bit survives
+        // ((x & LOW) + LOW) | x. The low parts cannot carry into the neighbouring field.
+        constexpr word_type HIGH = broadcast(1u << (Bits - 1));
+        constexpr word_type LOW = broadcast(static_cast<value_type>(MASK >> 1));
+        const word_type pattern = broadcast(value);
+        const size_type full_words = entry_count / PER_WORD;
+        size_type result = 0;
+        for (size_type i = 0; i < full_words; ++i)
+        {
+            const word_type x = words[i] ^ pattern;
+            const word_type non_zero = (((x & LOW) + LOW) | x) & HIGH;
+            result += PER_WORD - static_cast<size_type>(popcount64(non_zero));
+        }
+        for (size_type i = full_words * PER_WORD; i < entry_count; ++i)
+        {
+            result += get(i) == value;
+        }
+        return result;
+    }
+
+    void swap(PackedArray &other) noexcept
+    {
+        Utils::swap(words, other.words);
+        Utils::swap(entry_count, other.entry_count);
+    }
+
+    [[nodiscard]] word_type *data() noexcept
+    {
+        return words;
+    }
+    [[nodiscard]] const word_type *data() const noexcept
+    {
+        return words;
+    }
+
+  private:
+    word_type *words = nullptr;
+    size_type entry_count = 0;
+
+    static constexpr word_type broadcast(value_type value) noexcept
+    {
+        word_type pattern = 0;
+        for (size_type i = 0; i < PER_WORD; ++i)
+        {
+            pattern |= (static_cast<word_type>(value) & MASK) << (i * Bits);
+        }
+        return pattern;
+    }
+};
+} // namespace Utils
+} // namespace LunaVoxelEngine
+#endif
@@ -0,0 +1,249 @@
+#include <utils/bits.h>
+#include <utils/range_allocator.h>
+
+namespace LunaVoxelEngine::Utils
+{
+namespace
+{
+/**
+ * @brief Size class of size: first level is the power of two, second level one of SL_COUNT linear steps in it.
+ *        Sizes below SL_COUNT get a class each in the first row.
+ */
+template<unsigned int SlBits> inline void mapping(unsigned long long size, unsigned int &fl, unsigned int &sl) noexcept
+{
+    if (size < (1ULL << SlBits))
+    {
+        fl = 0;
+        sl = static_cast<unsigned int>(size);
+        return;
+    }
+    const unsigned int log2 = 63 - static_cast<unsigned int>(count_leading_zeros64(size));
+    sl = static_cast<unsigned int>(size >> (log2 - SlBits)) ^ (1u << SlBits);
+    fl = log2 - SlBits + 1;
+}
+} // namespace
+
+RangeAllocator::RangeAllocator(unsigned long long capacity_in)
+{
+    reset(capacity_in);
+}
+
+void RangeAllocator::reset(unsigned long long capacity_in)
+{
+    nodes.clear();
+    unused_nodes = NONE;
+    fl_bitmap = 0;
+    for (unsigned int fl = 0; fl < FL_COUNT; ++fl)
+    {
+        sl_bitmap[fl] = 0;
+        for (unsigned int sl = 0; sl < SL_COUNT; ++sl)
+        {
+            heads[fl][sl] = NONE;
+        }
+    }
+    capacity = capacity_in;
+    free_bytes = capacity_in;
+    if (capacity_in == 0)
+    {
+        return;
+    }
+    const unsigned int index = new_node();
+    nodes[index].offset = 0;
+    nodes[index].size = capacity_in;
+    nodes[index].prev_physical = NONE;
+    nodes[index].next_physical = NONE;
+    insert_free(index);
+}
+
+RangeAllocation RangeAllocator::allocate(unsigned long long size, unsigned long long alignment) noexcept
+{
+    RangeAllocation allocation;
+    size = size > 0 ? size : 1;
+    alignment = alignment > 0 ? alignment : 1;
+    if (size > free_bytes || alignment - 1 > capacity - size)
+    {
+        return allocation;
+    }
+
+    // Any range in a class at or above the rounded-up request is large enough, so the bitmaps answer in O(1).
+    unsigned long long search = size + alignment - 1;
+    if (search >= SL_COUNT)
+    {
+        const unsigned int log2 = 63 - static_cast<unsigned int>(count_leading_zeros64(search));
+        search += (1ULL << (log2 - SL_BITS)) - 1;
+    }
+    unsigned int fl = 0;
+    unsigned int sl = 0;
+    mapping<SL_BITS>(search, fl, sl);
+    if (fl >= FL_COUNT)
+    {
+        return allocation;
+    }
+    unsigned int sl_map = sl_bitmap[fl] & (sl < 32 ? ~0u << sl : 0);
+    if (sl_map == 0)
+    {
+        const unsigned long long fl_map = fl + 1 < 64 ? fl_bitmap & (~0ULL << (fl + 1)) : 0;
+        if (fl_map == 0)
+        {
+            return allocation;
+        }
+        fl = static_cast<unsigned int>(count_trailing_zeros64(fl_map));
+        sl_map = sl_bitmap[fl];
+    }
+    sl = static_cast<unsigned int>(count_trailing_zeros64(sl_map));
+    unsigned int index = heads[fl][sl];
+    remove_free(index);
+
+    const unsigned long long aligned = (nodes[index].offset + alignment - 1) & ~(alignment - 1);
+    const unsigned long long gap = aligned - nodes[index].offset;
+    if (gap > 0)
+    {
+        // Keep the alignment padding as a free range of its own, so it merges back later.
+        split(index, gap);
+        const unsigned int padding = index;
+        index = nodes[padding].next_physical;
+        remove_free(index);
+        insert_free(padding);
+    }
+    if (nodes[index].size > size)
+    {
+        split(index, size);
+    }
+    nodes[index].is_free = false;
+    free_bytes -= nodes[index].size;
+    allocation.offset = nodes[index].offset;
+    allocation.node = index;
+    return allocation;
+}
+
+void RangeAllocator::free(RangeAllocation allocation) noexcept
+{
+    if (!allocation.is_valid())
+    {
+        return;
+    }
+    unsigned int index = allocation.node;
+    free_bytes += nodes[index].size;
+    const unsigned int next = nodes[index].next_physical;
+    if (next != NONE && nodes[next].is_free)
+    {
+        remove_free(next);
+        merge(index, next);
+    }
+    const unsigned int prev = nodes[index].prev_physical;
+    if (prev != NONE && nodes[prev].is_free)
+    {
+        remove_free(prev);
+        merge(prev, index);
+        index = prev;
+    }
+    insert_free(index);
+}
+
+unsigned long long RangeAllocator::get_largest_free() const noexcept
+{
+    if (fl_bitmap == 0)
+    {
+        return 0;
+    }
+    const unsigned int fl = 63 - static_cast<unsigned int>(count_leading_zeros64(fl_bitmap));
+    const unsigned int sl = 31 - static_cast<unsigned int>(count_leading_zeros64(sl_bitmap[fl]) - 32);
+    unsigned long long largest = 0;
+    for (unsigned int i = heads[fl][sl]; i != NONE; i = nodes[i].next_free)
+    {
+        largest = nodes[i].size > largest ? nodes[i].size : largest;
+    }
+    return largest;
+}
+
+unsigned int RangeAllocator::new_node() noexcept
+{
+    if (unused_nodes != NONE)
+    {
+        const unsigned int index = unused_nodes;
+        unused_nodes = nodes[index].next_free;
+        return index;
+    }
+    nodes.emplace_back();
+    return static_cast<unsigned int>(nodes.size() - 1);
+}
+
+void RangeAllocator::insert_free(unsigned int index) noexcept
+{
+    unsigned int fl = 0;
+    unsigned int sl = 0;
+    mapping<SL_BITS>(nodes[index].size, fl, sl);
+    Node &node = nodes[index];
+    node.is_free = true;
+    node.prev_free = NONE;
+    node.next_free = heads[fl][sl];
+    if (node.next_free != NONE)
+    {
+        nodes[node.next_free].prev_free = index;
+    }
+    heads[fl][sl] = index;
+    fl_bitmap |= 1ULL << fl;
+    sl_bitmap[fl] |= 1u << sl;
+}
+
+void RangeAllocator::remove_free(unsigned int index) noexcept
+{
+    unsigned int fl = 0;
+    unsigned int sl = 0;
+    mapping<SL_BITS>(nodes[index].size, fl, sl);
+    Node &node = nodes[index];
+    if (node.prev_free != NONE)
+    {
+        nodes[node.prev_free].next_free = node.next_free;
+    }
+    else
+    {
+        heads[fl][sl] = node.next_free;
+        if (heads[fl][sl] == NONE)
+        {
+            sl_bitmap[fl] &= ~(1u << sl);
+            if (sl_bitmap[fl] == 0)
+            {
+                fl_bitmap &= ~(1ULL << fl);
+            }
+        }
+    }
+    if (node.next_free != NONE)
+    {
+        nodes[node.next_free].prev_free = node.prev_free;
+    }
+    node.is_free = false;
+}
+
+void RangeAllocator::split(unsigned int index, unsigned long long size) noexcept
+{
+    // new_node() may grow the vector, so no references are held across it.
+    const unsigned int rest = new_node();
+    Node &node = nodes[index];
+    Node &tail = nodes[rest];
+    tail.offset = node.offset + size;
+    tail.size = node.size - size;
+    tail.prev_physical = index;
+    tail.next_physical = node.next_physical;
+    if (tail.next_physical != NONE)
+    {
+        nodes[tail.next_physical].prev_physical = rest;
+    }
+    node.size = size;
+    node.next_physical = rest;
+    insert_free(rest);
+}
+
+void RangeAllocator::merge(unsigned int index, unsigned int next) noexcept
+{
+    Node &node = nodes[index];
+    node.size += nodes[next].size;
+    node.next_physical = nodes[next].next_physical;
+    if (node.next_physical != NONE)
+    {
+        nodes[node.next_physical].prev_physical = index;
+    }
+    nodes[next].next_free = unused_nodes;
+    unused_nodes = next;
+}
+} // namespace LunaVoxelEngine::Utils
@@ -0,0 +1,106 @@
+#ifndef RANGE_ALLOCATOR_H
+#define RANGE_ALLOCATOR_H
+#include <utils/vector.h>
+namespace LunaVoxelEngine
+{
+namespace Utils
+{
+struct RangeAllocation
+{
+    static constexpr unsigned int INVALID_NODE = ~0u;
+
+    unsigned long long offset = 0;
+    unsigned int node = INVALID_NODE; ///< Allocator bookkeeping; INVALID_NODE if the allocation failed.
+
+    [[nodiscard]] bool is_valid() const noexcept
+    {
+        return node != INVALID_NODE;
+    }
+};
+
+/**
+ * @class RangeAllocator
+ * @brief Hands out aligned sub-ranges of [0, capacity) with a two-level segregated fit (TLSF).
+ *
+ * Only offsets are managed, never memory, so the same allocator serves GPU memory blocks, shared vertex
+ * buffers and anything else that is carved up by offset. Allocate and free are O(1): a free range is found
+ * from two bitmaps, and freed ranges merge with free neighbours at once, so fragmentation stays low without
+ * compaction. Bookkeeping nodes live in a vector that grows with the number of ranges, not with capacity.
+ * @warning Not thread-safe.
+ */
+class RangeAllocator final
+{
+  public:
+    explicit RangeAllocator(unsigned long long capacity = 0);
+    RangeAllocator(const RangeAllocator &) = delete;
+    RangeAllocator &operator=(const RangeAllocator &) = delete;
+
+    /**
+     * @brief Forgets every allocation and manages [0, capacity) afresh.
+     */
+    void reset(unsigned long long capacity);
+
+    /**
+     * @param alignment A power of two; the returned offset is a multiple of it.
+     * @return An invalid allocation if no free range is large enough.
+     */
+    [[nodiscard]] RangeAllocation allocate(unsigned long long size, unsigned long long alignment = 1) noexcept;
+    void free(RangeAllocation allocation) noexcept;
+
+    [[nodiscard]] unsigned long long get_size(RangeAllocation allocation) const noexcept
+    {
+        return nodes[allocation.node].size;
+    }
+    [[nodiscard]] unsigned long long get_capacity() const noexcept
+    {
+        return capacity;
+    }
+    [[nodiscard]] unsigned long long get_free_bytes() const noexcept
+    {
+        return free_bytes;
+    }
+    /**
+     * @brief The largest single free range; allocations up to this size (less alignment) will succeed.
+     */
+    [[nodiscard]] unsigned long long get_largest_free() const noexcept;
+    [[nodiscard]] bool is_empty() const noexcept
+    {
+        return free_bytes == capacity;
+    }
+
+  private:
+    static constexpr unsigned int SL_BITS = 5;
+    static constexpr unsigned int SL_COUNT = 1u << SL_BITS;
+    static constexpr unsigned int FL_COUNT = 64 - SL_BITS + 1;
+    static constexpr unsigned int NONE = RangeAllocation::INVALID_NODE;
+
+    struct Node
+    {
+        unsigned long long offset;
+        unsigned long long size;
+        unsigned int prev_physical; ///< The range just below this one, or NONE.
+        unsigned int next_physical; ///< The range just above this one, or NONE.
+        unsigned int prev_free;     ///< Links in a size-class list while free; next_free also links unused nodes.
+        unsigned int next_free;
+        bool is_free;
+    };
+
+    Vector<Node> nodes;
+    unsigned int unused_nodes = NONE;
+    unsigned long long fl_bitmap = 0;
+    unsigned int sl_bitmap[FL_COUNT] = {};
+    unsigned int heads[FL_COUNT][SL_COUNT];
+    unsigned long long capacity = 0;
+    unsigned long long free_bytes = 0;
+
+    unsigned int new_node() noexcept;
+    void insert_free(unsigned int index) noexcept;
+    void remove_free(unsigned int index) noexcept;
+    /// Splits [offset + size, end) off node index into a new free node.
+    void split(unsigned int index, unsigned long long size) noexcept;
+    /// Absorbs node next, the physical successor of index, and recycles it.
+    void merge(unsigned int index, unsigned int next) noexcept;
+};
+} // namespace Utils
+} // namespace LunaVoxelEngine
+#endif
@@ -1,6 +1,7 @@
 #include <platform/log.h>
 #include <utils/algorithm.h>
 #include <utils/string.h>
+#include <utils/utf.h>
 
 namespace LunaVoxelEngine::Utils
 {
@@ -208,7 +209,7 @@ String::data_type String::at(String::size_type index) const
 {
     if (index >= len)
     {
-        Log::fatal("Index out of range: %s", ptr);
+        Log::fatal("Index out of range: %lu (length %lu)", index, len);
     }
     return ptr[index];
 }
@@ -217,7 +218,7 @@ String::data_type &String::at(String::size_type index)
 {
     if (index >= len)
     {
-        Log::fatal("Index out of range: %s", ptr);
+        Log::fatal("Index out of range: %lu (length %lu)", index, len);
     }
     return ptr[index];
 }
@@ -562,67 +563,23 @@ const ThrowAwayString String::throw_away() const
 {
     if (!ptr)
         return ThrowAwayString("\0");
-    char *utf8_result = new char[len + 1];
-    memset(utf8_result, '\0', len + 1);
-
-    String::size_type i = 0;
-    long j = 0;
-
-    while (i < len)
-    {
-        String::udata_type code_unit = ptr[i++];
-
-        if (code_unit < 0x80)
-        {
-            // 1-byte UTF-8
-            utf8_result[j++] = static_cast<char>(code_unit);
-        }
-        else if (code_unit < 0x800)
-        {
-            // 2-byte UTF-8
-            utf8_result[j++] = static_cast<char>(0xC0 | (code_unit >> 6));
-            utf8_result[j++] = static_cast<char>(0x80 | (code_unit & 0x3F));
-        }
-        else if (code_unit >= 0xD800 && code_unit <= 0xDBFF)
-        {
-            // Surrogate pair: high surrogate
-            String::udata_type high_surrogate = code_unit;
-            String::udata_type low_surrogate = ptr[i];
+    const udata_type *units = reinterpret_cast<const udata_type *>(ptr);
+    unsigned long utf8_len = utf16_to_utf8_length(units, len);
+    char *utf8_result = new char[utf8_len + 1];
+    utf16_to_utf8(units, len, utf8_result);
+    utf8_result[utf8_len] = '\0';
+    return ThrowAwayString(utf8_result, static_cast<long>(utf8_len));
+}
 
-            if (low_surrogate >= 0xDC00 && low_surrogate <= 0xDFFF)
-            {
-                // Valid surrogate pair
-                i++; // Consume the low surrogate
-                unsigned int code_point = 0x10000 + ((high_surrogate - 0xD800) << 10) + (low_surrogate - 0xDC00);
-
-                // Encode the code point as 4-byte UTF-8
-                utf8_result[j++] = static_cast<char>(0xF0 | (code_point >> 18));
-                utf8_result[j++] = static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
-                utf8_result[j++] = static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
-                utf8_result[j++] = static_cast<char>(0x80 | (code_point & 0x3F));
-            }
-            else
-            {
-                // Invalid surrogate pair; skip the invalid sequence
-                continue;
-            }
-        }
-        else if (code_unit >= 0xDC00 && code_unit <= 0xDFFF)
-        {
-            // Unpaired low surrogate; skip it
-            continue;
-        }
-        else
-        {
-            // 3-byte UTF-8
-            utf8_result[j++] = static_cast<char>(0xE0 | (code_unit >> 12));
-            utf8_result[j++] = static_cast<char>(0x80 | ((code_unit >> 6) & 0x3F));
-            utf8_result[j++] = static_cast<char>(0x80 | (code_unit & 0x3F));
-        }
-    }
-    ThrowAwayString ret(utf8_result);
-    delete[] utf8_result;
-    return ret;
+String8 String::to_utf8() const
+{
+    String8 result;
+    if (!ptr)
+        return result;
+    const udata_type *units = reinterpret_cast<const udata_type *>(ptr);
+    result.resize(utf16_to_utf8_length(units, len));
+    utf16_to_utf8(units, len, result.data());
+    return result;
 }
 
 bool String::start_with(const String &other) const
@@ -651,7 +608,7 @@ void String::clear()
     _str_capacity = 0;
 }
 
-constexpr void String::resize(size_type n, String::data_type ch)
+void String::resize(size_type n, String::data_type ch)
 {
     if (n > len)
     {
@@ -807,38 +764,8 @@ String::Encoding String::detect_encoding(const char *str, long len_in)
 
 String::Encoding String::detect_utf8_heuristic(const char *str, long len_in)
 {
-    String::size_type utf8_sequence_count = 0;
-    String::size_type expected_continuation_bytes = 0;
-
-    for (long i = 0; i < len_in; ++i)
-    {
-        unsigned char byte = static_cast<unsigned char>(str[i]);
-
-        if (expected_continuation_bytes == 0)
-        {
-            if (byte <= 0x7F)
-                continue;
-
-            if ((byte & 0xE0) == 0xC0)
-                expected_continuation_bytes = 1;
-            else if ((byte & 0xF0) == 0xE0)
-                expected_continuation_bytes = 2;
-            else if ((byte & 0xF8) == 0xF0)
-                expected_continuation_bytes = 3;
-            else
-                return String::Encoding::ASCII;
-
-            utf8_sequence_count++;
-        }
-        else
-        {
-            if ((byte & 0xC0) != 0x80)
-                return String::Encoding::ASCII;
-            expected_continuation_bytes--;
-        }
-    }
-
-    return (utf8_sequence_count > 0) ? String::Encoding::UTF8 : String::Encoding::ASCII;
+    // Valid UTF-8 (pure ASCII included) takes the vectorised UTF-8 path; anything else is widened byte by byte.
+    return utf8_validate(str, static_cast<unsigned long>(len_in)) ? String::Encoding::UTF8 : String::Encoding::ASCII;
 }
 
 void String::convert_to_utf16(const char *str, long len_in, String::Encoding encoding)
@@ -848,12 +775,11 @@ void String::convert_to_utf16(const char *str, long len_in, String::Encoding enc
         len_in = strlen(str);
     }
 
-    ensure_capacity(len_in);
-    len = 0;
-
+    // Conversions append at len so that append(const char *) does not overwrite the existing contents.
     switch (encoding)
     {
     case String::Encoding::ASCII:
+        ensure_capacity(len + len_in);
         for (long i = 0; i < len_in; ++i)
         {
             ptr[len++] = static_cast<String::data_type>(str[i]);
@@ -884,91 +810,23 @@ void String::convert_to_utf16(const char *str, long len_in, String::Encoding enc
 
 void String::convert_utf8_to_utf16(const char *str, long len_in)
 {
-    String::size_type utf16_index = 0;
-    for (long i = 0; i < len_in;)
-    {
-        unsigned char first_byte = static_cast<unsigned char>(str[i]);
-
-        if (first_byte < 0x80)
-        {
-            ensure_capacity(utf16_index + 1);
-            ptr[utf16_index++] = first_byte;
-            i++;
-        }
-        else if ((first_byte & 0xE0) == 0xC0)
-        {
-            if (i + 1 >= len_in)
-                Log::fatal("Incomplete UTF-8 sequence");
-
-            unsigned char second_byte = static_cast<unsigned char>(str[i + 1]);
-            if ((second_byte & 0xC0) != 0x80)
-                Log::fatal("Invalid UTF-8 sequence");
-
-            unsigned int code_point = ((first_byte & 0x1F) << 6) | (second_byte & 0x3F);
-            ensure_capacity(utf16_index + 1);
-            ptr[utf16_index++] = static_cast<String::data_type>(code_point);
-            i += 2;
-        }
-
-        else if ((first_byte & 0xF0) == 0xE0)
-        {
-            if (i + 2 >= len_in)
-                Log::fatal("Incomplete UTF-8 sequence");
-
-            unsigned char second_byte = static_cast<unsigned char>(str[i + 1]);
-            unsigned char third_byte = static_cast<unsigned char>(str[i + 2]);
-
-            if ((second_byte & 0xC0) != 0x80 || (third_byte & 0xC0) != 0x80)
-                Log::fatal("Invalid UTF-8 sequence");
-
-            unsigned int code_point = ((first_byte & 0x0F) << 12) | ((second_byte & 0x3F) << 6) | (third_byte & 0x3F);
-            ensure_capacity(utf16_index + 1);
-            ptr[utf16_index++] = static_cast<String::data_type>(code_point);
-            i += 3;
-        }
-
-        else if ((first_byte & 0xF8) == 0xF0)
-        {
-            if (i + 3 >= len_in)
-                Log::fatal("Incomplete UTF-8 sequence");
-
-            unsigned char second_byte = static_cast<unsigned char>(str[i + 1]);
-            unsigned char third_byte = static_cast<unsigned char>(str[i + 2]);
-            unsigned char fourth_byte = static_cast<unsigned char>(str[i + 3]);
-
-            if ((second_byte & 0xC0) != 0x80 || (third_byte & 0xC0) != 0x80 || (fourth_byte & 0xC0) != 0x80)
-                Log::fatal("Invalid UTF-8 sequence");
-
-            unsigned int code_point = ((first_byte & 0x07) << 18) | ((second_byte & 0x3F) << 12) |
-                                      ((third_byte & 0x3F) << 6) | (fourth_byte & 0x3F);
-
-            code_point -= 0x10000;
-            ensure_capacity(utf16_index + 2);
-            ptr[utf16_index++] = 0xD800 | ((code_point >> 10) & 0x3FF);
-            ptr[utf16_index++] = 0xDC00 | (code_point & 0x3FF);
-
-            i += 4;
-        }
-        else
-        {
-            Log::fatal("Invalid UTF-8 start byte");
-        }
-    }
-
-    len = utf16_index;
+    // Validate and size in one pass, allocate once, then transcode with the vector ASCII fast path.
+    long utf16_len = utf8_to_utf16_length(str, static_cast<unsigned long>(len_in));
+    if (utf16_len < 0)
+        Log::fatal("Invalid UTF-8 sequence");
+    ensure_capacity(len + utf16_len);
+    len += utf8_to_utf16(str, static_cast<unsigned long>(len_in), reinterpret_cast<udata_type *>(ptr + len));
 }
 
 void String::convert_utf16le_to_utf16(const char *str, long len_in)
 {
-    ensure_capacity(len_in / 2);
-    len = 0;
+    ensure_capacity(len + len_in / 2);
 
     for (long i = 0; i < len_in; i += 2)
     {
         String::udata_type code_unit =
             (static_cast<unsigned char>(str[i + 1]) << 8) | static_cast<unsigned char>(str[i]);
 
-        ensure_capacity(len + 1);
         ptr[len++] = static_cast<String::data_type>(code_unit);
 
         if (code_unit >= 0xD800 && code_unit <= 0xDBFF)
@@ -982,7 +840,6 @@ void String::convert_utf16le_to_utf16(const char *str, long len_in)
             if (low_surrogate < 0xDC00 || low_surrogate > 0xDFFF)
                 Log::fatal("Invalid low surrogate");
 
-            ensure_capacity(len + 1);
             ptr[len++] = static_cast<String::data_type>(low_surrogate);
             i += 2;
         }
@@ -991,15 +848,13 @@ void String::convert_utf16le_to_utf16(const char *str, long len_in)
 
 void String::convert_utf16be_to_utf16(const char *str, long len_in)
 {
-    ensure_capacity(len_in / 2);
-    len = 0;
+    ensure_capacity(len + len_in / 2);
 
     for (long i = 0; i < len_in; i += 2)
     {
         String::udata_type code_unit =
             (static_cast<unsigned char>(str[i]) << 8) | static_cast<unsigned char>(str[i + 1]);
 
-        ensure_capacity(len + 1);
         ptr[len++] = static_cast<String::data_type>(code_unit);
 
         if (code_unit >= 0xD800 && code_unit <= 0xDBFF)
@@ -1013,7 +868,6 @@ void String::convert_utf16be_to_utf16(const char *str, long len_in)
             if (low_surrogate < 0xDC00 || low_surrogate > 0xDFFF)
                 Log::fatal("Invalid low surrogate");
 
-            ensure_capacity(len + 1);
             ptr[len++] = static_cast<String::data_type>(low_surrogate);
             i += 2;
         }
@@ -1022,8 +876,7 @@ void String::convert_utf16be_to_utf16(const char *str, long len_in)
 
 void String::convert_utf32le_to_utf16(const char *str, long len_in)
 {
-    ensure_capacity(len_in / 4 * 2);
-    len = 0;
+    ensure_capacity(len + len_in / 4 * 2);
 
     for (long i = 0; i < len_in; i += 4)
     {
@@ -1033,13 +886,11 @@ void String::convert_utf32le_to_utf16(const char *str, long len_in)
 
         if (code_point <= 0xFFFF)
         {
-            ensure_capacity(len + 1);
             ptr[len++] = static_cast<String::data_type>(code_point);
         }
         else if (code_point <= 0x10FFFF)
         {
             code_point -= 0x10000;
-            ensure_capacity(len + 2);
             ptr[len++] = 0xD800 | ((code_point >> 10) & 0x3FF);
             ptr[len++] = 0xDC00 | (code_point & 0x3FF);
         }
@@ -1052,8 +903,7 @@ void String::convert_utf32le_to_utf16(const char *str, long len_in)
 
 void String::convert_utf32be_to_utf16(const char *str, long len_in)
 {
-    ensure_capacity(len_in / 4 * 2);
-    len = 0;
+    ensure_capacity(len + len_in / 4 * 2);
 
     for (long i = 0; i < len_in; i += 4)
     {
@@ -1063,13 +913,11 @@ void String::convert_utf32be_to_utf16(const char *str, long len_in)
 
         if (code_point <= 0xFFFF)
         {
-            ensure_capacity(len + 1);
             ptr[len++] = static_cast<String::data_type>(code_point);
         }
         else if (code_point <= 0x10FFFF)
         {
             code_point -= 0x10000;
-            ensure_capacity(len + 2);
             ptr[len++] = 0xD800 | ((code_point >> 10) & 0x3FF);
             ptr[len++] = 0xDC00 | (code_point & 0x3FF);
         }
@@ -3,6 +3,7 @@
 #include <utils/algorithm.h>
 #include <utils/new.h>
 #include <utils/riterator.h>
+#include <utils/string8.h>
 namespace LunaVoxelEngine
 {
 namespace Utils
@@ -66,6 +67,14 @@ class ThrowAwayString final
     }
 
   private:
+    friend class String;
+    /// Adopts a buffer allocated with new[] without copying it.
+    ThrowAwayString(char *owned, long len_in)
+        : ptr(owned)
+        , len(len_in)
+    {
+    }
+
     const char *ptr = nullptr;
     long len = 0;
 };
@@ -138,7 +147,7 @@ class String final
     void shrink_to_fit();
     void resize(size_type new_size);
     void clear();
-    constexpr void resize(size_type n, data_type ch);
+    void resize(size_type n, data_type ch);
     String &append(const char *str);
     String &operator+=(const char *str);
     String &append(const String &other);
@@ -161,6 +170,10 @@ class String final
     constexpr bool operator==(const String &other) const;
     constexpr bool operator!=(const String &other) const;
     const ThrowAwayString throw_away() const;
+    /**
+     * @brief Converts to UTF-8 with a single exact-size allocation (none if it fits inline).
+     */
+    String8 to_utf8() const;
     bool start_with(const String &other) const;
     bool end_with(const String &other) const;
 
@@ -0,0 +1,159 @@
+#include <utils/algorithm.h>
+#include <utils/string8.h>
+
+namespace LunaVoxelEngine::Utils
+{
+String8::String8(StringView view)
+{
+    set_inline_size(0);
+    append(view);
+}
+
+String8::String8(const String8 &other)
+{
+    set_inline_size(0);
+    append(other.view());
+}
+
+String8::String8(String8 &&other) noexcept
+{
+    memcpy(&storage, &other.storage, sizeof(Storage));
+    other.set_inline_size(0);
+}
+
+String8::~String8()
+{
+    if (is_heap())
+    {
+        delete[] storage.heap.ptr;
+    }
+}
+
+String8 &String8::operator=(const String8 &other)
+{
+    if (this != &other)
+    {
+        set_size(0);
+        append(other.view());
+    }
+    return *this;
+}
+
+String8 &String8::operator=(String8 &&other) noexcept
+{
+    if (this != &other)
+    {
+        if (is_heap())
+        {
+            delete[] storage.heap.ptr;
+        }
+        memcpy(&storage, &other.storage, sizeof(Storage));
+        other.set_inline_size(0);
+    }
+    return *this;
+}
+
+String8 &String8::operator=(StringView view)
+{
+    // The view may point into our own buffer, so copy it out before truncating.
+    String8 temp(view);
+    *this = static_cast<String8 &&>(temp);
+    return *this;
+}
+
+void String8::reserve(size_type new_capacity)
+{
+    if (new_capacity > capacity())
+    {
+        grow(new_capacity);
+    }
+}
+
+void String8::resize(size_type new_size, char ch)
+{
+    size_type old_size = size();
+    reserve(new_size);
+    if (new_size > old_size)
+    {
+        memset(data() + old_size, ch, new_size - old_size);
+    }
+    set_size(new_size);
+}
+
+void String8::clear() noexcept
+{
+    set_size(0);
+}
+
+void String8::push_back(char ch)
+{
+    size_type old_size = size();
+    if (old_size + 1 > capacity())
+    {
+        grow(old_size + 1);
+    }
+    data()[old_size] = ch;
+    set_size(old_size + 1);
+}
+
+String8 &String8::append(StringView view)
+{
+    if (view.empty())
+    {
+        return *this;
+    }
+    size_type old_size = size();
+    size_type new_size = old_size + view.size();
+    if (new_size > capacity())
+    {
+        // grow() releases the old buffer, which may be where the view points.
+        const char *old_data = data();
+        if (view.data() >= old_data && view.data() < old_data + old_size)
+        {
+            String8 temp(view);
+            grow(new_size);
+            memcpy(data() + old_size, temp.data(), view.size());
+            set_size(new_size);
+            return *this;
+        }
+        grow(new_size);
+    }
+    memmove(data() + old_size, view.data(), view.size());
+    set_size(new_size);
+    return *this;
+}
+
+void String8::set_size(size_type new_size) noexcept
+{
+    if (is_heap())
+    {
+        storage.heap.len = new_size;
+        storage.heap.ptr[new_size] = '\0';
+    }
+    else
+    {
+        set_inline_size(new_size);
+    }
+}
+
+void String8::grow(size_type min_capacity)
+{
+    size_type old_capacity = capacity();
+    size_type new_capacity = old_capacity * 2;
+    if (new_capacity < min_capacity)
+    {
+        new_capacity = min_capacity;
+    }
+    size_type old_size = size();
+    char *new_ptr = new char[new_capacity + 1];
+    memcpy(new_ptr, data(), old_size);
+    new_ptr[old_size] = '\0';
+    if (is_heap())
+    {
+        delete[] storage.heap.ptr;
+    }
+    storage.heap.ptr = new_ptr;
+    storage.heap.len = old_size;
+    storage.heap.cap = new_capacity | (static_cast<heap_size_type>(HEAP_TAG) << ((sizeof(heap_size_type) - 1) * 8));
+}
+} // namespace LunaVoxelEngine::Utils
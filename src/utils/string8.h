@@ -0,0 +1,173 @@
+#ifndef STRING8_H
+#define STRING8_H
+#include <utils/new.h>
+#include <utils/string_view.h>
+namespace LunaVoxelEngine
+{
+namespace Utils
+{
+/**
+ * @class String8
+ * @brief An owning, null terminated UTF-8 string with small-string optimization.
+ *
+ * Up to 23 bytes are stored inline without touching the heap, which covers log prefixes, window titles and
+ * most asset names. c_str() never copies, so a String8 can be handed straight to the OS and Vulkan.
+ *
+ * Layout: the 24 byte object is either 23 inline bytes followed by a tag byte holding the unused inline
+ * capacity (so a full inline string is terminated by the tag itself), or a heap pointer, length and
+ * capacity whose last byte carries HEAP_TAG.
+ */
+class String8 final
+{
+  public:
+    using size_type = unsigned long;
+    using iterator = char *;
+    using const_iterator = const char *;
+    static constexpr size_type npos = static_cast<size_type>(-1);
+    static constexpr size_type INLINE_CAPACITY = 23;
+
+    String8() noexcept
+    {
+        set_inline_size(0);
+    }
+    String8(StringView view);
+    String8(const char *str)
+        : String8(StringView(str))
+    {
+    }
+    String8(const String8 &other);
+    String8(String8 &&other) noexcept;
+    ~String8();
+    String8 &operator=(const String8 &other);
+    String8 &operator=(String8 &&other) noexcept;
+    String8 &operator=(StringView view);
+
+    [[nodiscard]] const char *c_str() const noexcept
+    {
+        return data();
+    }
+    [[nodiscard]] const char *data() const noexcept
+    {
+        return is_heap() ? storage.heap.ptr : storage.local;
+    }
+    [[nodiscard]] char *data() noexcept
+    {
+        return is_heap() ? storage.heap.ptr : storage.local;
+    }
+    [[nodiscard]] size_type size() const noexcept
+    {
+        return is_heap() ? static_cast<size_type>(storage.heap.len)
+                         : INLINE_CAPACITY - static_cast<unsigned char>(storage.local[INLINE_CAPACITY]);
+    }
+    [[nodiscard]] size_type length() const noexcept
+    {
+        return size();
+    }
+    [[nodiscard]] bool empty() const noexcept
+    {
+        return size() == 0;
+    }
+    [[nodiscard]] size_type capacity() const noexcept
+    {
+        return is_heap() ? static_cast<size_type>(storage.heap.cap & ~HEAP_TAG_MASK) : INLINE_CAPACITY;
+    }
+    [[nodiscard]] bool is_inline() const noexcept
+    {
+        return !is_heap();
+    }
+    [[nodiscard]] StringView view() const noexcept
+    {
+        return StringView(data(), size());
+    }
+    operator StringView() const noexcept
+    {
+        return view();
+    }
+
+    iterator begin() noexcept
+    {
+        return data();
+    }
+    const_iterator begin() const noexcept
+    {
+        return data();
+    }
+    iterator end() noexcept
+    {
+        return data() + size();
+    }
+    const_iterator end() const noexcept
+    {
+        return data() + size();
+    }
+    char operator[](size_type index) const noexcept
+    {
+        return data()[index];
+    }
+    char &operator[](size_type index) noexcept
+    {
+        return data()[index];
+    }
+
+    void reserve(size_type new_capacity);
+    void resize(size_type new_size, char ch = '\0');
+    void clear() noexcept;
+    void push_back(char ch);
+    String8 &append(StringView view);
+    String8 &operator+=(StringView view)
+    {
+        return append(view);
+    }
+    String8 &operator+=(char ch)
+    {
+        push_back(ch);
+        return *this;
+    }
+
+    [[nodiscard]] bool operator==(StringView other) const noexcept
+    {
+        return view() == other;
+    }
+    [[nodiscard]] bool operator!=(StringView other) const noexcept
+    {
+        return view() != other;
+    }
+
+  private:
+    /// 64-bit even where long is 32-bit (LLP64 Windows), so the heap form is 24 bytes on every target.
+    using heap_size_type = unsigned long long;
+    static constexpr unsigned char HEAP_TAG = 0x80;
+    static constexpr heap_size_type HEAP_TAG_MASK = static_cast<heap_size_type>(0xFF)
+                                                    << ((sizeof(heap_size_type) - 1) * 8);
+
+    struct Heap
+    {
+        char *ptr;
+        heap_size_type len;
+        heap_size_type cap; ///< Top byte overlaps the tag byte and is masked off on read.
+    };
+    union Storage {
+        Heap heap;
+        char local[INLINE_CAPACITY + 1];
+    } storage;
+
+    static_assert(sizeof(Heap) == INLINE_CAPACITY + 1, "String8 layout expects a 24 byte heap form");
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#    error "String8 stores its heap tag in the high byte of the capacity and requires a little-endian target"
+#endif
+
+    [[nodiscard]] bool is_heap() const noexcept
+    {
+        return (static_cast<unsigned char>(storage.local[INLINE_CAPACITY]) & HEAP_TAG) != 0;
+    }
+    void set_inline_size(size_type new_size) noexcept
+    {
+        storage.local[new_size] = '\0';
+        storage.local[INLINE_CAPACITY] = static_cast<char>(INLINE_CAPACITY - new_size);
+    }
+    void set_size(size_type new_size) noexcept;
+    void grow(size_type min_capacity);
+};
+} // namespace Utils
+} // namespace LunaVoxelEngine
+#endif
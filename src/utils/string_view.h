@@ -0,0 +1,140 @@
+#ifndef STRING_VIEW_H
+#define STRING_VIEW_H
+namespace LunaVoxelEngine
+{
+namespace Utils
+{
+/**
+ * @class StringView
+ * @brief A non-owning view over UTF-8 bytes.
+ *
+ * Log formats, window titles and file paths are passed around as views so that string literals and
+ * native argv strings reach the OS APIs without being copied or transcoded. A view built from a
+ * string literal or String8 is null terminated; a view produced by substr() generally is not.
+ */
+class [[nodiscard]] StringView final
+{
+  public:
+    using size_type = unsigned long;
+    using const_iterator = const char *;
+    static constexpr size_type npos = static_cast<size_type>(-1);
+
+    constexpr StringView() noexcept = default;
+
+    constexpr StringView(const char *str) noexcept
+        : ptr(str)
+        , len(0)
+    {
+        if (str != nullptr)
+        {
+            while (str[len] != 0)
+            {
+                ++len;
+            }
+        }
+    }
+
+    constexpr StringView(const char *str, size_type len_in) noexcept
+        : ptr(str)
+        , len(len_in)
+    {
+    }
+
+    [[nodiscard]] constexpr const char *data() const noexcept
+    {
+        return ptr;
+    }
+
+    [[nodiscard]] constexpr size_type size() const noexcept
+    {
+        return len;
+    }
+
+    [[nodiscard]] constexpr size_type length() const noexcept
+    {
+        return len;
+    }
+
+    [[nodiscard]] constexpr bool empty() const noexcept
+    {
+        return len == 0;
+    }
+
+    constexpr char operator[](size_type index) const noexcept
+    {
+        return ptr[index];
+    }
+
+    constexpr const_iterator begin() const noexcept
+    {
+        return ptr;
+    }
+
+    constexpr const_iterator end() const noexcept
+    {
+        return ptr + len;
+    }
+
+    [[nodiscard]] constexpr StringView substr(size_type start, size_type count = npos) const noexcept
+    {
+        if (start > len)
+        {
+            start = len;
+        }
+        if (count > len - start)
+        {
+            count = len - start;
+        }
+        return StringView(ptr + start, count);
+    }
+
+    [[nodiscard]] constexpr size_type find(char ch, size_type pos = 0) const noexcept
+    {
+        for (size_type i = pos; i < len; ++i)
+        {
+            if (ptr[i] == ch)
+            {
+                return i;
+            }
+        }
+        return npos;
+    }
+
+    [[nodiscard]] constexpr bool starts_with(StringView other) const noexcept
+    {
+        return len >= other.len && substr(0, other.len) == other;
+    }
+
+    [[nodiscard]] constexpr bool ends_with(StringView other) const noexcept
+    {
+        return len >= other.len && substr(len - other.len) == other;
+    }
+
+    [[nodiscard]] constexpr bool operator==(StringView other) const noexcept
+    {
+        if (len != other.len)
+        {
+            return false;
+        }
+        for (size_type i = 0; i < len; ++i)
+        {
+            if (ptr[i] != other.ptr[i])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    [[nodiscard]] constexpr bool operator!=(StringView other) const noexcept
+    {
+        return !(*this == other);
+    }
+
+  private:
+    const char *ptr = nullptr;
+    size_type len = 0;
+};
+} // namespace Utils
+} // namespace LunaVoxelEngine
+#endif
@@ -0,0 +1,446 @@
+#include <utils/algorithm.h>
+#include <utils/bits.h>
+#include <utils/to_chars.h>
+
+namespace LunaVoxelEngine::Utils
+{
+namespace
+{
+constexpr char DIGIT_PAIRS[] = "00010203040506070809"
+                               "10111213141516171819"
+                               "20212223242526272829"
+                               "30313233343536373839"
+                               "40414243444546474849"
+                               "50515253545556575859"
+                               "60616263646566676869"
+                               "70717273747576777879"
+                               "80818283848586878889"
+                               "90919293949596979899";
+
+constexpr unsigned long long POWERS_OF_10[] = {1ULL,
+                                               10ULL,
+                                               100ULL,
+                                               1000ULL,
+                                               10000ULL,
+                                               100000ULL,
+                                               1000000ULL,
+                                               10000000ULL,
+                                               100000000ULL,
+                                               1000000000ULL,
+                                               10000000000ULL,
+                                               100000000000ULL,
+                                               1000000000000ULL,
+                                               10000000000000ULL,
+                                               100000000000000ULL,
+                                               1000000000000000ULL,
+                                               10000000000000000ULL,
+                                               100000000000000000ULL,
+                                               1000000000000000000ULL,
+                                               10000000000000000000ULL};
+
+inline unsigned int count_digits(unsigned long long value) noexcept
+{
+    if (value < 10)
+    {
+        return 1;
+    }
+    // floor(log10(2^bits)) from the bit length, then one comparison to correct it.
+    const unsigned int bits = static_cast<unsigned int>(64 - count_leading_zeros64(value));
+    const unsigned int approx = (bits * 1233) >> 12;
+    return approx + 1 - (value < POWERS_OF_10[approx]);
+}
+
+inline void write_pair(char *out, unsigned int value) noexcept
+{
+    out[0] = DIGIT_PAIRS[value * 2];
+    out[1] = DIGIT_PAIRS[value * 2 + 1];
+}
+
+// Grisu2, after Loitsch, "Printing Floating-Point Numbers Quickly and Accurately with Integers" (PLDI 2010).
+// All arithmetic is on 64-bit "do-it-yourself" floats f * 2^e.
+struct DiyFp
+{
+    unsigned long long f;
+    int e;
+};
+
+inline DiyFp diy_sub(DiyFp x, DiyFp y) noexcept
+{
+    return DiyFp{x.f - y.f, x.e};
+}
+
+// Upper 64 bits of the 128-bit product, rounded. Written out in halves since MSVC has no 128-bit integer.
+inline DiyFp diy_mul(DiyFp x, DiyFp y) noexcept
+{
+    const unsigned long long x_lo = x.f & 0xFFFFFFFFULL;
+    const unsigned long long x_hi = x.f >> 32;
+    const unsigned long long y_lo = y.f & 0xFFFFFFFFULL;
+    const unsigned long long y_hi = y.f >> 32;
+    const unsigned long long p0 = x_lo * y_lo;
+    const unsigned long long p1 = x_lo * y_hi;
+    const unsigned long long p2 = x_hi * y_lo;
+    const unsigned long long p3 = x_hi * y_hi;
+    unsigned long long middle = (p0 >> 32) + (p1 & 0xFFFFFFFFULL) + (p2 & 0xFFFFFFFFULL);
+    middle += 1ULL << 31;
+    return DiyFp{p3 + (p1 >> 32) + (p2 >> 32) + (middle >> 32), x.e + y.e + 64};
+}
+
+inline DiyFp normalize(DiyFp x) noexcept
+{
+    const int shift = count_leading_zeros64(x.f);
+    return DiyFp{x.f << shift, x.e - shift};
+}
+
+inline DiyFp normalize_to(DiyFp x, int exponent) noexcept
+{
+    return DiyFp{x.f << (x.e - exponent), exponent};
+}
+
+/**
+ * The value and the midpoints to its neighbours, all normalised to the same exponent. Any decimal strictly
+ * between minus and plus reads back as the value.
+ */
+struct Boundaries
+{
+    DiyFp w;
+    DiyFp minus;
+    DiyFp plus;
+};
+
+// bits is the IEEE encoding of a positive finite value with precision significand bits (hidden bit included).
+Boundaries compute_boundaries(unsigned long long bits, int precision, int bias) noexcept
+{
+    const unsigned long long hidden = 1ULL << (precision - 1);
+    const unsigned long long biased_exponent = bits >> (precision - 1);
+    const unsigned long long fraction = bits & (hidden - 1);
+    const DiyFp v = biased_exponent == 0 ? DiyFp{fraction, 1 - bias}
+                                         : DiyFp{fraction + hidden, static_cast<int>(biased_exponent) - bias};
+    // At a power of two the gap below is half the gap above.
+    const bool lower_closer = fraction == 0 && biased_exponent > 1;
+    const DiyFp plus = normalize(DiyFp{2 * v.f + 1, v.e - 1});
+    const DiyFp minus = lower_closer ? DiyFp{4 * v.f - 1, v.e - 2} : DiyFp{2 * v.f - 1, v.e - 1};
+    return Boundaries{normalize(v), normalize_to(minus, plus.e), plus};
+}
+
+struct CachedPower
+{
+    unsigned long long f;
+    int e;
+    int k;
+};
+
+// 10^k for k = -300, -292, ..., 324, normalised to 64 bits and rounded to nearest.
+constexpr CachedPower CACHED_POWERS[] = {
+    {0xAB70FE17C79AC6CAULL, -1060, -300},
+    {0xFF77B1FCBEBCDC4FULL, -1034, -292},
+    {0xBE5691EF416BD60CULL, -1007, -284},
+    {0x8DD01FAD907FFC3CULL, -980, -276},
+    {0xD3515C2831559A83ULL, -954, -268},
+    {0x9D71AC8FADA6C9B5ULL, -927, -260},
+    {0xEA9C227723EE8BCBULL, -901, -252},
+    {0xAECC49914078536DULL, -874, -244},
+    {0x823C12795DB6CE57ULL, -847, -236},
+    {0xC21094364DFB5637ULL, -821, -228},
+    {0x9096EA6F3848984FULL, -794, -220},
+    {0xD77485CB25823AC7ULL, -768, -212},
+    {0xA086CFCD97BF97F4ULL, -741, -204},
+    {0xEF340A98172AACE5ULL, -715, -196},
+    {0xB23867FB2A35B28EULL, -688, -188},
+    {0x84C8D4DFD2C63F3BULL, -661, -180},
+    {0xC5DD44271AD3CDBAULL, -635, -172},
+    {0x936B9FCEBB25C996ULL, -608, -164},
+    {0xDBAC6C247D62A584ULL, -582, -156},
+    {0xA3AB66580D5FDAF6ULL, -555, -148},
+    {0xF3E2F893DEC3F126ULL, -529, -140},
+    {0xB5B5ADA8AAFF80B8ULL, -502, -132},
+    {0x87625F056C7C4A8BULL, -475, -124},
+    {0xC9BCFF6034C13053ULL, -449, -116},
+    {0x964E858C91BA2655ULL, -422, -108},
+    {0xDFF9772470297EBDULL, -396, -100},
+    {0xA6DFBD9FB8E5B88FULL, -369, -92},
+    {0xF8A95FCF88747D94ULL, -343, -84},
+    {0xB94470938FA89BCFULL, -316, -76},
+    {0x8A08F0F8BF0F156BULL, -289, -68},
+    {0xCDB02555653131B6ULL, -263, -60},
+    {0x993FE2C6D07B7FACULL, -236, -52},
+    {0xE45C10C42A2B3B06ULL, -210, -44},
+    {0xAA242499697392D3ULL, -183, -36},
+    {0xFD87B5F28300CA0EULL, -157, -28},
+    {0xBCE5086492111AEBULL, -130, -20},
+    {0x8CBCCC096F5088CCULL, -103, -12},
+    {0xD1B71758E219652CULL, -77, -4},
+    {0x9C40000000000000ULL, -50, 4},
+    {0xE8D4A51000000000ULL, -24, 12},
+    {0xAD78EBC5AC620000ULL, 3, 20},
+    {0x813F3978F8940984ULL, 30, 28},
+    {0xC097CE7BC90715B3ULL, 56, 36},
+    {0x8F7E32CE7BEA5C70ULL, 83, 44},
+    {0xD5D238A4ABE98068ULL, 109, 52},
+    {0x9F4F2726179A2245ULL, 136, 60},
+    {0xED63A231D4C4FB27ULL, 162, 68},
+    {0xB0DE65388CC8ADA8ULL, 189, 76},
+    {0x83C7088E1AAB65DBULL, 216, 84},
+    {0xC45D1DF942711D9AULL, 242, 92},
+    {0x924D692CA61BE758ULL, 269, 100},
+    {0xDA01EE641A708DEAULL, 295, 108},
+    {0xA26DA3999AEF774AULL, 322, 116},
+    {0xF209787BB47D6B85ULL, 348, 124},
+    {0xB454E4A179DD1877ULL, 375, 132},
+    {0x865B86925B9BC5C2ULL, 402, 140},
+    {0xC83553C5C8965D3DULL, 428, 148},
+    {0x952AB45CFA97A0B3ULL, 455, 156},
+    {0xDE469FBD99A05FE3ULL, 481, 164},
+    {0xA59BC234DB398C25ULL, 508, 172},
+    {0xF6C69A72A3989F5CULL, 534, 180},
+    {0xB7DCBF5354E9BECEULL, 561, 188},
+    {0x88FCF317F22241E2ULL, 588, 196},
+    {0xCC20CE9BD35C78A5ULL, 614, 204},
+    {0x98165AF37B2153DFULL, 641, 212},
+    {0xE2A0B5DC971F303AULL, 667, 220},
+    {0xA8D9D1535CE3B396ULL, 694, 228},
+    {0xFB9B7CD9A4A7443CULL, 720, 236},
+    {0xBB764C4CA7A44410ULL, 747, 244},
+    {0x8BAB8EEFB6409C1AULL, 774, 252},
+    {0xD01FEF10A657842CULL, 800, 260},
+    {0x9B10A4E5E9913129ULL, 827, 268},
+    {0xE7109BFBA19C0C9DULL, 853, 276},
+    {0xAC2820D9623BF429ULL, 880, 284},
+    {0x80444B5E7AA7CF85ULL, 907, 292},
+    {0xBF21E44003ACDD2DULL, 933, 300},
+    {0x8E679C2F5E44FF8FULL, 960, 308},
+    {0xD433179D9C8CB841ULL, 986, 316},
+    {0x9E19DB92B4E31BA9ULL, 1013, 324},};
+
+// Digit generation needs the scaled value's exponent in [ALPHA, GAMMA].
+constexpr int ALPHA = -60;
+constexpr int GAMMA = -32;
+
+inline CachedPower cached_power_for(int e) noexcept
+{
+    // k = ceil((ALPHA - e - 1) * log10(2)); the table step of 8 keeps the result within [ALPHA, GAMMA].
+    const int f = ALPHA - e - 1;
+    const int k = (f * 78913) / (1 << 18) + (f > 0);
+    return CACHED_POWERS[(300 + k + 7) / 8];
+}
+
+inline int largest_pow10(unsigned int n, unsigned int &pow10) noexcept
+{
+    int digits = 10;
+    pow10 = 1000000000;
+    while (pow10 > n && digits > 1)
+    {
+        pow10 /= 10;
+        --digits;
+    }
+    return digits;
+}
+
+// Moves the last digit towards w while the result stays inside the boundaries.
+inline void round_towards(char *digits, int length, unsigned long long dist, unsigned long long delta,
+                          unsigned long long rest, unsigned long long ten_k) noexcept
+{
+    while (rest < dist && delta - rest >= ten_k && (rest + ten_k < dist || dist - rest > rest + ten_k - dist))
+    {
+        --digits[length - 1];
+        rest += ten_k;
+    }
+}
+
+void generate_digits(char *digits, int &length, int &exponent, DiyFp minus, DiyFp w, DiyFp plus) noexcept
+{
+    unsigned long long delta = diy_sub(plus, minus).f;
+    unsigned long long dist = diy_sub(plus, w).f;
+    const DiyFp one{1ULL << -plus.e, plus.e};
+    unsigned int integral = static_cast<unsigned int>(plus.f >> -one.e);
+    unsigned long long fractional = plus.f & (one.f - 1);
+
+    unsigned int pow10 = 0;
+    int remaining = largest_pow10(integral, pow10);
+    while (remaining > 0)
+    {
+        digits[length++] = static_cast<char>('0' + integral / pow10);
+        integral %= pow10;
+        --remaining;
+        const unsigned long long rest = (static_cast<unsigned long long>(integral) << -one.e) + fractional;
+        if (rest <= delta)
+        {
+            exponent += remaining;
+            round_towards(digits, length, dist, delta, rest, static_cast<unsigned long long>(pow10) << -one.e);
+            return;
+        }
+        pow10 /= 10;
+    }
+
+    int fraction_digits = 0;
+    while (true)
+    {
+        fractional *= 10;
+        delta *= 10;
+        dist *= 10;
+        digits[length++] = static_cast<char>('0' + (fractional >> -one.e));
+        fractional &= one.f - 1;
+        ++fraction_digits;
+        if (fractional <= delta)
+        {
+            break;
+        }
+    }
+    exponent -= fraction_digits;
+    round_towards(digits, length, dist, delta, fractional, one.f);
+}
+
+// Lays out digits * 10^exponent: plain notation for moderate exponents, scientific otherwise.
+char *write_decimal(char *out, const char *digits, int length, int exponent) noexcept
+{
+    constexpr int MIN_PLAIN = -4;
+    constexpr int MAX_PLAIN = 15;
+    const int point = length + exponent;
+    if (length <= point && point <= MAX_PLAIN)
+    {
+        // 1234e2 -> 123400.0
+        memcpy(out, digits, length);
+        memset(out + length, '0', point - length);
+        out += point;
+        *out++ = '.';
+        *out++ = '0';
+        return out;
+    }
+    if (0 < point && point <= MAX_PLAIN)
+    {
+        // 1234e-2 -> 12.34
+        memcpy(out, digits, point);
+        out[point] = '.';
+        memcpy(out + point + 1, digits + point, length - point);
+        return out + length + 1;
+    }
+    if (MIN_PLAIN < point && point <= 0)
+    {
+        // 1234e-6 -> 0.001234
+        *out++ = '0';
+        *out++ = '.';
+        memset(out, '0', -point);
+        memcpy(out - point, digits, length);
+        return out - point + length;
+    }
+    // 1234e30 -> 1.234e+33
+    *out++ = digits[0];
+    if (length > 1)
+    {
+        *out++ = '.';
+        memcpy(out, digits + 1, length - 1);
+        out += length - 1;
+    }
+    *out++ = 'e';
+    int e = point - 1;
+    *out++ = e < 0 ? '-' : '+';
+    e = e < 0 ? -e : e;
+    if (e >= 100)
+    {
+        *out++ = static_cast<char>('0' + e / 100);
+        e %= 100;
+    }
+    write_pair(out, static_cast<unsigned int>(e));
+    return out + 2;
+}
+
+char *write_shortest(char *out, const Boundaries &boundaries) noexcept
+{
+    const CachedPower cached = cached_power_for(boundaries.plus.e);
+    const DiyFp c_minus_k{cached.f, cached.e};
+    const DiyFp w = diy_mul(boundaries.w, c_minus_k);
+    const DiyFp minus = diy_mul(boundaries.minus, c_minus_k);
+    const DiyFp plus = diy_mul(boundaries.plus, c_minus_k);
+    char digits[20];
+    int length = 0;
+    int exponent = -cached.k;
+    // Shrink the interval by one unit each side to absorb the error of the rounded multiplications.
+    generate_digits(digits, length, exponent, DiyFp{minus.f + 1, minus.e}, w, DiyFp{plus.f - 1, plus.e});
+    return write_decimal(out, digits, length, exponent);
+}
+
+// Shared handling of sign, zero and non-finite values; exponent_mask selects the all-ones exponent field.
+char *write_special_or_shortest(char *out, unsigned long long bits, unsigned long long sign_mask,
+                                unsigned long long exponent_mask, int precision, int bias) noexcept
+{
+    const unsigned long long magnitude = bits & ~sign_mask;
+    if ((magnitude & exponent_mask) == exponent_mask && magnitude != exponent_mask)
+    {
+        memcpy(out, "nan", 3);
+        return out + 3;
+    }
+    if ((bits & sign_mask) != 0)
+    {
+        *out++ = '-';
+    }
+    if (magnitude == exponent_mask)
+    {
+        memcpy(out, "inf", 3);
+        return out + 3;
+    }
+    if (magnitude == 0)
+    {
+        memcpy(out, "0.0", 3);
+        return out + 3;
+    }
+    return write_shortest(out, compute_boundaries(magnitude, precision, bias));
+}
+} // namespace
+
+char *u64_to_chars(char *out, unsigned long long value) noexcept
+{
+    char *const end = out + count_digits(value);
+    char *cursor = end;
+    while (value >= 100)
+    {
+        cursor -= 2;
+        write_pair(cursor, static_cast<unsigned int>(value % 100));
+        value /= 100;
+    }
+    if (value >= 10)
+    {
+        write_pair(cursor - 2, static_cast<unsigned int>(value));
+    }
+    else
+    {
+        cursor[-1] = static_cast<char>('0' + value);
+    }
+    return end;
+}
+
+char *i64_to_chars(char *out, long long value) noexcept
+{
+    if (value < 0)
+    {
+        *out++ = '-';
+        // Negate in unsigned arithmetic so that the minimum value does not overflow.
+        return u64_to_chars(out, 0ULL - static_cast<unsigned long long>(value));
+    }
+    return u64_to_chars(out, static_cast<unsigned long long>(value));
+}
+
+char *hex_to_chars(char *out, unsigned long long value) noexcept
+{
+    static constexpr char DIGITS[] = "0123456789abcdef";
+    const int nibbles = (64 - count_leading_zeros64(value | 1) + 3) / 4;
+    char *const end = out + nibbles;
+    for (char *cursor = end; cursor != out; value >>= 4)
+    {
+        *--cursor = DIGITS[value & 0xF];
+    }
+    return end;
+}
+
+char *double_to_chars(char *out, double value) noexcept
+{
+    unsigned long long bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return write_special_or_shortest(out, bits, 1ULL << 63, 0x7FFULL << 52, 53, 1075);
+}
+
+char *float_to_chars(char *out, float value) noexcept
+{
+    unsigned int bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return write_special_or_shortest(out, bits, 1ULL << 31, 0xFFULL << 23, 24, 150);
+}
+} // namespace LunaVoxelEngine::Utils
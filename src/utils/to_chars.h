@@ -0,0 +1,39 @@
+#ifndef TO_CHARS_H
+#define TO_CHARS_H
+namespace LunaVoxelEngine
+{
+namespace Utils
+{
+/// Worst-case output sizes; callers must provide at least this much room. Nothing is null terminated.
+constexpr unsigned long MAX_U64_CHARS = 20;
+constexpr unsigned long MAX_I64_CHARS = 20;
+constexpr unsigned long MAX_HEX64_CHARS = 16;
+constexpr unsigned long MAX_FLOAT_CHARS = 32;
+
+/**
+ * @brief Writes value in decimal, two digits per division. Returns one past the last character written.
+ */
+char *u64_to_chars(char *out, unsigned long long value) noexcept;
+char *i64_to_chars(char *out, long long value) noexcept;
+
+/**
+ * @brief Writes value in lowercase hexadecimal without a prefix or leading zeros.
+ */
+char *hex_to_chars(char *out, unsigned long long value) noexcept;
+
+/**
+ * @brief Writes a short decimal that reads back as exactly value. Grisu2: always round-trips, and is the
+ *        shortest such decimal for all but a fraction of a percent of values, which get one digit more.
+ * @details Plain notation for decimal exponents in [-4, 15), e.g. "16.6", "1.0", "0.001", otherwise
+ *          scientific, e.g. "1e+20", "1.5e-07". Non-finite values print as "inf", "-inf" and "nan".
+ */
+char *double_to_chars(char *out, double value) noexcept;
+
+/**
+ * @brief As double_to_chars, but shortest at single precision, so 16.6f prints "16.6" and not the digits of
+ *        its widened double.
+ */
+char *float_to_chars(char *out, float value) noexcept;
+} // namespace Utils
+} // namespace LunaVoxelEngine
+#endif
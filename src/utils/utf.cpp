@@ -0,0 +1,457 @@
+#include <utils/bits.h>
+#include <utils/utf.h>
+#if defined(__SSE2__) || defined(_M_X64)
+#    define UTF_SSE2
+#    include <emmintrin.h>
+#endif
+#if defined(__SSSE3__) || defined(__AVX2__)
+#    define UTF_SSSE3
+#    include <tmmintrin.h>
+#endif
+#if defined(__AVX2__)
+#    include <immintrin.h>
+#endif
+#if defined(_MSC_VER)
+#    include <intrin.h>
+#endif
+
+namespace LunaVoxelEngine::Utils
+{
+static inline bool is_continuation(unsigned char byte) noexcept
+{
+    return (byte & 0xC0) == 0x80;
+}
+
+// Returns the first index at or after i that holds a non-ASCII byte (or len).
+static inline unsigned long skip_ascii(const unsigned char *str, unsigned long i, unsigned long len) noexcept
+{
+#if defined(__AVX2__)
+    for (; i + 32 <= len; i += 32)
+    {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(str + i));
+        if (_mm256_movemask_epi8(block) != 0)
+        {
+            break;
+        }
+    }
+#endif
+#if defined(UTF_SSE2)
+    for (; i + 16 <= len; i += 16)
+    {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(str + i));
+        if (_mm_movemask_epi8(block) != 0)
+        {
+            break;
+        }
+    }
+#endif
+    while (i < len && str[i] < 0x80)
+    {
+        ++i;
+    }
+    return i;
+}
+
+static bool validate_scalar(const unsigned char *str, unsigned long i, unsigned long len) noexcept
+{
+    while (i < len)
+    {
+        unsigned char byte = str[i];
+        if (byte < 0x80)
+        {
+            i = skip_ascii(str, i, len);
+            continue;
+        }
+        if (byte < 0xC2)
+        {
+            // Stray continuation byte or overlong two byte form.
+            return false;
+        }
+        if (byte < 0xE0)
+        {
+            if (i + 1 >= len || !is_continuation(str[i + 1]))
+                return false;
+            i += 2;
+        }
+        else if (byte < 0xF0)
+        {
+            if (i + 2 >= len)
+                return false;
+            unsigned char second = str[i + 1];
+            if ((byte == 0xE0 && second < 0xA0) || (byte == 0xED && second >= 0xA0))
+                return false;
+            if (!is_continuation(second) || !is_continuation(str[i + 2]))
+                return false;
+            i += 3;
+        }
+        else if (byte < 0xF5)
+        {
+            if (i + 3 >= len)
+                return false;
+            unsigned char second = str[i + 1];
+            if ((byte == 0xF0 && second < 0x90) || (byte == 0xF4 && second >= 0x90))
+                return false;
+            if (!is_continuation(second) || !is_continuation(str[i + 2]) || !is_continuation(str[i + 3]))
+                return false;
+            i += 4;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+#if defined(UTF_SSSE3)
+// Keiser & Lemire, "Validating UTF-8 In Less Than One Instruction Per Byte" (2021). Each byte pair is classified
+// through three 16 entry nibble tables; any bit surviving the AND is an error, except TWO_CONTS which must line
+// up exactly with the positions that a preceding three or four byte lead requires to be continuations.
+namespace
+{
+constexpr char TOO_SHORT = 1 << 0;
+constexpr char TOO_LONG = 1 << 1;
+constexpr char OVERLONG_3 = 1 << 2;
+constexpr char TOO_LARGE = 1 << 3;
+constexpr char SURROGATE = 1 << 4;
+constexpr char OVERLONG_2 = 1 << 5;
+constexpr char TOO_LARGE_1000 = 1 << 6;
+constexpr char OVERLONG_4 = 1 << 6;
+constexpr char TWO_CONTS = static_cast<char>(1 << 7);
+constexpr char CARRY = TOO_SHORT | TOO_LONG | TWO_CONTS;
+
+class Utf8Checker final
+{
+  public:
+    void check_block(__m128i input) noexcept
+    {
+        if (_mm_movemask_epi8(input) == 0)
+        {
+            // A pure ASCII block is fine unless the previous block ended mid sequence.
+            error = _mm_or_si128(error, prev_incomplete);
+            prev_incomplete = _mm_setzero_si128();
+        }
+        else
+        {
+            check_bytes(input);
+            prev_incomplete = _mm_subs_epu8(input, incomplete_limits());
+        }
+        prev_input = input;
+    }
+
+    [[nodiscard]] bool has_error() const noexcept
+    {
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) != 0xFFFF;
+    }
+
+  private:
+    __m128i error = _mm_setzero_si128();
+    __m128i prev_input = _mm_setzero_si128();
+    __m128i prev_incomplete = _mm_setzero_si128();
+
+    static __m128i high_nibbles(__m128i value) noexcept
+    {
+        return _mm_and_si128(_mm_srli_epi16(value, 4), _mm_set1_epi8(0x0F));
+    }
+
+    static __m128i incomplete_limits() noexcept
+    {
+        // The last three bytes may not start a sequence that needs more bytes than remain in the block.
+        return _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, static_cast<char>(0xF0 - 1),
+                             static_cast<char>(0xE0 - 1), static_cast<char>(0xC0 - 1));
+    }
+
+    void check_bytes(__m128i input) noexcept
+    {
+        __m128i prev1 = _mm_alignr_epi8(input, prev_input, 15);
+        __m128i prev2 = _mm_alignr_epi8(input, prev_input, 14);
+        __m128i prev3 = _mm_alignr_epi8(input, prev_input, 13);
+
+        const __m128i byte_1_high_table =
+            _mm_setr_epi8(TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TWO_CONTS,
+                          TWO_CONTS, TWO_CONTS, TWO_CONTS, TOO_SHORT | OVERLONG_2, TOO_SHORT,
+                          TOO_SHORT | OVERLONG_3 | SURROGATE, TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4);
+        const __m128i byte_1_low_table = _mm_setr_epi8(
+            CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4, CARRY | OVERLONG_2, CARRY, CARRY, CARRY | TOO_LARGE,
+            CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE, CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000);
+        const __m128i byte_2_high_table = _mm_setr_epi8(
+            TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+            TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+            TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+            TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+            TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT);
+
+        __m128i byte_1_high = _mm_shuffle_epi8(byte_1_high_table, high_nibbles(prev1));
+        __m128i byte_1_low = _mm_shuffle_epi8(byte_1_low_table, _mm_and_si128(prev1, _mm_set1_epi8(0x0F)));
+        __m128i byte_2_high = _mm_shuffle_epi8(byte_2_high_table, high_nibbles(input));
+        __m128i special_cases = _mm_and_si128(_mm_and_si128(byte_1_high, byte_1_low), byte_2_high);
+
+        // Only 111xxxxx two back or 1111xxxx three back force this byte to be a continuation.
+        __m128i is_third_byte = _mm_subs_epu8(prev2, _mm_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+        __m128i is_fourth_byte = _mm_subs_epu8(prev3, _mm_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+        __m128i must_be_continuation =
+            _mm_and_si128(_mm_or_si128(is_third_byte, is_fourth_byte), _mm_set1_epi8(TWO_CONTS));
+
+        error = _mm_or_si128(error, _mm_xor_si128(must_be_continuation, special_cases));
+    }
+};
+} // namespace
+#endif
+
+bool utf8_validate(const char *str, unsigned long len) noexcept
+{
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(str);
+#if defined(UTF_SSSE3)
+    unsigned long simd_end = len & ~15UL;
+    Utf8Checker checker;
+    for (unsigned long i = 0; i < simd_end; i += 16)
+    {
+        checker.check_block(_mm_loadu_si128(reinterpret_cast<const __m128i *>(bytes + i)));
+    }
+    if (checker.has_error())
+    {
+        return false;
+    }
+    // Re-check the tail scalar, starting from the lead byte of whatever sequence straddles the last block.
+    unsigned long tail = simd_end;
+    while (tail > 0 && simd_end - tail < 3 && is_continuation(bytes[tail - 1]))
+    {
+        --tail;
+    }
+    if (tail > 0 && bytes[tail - 1] >= 0xC0)
+    {
+        --tail;
+    }
+    return validate_scalar(bytes, tail, len);
+#else
+    return validate_scalar(bytes, 0, len);
+#endif
+}
+
+long utf8_to_utf16_length(const char *str, unsigned long len) noexcept
+{
+    if (!utf8_validate(str, len))
+    {
+        return -1;
+    }
+    // Every non-continuation byte starts one unit; four byte sequences need a second (surrogate) unit.
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(str);
+    long count = 0;
+    unsigned long i = 0;
+#if defined(UTF_SSE2)
+    const __m128i continuation_limit = _mm_set1_epi8(-64);
+    const __m128i four_byte_limit = _mm_set1_epi8(-17);
+    for (; i + 16 <= len; i += 16)
+    {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bytes + i));
+        int non_ascii = _mm_movemask_epi8(block);
+        if (non_ascii == 0)
+        {
+            count += 16;
+            continue;
+        }
+        int continuations = _mm_movemask_epi8(_mm_cmplt_epi8(block, continuation_limit));
+        int four_byte_leads = _mm_movemask_epi8(_mm_cmpgt_epi8(block, four_byte_limit)) & non_ascii;
+        count += 16 - popcount32(continuations) + popcount32(four_byte_leads);
+    }
+#endif
+    for (; i < len; ++i)
+    {
+        unsigned char byte = bytes[i];
+        count += is_continuation(byte) ? 0 : 1;
+        count += byte >= 0xF0 ? 1 : 0;
+    }
+    return count;
+}
+
+unsigned long utf8_to_utf16(const char *str, unsigned long len, unsigned short *out) noexcept
+{
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(str);
+    unsigned long i = 0;
+    unsigned long o = 0;
+    while (i < len)
+    {
+        unsigned long block_end = len;
+#if defined(__AVX2__)
+        if (i + 32 <= len)
+        {
+            __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(bytes + i));
+            if (_mm256_movemask_epi8(block) == 0)
+            {
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + o),
+                                    _mm256_cvtepu8_epi16(_mm256_castsi256_si128(block)));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + o + 16),
+                                    _mm256_cvtepu8_epi16(_mm256_extracti128_si256(block, 1)));
+                i += 32;
+                o += 32;
+                continue;
+            }
+        }
+#endif
+#if defined(UTF_SSE2)
+        if (i + 16 <= len)
+        {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bytes + i));
+            if (_mm_movemask_epi8(block) == 0)
+            {
+                __m128i zero = _mm_setzero_si128();
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(out + o), _mm_unpacklo_epi8(block, zero));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(out + o + 8), _mm_unpackhi_epi8(block, zero));
+                i += 16;
+                o += 16;
+                continue;
+            }
+            // Decode this window scalar before probing for ASCII again, so CJK-heavy text does not pay for a
+            // failed vector probe on every character.
+            block_end = i + 16;
+        }
+#endif
+        while (i < block_end)
+        {
+            unsigned char byte = bytes[i];
+            if (byte < 0x80)
+            {
+                out[o++] = byte;
+                i += 1;
+            }
+            else if (byte < 0xE0)
+            {
+                out[o++] = static_cast<unsigned short>(((byte & 0x1F) << 6) | (bytes[i + 1] & 0x3F));
+                i += 2;
+            }
+            else if (byte < 0xF0)
+            {
+                out[o++] = static_cast<unsigned short>(((byte & 0x0F) << 12) | ((bytes[i + 1] & 0x3F) << 6) |
+                                                       (bytes[i + 2] & 0x3F));
+                i += 3;
+            }
+            else
+            {
+                unsigned int code_point = ((byte & 0x07) << 18) | ((bytes[i + 1] & 0x3F) << 12) |
+                                          ((bytes[i + 2] & 0x3F) << 6) | (bytes[i + 3] & 0x3F);
+                code_point -= 0x10000;
+                out[o++] = static_cast<unsigned short>(0xD800 | (code_point >> 10));
+                out[o++] = static_cast<unsigned short>(0xDC00 | (code_point & 0x3FF));
+                i += 4;
+            }
+        }
+    }
+    return o;
+}
+
+#if defined(UTF_SSE2)
+static inline bool is_ascii_units(__m128i units) noexcept
+{
+    __m128i high_bits = _mm_and_si128(units, _mm_set1_epi16(static_cast<short>(0xFF80)));
+    return _mm_movemask_epi8(_mm_cmpeq_epi16(high_bits, _mm_setzero_si128())) == 0xFFFF;
+}
+#endif
+
+unsigned long utf16_to_utf8_length(const unsigned short *str, unsigned long len) noexcept
+{
+    unsigned long count = 0;
+    unsigned long i = 0;
+    while (i < len)
+    {
+        unsigned long block_end = len;
+#if defined(UTF_SSE2)
+        if (i + 8 <= len)
+        {
+            if (is_ascii_units(_mm_loadu_si128(reinterpret_cast<const __m128i *>(str + i))))
+            {
+                count += 8;
+                i += 8;
+                continue;
+            }
+            block_end = i + 8;
+        }
+#endif
+        while (i < block_end)
+        {
+            unsigned short unit = str[i++];
+            if (unit < 0x80)
+            {
+                count += 1;
+            }
+            else if (unit < 0x800)
+            {
+                count += 2;
+            }
+            else if (unit >= 0xD800 && unit <= 0xDBFF)
+            {
+                if (i < len && str[i] >= 0xDC00 && str[i] <= 0xDFFF)
+                {
+                    count += 4;
+                    ++i;
+                }
+            }
+            else if (unit < 0xDC00 || unit > 0xDFFF)
+            {
+                count += 3;
+            }
+        }
+    }
+    return count;
+}
+
+unsigned long utf16_to_utf8(const unsigned short *str, unsigned long len, char *out) noexcept
+{
+    unsigned long o = 0;
+    unsigned long i = 0;
+    while (i < len)
+    {
+        unsigned long block_end = len;
+#if defined(UTF_SSE2)
+        if (i + 16 <= len)
+        {
+            __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i *>(str + i));
+            __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i *>(str + i + 8));
+            if (is_ascii_units(_mm_or_si128(low, high)))
+            {
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(out + o), _mm_packus_epi16(low, high));
+                i += 16;
+                o += 16;
+                continue;
+            }
+            block_end = i + 16;
+        }
+#endif
+        while (i < block_end)
+        {
+            unsigned short unit = str[i++];
+            if (unit < 0x80)
+            {
+                out[o++] = static_cast<char>(unit);
+            }
+            else if (unit < 0x800)
+            {
+                out[o++] = static_cast<char>(0xC0 | (unit >> 6));
+                out[o++] = static_cast<char>(0x80 | (unit & 0x3F));
+            }
+            else if (unit >= 0xD800 && unit <= 0xDBFF)
+            {
+                if (i < len && str[i] >= 0xDC00 && str[i] <= 0xDFFF)
+                {
+                    unsigned int code_point = 0x10000 + ((unit - 0xD800) << 10) + (str[i] - 0xDC00);
+                    ++i;
+                    out[o++] = static_cast<char>(0xF0 | (code_point >> 18));
+                    out[o++] = static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+                    out[o++] = static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+                    out[o++] = static_cast<char>(0x80 | (code_point & 0x3F));
+                }
+            }
+            else if (unit < 0xDC00 || unit > 0xDFFF)
+            {
+                out[o++] = static_cast<char>(0xE0 | (unit >> 12));
+                out[o++] = static_cast<char>(0x80 | ((unit >> 6) & 0x3F));
+                out[o++] = static_cast<char>(0x80 | (unit & 0x3F));
+            }
+        }
+    }
+    return o;
+}
+} // namespace LunaVoxelEngine::Utils
@@ -0,0 +1,42 @@
+#ifndef UTF_H
+#define UTF_H
+namespace LunaVoxelEngine
+{
+namespace Utils
+{
+/**
+ * @brief Validates UTF-8 (rejects overlong forms, surrogates and code points above U+10FFFF).
+ * @details Uses the Keiser-Lemire lookup algorithm 16 bytes at a time when SSSE3/AVX2 is enabled, otherwise
+ *          skips ASCII runs 16 bytes at a time and validates the rest scalar.
+ */
+bool utf8_validate(const char *str, unsigned long len) noexcept;
+
+/**
+ * @brief Counts the UTF-16 code units needed to hold a UTF-8 string.
+ * @return The exact unit count, or -1 if the input is not valid UTF-8.
+ */
+long utf8_to_utf16_length(const char *str, unsigned long len) noexcept;
+
+/**
+ * @brief Transcodes valid UTF-8 into UTF-16.
+ * @param out Must hold utf8_to_utf16_length(str, len) units.
+ * @return The number of units written.
+ * @warning The input must already have passed utf8_validate().
+ */
+unsigned long utf8_to_utf16(const char *str, unsigned long len, unsigned short *out) noexcept;
+
+/**
+ * @brief Counts the UTF-8 bytes needed to hold a UTF-16 string, excluding the terminator.
+ * @details Unpaired surrogates are dropped, matching utf16_to_utf8().
+ */
+unsigned long utf16_to_utf8_length(const unsigned short *str, unsigned long len) noexcept;
+
+/**
+ * @brief Transcodes UTF-16 into UTF-8 without writing a terminator.
+ * @param out Must hold utf16_to_utf8_length(str, len) bytes.
+ * @return The number of bytes written.
+ */
+unsigned long utf16_to_utf8(const unsigned short *str, unsigned long len, char *out) noexcept;
+} // namespace Utils
+} // namespace LunaVoxelEngine
+#endif
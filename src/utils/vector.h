@@ -43,7 +43,7 @@ template<typename T> class Vector final
 
     constexpr Vector(const Vector &other) noexcept
         : _size{other._size}
-        , _capacity{other._capacity}
+        , _capacity{other._size}
     {
         if (_size > 0)
         {
@@ -60,9 +60,9 @@ template<typename T> class Vector final
     }
 
     constexpr Vector(Vector &&other) noexcept
-        : _size{other._size}
+        : _data{other._data}
+        , _size{other._size}
         , _capacity{other._capacity}
-        , _data{other._data}
     {
         other._data = nullptr;
         other._size = 0;
@@ -290,8 +290,7 @@ template<typename T> class Vector final
 
     void swap(Vector &other) noexcept
     {
-        // Using your custom swap function
-        swap(_data, other._data);
+        Utils::swap(_data, other._data);
         unsigned long temp_size = _size;
         unsigned long temp_capacity = _capacity;
 
@@ -0,0 +1,122 @@
+// LunaTestBindlessSlots: bindless index recycling through a deletion queue against a simulated timeline.
+//
+//     LunaTestBindlessSlots
+//
+// Indices are released the way BindlessHeap::release() and ChunkRenderer release them, by deferring the free to one
+// past the last submitted point, while a simulated GPU completes submissions a few frames late. An index must never
+// be handed out again while a submission that may read it through its old resource is still pending.
+#include "test.h"
+#include <renderer/vulkan/bindless.h>
+
+using namespace LunaVoxelEngine;
+using namespace LunaVoxelEngine::Renderer;
+
+/// Nothing here creates a Vulkan object, but bindless.cpp refers to this.
+VkAllocationCallbacks callbacks{};
+
+constexpr uint32_t CAPACITY = 256;
+constexpr unsigned int FRAMES = 20000;
+constexpr unsigned int MAX_LAG = 3;
+
+struct Slots
+{
+    BindlessSlotAllocator allocator{CAPACITY};
+    /// Per index, the last point whose submission may read it, or 0 while it is free.
+    unsigned long long last_read[CAPACITY] = {};
+    unsigned long long completed = 0;
+    unsigned int early_frees = 0;
+};
+
+static void free_index(void *slots_in, unsigned int freed) noexcept
+{
+    Slots *slots = static_cast<Slots *>(slots_in);
+    if (slots->last_read[freed] > slots->completed)
+    {
+        ++slots->early_frees;
+    }
+    slots->last_read[freed] = 0;
+    slots->allocator.free(freed);
+}
+
+static void test_allocator() noexcept
+{
+    BindlessSlotAllocator allocator(3);
+    const uint32_t a = allocator.allocate();
+    const uint32_t b = allocator.allocate();
+    const uint32_t c = allocator.allocate();
+    LUNA_CHECK(a == 0 && b == 1 && c == 2);
+    LUNA_CHECK(allocator.allocate() == INVALID_BINDLESS_INDEX);
+    LUNA_CHECK(allocator.get_used() == 3);
+    allocator.free(b);
+    LUNA_CHECK(allocator.get_used() == 2);
+    LUNA_CHECK(allocator.allocate() == b);
+    LUNA_CHECK(allocator.get_used() == allocator.get_capacity());
+}
+
+/**
+ * @brief Each frame allocates and releases indices at random, and every live index is read by the frame's
+ *        submission.
+ */
+static void test_simulated_timeline() noexcept
+{
+    Slots slots;
+    DeletionQueue deletions;
+    Test::Random random;
+    Utils::Vector<uint32_t> live;
+    unsigned long long submitted = 0;
+    unsigned int exhausted = 0;
+    for (unsigned int frame = 0; frame < FRAMES; ++frame)
+    {
+        deletions.retire(slots.completed);
+        // More allocations than releases on average, so the set fills and every allocation after that is a reuse.
+        for (unsigned int i = random.below(5); i > 0; --i)
+        {
+            const uint32_t index = slots.allocator.allocate();
+            if (index == INVALID_BINDLESS_INDEX)
+            {
+                ++exhausted;
+                break;
+            }
+            if (!LUNA_CHECK(slots.last_read[index] == 0))
+            {
+                Log::error("  index %u reallocated while point %llu may read it, %llu complete", index,
+                           slots.last_read[index], slots.completed);
+            }
+            live.push_back(index);
+        }
+        for (unsigned int i = random.below(4); i > 0 && !live.empty(); --i)
+        {
+            const unsigned long at = random.below(static_cast<unsigned int>(live.size()));
+            const uint32_t index = live[at];
+            live[at] = live.back();
+            live.pop_back();
+            slots.last_read[index] = submitted + 1;
+            deletions.push(submitted + 1, free_index, &slots, index);
+        }
+
+        // This frame's submission reads every index still live, and those released this frame were recorded into it.
+        ++submitted;
+        for (const uint32_t index : live)
+        {
+            slots.last_read[index] = submitted;
+        }
+        const unsigned int lag = random.below(MAX_LAG + 1);
+        if (submitted > lag && submitted - lag > slots.completed)
+        {
+            slots.completed = submitted - lag;
+        }
+    }
+    LUNA_CHECK(slots.early_frees == 0);
+    LUNA_CHECK(exhausted > 0);
+
+    slots.completed = ~0ull;
+    deletions.flush();
+    LUNA_CHECK(slots.allocator.get_used() == live.size());
+}
+
+int main()
+{
+    test_allocator();
+    test_simulated_timeline();
+    return Test::finish("bindless_slots");
+}
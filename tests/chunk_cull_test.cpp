@@ -0,0 +1,214 @@
+// LunaTestChunkCull: chunk record packing, frustum extraction and the CPU culling path.
+//
+//     LunaTestChunkCull
+//
+// The camera sits at the origin looking down -z through a 90 degree, square perspective with near 1 and far 100,
+// so the frustum's side planes are x = +-z and y = +-z and boxes can be placed against them by hand.
+#include "test.h"
+#include <renderer/vulkan/chunk_cull.h>
+
+using namespace LunaVoxelEngine;
+using namespace LunaVoxelEngine::Renderer;
+
+constexpr float NEAR = 1.0f;
+constexpr float FAR = 100.0f;
+constexpr unsigned int RANDOM_BOXES = 100000;
+
+/// Column-major, right-handed, depth 0 at the near plane and 1 at the far one.
+static const float VIEW_PROJ[16] = {1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, FAR / (NEAR - FAR),
+                                    -1.0f, 0.0f, 0.0f, -(FAR * NEAR) / (FAR - NEAR), 0.0f};
+
+static bool visible(const Frustum &frustum, float x0, float y0, float z0, float x1, float y1, float z1) noexcept
+{
+    const float bounds_min[3] = {x0, y0, z0};
+    const float bounds_max[3] = {x1, y1, z1};
+    return is_box_visible(frustum, bounds_min, bounds_max);
+}
+
+/**
+ * @brief Whether the point is inside the clip volume, straight from the matrix.
+ */
+static bool point_inside(const float point[3]) noexcept
+{
+    float clip[4];
+    for (unsigned int r = 0; r < 4; ++r)
+    {
+        clip[r] = VIEW_PROJ[12 + r];
+        for (unsigned int c = 0; c < 3; ++c)
+        {
+            clip[r] += VIEW_PROJ[c * 4 + r] * point[c];
+        }
+    }
+    return -clip[3] <= clip[0] && clip[0] <= clip[3] && -clip[3] <= clip[1] && clip[1] <= clip[3] &&
+           0.0f <= clip[2] && clip[2] <= clip[3];
+}
+
+static void test_record_layout() noexcept
+{
+    // Offsets the std430 struct in assets/chunk_cull.comp has.
+    LUNA_CHECK(__builtin_offsetof(ChunkDrawRecord, bounds_min) == 0);
+    LUNA_CHECK(__builtin_offsetof(ChunkDrawRecord, index_count) == 12);
+    LUNA_CHECK(__builtin_offsetof(ChunkDrawRecord, bounds_max) == 16);
+    LUNA_CHECK(__builtin_offsetof(ChunkDrawRecord, first_index) == 28);
+    LUNA_CHECK(__builtin_offsetof(ChunkDrawRecord, vertex_offset) == 32);
+    LUNA_CHECK(__builtin_offsetof(ChunkDrawRecord, flags) == 36);
+    LUNA_CHECK(__builtin_offsetof(IndirectDrawCommand, first_instance) == 16);
+
+    const float bounds_min[3] = {-1.5f, 2.0f, 32.0f};
+    const float bounds_max[3] = {14.5f, 18.0f, 48.0f};
+    const ChunkDrawRecord record = pack_chunk_record(bounds_min, bounds_max, 160 * 12, 12, 4000, 36);
+    for (unsigned int axis = 0; axis < 3; ++axis)
+    {
+        LUNA_CHECK(record.bounds_min[axis] == bounds_min[axis] && record.bounds_max[axis] == bounds_max[axis]);
+    }
+    LUNA_CHECK(record.index_count == 36);
+    LUNA_CHECK(record.first_index == 1000);
+    LUNA_CHECK(record.vertex_offset == 160);
+    LUNA_CHECK(record.flags == ChunkDrawRecord::FLAG_LIVE);
+    LUNA_CHECK(record.padding[0] == 0 && record.padding[1] == 0);
+
+    // Offsets past 4 GB of indices or 2^31 vertices do not fit; anything below them must survive.
+    const ChunkDrawRecord far_record = pack_chunk_record(bounds_min, bounds_max, 0x7FFFFFFFull * 16, 16,
+                                                         0xFFFFFFFFull * 4, 3);
+    LUNA_CHECK(far_record.vertex_offset == 0x7FFFFFFF && far_record.first_index == 0xFFFFFFFFu);
+}
+
+static void test_frustum_planes() noexcept
+{
+    const Frustum frustum = extract_frustum(VIEW_PROJ);
+    // A point on each plane is at distance 0 from it; the eye-space points straight ahead are inside all of them.
+    const float on_plane[6][3] = {{-5.0f, 0.0f, -5.0f}, {5.0f, 0.0f, -5.0f}, {0.0f, -5.0f, -5.0f},
+                                  {0.0f, 5.0f, -5.0f},  {0.0f, 0.0f, -NEAR}, {0.0f, 0.0f, -FAR}};
+    for (unsigned int i = 0; i < 6; ++i)
+    {
+        const float *plane = frustum.planes[i];
+        const float *point = on_plane[i];
+        const float distance = plane[0] * point[0] + plane[1] * point[1] + plane[2] * point[2] + plane[3];
+        const float ahead = plane[0] * 0.0f + plane[1] * 0.0f + plane[2] * -10.0f + plane[3];
+        if (!LUNA_CHECK(distance > -1e-3f && distance < 1e-3f) || !LUNA_CHECK(ahead > 0.0f))
+        {
+            Log::error("  plane %u", i);
+        }
+    }
+}
+
+static void test_box_visibility() noexcept
+{
+    const Frustum frustum = extract_frustum(VIEW_PROJ);
+    LUNA_CHECK(visible(frustum, -1.0f, -1.0f, -11.0f, 1.0f, 1.0f, -9.0f));
+    // Straddling each plane, and enclosing the whole frustum.
+    LUNA_CHECK(visible(frustum, 9.0f, -1.0f, -11.0f, 12.0f, 1.0f, -9.0f));
+    LUNA_CHECK(visible(frustum, -1.0f, -12.0f, -11.0f, 1.0f, -9.0f, -9.0f));
+    LUNA_CHECK(visible(frustum, -0.5f, -0.5f, -1.5f, 0.5f, 0.5f, 0.0f));
+    LUNA_CHECK(visible(frustum, -1.0f, -1.0f, -101.0f, 1.0f, 1.0f, -99.0f));
+    LUNA_CHECK(visible(frustum, -200.0f, -200.0f, -200.0f, 200.0f, 200.0f, 200.0f));
+    // Entirely past each plane: left, right, below, above, behind the near plane, beyond the far one.
+    LUNA_CHECK(!visible(frustum, -14.0f, -1.0f, -11.0f, -12.0f, 1.0f, -9.0f));
+    LUNA_CHECK(!visible(frustum, 12.0f, -1.0f, -11.0f, 14.0f, 1.0f, -9.0f));
+    LUNA_CHECK(!visible(frustum, -1.0f, -14.0f, -11.0f, 1.0f, -12.0f, -9.0f));
+    LUNA_CHECK(!visible(frustum, -1.0f, 12.0f, -11.0f, 1.0f, 14.0f, -9.0f));
+    LUNA_CHECK(!visible(frustum, -0.5f, -0.5f, -0.9f, 0.5f, 0.5f, 5.0f));
+    LUNA_CHECK(!visible(frustum, -1.0f, -1.0f, -120.0f, 1.0f, 1.0f, -101.0f));
+    // Past the corner where the right and far planes meet, but not entirely past either: the documented false
+    // positive.
+    LUNA_CHECK(visible(frustum, 100.5f, -1.0f, -110.0f, 110.0f, 1.0f, -99.5f));
+}
+
+/**
+ * @brief Random boxes: one with a corner or its centre inside the clip volume is never culled, and one entirely
+ *        past a single plane always is.
+ */
+static void test_box_random() noexcept
+{
+    const Frustum frustum = extract_frustum(VIEW_PROJ);
+    Test::Random random;
+    unsigned int culled = 0;
+    for (unsigned int i = 0; i < RANDOM_BOXES; ++i)
+    {
+        float bounds_min[3];
+        float bounds_max[3];
+        for (unsigned int axis = 0; axis < 3; ++axis)
+        {
+            const float centre = static_cast<float>(random.below(24000)) / 100.0f - 120.0f;
+            const float half = static_cast<float>(random.below(1000)) / 100.0f;
+            bounds_min[axis] = centre - half;
+            bounds_max[axis] = centre + half;
+        }
+        bool any_inside = false;
+        for (unsigned int corner = 0; corner < 9; ++corner)
+        {
+            float point[3];
+            for (unsigned int axis = 0; axis < 3; ++axis)
+            {
+                point[axis] = corner == 8 ? (bounds_min[axis] + bounds_max[axis]) * 0.5f
+                                          : ((corner >> axis) & 1) != 0 ? bounds_max[axis] : bounds_min[axis];
+            }
+            any_inside = any_inside || point_inside(point);
+        }
+        bool past_one_plane = false;
+        for (const float *plane : frustum.planes)
+        {
+            float nearest = plane[3];
+            for (unsigned int axis = 0; axis < 3; ++axis)
+            {
+                nearest += plane[axis] * (plane[axis] >= 0.0f ? bounds_max[axis] : bounds_min[axis]);
+            }
+            past_one_plane = past_one_plane || nearest < -1e-3f;
+        }
+        const bool result = is_box_visible(frustum, bounds_min, bounds_max);
+        culled += result ? 0 : 1;
+        if (!LUNA_CHECK(!any_inside || result) || !LUNA_CHECK(!past_one_plane || !result))
+        {
+            Log::error("  box %u: (%f %f %f) - (%f %f %f)", i, bounds_min[0], bounds_min[1], bounds_min[2],
+                       bounds_max[0], bounds_max[1], bounds_max[2]);
+            return;
+        }
+    }
+    // Most of the random volume is outside a 90 degree frustum; a test that culls nothing proves little.
+    LUNA_CHECK(culled > RANDOM_BOXES / 2);
+}
+
+static void test_cull_chunks() noexcept
+{
+    const Frustum frustum = extract_frustum(VIEW_PROJ);
+    const float inside_min[3] = {-1.0f, -1.0f, -11.0f};
+    const float inside_max[3] = {1.0f, 1.0f, -9.0f};
+    const float behind_min[3] = {-1.0f, -1.0f, 5.0f};
+    const float behind_max[3] = {1.0f, 1.0f, 7.0f};
+    ChunkDrawRecord records[5] = {
+        pack_chunk_record(inside_min, inside_max, 0, 16, 0, 36),
+        pack_chunk_record(behind_min, behind_max, 1600, 16, 144, 12),
+        pack_chunk_record(inside_min, inside_max, 3200, 16, 192, 6),
+        pack_chunk_record(inside_min, inside_max, 4800, 16, 216, 24),
+        pack_chunk_record(inside_min, inside_max, 6400, 16, 312, 3),
+    };
+    // A removed chunk is skipped even while inside.
+    records[3].flags = 0;
+
+    IndirectDrawCommand commands[5] = {};
+    const unsigned int count = cull_chunks(records, 5, frustum, commands);
+    LUNA_CHECK(count == 3);
+    const unsigned int expected_record[3] = {0, 2, 4};
+    for (unsigned int i = 0; i < 3 && i < count; ++i)
+    {
+        const ChunkDrawRecord &record = records[expected_record[i]];
+        const IndirectDrawCommand &command = commands[i];
+        if (!LUNA_CHECK(command.first_instance == expected_record[i] && command.instance_count == 1 &&
+                        command.index_count == record.index_count && command.first_index == record.first_index &&
+                        command.vertex_offset == record.vertex_offset))
+        {
+            Log::error("  command %u", i);
+        }
+    }
+    LUNA_CHECK(cull_chunks(records, 0, frustum, commands) == 0);
+}
+
+int main()
+{
+    test_record_layout();
+    test_frustum_planes();
+    test_box_visibility();
+    test_box_random();
+    test_cull_chunks();
+    return Test::finish("chunk_cull");
+}
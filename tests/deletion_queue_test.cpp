@@ -0,0 +1,190 @@
+// LunaTestDeletionQueue: DeletionQueue against a simulated timeline.
+//
+//     LunaTestDeletionQueue
+//
+// Deletions are pushed the way Timeline::defer pushes them, at one past the last submitted value, and retired
+// against a simulated GPU that completes submissions a few frames late. The queue never fully drains there, so
+// retire() has to compact it rather than reset it; every deletion must still be destroyed exactly once, in push
+// order, and never before its value completed.
+#include "test.h"
+#include <renderer/vulkan/deletion_queue.h>
+
+using namespace LunaVoxelEngine;
+using namespace LunaVoxelEngine::Renderer;
+
+constexpr unsigned int FRAMES = 20000;
+constexpr unsigned int MAX_LAG = 3;
+constexpr unsigned int MAX_DELETIONS_PER_FRAME = 8;
+
+/// What the destroy and release functions record into; passed as user, or as the owner of a release.
+struct Destroyed
+{
+    Utils::Vector<unsigned long> order;
+    unsigned long long completed = 0;
+    DeletionQueue *queue = nullptr;
+};
+
+/// A deletion as pushed: released with its sequence number as the index, or destroyed with itself as the object.
+struct Deferred
+{
+    unsigned long sequence;
+    unsigned long long value;
+};
+
+static void record(void *destroyed, unsigned int sequence) noexcept
+{
+    static_cast<Destroyed *>(destroyed)->order.push_back(sequence);
+}
+
+static void record_deferred(void *deferred, void *destroyed) noexcept
+{
+    static_cast<Destroyed *>(destroyed)->order.push_back(static_cast<Deferred *>(deferred)->sequence);
+}
+
+static void test_order() noexcept
+{
+    Destroyed destroyed;
+    DeletionQueue queue;
+    queue.push(2, record, &destroyed, 0);
+    queue.push(3, record, &destroyed, 1);
+    // Smaller than the deletion before it, so it waits for 3 too.
+    queue.push(1, record, &destroyed, 2);
+    queue.push(4, record, &destroyed, 3);
+
+    LUNA_CHECK(queue.retire(0) == 0);
+    LUNA_CHECK(queue.get_pending() == 4);
+    LUNA_CHECK(queue.retire(2) == 1);
+    LUNA_CHECK(queue.retire(2) == 0);
+    LUNA_CHECK(queue.retire(3) == 2);
+    LUNA_CHECK(queue.get_pending() == 1);
+    LUNA_CHECK(queue.retire(10) == 1);
+    LUNA_CHECK(queue.get_pending() == 0);
+    LUNA_CHECK(queue.get_destroyed() == 4);
+    if (LUNA_CHECK(destroyed.order.size() == 4))
+    {
+        for (unsigned long i = 0; i < 4; ++i)
+        {
+            LUNA_CHECK(destroyed.order[i] == i);
+        }
+    }
+
+    // An empty queue takes any value again.
+    queue.push(1, record, &destroyed, 4);
+    LUNA_CHECK(queue.retire(1) == 1);
+}
+
+static void push_another(void *destroyed_in, unsigned int sequence) noexcept
+{
+    Destroyed *destroyed = static_cast<Destroyed *>(destroyed_in);
+    record(destroyed, sequence);
+    destroyed->queue->push(0, record, destroyed, 1000);
+}
+
+/**
+ * @brief A release that defers a deletion of its own, as a resource holding another one would.
+ */
+static void test_push_during_retire() noexcept
+{
+    Destroyed destroyed;
+    DeletionQueue queue;
+    destroyed.queue = &queue;
+    queue.push(1, push_another, &destroyed, 0);
+    for (unsigned int i = 1; i < 40; ++i)
+    {
+        queue.push(1, record, &destroyed, i);
+    }
+    queue.push(2, record, &destroyed, 40);
+
+    // The pushed deletion clamps to 2, behind the one already waiting for it.
+    LUNA_CHECK(queue.retire(1) == 40);
+    LUNA_CHECK(queue.get_pending() == 2);
+    LUNA_CHECK(queue.retire(2) == 2);
+    if (LUNA_CHECK(destroyed.order.size() == 42))
+    {
+        LUNA_CHECK(destroyed.order[40] == 40);
+        LUNA_CHECK(destroyed.order[41] == 1000);
+    }
+}
+
+static void check_destroyed(const Destroyed &destroyed, const Utils::Vector<Deferred> &pushed,
+                            unsigned long &checked) noexcept
+{
+    for (; checked < destroyed.order.size(); ++checked)
+    {
+        const unsigned long sequence = destroyed.order[checked];
+        if (!LUNA_CHECK(sequence == checked) || !LUNA_CHECK(pushed[sequence].value <= destroyed.completed))
+        {
+            Log::error("  destroyed %lu as the %luth deletion", sequence, checked);
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Submits a frame at a time, deferring deletions at the next value, while the GPU trails by up to MAX_LAG.
+ */
+static void test_simulated_timeline() noexcept
+{
+    Destroyed destroyed;
+    Utils::Vector<Deferred> pushed;
+    unsigned long checked = 0;
+    unsigned long most_pending = 0;
+    {
+        DeletionQueue queue;
+        Test::Random random;
+        unsigned long long submitted = 0;
+        // Never reallocated, so the destroyed deletions' objects stay put.
+        pushed.reserve(FRAMES * MAX_DELETIONS_PER_FRAME);
+        for (unsigned int frame = 0; frame < FRAMES; ++frame)
+        {
+            const unsigned int count = random.below(MAX_DELETIONS_PER_FRAME + 1);
+            for (unsigned int i = 0; i < count; ++i)
+            {
+                const unsigned long sequence = pushed.size();
+                pushed.push_back({sequence, submitted + 1});
+                // Both kinds of deletion share the one order.
+                if (random.below(2) == 0)
+                {
+                    queue.push(submitted + 1, record, &destroyed, static_cast<unsigned int>(sequence));
+                }
+                else
+                {
+                    queue.push(submitted + 1, record_deferred, &pushed[sequence], &destroyed);
+                }
+            }
+            ++submitted;
+
+            const unsigned int lag = random.below(MAX_LAG + 1);
+            if (submitted > lag && submitted - lag > destroyed.completed)
+            {
+                destroyed.completed = submitted - lag;
+            }
+            const unsigned long before = destroyed.order.size();
+            const unsigned int retired = queue.retire(destroyed.completed);
+            LUNA_CHECK(retired == destroyed.order.size() - before);
+            check_destroyed(destroyed, pushed, checked);
+
+            // Everything at or below completed has gone, and nothing above it.
+            LUNA_CHECK(queue.get_pending() == pushed.size() - destroyed.order.size());
+            LUNA_CHECK(checked == pushed.size() || pushed[checked].value > destroyed.completed);
+            if (queue.get_pending() > most_pending)
+            {
+                most_pending = queue.get_pending();
+            }
+        }
+        LUNA_CHECK(queue.get_destroyed() == destroyed.order.size());
+        destroyed.completed = ~0ull;
+    }
+    // The destructor flushed the rest.
+    check_destroyed(destroyed, pushed, checked);
+    LUNA_CHECK(destroyed.order.size() == pushed.size());
+    LUNA_CHECK(most_pending <= (MAX_LAG + 1) * MAX_DELETIONS_PER_FRAME);
+}
+
+int main()
+{
+    test_order();
+    test_push_during_retire();
+    test_simulated_timeline();
+    return Test::finish("deletion_queue");
+}
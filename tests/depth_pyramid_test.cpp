@@ -0,0 +1,235 @@
+// LunaTestDepthPyramid: the CPU Hi-Z reference, on depth buffers whose pyramids can be worked out by hand.
+//
+//     LunaTestDepthPyramid
+//
+// Occlusion is tested under the identity matrix, an orthographic camera where a point's x and y map straight to
+// the screen (uv = x * 0.5 + 0.5) and z is its depth, so each box below is placed on known pyramid texels. With a
+// 64x64 depth buffer, level 0 is 32x32 and level-0 texel i spans uv [i / 32, (i + 1) / 32).
+#include "test.h"
+#include <renderer/vulkan/chunk_cull.h>
+
+using namespace LunaVoxelEngine;
+using namespace LunaVoxelEngine::Renderer;
+
+constexpr unsigned int SIZE = 64;
+constexpr float WALL_DEPTH = 0.5f;
+/// Source columns 20 and 21, so level-0 column 10, see through the wall to the far plane.
+constexpr unsigned int HOLE_COLUMN = 20;
+
+static const float IDENTITY[16] = {1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f,
+                                   0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f};
+
+static void test_extents() noexcept
+{
+    unsigned int width = 0;
+    unsigned int height = 0;
+    get_pyramid_extent(7, 5, width, height);
+    LUNA_CHECK(width == 3 && height == 2);
+    get_pyramid_extent(1, 1, width, height);
+    LUNA_CHECK(width == 1 && height == 1);
+    get_pyramid_extent(1920, 1080, width, height);
+    LUNA_CHECK(width == 960 && height == 540);
+    LUNA_CHECK(get_pyramid_level_count(1, 1) == 1);
+    LUNA_CHECK(get_pyramid_level_count(3, 2) == 2);
+    LUNA_CHECK(get_pyramid_level_count(960, 540) == 10);
+    LUNA_CHECK(get_pyramid_level_count(32, 1) == 6);
+    LUNA_CHECK(get_pyramid_level_count(1u << 20, 1) == MAX_PYRAMID_LEVELS);
+}
+
+/**
+ * @brief An 8x8 buffer whose depth grows along each row and down the rows, so the farthest texel under any
+ *        square is its bottom-right one.
+ */
+static void test_known_levels() noexcept
+{
+    float depth[8 * 8];
+    for (unsigned int i = 0; i < 8 * 8; ++i)
+    {
+        depth[i] = static_cast<float>(i) / 64.0f;
+    }
+    CpuDepthPyramid pyramid;
+    pyramid.build(depth, 8, 8);
+    LUNA_CHECK(pyramid.get_level_count() == 3);
+    for (unsigned int level = 0; level < pyramid.get_level_count(); ++level)
+    {
+        const unsigned int size = 4u >> level;
+        const unsigned int span = 2u << level; ///< Source texels per texel of this level.
+        if (!LUNA_CHECK(pyramid.get_width(level) == size && pyramid.get_height(level) == size))
+        {
+            return;
+        }
+        for (unsigned int y = 0; y < size; ++y)
+        {
+            for (unsigned int x = 0; x < size; ++x)
+            {
+                const float expected = static_cast<float>((y * span + span - 1) * 8 + x * span + span - 1) / 64.0f;
+                if (!LUNA_CHECK(pyramid.get_texel(level, x, y) == expected))
+                {
+                    Log::error("  level %u texel %u, %u", level, x, y);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Odd sizes fold the leftover row and column into the texel beside them: 7x5 gives a 3x2 level 0 whose
+ *        texels cover columns [0, 3), [2, 5), [4, 7) and rows [0, 3), [2, 5).
+ */
+static void test_odd_levels() noexcept
+{
+    float depth[7 * 5];
+    for (unsigned int i = 0; i < 7 * 5; ++i)
+    {
+        depth[i] = static_cast<float>(i) / 64.0f;
+    }
+    CpuDepthPyramid pyramid;
+    pyramid.build(depth, 7, 5);
+    LUNA_CHECK(pyramid.get_level_count() == 2);
+    const unsigned int expected[2][3] = {{16, 18, 20}, {30, 32, 34}};
+    for (unsigned int y = 0; y < 2; ++y)
+    {
+        for (unsigned int x = 0; x < 3; ++x)
+        {
+            LUNA_CHECK(pyramid.get_texel(0, x, y) == static_cast<float>(expected[y][x]) / 64.0f);
+        }
+    }
+    LUNA_CHECK(pyramid.get_width(1) == 1 && pyramid.get_height(1) == 1);
+    LUNA_CHECK(pyramid.get_texel(1, 0, 0) == 34.0f / 64.0f);
+
+    // The last column and row are not dropped.
+    float corner[7 * 5] = {};
+    corner[4 * 7 + 6] = 1.0f;
+    pyramid.build(corner, 7, 5);
+    LUNA_CHECK(pyramid.get_texel(0, 2, 1) == 1.0f && pyramid.get_texel(0, 1, 1) == 0.0f);
+    LUNA_CHECK(pyramid.get_texel(1, 0, 0) == 1.0f);
+}
+
+/**
+ * @brief Every texel of every level against the farthest depth of the 64x64 source square under it.
+ */
+static void test_random_levels() noexcept
+{
+    float depth[SIZE * SIZE];
+    Test::Random random;
+    for (float &value : depth)
+    {
+        value = static_cast<float>(random.below(1 << 20)) / static_cast<float>(1 << 20);
+    }
+    CpuDepthPyramid pyramid;
+    pyramid.build(depth, SIZE, SIZE);
+    LUNA_CHECK(pyramid.get_level_count() == 6);
+    for (unsigned int level = 0; level < pyramid.get_level_count(); ++level)
+    {
+        const unsigned int size = (SIZE / 2) >> level;
+        const unsigned int span = 2u << level;
+        for (unsigned int y = 0; y < size; ++y)
+        {
+            for (unsigned int x = 0; x < size; ++x)
+            {
+                float farthest = 0.0f;
+                for (unsigned int sy = y * span; sy < (y + 1) * span; ++sy)
+                {
+                    for (unsigned int sx = x * span; sx < (x + 1) * span; ++sx)
+                    {
+                        farthest = Utils::max(farthest, depth[sy * SIZE + sx]);
+                    }
+                }
+                if (!LUNA_CHECK(pyramid.get_texel(level, x, y) == farthest))
+                {
+                    Log::error("  level %u texel %u, %u", level, x, y);
+                    return;
+                }
+            }
+        }
+    }
+}
+
+static PyramidFootprint footprint(float u0, float v0, float u1, float v1) noexcept
+{
+    const ScreenBounds bounds{{u0, v0}, {u1, v1}, 0.0f};
+    return get_pyramid_footprint(bounds, SIZE / 2, SIZE / 2, get_pyramid_level_count(SIZE / 2, SIZE / 2));
+}
+
+static bool has_footprint(const PyramidFootprint &footprint, unsigned int level, unsigned int first_x,
+                          unsigned int last_x, unsigned int first_y, unsigned int last_y) noexcept
+{
+    return footprint.level == level && footprint.first[0] == first_x && footprint.last[0] == last_x &&
+           footprint.first[1] == first_y && footprint.last[1] == last_y;
+}
+
+static void test_footprints() noexcept
+{
+    // Inside one level-0 texel, and across the boundary of two.
+    LUNA_CHECK(has_footprint(footprint(0.26f, 0.40f, 0.28f, 0.42f), 0, 8, 8, 12, 13));
+    LUNA_CHECK(has_footprint(footprint(0.30f, 0.40f, 0.33f, 0.42f), 0, 9, 10, 12, 13));
+    // Across the middle, a boundary at every level.
+    LUNA_CHECK(has_footprint(footprint(0.49f, 0.49f, 0.51f, 0.51f), 0, 15, 16, 15, 16));
+    // Three texels wide at level 0 is two at level 1; eight wide is two at level 2.
+    LUNA_CHECK(has_footprint(footprint(0.30f, 0.40f, 0.36f, 0.42f), 1, 4, 5, 6, 6));
+    LUNA_CHECK(has_footprint(footprint(0.40f, 0.40f, 0.60f, 0.42f), 2, 3, 4, 3, 3));
+    // The whole screen stops at the 2x2 level, with uv 1 clamped to the last texel.
+    LUNA_CHECK(has_footprint(footprint(0.0f, 0.0f, 1.0f, 1.0f), 4, 0, 1, 0, 1));
+    // A point.
+    LUNA_CHECK(has_footprint(footprint(0.5f, 0.5f, 0.5f, 0.5f), 0, 16, 16, 16, 16));
+}
+
+/**
+ * @brief A box spanning uv u0 to u1 across, 0.40 to 0.42 down, and depth z0 to z1.
+ */
+static bool occluded(const CpuDepthPyramid &pyramid, float u0, float u1, float z0, float z1) noexcept
+{
+    const float bounds_min[3] = {u0 * 2.0f - 1.0f, 0.40f * 2.0f - 1.0f, z0};
+    const float bounds_max[3] = {u1 * 2.0f - 1.0f, 0.42f * 2.0f - 1.0f, z1};
+    return is_box_occluded(pyramid, IDENTITY, bounds_min, bounds_max);
+}
+
+/**
+ * @brief A wall at depth 0.5 with a hole down level-0 column 10, uv [0.3125, 0.34375).
+ */
+static void test_occlusion() noexcept
+{
+    float depth[SIZE * SIZE];
+    for (unsigned int y = 0; y < SIZE; ++y)
+    {
+        for (unsigned int x = 0; x < SIZE; ++x)
+        {
+            depth[y * SIZE + x] = x == HOLE_COLUMN || x == HOLE_COLUMN + 1 ? 1.0f : WALL_DEPTH;
+        }
+    }
+    CpuDepthPyramid pyramid;
+    pyramid.build(depth, SIZE, SIZE);
+
+    // Behind the wall, in one texel and straddling two, including the one beside the hole.
+    LUNA_CHECK(occluded(pyramid, 0.26f, 0.28f, 0.7f, 0.8f));
+    LUNA_CHECK(occluded(pyramid, 0.28f, 0.31f, 0.7f, 0.8f));
+    LUNA_CHECK(occluded(pyramid, 0.49f, 0.51f, 0.7f, 0.8f));
+    // Straddling into the hole's texel, and inside it.
+    LUNA_CHECK(!occluded(pyramid, 0.30f, 0.33f, 0.7f, 0.8f));
+    LUNA_CHECK(!occluded(pyramid, 0.32f, 0.34f, 0.7f, 0.8f));
+    // Wide enough to go up to level 1, whose texels 3 and 4 stop short of the hole.
+    LUNA_CHECK(occluded(pyramid, 0.20f, 0.31f, 0.7f, 0.8f));
+    // Wide enough to go up to level 2, whose texel 2 takes in the hole although the box stops short of it: the
+    // coarser level may keep a hidden box, never cull a visible one.
+    LUNA_CHECK(!occluded(pyramid, 0.15f, 0.31f, 0.7f, 0.8f));
+    // In front of the wall, touching it, and through it.
+    LUNA_CHECK(!occluded(pyramid, 0.26f, 0.28f, 0.2f, 0.3f));
+    LUNA_CHECK(!occluded(pyramid, 0.26f, 0.28f, WALL_DEPTH, 0.8f));
+    LUNA_CHECK(!occluded(pyramid, 0.26f, 0.28f, 0.4f, 0.8f));
+    // Crossing the near plane cannot be tested, so it is kept.
+    LUNA_CHECK(!occluded(pyramid, 0.26f, 0.28f, -0.1f, 0.8f));
+    // Nothing is culled before a pyramid is built.
+    CpuDepthPyramid empty;
+    LUNA_CHECK(!occluded(empty, 0.26f, 0.28f, 0.7f, 0.8f));
+}
+
+int main()
+{
+    test_extents();
+    test_known_levels();
+    test_odd_levels();
+    test_random_levels();
+    test_footprints();
+    test_occlusion();
+    return Test::finish("depth_pyramid");
+}
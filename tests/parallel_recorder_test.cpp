@@ -0,0 +1,309 @@
+// LunaTestParallelRecorder: how ParallelRecorder splits a run of draws, and the order the batches are executed in.
+//
+//     LunaTestParallelRecorder
+//
+// volk's function pointers are pointed at a fake driver before the recorder is made, so record() runs for real on
+// its worker threads without a device. The fake hands out numbered command buffers and remembers what the primary
+// buffer executed; the record function notes which buffer and thread recorded each item.
+#include "test.h"
+#include <platform/thread.h>
+#include <renderer/vulkan/parallel_recorder.h>
+#include <utils/atomic.h>
+
+using namespace LunaVoxelEngine;
+using namespace LunaVoxelEngine::Renderer;
+
+/// The recorder creates its command pools with these.
+VkAllocationCallbacks callbacks{};
+
+constexpr unsigned int FRAMES_IN_FLIGHT = 2;
+constexpr unsigned int LARGE_COUNT = 100000;
+constexpr unsigned int MAX_BATCHES = ParallelRecorder::MAX_WORKERS + 1;
+
+/**
+ * @brief What the fake driver has seen. Buffers are allocated from worker threads, so the counters are atomic.
+ */
+struct FakeDriver
+{
+    Utils::Atomic<unsigned long long> next_handle{1};
+    Utils::Atomic<unsigned int> live_pools{0};
+    Utils::Atomic<unsigned int> live_buffers{0};
+    Utils::Atomic<unsigned int> allocations{0};
+    // Written by vkCmdExecuteCommands, which only the calling thread reaches.
+    unsigned int execute_calls = 0;
+    unsigned int executed_count = 0;
+    VkCommandBuffer executed[MAX_BATCHES] = {};
+};
+
+static FakeDriver driver;
+
+static VKAPI_ATTR VkResult VKAPI_CALL fake_create_command_pool(VkDevice, const VkCommandPoolCreateInfo *,
+                                                               const VkAllocationCallbacks *, VkCommandPool *pool)
+{
+    *pool = reinterpret_cast<VkCommandPool>(driver.next_handle.fetch_add(1));
+    driver.live_pools.fetch_add(1);
+    return VK_SUCCESS;
+}
+static VKAPI_ATTR void VKAPI_CALL fake_destroy_command_pool(VkDevice, VkCommandPool, const VkAllocationCallbacks *)
+{
+    driver.live_pools.fetch_sub(1);
+}
+static VKAPI_ATTR VkResult VKAPI_CALL fake_reset_command_pool(VkDevice, VkCommandPool, VkCommandPoolResetFlags)
+{
+    return VK_SUCCESS;
+}
+static VKAPI_ATTR VkResult VKAPI_CALL fake_allocate_command_buffers(VkDevice, const VkCommandBufferAllocateInfo *info,
+                                                                    VkCommandBuffer *buffers)
+{
+    for (uint32_t i = 0; i < info->commandBufferCount; ++i)
+    {
+        buffers[i] = reinterpret_cast<VkCommandBuffer>(driver.next_handle.fetch_add(1));
+    }
+    driver.live_buffers.fetch_add(info->commandBufferCount);
+    driver.allocations.fetch_add(info->commandBufferCount);
+    return VK_SUCCESS;
+}
+static VKAPI_ATTR void VKAPI_CALL fake_free_command_buffers(VkDevice, VkCommandPool, uint32_t count,
+                                                            const VkCommandBuffer *)
+{
+    driver.live_buffers.fetch_sub(count);
+}
+static VKAPI_ATTR VkResult VKAPI_CALL fake_begin_command_buffer(VkCommandBuffer, const VkCommandBufferBeginInfo *)
+{
+    return VK_SUCCESS;
+}
+static VKAPI_ATTR VkResult VKAPI_CALL fake_end_command_buffer(VkCommandBuffer)
+{
+    return VK_SUCCESS;
+}
+static VKAPI_ATTR void VKAPI_CALL fake_set_viewport(VkCommandBuffer, uint32_t, uint32_t, const VkViewport *)
+{
+}
+static VKAPI_ATTR void VKAPI_CALL fake_set_scissor(VkCommandBuffer, uint32_t, uint32_t, const VkRect2D *)
+{
+}
+static VKAPI_ATTR void VKAPI_CALL fake_execute_commands(VkCommandBuffer, uint32_t count, const VkCommandBuffer *buffers)
+{
+    ++driver.execute_calls;
+    driver.executed_count = count;
+    for (uint32_t i = 0; i < count && i < MAX_BATCHES; ++i)
+    {
+        driver.executed[i] = buffers[i];
+    }
+}
+
+static void install_fake_driver() noexcept
+{
+    vkCreateCommandPool = fake_create_command_pool;
+    vkDestroyCommandPool = fake_destroy_command_pool;
+    vkResetCommandPool = fake_reset_command_pool;
+    vkAllocateCommandBuffers = fake_allocate_command_buffers;
+    vkFreeCommandBuffers = fake_free_command_buffers;
+    vkBeginCommandBuffer = fake_begin_command_buffer;
+    vkEndCommandBuffer = fake_end_command_buffer;
+    vkCmdSetViewport = fake_set_viewport;
+    vkCmdSetScissor = fake_set_scissor;
+    vkCmdExecuteCommands = fake_execute_commands;
+}
+
+/**
+ * @brief One record() call as the record function saw it.
+ */
+struct Run
+{
+    struct Batch
+    {
+        VkCommandBuffer buffer;
+        unsigned int first;
+        unsigned int count;
+        size_t thread_id;
+    };
+
+    Platform::Mutex mutex; ///< Guards batches; hits are written to disjoint ranges.
+    Batch batches[MAX_BATCHES] = {};
+    unsigned int batch_count = 0;
+    Utils::Vector<unsigned char> hits;
+
+    explicit Run(unsigned int count)
+        : hits(count, 0)
+    {
+    }
+    const Batch *find(VkCommandBuffer buffer) const noexcept
+    {
+        for (unsigned int i = 0; i < batch_count; ++i)
+        {
+            if (batches[i].buffer == buffer)
+            {
+                return &batches[i];
+            }
+        }
+        return nullptr;
+    }
+};
+
+static void record_items(CommandBuffer &command_buffer, unsigned int first, unsigned int count, void *user) noexcept
+{
+    Run *run = static_cast<Run *>(user);
+    for (unsigned int i = first; i < first + count; ++i)
+    {
+        ++run->hits[i];
+    }
+    Platform::GuardLock guard(run->mutex);
+    if (run->batch_count < MAX_BATCHES)
+    {
+        run->batches[run->batch_count++] = {command_buffer.handle(), first, count, Platform::Thread::get_id()};
+    }
+}
+
+/**
+ * @brief get_batch_count() and get_batch_start() over every small count, for every possible thread count.
+ */
+static void test_batch_split() noexcept
+{
+    constexpr unsigned int MIN_BATCH = ParallelRecorder::MIN_BATCH;
+    for (unsigned int threads = 1; threads <= MAX_BATCHES; ++threads)
+    {
+        for (unsigned int count = 1; count <= (MAX_BATCHES + 1) * MIN_BATCH; count += count < 2 * MIN_BATCH ? 1 : 7)
+        {
+            const unsigned int batches = ParallelRecorder::get_batch_count(count, threads);
+            const unsigned int wanted = count < 2 * MIN_BATCH ? 1 : count / MIN_BATCH;
+            if (!LUNA_CHECK(batches == (wanted < threads ? wanted : threads)))
+            {
+                Log::error("  %u items on %u threads: %u batches", count, threads, batches);
+                return;
+            }
+            unsigned int expected_first = 0;
+            for (unsigned int batch = 0; batch < batches; ++batch)
+            {
+                const unsigned int first = ParallelRecorder::get_batch_start(count, batches, batch);
+                const unsigned int last = ParallelRecorder::get_batch_start(count, batches, batch + 1);
+                const unsigned int size = last - first;
+                if (!LUNA_CHECK(first == expected_first && last > first && size + 1 >= count / batches &&
+                                size <= count / batches + 1 && (batches == 1 || size >= MIN_BATCH)))
+                {
+                    Log::error("  %u items on %u threads: batch %u is [%u, %u)", count, threads, batch, first, last);
+                    return;
+                }
+                expected_first = last;
+            }
+            LUNA_CHECK(expected_first == count);
+        }
+    }
+    LUNA_CHECK(ParallelRecorder::get_batch_count(1, 4) == 1);
+    LUNA_CHECK(ParallelRecorder::get_batch_count(LARGE_COUNT, 4) == 4);
+    LUNA_CHECK(ParallelRecorder::get_batch_count(~0u, MAX_BATCHES) == MAX_BATCHES);
+}
+
+/**
+ * @brief Checks that one record() call recorded every item once, in batches the primary buffer executes in item
+ *        order, with the first batch on the calling thread and the rest on workers.
+ */
+static void check_run(const Run &run, unsigned int count, unsigned int threads, size_t caller) noexcept
+{
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        if (!LUNA_CHECK(run.hits[i] == 1))
+        {
+            Log::error("  %u items on %u threads: item %u recorded %u times", count, threads, i, run.hits[i]);
+            return;
+        }
+    }
+    if (count == 0)
+    {
+        LUNA_CHECK(driver.execute_calls == 0 && run.batch_count == 0);
+        return;
+    }
+    const unsigned int batches = ParallelRecorder::get_batch_count(count, threads);
+    if (!LUNA_CHECK(driver.execute_calls == 1 && driver.executed_count == batches && run.batch_count == batches))
+    {
+        Log::error("  %u items on %u threads: %u batches recorded, %u executed, %u expected", count, threads,
+                   run.batch_count, driver.executed_count, batches);
+        return;
+    }
+    unsigned int next = 0;
+    for (unsigned int i = 0; i < batches; ++i)
+    {
+        const Run::Batch *batch = run.find(driver.executed[i]);
+        if (!LUNA_CHECK(batch != nullptr && batch->first == next))
+        {
+            Log::error("  %u items on %u threads: executed batch %u is not the one starting at %u", count, threads, i,
+                       next);
+            return;
+        }
+        LUNA_CHECK((batch->thread_id == caller) == (i == 0));
+        next = batch->first + batch->count;
+    }
+    LUNA_CHECK(next == count);
+}
+
+/**
+ * @brief Drives a real recorder with counts below, at and above its thread count and its batch size, over two
+ *        rounds of frames, so the second round reuses the buffers the first allocated.
+ */
+static void test_record(unsigned int worker_count) noexcept
+{
+    const unsigned int threads = worker_count + 1;
+    const unsigned int min_batch = ParallelRecorder::MIN_BATCH;
+    const unsigned int counts[] = {0,
+                                   1,
+                                   threads > 1 ? threads - 1 : 1,
+                                   threads,
+                                   threads + 1,
+                                   min_batch - 1,
+                                   min_batch,
+                                   min_batch + 1,
+                                   threads * min_batch - 1,
+                                   threads * min_batch,
+                                   threads * min_batch + 1,
+                                   LARGE_COUNT};
+    constexpr unsigned int COUNT_COUNT = sizeof(counts) / sizeof(counts[0]);
+    const size_t caller = Platform::Thread::get_id();
+    const unsigned int pools_before = driver.live_pools.load();
+    const unsigned int buffers_before = driver.live_buffers.load();
+
+    ParallelRecorder *recorder = new ParallelRecorder(0, worker_count, FRAMES_IN_FLIGHT);
+    LUNA_CHECK(recorder->get_thread_count() == threads);
+    CommandBuffer primary(reinterpret_cast<VkCommandPool>(driver.next_handle.fetch_add(1)));
+    SecondaryTarget target;
+    target.extent = {1280, 720};
+    unsigned int first_round_allocations = 0;
+    for (unsigned int round = 0; round < 2; ++round)
+    {
+        const unsigned int allocations = driver.allocations.load();
+        for (unsigned int frame = 0; frame < FRAMES_IN_FLIGHT; ++frame)
+        {
+            recorder->begin_frame(frame);
+            for (unsigned int i = 0; i < COUNT_COUNT; ++i)
+            {
+                Run run(counts[i]);
+                driver.execute_calls = 0;
+                recorder->record(primary, target, counts[i], record_items, &run);
+                check_run(run, counts[i], threads, caller);
+            }
+        }
+        if (round == 0)
+        {
+            first_round_allocations = driver.allocations.load() - allocations;
+        }
+        else if (!LUNA_CHECK(driver.allocations.load() == allocations))
+        {
+            Log::error("  %u threads: %u buffers allocated in the second round, %u in the first", threads,
+                       driver.allocations.load() - allocations, first_round_allocations);
+        }
+    }
+    delete recorder;
+    LUNA_CHECK(driver.live_pools.load() == pools_before);
+    LUNA_CHECK(driver.live_buffers.load() == buffers_before + 1);
+}
+
+int main()
+{
+    install_fake_driver();
+    test_batch_split();
+    test_record(0);
+    test_record(1);
+    test_record(3);
+    test_record(ParallelRecorder::MAX_WORKERS);
+    LUNA_CHECK(driver.live_pools.load() == 0);
+    return Test::finish("parallel_recorder");
+}
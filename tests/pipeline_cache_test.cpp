@@ -0,0 +1,194 @@
+// LunaTestPipelineCache: which pipeline cache files validate_pipeline_cache hands to the driver.
+//
+//     LunaTestPipelineCache
+//
+// Files are built in memory the way PipelineCache::save writes them, then damaged one field at a time. The hash
+// is recomputed after each edit to the driver's header, so those cases are rejected by the driver check rather
+// than by the hash.
+#include "test.h"
+#include <renderer/vulkan/pipeline_cache.h>
+#include <utils/algorithm.h>
+#include <utils/hash.h>
+
+using namespace LunaVoxelEngine;
+using namespace LunaVoxelEngine::Renderer;
+
+/// PipelineCache allocates through these; the test never creates one.
+VkAllocationCallbacks callbacks{};
+
+constexpr unsigned int VENDOR_ID = 0x10DE;
+constexpr unsigned int DEVICE_ID = 0x2684;
+constexpr unsigned int DRIVER_HEADER_SIZE = 16 + VK_UUID_SIZE;
+constexpr unsigned int PAYLOAD_SIZE = 200;
+constexpr unsigned int FILE_SIZE = sizeof(PipelineCacheFileHeader) + DRIVER_HEADER_SIZE + PAYLOAD_SIZE;
+
+/**
+ * @brief A cache file as save() writes it: the file header, then driver data that starts with the driver's header.
+ */
+struct CacheFile
+{
+    unsigned char bytes[FILE_SIZE];
+    unsigned char uuid[VK_UUID_SIZE];
+
+    CacheFile() noexcept
+    {
+        for (unsigned int i = 0; i < VK_UUID_SIZE; ++i)
+        {
+            uuid[i] = static_cast<unsigned char>(0xA0 + i);
+        }
+        unsigned char *data = driver_data();
+        write_u32(0, DRIVER_HEADER_SIZE);
+        write_u32(4, VK_PIPELINE_CACHE_HEADER_VERSION_ONE);
+        write_u32(8, VENDOR_ID);
+        write_u32(12, DEVICE_ID);
+        Utils::memcpy(data + 16, uuid, VK_UUID_SIZE);
+        for (unsigned int i = 0; i < PAYLOAD_SIZE; ++i)
+        {
+            data[DRIVER_HEADER_SIZE + i] = static_cast<unsigned char>(i * 7);
+        }
+        PipelineCacheFileHeader header;
+        header.magic = PipelineCacheFileHeader::MAGIC;
+        header.version = PipelineCacheFileHeader::VERSION;
+        header.data_size = DRIVER_HEADER_SIZE + PAYLOAD_SIZE;
+        header.data_hash = 0;
+        Utils::memcpy(bytes, &header, sizeof(header));
+        rehash();
+    }
+
+    unsigned char *driver_data() noexcept
+    {
+        return bytes + sizeof(PipelineCacheFileHeader);
+    }
+    PipelineCacheFileHeader get_header() const noexcept
+    {
+        PipelineCacheFileHeader header;
+        Utils::memcpy(&header, bytes, sizeof(header));
+        return header;
+    }
+    void set_header(const PipelineCacheFileHeader &header) noexcept
+    {
+        Utils::memcpy(bytes, &header, sizeof(header));
+    }
+    /// Little-endian, at offset into the driver data.
+    void write_u32(unsigned int offset, unsigned int value) noexcept
+    {
+        for (unsigned int i = 0; i < 4; ++i)
+        {
+            driver_data()[offset + i] = static_cast<unsigned char>(value >> (8 * i));
+        }
+    }
+    void rehash() noexcept
+    {
+        PipelineCacheFileHeader header = get_header();
+        header.data_hash =
+            Utils::xxhash64(reinterpret_cast<const char *>(driver_data()), DRIVER_HEADER_SIZE + PAYLOAD_SIZE);
+        set_header(header);
+    }
+    const unsigned char *validate(unsigned long size = FILE_SIZE) const noexcept
+    {
+        return validate_pipeline_cache(bytes, size, VENDOR_ID, DEVICE_ID, uuid);
+    }
+};
+
+static void test_valid() noexcept
+{
+    CacheFile file;
+    LUNA_CHECK(file.validate() == file.driver_data());
+}
+
+static void test_file_header() noexcept
+{
+    {
+        CacheFile file;
+        LUNA_CHECK(file.validate(0) == nullptr);
+        LUNA_CHECK(file.validate(sizeof(PipelineCacheFileHeader) - 1) == nullptr);
+        LUNA_CHECK(file.validate(FILE_SIZE - 1) == nullptr);
+    }
+    {
+        CacheFile file;
+        PipelineCacheFileHeader header = file.get_header();
+        header.magic ^= 1;
+        file.set_header(header);
+        LUNA_CHECK(file.validate() == nullptr);
+    }
+    {
+        CacheFile file;
+        PipelineCacheFileHeader header = file.get_header();
+        header.version = PipelineCacheFileHeader::VERSION + 1;
+        file.set_header(header);
+        LUNA_CHECK(file.validate() == nullptr);
+    }
+    {
+        // data_size agreeing with a file too short for the driver's header.
+        CacheFile file;
+        PipelineCacheFileHeader header = file.get_header();
+        header.data_size = DRIVER_HEADER_SIZE - 1;
+        header.data_hash = Utils::xxhash64(reinterpret_cast<const char *>(file.driver_data()), DRIVER_HEADER_SIZE - 1);
+        file.set_header(header);
+        LUNA_CHECK(file.validate(sizeof(PipelineCacheFileHeader) + DRIVER_HEADER_SIZE - 1) == nullptr);
+    }
+}
+
+static void test_corruption() noexcept
+{
+    // Any single flipped bit in the driver data fails the hash.
+    for (unsigned int i = 0; i < DRIVER_HEADER_SIZE + PAYLOAD_SIZE; i += 13)
+    {
+        CacheFile file;
+        file.driver_data()[i] ^= 0x10;
+        if (!LUNA_CHECK(file.validate() == nullptr))
+        {
+            Log::error("  flipped byte %u", i);
+        }
+    }
+}
+
+static void test_driver_header() noexcept
+{
+    {
+        CacheFile file;
+        file.write_u32(0, DRIVER_HEADER_SIZE - 1);
+        file.rehash();
+        LUNA_CHECK(file.validate() == nullptr);
+    }
+    {
+        // A larger header size is allowed; newer drivers append fields.
+        CacheFile file;
+        file.write_u32(0, DRIVER_HEADER_SIZE + 16);
+        file.rehash();
+        LUNA_CHECK(file.validate() == file.driver_data());
+    }
+    {
+        CacheFile file;
+        file.write_u32(4, VK_PIPELINE_CACHE_HEADER_VERSION_ONE + 1);
+        file.rehash();
+        LUNA_CHECK(file.validate() == nullptr);
+    }
+    {
+        CacheFile file;
+        file.write_u32(8, VENDOR_ID + 1);
+        file.rehash();
+        LUNA_CHECK(file.validate() == nullptr);
+    }
+    {
+        CacheFile file;
+        file.write_u32(12, DEVICE_ID + 1);
+        file.rehash();
+        LUNA_CHECK(file.validate() == nullptr);
+    }
+    {
+        // Same driver bytes, but this device reports another UUID, as after a driver update.
+        CacheFile file;
+        file.uuid[VK_UUID_SIZE - 1] ^= 1;
+        LUNA_CHECK(file.validate() == nullptr);
+    }
+}
+
+int main()
+{
+    test_valid();
+    test_file_header();
+    test_corruption();
+    test_driver_header();
+    return Test::finish("pipeline_cache");
+}
@@ -0,0 +1,318 @@
+// LunaTestPipeline: PipelineKey canonicalisation and PipelineRegistry.
+//
+//     LunaTestPipeline
+//
+// Builders are compared through their keys only; no pipeline is created, so no device is needed. Shader modules
+// and layouts are made-up handles, which the key only ever reads as numbers.
+#include "test.h"
+#include <renderer/vulkan/pipeline_registry.h>
+
+using namespace LunaVoxelEngine;
+using namespace LunaVoxelEngine::Renderer;
+
+/// Pipeline creation, which the test never reaches, allocates through these.
+VkAllocationCallbacks callbacks{};
+
+constexpr unsigned int REGISTRY_KEYS = 2000;
+constexpr unsigned int INSERT_THREADS = 4;
+
+static VkShaderModule fake_module(unsigned long long value) noexcept
+{
+    return reinterpret_cast<VkShaderModule>(value);
+}
+
+/**
+ * @brief The state every builder in the test starts from, with its arrays owned so copies can be edited.
+ */
+struct State
+{
+    VkDynamicState dynamic_states[3] = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR,
+                                        VK_DYNAMIC_STATE_VERTEX_INPUT_BINDING_STRIDE};
+    VkPipelineDynamicStateCreateInfo dynamic_state{};
+    VkVertexInputBindingDescription binding{0, 16, VK_VERTEX_INPUT_RATE_VERTEX};
+    VkVertexInputAttributeDescription attribute{0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0};
+    VkPipelineVertexInputStateCreateInfo vertex_input{};
+    VkViewport viewport{0.0f, 0.0f, 1280.0f, 720.0f, 0.0f, 1.0f};
+    VkRect2D scissor{{0, 0}, {1280, 720}};
+    VkPipelineViewportStateCreateInfo viewport_state{};
+    VkPipelineColorBlendAttachmentState attachment{};
+    VkPipelineColorBlendStateCreateInfo color_blending{};
+    VkPipelineDepthStencilStateCreateInfo depth_stencil{};
+
+    State() noexcept
+    {
+        dynamic_state.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+        dynamic_state.dynamicStateCount = 3;
+        vertex_input.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+        vertex_input.vertexBindingDescriptionCount = 1;
+        vertex_input.vertexAttributeDescriptionCount = 1;
+        viewport_state.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+        viewport_state.viewportCount = 1;
+        viewport_state.scissorCount = 1;
+        attachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+                                    VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+        color_blending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+        color_blending.attachmentCount = 1;
+        depth_stencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+        depth_stencil.depthTestEnable = VK_TRUE;
+        depth_stencil.depthWriteEnable = VK_TRUE;
+        depth_stencil.depthCompareOp = VK_COMPARE_OP_LESS;
+    }
+
+    [[nodiscard]] GraphicsPipelineBuilder builder(unsigned long long module = 1) noexcept
+    {
+        dynamic_state.pDynamicStates = dynamic_states;
+        vertex_input.pVertexBindingDescriptions = &binding;
+        vertex_input.pVertexAttributeDescriptions = &attribute;
+        viewport_state.pViewports = &viewport;
+        viewport_state.pScissors = &scissor;
+        color_blending.pAttachments = &attachment;
+        GraphicsPipelineBuilder result;
+        result.addShader(VK_SHADER_STAGE_VERTEX_BIT, fake_module(module))
+            .addShader(VK_SHADER_STAGE_FRAGMENT_BIT, fake_module(module + 1))
+            .setDynamicState(dynamic_state)
+            .setVertexInputInfo(vertex_input)
+            .setViewportState(viewport_state)
+            .setColorBlending(color_blending)
+            .setDepthStencil(depth_stencil);
+        return result;
+    }
+};
+
+static bool same_key(const GraphicsPipelineBuilder &a, const GraphicsPipelineBuilder &b) noexcept
+{
+    const PipelineKey key_a = a.key();
+    const PipelineKey key_b = b.key();
+    return key_a == key_b && key_a.get_hash() == key_b.get_hash();
+}
+
+static void test_key_words() noexcept
+{
+    // Lengths go in ahead of bytes, so where one run of bytes ends is part of the key.
+    PipelineKey split;
+    split.add_bytes("ab", 2);
+    split.add_bytes("c", 1);
+    split.finish();
+    PipelineKey joined;
+    joined.add_bytes("abc", 3);
+    joined.add_bytes("", 0);
+    joined.finish();
+    LUNA_CHECK(!(split == joined));
+
+    PipelineKey sorted;
+    sorted.add(9);
+    sorted.add(3);
+    sorted.add(1);
+    sorted.add(2);
+    sorted.sort_from(1);
+    sorted.finish();
+    PipelineKey presorted;
+    presorted.add(9);
+    presorted.add(1);
+    presorted.add(2);
+    presorted.add(3);
+    presorted.finish();
+    LUNA_CHECK(sorted == presorted && sorted.get_hash() == presorted.get_hash());
+
+    PipelineKey float_key;
+    float_key.add_float(-0.0f);
+    float_key.finish();
+    PipelineKey zero_key;
+    zero_key.add_float(0.0f);
+    zero_key.finish();
+    LUNA_CHECK(!(float_key == zero_key));
+}
+
+static void test_key_equal_state() noexcept
+{
+    State a;
+    State b;
+    LUNA_CHECK(same_key(a.builder(), b.builder()));
+    // A builder and its copy, and builds of the same state at different times.
+    const GraphicsPipelineBuilder builder = a.builder();
+    const GraphicsPipelineBuilder copy = builder;
+    LUNA_CHECK(same_key(builder, copy) && builder == copy && builder.hash() == copy.hash());
+
+    // The order of dynamic states does not matter.
+    b.dynamic_states[0] = VK_DYNAMIC_STATE_VERTEX_INPUT_BINDING_STRIDE;
+    b.dynamic_states[2] = VK_DYNAMIC_STATE_VIEWPORT;
+    LUNA_CHECK(same_key(a.builder(), b.builder()));
+
+    // Dynamic viewports, scissors and strides are left out.
+    b.viewport.width = 640.0f;
+    b.scissor.extent.height = 480;
+    b.binding.stride = 32;
+    LUNA_CHECK(same_key(a.builder(), b.builder()));
+
+    // So are blend factors with blending off, the compare op with the depth test off, and stencil state with the
+    // stencil test off.
+    b.attachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+    b.depth_stencil.front.failOp = VK_STENCIL_OP_REPLACE;
+    LUNA_CHECK(same_key(a.builder(), b.builder()));
+    a.depth_stencil.depthTestEnable = VK_FALSE;
+    b.depth_stencil.depthTestEnable = VK_FALSE;
+    b.depth_stencil.depthCompareOp = VK_COMPARE_OP_GREATER;
+    LUNA_CHECK(same_key(a.builder(), b.builder()));
+}
+
+static void test_key_different_state() noexcept
+{
+    State base;
+    const GraphicsPipelineBuilder reference = base.builder();
+
+    State shader;
+    LUNA_CHECK(!same_key(reference, shader.builder(5)));
+
+    State attribute;
+    attribute.attribute.format = VK_FORMAT_R32G32_SFLOAT;
+    LUNA_CHECK(!same_key(reference, attribute.builder()));
+
+    State blend;
+    blend.attachment.blendEnable = VK_TRUE;
+    LUNA_CHECK(!same_key(reference, blend.builder()));
+    State blend_factor;
+    blend_factor.attachment.blendEnable = VK_TRUE;
+    blend_factor.attachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+    LUNA_CHECK(!same_key(blend.builder(), blend_factor.builder()));
+
+    State compare;
+    compare.depth_stencil.depthCompareOp = VK_COMPARE_OP_GREATER;
+    LUNA_CHECK(!same_key(reference, compare.builder()));
+
+    // Static viewports and strides count once they are no longer dynamic.
+    State fixed_a;
+    State fixed_b;
+    fixed_a.dynamic_state.dynamicStateCount = 1;
+    fixed_b.dynamic_state.dynamicStateCount = 1;
+    fixed_b.scissor.extent.width = 640;
+    fixed_b.binding.stride = 32;
+    LUNA_CHECK(!same_key(reference, fixed_a.builder()));
+    LUNA_CHECK(!same_key(fixed_a.builder(), fixed_b.builder()));
+
+    // One stage less is not the same key as the same stages plus nothing.
+    GraphicsPipelineBuilder one_stage;
+    one_stage.addShader(VK_SHADER_STAGE_VERTEX_BIT, fake_module(1));
+    GraphicsPipelineBuilder two_stages;
+    two_stages.addShader(VK_SHADER_STAGE_VERTEX_BIT, fake_module(1));
+    two_stages.addShader(VK_SHADER_STAGE_VERTEX_BIT, fake_module(1));
+    LUNA_CHECK(!same_key(one_stage, two_stages));
+}
+
+/**
+ * @brief A builder per index; only the shader module differs, so every key is distinct.
+ */
+static GraphicsPipelineBuilder numbered_builder(unsigned int index) noexcept
+{
+    GraphicsPipelineBuilder builder;
+    builder.addShader(VK_SHADER_STAGE_COMPUTE_BIT, fake_module(1000 + index));
+    return builder;
+}
+
+static void test_registry() noexcept
+{
+    PipelineRegistry registry;
+    LUNA_CHECK(registry.size() == 0);
+    LUNA_CHECK(registry.find(numbered_builder(0).key()) == nullptr);
+
+    // Enough keys to grow the table several times; every job must still be found afterwards.
+    Utils::Vector<PipelineJob *> jobs;
+    for (unsigned int i = 0; i < REGISTRY_KEYS; ++i)
+    {
+        const GraphicsPipelineBuilder builder = numbered_builder(i);
+        bool created = false;
+        PipelineJob *job = registry.insert(builder, builder.key(), created);
+        LUNA_CHECK(created && job != nullptr && job->builder == builder && job->pipeline == nullptr);
+        jobs.push_back(job);
+    }
+    LUNA_CHECK(registry.size() == REGISTRY_KEYS);
+    for (unsigned int i = 0; i < REGISTRY_KEYS; ++i)
+    {
+        const GraphicsPipelineBuilder builder = numbered_builder(i);
+        if (!LUNA_CHECK(registry.find(builder.key()) == jobs[i]))
+        {
+            Log::error("  key %u", i);
+            return;
+        }
+        bool created = true;
+        LUNA_CHECK(registry.insert(builder, builder.key(), created) == jobs[i] && !created);
+    }
+    LUNA_CHECK(registry.size() == REGISTRY_KEYS);
+
+    unsigned int visited = 0;
+    registry.for_each([&](PipelineJob *) { ++visited; });
+    LUNA_CHECK(visited == REGISTRY_KEYS);
+}
+
+struct InsertRace
+{
+    PipelineRegistry *registry;
+    Utils::Atomic<unsigned int> *created_count;
+    PipelineJob *jobs[REGISTRY_KEYS];
+};
+
+static size_t insert_all(void *param)
+{
+    InsertRace &race = *static_cast<InsertRace *>(param);
+    for (unsigned int i = 0; i < REGISTRY_KEYS; ++i)
+    {
+        const GraphicsPipelineBuilder builder = numbered_builder(i);
+        bool created = false;
+        race.jobs[i] = race.registry->insert(builder, builder.key(), created);
+        if (created)
+        {
+            race.created_count->fetch_add(1, Utils::MemoryOrder::RELAXED);
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Threads inserting the same keys at once, through table growth, agree on one job per key, and exactly
+ *        one of them is told to build it.
+ */
+static void test_registry_threads() noexcept
+{
+    PipelineRegistry registry;
+    Utils::Atomic<unsigned int> created_count = 0;
+    InsertRace *races[INSERT_THREADS];
+    Platform::Thread *threads[INSERT_THREADS];
+    for (unsigned int i = 0; i < INSERT_THREADS; ++i)
+    {
+        races[i] = new InsertRace{&registry, &created_count, {}};
+        threads[i] = new Platform::Thread(insert_all, races[i]);
+    }
+    for (unsigned int i = 0; i < INSERT_THREADS; ++i)
+    {
+        threads[i]->wait();
+        delete threads[i];
+    }
+    LUNA_CHECK(created_count.load(Utils::MemoryOrder::RELAXED) == REGISTRY_KEYS);
+    LUNA_CHECK(registry.size() == REGISTRY_KEYS);
+    for (unsigned int key = 0; key < REGISTRY_KEYS; ++key)
+    {
+        bool agreed = races[0]->jobs[key] != nullptr;
+        for (unsigned int i = 1; i < INSERT_THREADS; ++i)
+        {
+            agreed = agreed && races[i]->jobs[key] == races[0]->jobs[key];
+        }
+        if (!LUNA_CHECK(agreed))
+        {
+            Log::error("  key %u", key);
+            break;
+        }
+    }
+    for (InsertRace *race : races)
+    {
+        delete race;
+    }
+}
+
+int main()
+{
+    test_key_words();
+    test_key_equal_state();
+    test_key_different_state();
+    test_registry();
+    test_registry_threads();
+    return Test::finish("pipeline");
+}
@@ -0,0 +1,298 @@
+// LunaTestRenderGraph: RenderGraph::compile() on graphs built by hand, without a device.
+//
+//     LunaTestRenderGraph
+//
+// compile() is pure CPU work, so each case checks the passes it keeps, the barriers it plans before each of them
+// and where it places transient images, against what the synchronisation rules call for.
+#include "test.h"
+#include <renderer/vulkan/render_graph.h>
+
+using namespace LunaVoxelEngine;
+using namespace LunaVoxelEngine::Renderer;
+
+/// Image creation, which compile() never reaches, allocates through these.
+VkAllocationCallbacks callbacks{};
+
+static void record_nothing(CommandBuffer &, const RenderGraph &, void *)
+{
+}
+
+static const TransientImage COLOR_TARGET{64, 64, VK_FORMAT_R8G8B8A8_UNORM, 0, VK_IMAGE_ASPECT_COLOR_BIT};
+
+static const RenderImageBarrier *find_image_barrier(const RenderBarrierBatch &batch, RenderResource resource) noexcept
+{
+    for (const RenderImageBarrier &barrier : batch.images)
+    {
+        if (barrier.resource == resource)
+        {
+            return &barrier;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Buffers only: reads after reads need nothing, and every buffer hazard before a pass shares one global
+ *        memory barrier.
+ */
+static void test_buffer_barriers() noexcept
+{
+    RenderGraph graph;
+    const RenderResource commands = graph.import_buffer("commands");
+    const RenderResource records = graph.import_buffer("records");
+    const RenderPass write = graph.add_pass("write", record_nothing, nullptr, true);
+    graph.use(write, commands, RenderAccess::STORAGE_WRITE_COMPUTE);
+    graph.use(write, records, RenderAccess::TRANSFER_WRITE);
+    const RenderPass read = graph.add_pass("read", record_nothing, nullptr, true);
+    graph.use(read, commands, RenderAccess::INDIRECT_READ);
+    graph.use(read, records, RenderAccess::STORAGE_READ_COMPUTE);
+    const RenderPass read_again = graph.add_pass("read again", record_nothing, nullptr, true);
+    graph.use(read_again, commands, RenderAccess::INDIRECT_READ);
+    graph.use(read_again, records, RenderAccess::STORAGE_READ_COMPUTE);
+    const RenderPass overwrite = graph.add_pass("overwrite", record_nothing, nullptr, true);
+    graph.use(overwrite, commands, RenderAccess::STORAGE_WRITE_COMPUTE);
+    if (!LUNA_CHECK(graph.compile()))
+    {
+        return;
+    }
+    LUNA_CHECK(graph.get_pass_order().size() == 4);
+
+    // Nothing came before the first writes.
+    LUNA_CHECK(graph.get_barriers(0).empty());
+
+    // Both write-to-read hazards in one memory barrier, with no per-buffer barriers.
+    const RenderBarrierBatch &after_write = graph.get_barriers(1);
+    LUNA_CHECK(after_write.images.size() == 0);
+    LUNA_CHECK(after_write.memory_src_stages ==
+               (VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_TRANSFER_BIT));
+    LUNA_CHECK(after_write.memory_src_access ==
+               (VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT));
+    LUNA_CHECK(after_write.memory_dst_stages ==
+               (VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT));
+    LUNA_CHECK(after_write.memory_dst_access ==
+               (VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_READ_BIT));
+
+    // The same reads again: the writes are already visible there.
+    LUNA_CHECK(graph.get_barriers(2).empty());
+
+    // Overwriting waits for the reads, with nothing to make visible.
+    const RenderBarrierBatch &before_overwrite = graph.get_barriers(3);
+    LUNA_CHECK(before_overwrite.memory_src_stages ==
+               (VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT));
+    LUNA_CHECK(before_overwrite.memory_dst_stages == VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT);
+    LUNA_CHECK(graph.get_barriers(4).empty());
+}
+
+/**
+ * @brief The runtime's frame: cull, draw, build the depth pyramid, late cull, late draw. Depth goes from attachment
+ *        to sampled and back, and the swapchain image ends up ready to present.
+ */
+static void test_depth_round_trip() noexcept
+{
+    RenderGraph graph;
+    ImportedImage color;
+    color.initial_stages = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+    color.final_layout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    color.final_stages = VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT;
+    color.output = true;
+    ImportedImage depth;
+    depth.aspect = VK_IMAGE_ASPECT_DEPTH_BIT;
+    depth.initial_stages = VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+    depth.initial_write_access = VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    const RenderResource swapchain = graph.import_image("swapchain", color);
+    const RenderResource depth_buffer = graph.import_image("depth", depth);
+
+    graph.add_pass("cull", record_nothing, nullptr, true);
+    const RenderPass draw = graph.add_pass("draw", record_nothing, nullptr);
+    graph.use(draw, swapchain, RenderAccess::COLOR_ATTACHMENT_WRITE);
+    graph.use(draw, depth_buffer, RenderAccess::DEPTH_ATTACHMENT_WRITE);
+    const RenderPass pyramid = graph.add_pass("depth pyramid", record_nothing, nullptr, true);
+    graph.use(pyramid, depth_buffer, RenderAccess::SAMPLED_COMPUTE);
+    graph.add_pass("late cull", record_nothing, nullptr, true);
+    const RenderPass late_draw = graph.add_pass("late draw", record_nothing, nullptr);
+    graph.use(late_draw, swapchain, RenderAccess::COLOR_ATTACHMENT_READ_WRITE);
+    graph.use(late_draw, depth_buffer, RenderAccess::DEPTH_ATTACHMENT_READ_WRITE);
+    if (!LUNA_CHECK(graph.compile()))
+    {
+        return;
+    }
+    LUNA_CHECK(graph.get_pass_order().size() == 5);
+    LUNA_CHECK(graph.get_barriers(0).empty());
+
+    // Both attachments start undefined, after last frame's uses.
+    const RenderBarrierBatch &before_draw = graph.get_barriers(1);
+    const RenderImageBarrier *color_in = find_image_barrier(before_draw, swapchain);
+    const RenderImageBarrier *depth_in = find_image_barrier(before_draw, depth_buffer);
+    LUNA_CHECK(before_draw.images.size() == 2 && color_in != nullptr && depth_in != nullptr);
+    if (color_in != nullptr && depth_in != nullptr)
+    {
+        LUNA_CHECK(color_in->old_layout == VK_IMAGE_LAYOUT_UNDEFINED &&
+                   color_in->new_layout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+        LUNA_CHECK(color_in->src_stages == VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT);
+        LUNA_CHECK(depth_in->old_layout == VK_IMAGE_LAYOUT_UNDEFINED &&
+                   depth_in->new_layout == VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL);
+        LUNA_CHECK(depth_in->src_access == VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT);
+    }
+
+    // DEPTH_ATTACHMENT to SHADER_READ_ONLY for the pyramid, keeping what was drawn.
+    const RenderBarrierBatch &before_pyramid = graph.get_barriers(2);
+    LUNA_CHECK(before_pyramid.images.size() == 1 && before_pyramid.memory_dst_stages == VK_PIPELINE_STAGE_2_NONE);
+    const RenderImageBarrier *pyramid_barrier = find_image_barrier(before_pyramid, depth_buffer);
+    if (LUNA_CHECK(pyramid_barrier != nullptr))
+    {
+        LUNA_CHECK(pyramid_barrier->old_layout == VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL &&
+                   pyramid_barrier->new_layout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        LUNA_CHECK(pyramid_barrier->src_access == VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT);
+        LUNA_CHECK(pyramid_barrier->dst_stages == VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT &&
+                   pyramid_barrier->dst_access == VK_ACCESS_2_SHADER_SAMPLED_READ_BIT);
+    }
+    LUNA_CHECK(graph.get_barriers(3).empty());
+
+    // And back to DEPTH_ATTACHMENT, after the pyramid's reads; the colour attachment only needs its writes ordered.
+    const RenderBarrierBatch &before_late_draw = graph.get_barriers(4);
+    LUNA_CHECK(before_late_draw.images.size() == 2);
+    const RenderImageBarrier *depth_out = find_image_barrier(before_late_draw, depth_buffer);
+    if (LUNA_CHECK(depth_out != nullptr))
+    {
+        LUNA_CHECK(depth_out->old_layout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL &&
+                   depth_out->new_layout == VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL);
+        LUNA_CHECK(depth_out->src_stages == VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT &&
+                   depth_out->src_access == VK_ACCESS_2_NONE);
+    }
+    const RenderImageBarrier *color_again = find_image_barrier(before_late_draw, swapchain);
+    if (LUNA_CHECK(color_again != nullptr))
+    {
+        LUNA_CHECK(color_again->old_layout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL &&
+                   color_again->new_layout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+        LUNA_CHECK(color_again->src_access == VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT);
+    }
+
+    // Only the image with a final layout gets a barrier after the last pass.
+    const RenderBarrierBatch &final_batch = graph.get_barriers(5);
+    LUNA_CHECK(final_batch.images.size() == 1);
+    const RenderImageBarrier *present = find_image_barrier(final_batch, swapchain);
+    if (LUNA_CHECK(present != nullptr))
+    {
+        LUNA_CHECK(present->old_layout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL &&
+                   present->new_layout == VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+        LUNA_CHECK(present->dst_stages == VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT);
+    }
+}
+
+/**
+ * @brief A chain of transients feeding a pass whose output nothing reads: all of it goes, and only the pass
+ *        writing the output is kept.
+ */
+static void test_culling() noexcept
+{
+    RenderGraph graph;
+    ImportedImage color;
+    color.output = true;
+    const RenderResource output = graph.import_image("output", color);
+    const RenderResource first = graph.add_transient_image("first", COLOR_TARGET);
+    const RenderResource second = graph.add_transient_image("second", COLOR_TARGET);
+    graph.set_memory_requirements(first, 1000, 256);
+    graph.set_memory_requirements(second, 1000, 256);
+    const RenderPass make_first = graph.add_pass("make first", record_nothing, nullptr);
+    graph.use(make_first, first, RenderAccess::COLOR_ATTACHMENT_WRITE);
+    const RenderPass make_second = graph.add_pass("make second", record_nothing, nullptr);
+    graph.use(make_second, first, RenderAccess::SAMPLED_FRAGMENT);
+    graph.use(make_second, second, RenderAccess::COLOR_ATTACHMENT_WRITE);
+    // Writes the output, but the next pass overwrites all of it.
+    const RenderPass overwritten = graph.add_pass("overwritten", record_nothing, nullptr);
+    graph.use(overwritten, first, RenderAccess::SAMPLED_FRAGMENT);
+    graph.use(overwritten, second, RenderAccess::SAMPLED_FRAGMENT);
+    graph.use(overwritten, output, RenderAccess::COLOR_ATTACHMENT_WRITE);
+    const RenderPass final_pass = graph.add_pass("final", record_nothing, nullptr);
+    graph.use(final_pass, output, RenderAccess::COLOR_ATTACHMENT_WRITE);
+    // Writes nothing anyone reads, but has side effects.
+    const RenderPass side_effects = graph.add_pass("side effects", record_nothing, nullptr, true);
+    const RenderPass unread = graph.add_pass("unread", record_nothing, nullptr);
+    graph.use(unread, first, RenderAccess::COLOR_ATTACHMENT_WRITE);
+    if (!LUNA_CHECK(graph.compile()))
+    {
+        return;
+    }
+    LUNA_CHECK(graph.is_culled(make_first) && graph.is_culled(make_second) && graph.is_culled(overwritten) &&
+               graph.is_culled(unread));
+    LUNA_CHECK(!graph.is_culled(final_pass) && !graph.is_culled(side_effects));
+    const Utils::Vector<RenderPass> &order = graph.get_pass_order();
+    LUNA_CHECK(order.size() == 2 && order[0] == final_pass && order[1] == side_effects);
+    LUNA_CHECK(graph.get_transient_bytes() == 0 && graph.get_unaliased_bytes() == 0);
+}
+
+/**
+ * @brief first -> second -> third -> output: first and third are never alive together, so they share memory
+ *        after second, which is largest and placed first.
+ */
+static void test_aliasing() noexcept
+{
+    RenderGraph graph;
+    ImportedImage color;
+    color.output = true;
+    const RenderResource output = graph.import_image("output", color);
+    const RenderResource first = graph.add_transient_image("first", COLOR_TARGET);
+    const RenderResource second = graph.add_transient_image("second", COLOR_TARGET);
+    const RenderResource third = graph.add_transient_image("third", COLOR_TARGET);
+    graph.set_memory_requirements(first, 1000, 256);
+    graph.set_memory_requirements(second, 2000, 512);
+    graph.set_memory_requirements(third, 900, 256);
+    const RenderPass make_first = graph.add_pass("make first", record_nothing, nullptr);
+    graph.use(make_first, first, RenderAccess::COLOR_ATTACHMENT_WRITE);
+    const RenderPass make_second = graph.add_pass("make second", record_nothing, nullptr);
+    graph.use(make_second, first, RenderAccess::SAMPLED_FRAGMENT);
+    graph.use(make_second, second, RenderAccess::COLOR_ATTACHMENT_WRITE);
+    const RenderPass make_third = graph.add_pass("make third", record_nothing, nullptr);
+    graph.use(make_third, second, RenderAccess::SAMPLED_FRAGMENT);
+    graph.use(make_third, third, RenderAccess::COLOR_ATTACHMENT_WRITE);
+    const RenderPass resolve = graph.add_pass("resolve", record_nothing, nullptr);
+    graph.use(resolve, third, RenderAccess::SAMPLED_FRAGMENT);
+    graph.use(resolve, output, RenderAccess::COLOR_ATTACHMENT_WRITE);
+    if (!LUNA_CHECK(graph.compile()))
+    {
+        return;
+    }
+    LUNA_CHECK(graph.get_pass_order().size() == 4);
+    LUNA_CHECK(graph.get_memory_offset(second) == 0);
+    LUNA_CHECK(graph.get_memory_offset(first) == 2048);
+    LUNA_CHECK(graph.get_memory_offset(third) == 2048);
+    LUNA_CHECK(graph.get_transient_bytes() == 3048);
+    // 2000, then 1000 aligned up to 256, then 900 aligned up to 256.
+    LUNA_CHECK(graph.get_unaliased_bytes() == 2048 + 1024 + 900);
+
+    // third's first use waits for every use of first, whose memory it takes over, and discards its contents.
+    const RenderImageBarrier *alias_barrier = find_image_barrier(graph.get_barriers(2), third);
+    if (LUNA_CHECK(alias_barrier != nullptr))
+    {
+        LUNA_CHECK(alias_barrier->old_layout == VK_IMAGE_LAYOUT_UNDEFINED);
+        LUNA_CHECK(alias_barrier->src_stages ==
+                   (VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT));
+        LUNA_CHECK(alias_barrier->src_access == VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT);
+    }
+}
+
+static void test_invalid() noexcept
+{
+    RenderGraph read_first;
+    const RenderResource transient = read_first.add_transient_image("transient", COLOR_TARGET);
+    const RenderPass reader = read_first.add_pass("read first", record_nothing, nullptr, true);
+    read_first.use(reader, transient, RenderAccess::SAMPLED_FRAGMENT);
+    LUNA_CHECK(!read_first.compile());
+
+    RenderGraph two_layouts;
+    const RenderResource image = two_layouts.import_image("image", ImportedImage{});
+    const RenderPass pass = two_layouts.add_pass("two layouts", record_nothing, nullptr, true);
+    two_layouts.use(pass, image, RenderAccess::SAMPLED_FRAGMENT);
+    two_layouts.use(pass, image, RenderAccess::STORAGE_WRITE_COMPUTE);
+    LUNA_CHECK(!two_layouts.compile());
+}
+
+int main()
+{
+    test_buffer_barriers();
+    test_depth_round_trip();
+    test_culling();
+    test_aliasing();
+    test_invalid();
+    return Test::finish("render_graph");
+}
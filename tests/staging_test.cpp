@@ -0,0 +1,288 @@
+// LunaTestStaging: StagingRing against a simulated timeline, and UploadBatcher's merging and overlaps.
+//
+//     LunaTestStaging
+//
+// The ring is driven the way UploadQueue drives it: allocate, submit at the next timeline value, and retire what
+// the simulated GPU has completed. The batcher's output is checked by replaying its copies into a byte array and
+// comparing that with doing every upload in the order it was added.
+#include "test.h"
+#include <renderer/vulkan/staging.h>
+
+using namespace LunaVoxelEngine;
+using namespace LunaVoxelEngine::Renderer;
+
+constexpr unsigned long long RING_CAPACITY = 1024;
+constexpr unsigned int DESTINATION_BYTES = 256;
+constexpr unsigned int RANDOM_ROUNDS = 2000;
+
+static void test_ring_allocate() noexcept
+{
+    StagingRing ring(RING_CAPACITY);
+    unsigned long long offset = 0;
+    LUNA_CHECK(ring.allocate(100, 1, offset) && offset == 0);
+    LUNA_CHECK(ring.allocate(10, 64, offset) && offset == 128);
+    LUNA_CHECK(ring.get_used() == 138);
+    LUNA_CHECK(!ring.allocate(RING_CAPACITY + 1, 1, offset));
+    LUNA_CHECK(ring.allocate(886, 1, offset) && offset == 138);
+    LUNA_CHECK(ring.get_used() == RING_CAPACITY);
+    LUNA_CHECK(!ring.allocate(1, 1, offset));
+}
+
+static void test_ring_empty() noexcept
+{
+    // Default-constructed with no capacity, and reset to none after being used.
+    StagingRing ring;
+    unsigned long long offset = 0;
+    LUNA_CHECK(!ring.allocate(0, 1, offset));
+    LUNA_CHECK(!ring.allocate(1, 1, offset));
+    ring.reset(RING_CAPACITY);
+    LUNA_CHECK(ring.allocate(1, 1, offset));
+    ring.reset(0);
+    LUNA_CHECK(!ring.allocate(0, 16, offset));
+    LUNA_CHECK(ring.get_used() == 0);
+}
+
+static void test_ring_timeline() noexcept
+{
+    StagingRing ring(RING_CAPACITY);
+    unsigned long long completed = 0;
+    unsigned long long offset = 0;
+
+    // Nothing allocated: submitting is a no-op and leaves nothing pending.
+    LUNA_CHECK(ring.submit(1));
+    LUNA_CHECK(ring.get_pending_submits() == 0);
+
+    LUNA_CHECK(ring.allocate(600, 1, offset) && offset == 0);
+    LUNA_CHECK(ring.submit(1));
+    LUNA_CHECK(ring.allocate(300, 1, offset) && offset == 600);
+    LUNA_CHECK(ring.submit(2));
+    LUNA_CHECK(ring.get_pending_submits() == 2 && ring.get_oldest_pending() == 1);
+
+    // Would cross the end, so it starts again at 0, which submission 1 still holds.
+    LUNA_CHECK(!ring.allocate(200, 1, offset));
+    ring.retire(completed);
+    LUNA_CHECK(ring.get_pending_submits() == 2);
+
+    completed = 1;
+    ring.retire(completed);
+    LUNA_CHECK(ring.get_pending_submits() == 1 && ring.get_oldest_pending() == 2);
+    LUNA_CHECK(ring.get_used() == 300);
+    // The 124 bytes skipped at the end are used until this allocation retires.
+    LUNA_CHECK(ring.allocate(200, 1, offset) && offset == 0);
+    LUNA_CHECK(ring.get_used() == 624);
+    LUNA_CHECK(ring.submit(3));
+
+    completed = 3;
+    ring.retire(completed);
+    LUNA_CHECK(ring.get_pending_submits() == 0 && ring.get_used() == 0);
+
+    for (unsigned int i = 0; i < StagingRing::MAX_PENDING_SUBMITS; ++i)
+    {
+        LUNA_CHECK(ring.allocate(1, 1, offset));
+        LUNA_CHECK(ring.submit(4 + i));
+    }
+    LUNA_CHECK(ring.allocate(1, 1, offset));
+    LUNA_CHECK(!ring.submit(4 + StagingRing::MAX_PENDING_SUBMITS));
+    ring.retire(4);
+    LUNA_CHECK(ring.submit(4 + StagingRing::MAX_PENDING_SUBMITS));
+}
+
+/**
+ * @brief Random allocations against a GPU that completes a random number of submissions each frame; no live
+ *        allocation may overlap another or cross the end of the buffer.
+ */
+static void test_ring_random() noexcept
+{
+    struct Live
+    {
+        unsigned long long offset;
+        unsigned long long size;
+        unsigned long long value;
+    };
+    StagingRing ring(RING_CAPACITY);
+    Utils::Vector<Live> live;
+    Test::Random random;
+    unsigned long long next_value = 1;
+    unsigned long long completed = 0;
+    for (unsigned int round = 0; round < RANDOM_ROUNDS; ++round)
+    {
+        const unsigned long long size = 1 + random.below(200);
+        const unsigned long long alignment = 1ull << random.below(7);
+        unsigned long long offset = 0;
+        if (ring.allocate(size, alignment, offset))
+        {
+            if (!LUNA_CHECK(offset % alignment == 0 && offset + size <= RING_CAPACITY))
+            {
+                return;
+            }
+            for (const Live &other : live)
+            {
+                if (!LUNA_CHECK(offset + size <= other.offset || other.offset + other.size <= offset))
+                {
+                    Log::error("  round %u: [%llu, %llu) overlaps [%llu, %llu)", round, offset, offset + size,
+                               other.offset, other.offset + other.size);
+                    return;
+                }
+            }
+            live.push_back({offset, size, next_value});
+        }
+        if (random.below(3) == 0 && ring.submit(next_value))
+        {
+            ++next_value;
+        }
+        if (random.below(2) == 0 && completed + 1 < next_value)
+        {
+            completed += 1 + random.below(static_cast<unsigned int>(next_value - completed - 1));
+            ring.retire(completed);
+            unsigned long kept = 0;
+            for (const Live &allocation : live)
+            {
+                if (allocation.value > completed)
+                {
+                    live[kept++] = allocation;
+                }
+            }
+            live.resize(kept);
+        }
+    }
+}
+
+/**
+ * @brief Replays the batcher's copies of dst over expected's starting bytes and checks they match doing every
+ *        upload to dst in order; source byte i holds i + 1, so a wrong offset shows.
+ */
+static bool matches_in_order(const UploadBatcher &batcher, unsigned long long dst,
+                             const unsigned char *expected) noexcept
+{
+    unsigned char copied[DESTINATION_BYTES] = {};
+    bool written[DESTINATION_BYTES] = {};
+    for (const BufferCopyBatch &batch : batcher.get_batches())
+    {
+        if (batch.dst != dst)
+        {
+            continue;
+        }
+        for (unsigned int i = batch.first_region; i < batch.first_region + batch.region_count; ++i)
+        {
+            const BufferCopyRegion &region = batcher.get_regions()[i];
+            for (unsigned long long byte = 0; byte < region.size; ++byte)
+            {
+                // Regions of one copy command must not overlap.
+                if (!LUNA_CHECK(!written[region.dst_offset + byte]))
+                {
+                    return false;
+                }
+                written[region.dst_offset + byte] = true;
+                copied[region.dst_offset + byte] = static_cast<unsigned char>(region.src_offset + byte + 1);
+            }
+        }
+    }
+    for (unsigned int byte = 0; byte < DESTINATION_BYTES; ++byte)
+    {
+        if (!LUNA_CHECK(copied[byte] == expected[byte]))
+        {
+            Log::error("  destination %llu byte %u", dst, byte);
+            return false;
+        }
+    }
+    return true;
+}
+
+static void upload(UploadBatcher &batcher, unsigned char *expected, unsigned long long dst_offset,
+                   unsigned long long src_offset, unsigned long long size) noexcept
+{
+    batcher.add(1, dst_offset, src_offset, size);
+    for (unsigned long long byte = 0; byte < size; ++byte)
+    {
+        expected[dst_offset + byte] = static_cast<unsigned char>(src_offset + byte + 1);
+    }
+}
+
+static void test_batcher_merge() noexcept
+{
+    UploadBatcher batcher;
+    // Added out of order; 0 and 2 are contiguous on both sides, 3 only in the destination.
+    batcher.add(7, 16, 116, 8);
+    batcher.add(3, 0, 0, 4);
+    batcher.add(7, 0, 100, 16);
+    batcher.add(7, 24, 200, 8);
+    batcher.build();
+
+    const Utils::Vector<BufferCopyBatch> &batches = batcher.get_batches();
+    const Utils::Vector<BufferCopyRegion> &regions = batcher.get_regions();
+    LUNA_CHECK(batcher.get_upload_count() == 4 && batcher.get_upload_bytes() == 36);
+    LUNA_CHECK(batches.size() == 2 && regions.size() == 3);
+    LUNA_CHECK(batches[0].dst == 3 && batches[0].first_region == 0 && batches[0].region_count == 1);
+    LUNA_CHECK(batches[1].dst == 7 && batches[1].first_region == 1 && batches[1].region_count == 2);
+    LUNA_CHECK(regions[1].src_offset == 100 && regions[1].dst_offset == 0 && regions[1].size == 24);
+    LUNA_CHECK(regions[2].src_offset == 200 && regions[2].dst_offset == 24 && regions[2].size == 8);
+
+    batcher.clear();
+    batcher.build();
+    LUNA_CHECK(batcher.get_batches().size() == 0 && batcher.get_regions().size() == 0);
+}
+
+static void test_batcher_overlap() noexcept
+{
+    UploadBatcher batcher;
+    unsigned char expected[DESTINATION_BYTES] = {};
+    // A later upload inside an earlier one splits it; one over the boundary of two trims both.
+    upload(batcher, expected, 0, 0, 64);
+    upload(batcher, expected, 16, 100, 8);
+    upload(batcher, expected, 56, 120, 16);
+    // The same range twice, and a range written again by an earlier upload's neighbour.
+    upload(batcher, expected, 80, 140, 8);
+    upload(batcher, expected, 80, 150, 8);
+    upload(batcher, expected, 76, 160, 16);
+    batcher.build();
+    LUNA_CHECK(batcher.get_batches().size() == 1);
+    matches_in_order(batcher, 1, expected);
+
+    // Fully hidden uploads leave nothing behind.
+    batcher.clear();
+    unsigned char hidden[DESTINATION_BYTES] = {};
+    upload(batcher, hidden, 8, 0, 4);
+    upload(batcher, hidden, 0, 10, 32);
+    batcher.build();
+    LUNA_CHECK(batcher.get_regions().size() == 1 && batcher.get_regions()[0].size == 32);
+    matches_in_order(batcher, 1, hidden);
+}
+
+static void test_batcher_random() noexcept
+{
+    UploadBatcher batcher;
+    Test::Random random;
+    for (unsigned int round = 0; round < RANDOM_ROUNDS; ++round)
+    {
+        batcher.clear();
+        unsigned char expected[DESTINATION_BYTES] = {};
+        const unsigned int count = 1 + random.below(12);
+        unsigned long long src_offset = 0;
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            const unsigned long long size = 1 + random.below(32);
+            const unsigned long long dst_offset = random.below(static_cast<unsigned int>(DESTINATION_BYTES - size));
+            upload(batcher, expected, dst_offset, src_offset, size);
+            // Sometimes contiguous with the last upload's source, so merging is exercised too.
+            src_offset += size + random.below(2) * 8;
+        }
+        batcher.build();
+        if (!matches_in_order(batcher, 1, expected))
+        {
+            Log::error("  round %u", round);
+            return;
+        }
+    }
+}
+
+int main()
+{
+    test_ring_allocate();
+    test_ring_empty();
+    test_ring_timeline();
+    test_ring_random();
+    test_batcher_merge();
+    test_batcher_overlap();
+    test_batcher_random();
+    return Test::finish("staging");
+}
@@ -0,0 +1,65 @@
+#ifndef TEST_H
+#define TEST_H
+#include <platform/log.h>
+#include <utils/new.h>
+
+// Shared by the tests. A failed check logs where it failed and the test carries on, so one run reports every
+// broken case; main returns finish(), which ctest takes as the result.
+namespace LunaVoxelEngine::Test
+{
+/// Failures past this many are counted but not logged, so a broken loop does not flood the output.
+constexpr unsigned long long MAX_REPORTED = 20;
+
+inline unsigned long long checks = 0;
+inline unsigned long long failures = 0;
+
+inline bool check(bool passed, const char *expression, const char *file, int line) noexcept
+{
+    ++checks;
+    if (!passed && ++failures <= MAX_REPORTED)
+    {
+        Log::error("%s:%d: check failed: %s", file, line, expression);
+    }
+    return passed;
+}
+
+/**
+ * @brief xorshift64*, so every run checks the same inputs.
+ */
+struct Random
+{
+    unsigned long long state = 0x9E3779B97F4A7C15ull;
+
+    unsigned long long next() noexcept
+    {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 0x2545F4914F6CDD1Dull;
+    }
+    /// Uniform enough in [0, bound) for bound far below 2^32.
+    unsigned int below(unsigned int bound) noexcept
+    {
+        return static_cast<unsigned int>((next() >> 32) % bound);
+    }
+};
+
+/**
+ * @return The exit code: 0 if every check passed.
+ */
+inline int finish(const char *name) noexcept
+{
+    if (failures != 0)
+    {
+        Log::error("%s: %llu of %llu checks failed", name, failures, checks);
+        return 1;
+    }
+    Log::info("%s: %llu checks passed", name, checks);
+    return 0;
+}
+} // namespace LunaVoxelEngine::Test
+
+/// Counts a check and logs it if it fails. Evaluates to whether it passed, so callers can log more context.
+#define LUNA_CHECK(expression)                                                                                        \
+    LunaVoxelEngine::Test::check(static_cast<bool>(expression), #expression, __FILE__, __LINE__)
+#endif
@@ -0,0 +1,82 @@
+// LunaTestThread: joining threads with and without a timeout, and destroying joined threads.
+//
+//     LunaTestThread
+//
+// Each worker blocks on a mutex the test holds, so a timed wait is known to expire before the worker can finish.
+// The joined threads are then destroyed, which must not detach them a second time.
+#include "test.h"
+#include <platform/thread.h>
+#include <utils/atomic.h>
+
+using namespace LunaVoxelEngine;
+using namespace LunaVoxelEngine::Platform;
+
+constexpr unsigned int WORKERS = 8;
+constexpr size_t TIMEOUT_MS = 20;
+
+struct Gate
+{
+    Mutex mutex;
+    Utils::Atomic<unsigned int> finished{0};
+};
+
+static size_t pass_gate(void *gate_in)
+{
+    Gate *gate = static_cast<Gate *>(gate_in);
+    gate->mutex.lock();
+    gate->mutex.unlock();
+    gate->finished.fetch_add(1);
+    return 0;
+}
+
+static void test_timed_wait() noexcept
+{
+    Gate gate;
+    gate.mutex.lock();
+    Thread thread(pass_gate, &gate);
+    LUNA_CHECK(thread.wait(0) == ThreadError::THREAD_ERROR_TIMEOUT);
+    LUNA_CHECK(thread.wait(TIMEOUT_MS) == ThreadError::THREAD_ERROR_TIMEOUT);
+    LUNA_CHECK(gate.finished.load() == 0);
+    gate.mutex.unlock();
+    LUNA_CHECK(thread.wait() == ThreadError::THREAD_SUCCESS);
+    LUNA_CHECK(gate.finished.load() == 1);
+}
+
+static void test_join_then_destroy() noexcept
+{
+    // The way the log writer, the pipeline compiler and the parallel recorder stop their threads.
+    Gate gate;
+    Thread *threads[WORKERS];
+    for (unsigned int i = 0; i < WORKERS; ++i)
+    {
+        threads[i] = new Thread(pass_gate, &gate);
+    }
+    for (unsigned int i = 0; i < WORKERS; ++i)
+    {
+        LUNA_CHECK(threads[i]->wait() == ThreadError::THREAD_SUCCESS);
+        delete threads[i];
+    }
+    LUNA_CHECK(gate.finished.load() == WORKERS);
+}
+
+static void test_destroy_unjoined() noexcept
+{
+    // Destroying a thread nobody joined detaches it, so it still runs to the end on its own. Static, since nothing
+    // joins the thread to say when it has stopped using the gate.
+    static Gate gate;
+    gate.mutex.lock();
+    delete new Thread(pass_gate, &gate);
+    gate.mutex.unlock();
+    while (gate.finished.load() == 0)
+    {
+        Thread::sleep(1);
+    }
+}
+
+int main()
+{
+    test_timed_wait();
+    test_join_then_destroy();
+    test_destroy_unjoined();
+    return Test::finish("thread");
+}
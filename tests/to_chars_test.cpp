@@ -0,0 +1,236 @@
+// LunaTestToChars: utils/to_chars and the log's %p against libc.
+//
+//     LunaTestToChars [--exhaustive]
+//
+// Integers and hex must match snprintf exactly. Doubles and floats must read back bit-identical through strtod and
+// strtof; Grisu2 is allowed an extra digit, so the text itself is only checked for a few fixed values. Floats are
+// checked at a stride through every bit pattern, or all of them with --exhaustive.
+#include "test.h"
+#include <platform/common_log.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <utils/to_chars.h>
+
+using namespace LunaVoxelEngine;
+
+constexpr unsigned long long SEQUENTIAL_INTEGERS = 2000000;
+constexpr unsigned int RANDOM_VALUES = 1000000;
+/// Odd, so the stride reaches every exponent and low mantissa bits vary.
+constexpr unsigned int FLOAT_STRIDE = 4099;
+
+static bool matches(const char *text, const char *end, const char *expected) noexcept
+{
+    const unsigned long length = static_cast<unsigned long>(end - text);
+    return length == strlen(expected) && memcmp(text, expected, length) == 0;
+}
+
+static bool check_unsigned(unsigned long long value) noexcept
+{
+    char text[Utils::MAX_U64_CHARS];
+    char hex[Utils::MAX_HEX64_CHARS];
+    char expected[32];
+    snprintf(expected, sizeof(expected), "%llu", value);
+    char expected_hex[32];
+    snprintf(expected_hex, sizeof(expected_hex), "%llx", value);
+    if (!LUNA_CHECK(matches(text, Utils::u64_to_chars(text, value), expected)) ||
+        !LUNA_CHECK(matches(hex, Utils::hex_to_chars(hex, value), expected_hex)))
+    {
+        Log::error("  value %llu", value);
+        return false;
+    }
+    return true;
+}
+
+static bool check_signed(long long value) noexcept
+{
+    char text[Utils::MAX_I64_CHARS];
+    char expected[32];
+    snprintf(expected, sizeof(expected), "%lld", value);
+    if (!LUNA_CHECK(matches(text, Utils::i64_to_chars(text, value), expected)))
+    {
+        Log::error("  value %lld", value);
+        return false;
+    }
+    return true;
+}
+
+static void test_integers() noexcept
+{
+    for (unsigned long long value = 0; value < SEQUENTIAL_INTEGERS; ++value)
+    {
+        if (!check_unsigned(value) || !check_signed(-static_cast<long long>(value)))
+        {
+            return;
+        }
+    }
+    // Where the digit count changes.
+    for (unsigned int bit = 0; bit < 64; ++bit)
+    {
+        const unsigned long long power = 1ull << bit;
+        check_unsigned(power - 1);
+        check_unsigned(power);
+        check_unsigned(power + 1);
+        check_signed(static_cast<long long>(power - 1));
+        check_signed(-static_cast<long long>(power - 1));
+    }
+    unsigned long long power = 1;
+    for (unsigned int digits = 1; digits < 20; ++digits)
+    {
+        power *= 10;
+        check_unsigned(power - 1);
+        check_unsigned(power);
+        check_signed(static_cast<long long>(power - 1));
+        check_signed(-static_cast<long long>(power));
+    }
+    check_unsigned(~0ull);
+    check_signed(0x7FFFFFFFFFFFFFFFll);
+    check_signed(-0x7FFFFFFFFFFFFFFFll - 1);
+
+    Test::Random random;
+    for (unsigned int i = 0; i < RANDOM_VALUES; ++i)
+    {
+        // Shifted so short values are as common as long ones.
+        const unsigned long long value = random.next() >> random.below(64);
+        if (!check_unsigned(value) || !check_signed(static_cast<long long>(random.next())))
+        {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief %p through the log formatter, which writes it as "0x" and hex_to_chars; glibc spells null "(nil)", so
+ *        only non-null pointers are compared.
+ */
+static void test_pointers() noexcept
+{
+    static constexpr Utils::FormatString<const void *> FORMAT("%p");
+    const Utils::FormatView format = FORMAT.view();
+    Test::Random random;
+    for (unsigned int i = 0; i < RANDOM_VALUES; ++i)
+    {
+        const unsigned long long bits = (random.next() >> random.below(64)) | 1;
+        const void *pointer = reinterpret_cast<const void *>(bits);
+        const Utils::FormatArg arg = Utils::make_format_arg(pointer);
+        Log::LineBuffer line;
+        Log::write_args(line, format, &arg);
+        char expected[32];
+        snprintf(expected, sizeof(expected), "%p", pointer);
+        if (!LUNA_CHECK(matches(line.data, line.data + line.len, expected)))
+        {
+            Log::error("  pointer %llx", bits);
+            return;
+        }
+    }
+}
+
+static bool check_double(double value) noexcept
+{
+    char text[Utils::MAX_FLOAT_CHARS + 1];
+    *Utils::double_to_chars(text, value) = '\0';
+    const double parsed = strtod(text, nullptr);
+    if (!LUNA_CHECK(memcmp(&parsed, &value, sizeof(value)) == 0))
+    {
+        unsigned long long bits;
+        memcpy(&bits, &value, sizeof(bits));
+        Log::error("  double %llx printed as %s", bits, text);
+        return false;
+    }
+    return true;
+}
+
+static bool check_float(float value) noexcept
+{
+    char text[Utils::MAX_FLOAT_CHARS + 1];
+    *Utils::float_to_chars(text, value) = '\0';
+    const float parsed = strtof(text, nullptr);
+    if (!LUNA_CHECK(memcmp(&parsed, &value, sizeof(value)) == 0))
+    {
+        unsigned int bits;
+        memcpy(&bits, &value, sizeof(bits));
+        Log::error("  float %x printed as %s", bits, text);
+        return false;
+    }
+    return true;
+}
+
+static bool prints_as(double value, const char *expected) noexcept
+{
+    char text[Utils::MAX_FLOAT_CHARS];
+    return matches(text, Utils::double_to_chars(text, value), expected);
+}
+
+static bool prints_as(float value, const char *expected) noexcept
+{
+    char text[Utils::MAX_FLOAT_CHARS];
+    return matches(text, Utils::float_to_chars(text, value), expected);
+}
+
+static void test_doubles() noexcept
+{
+    LUNA_CHECK(prints_as(16.6, "16.6"));
+    LUNA_CHECK(prints_as(1.0, "1.0"));
+    LUNA_CHECK(prints_as(0.001, "0.001"));
+    LUNA_CHECK(prints_as(-2.5, "-2.5"));
+    LUNA_CHECK(prints_as(1e20, "1e+20"));
+    LUNA_CHECK(prints_as(1.5e-7, "1.5e-07"));
+    LUNA_CHECK(prints_as(16.6f, "16.6"));
+    LUNA_CHECK(prints_as(0.1f, "0.1"));
+    LUNA_CHECK(prints_as(__builtin_inf(), "inf"));
+    LUNA_CHECK(prints_as(-__builtin_inf(), "-inf"));
+    LUNA_CHECK(prints_as(__builtin_nan(""), "nan"));
+
+    check_double(0.0);
+    check_double(-0.0);
+    check_double(4.9406564584124654e-324);
+    check_double(2.2250738585072014e-308);
+    check_double(1.7976931348623157e308);
+
+    Test::Random random;
+    for (unsigned int i = 0; i < RANDOM_VALUES; ++i)
+    {
+        // Random bit patterns, which are mostly far from 1, and short decimals, which are what gets logged.
+        unsigned long long bits = random.next();
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        if ((bits & 0x7FF0000000000000ull) != 0x7FF0000000000000ull && !check_double(value))
+        {
+            return;
+        }
+        value = static_cast<double>(static_cast<long long>(random.next() >> 40)) / 1000.0;
+        if (!check_double(value))
+        {
+            return;
+        }
+    }
+}
+
+static void test_floats(bool exhaustive) noexcept
+{
+    const unsigned long long stride = exhaustive ? 1 : FLOAT_STRIDE;
+    for (unsigned long long bits = 0; bits <= 0xFFFFFFFFull; bits += stride)
+    {
+        if ((bits & 0x7F800000u) == 0x7F800000u)
+        {
+            continue;
+        }
+        const unsigned int narrow = static_cast<unsigned int>(bits);
+        float value;
+        memcpy(&value, &narrow, sizeof(value));
+        if (!check_float(value))
+        {
+            return;
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const bool exhaustive = argc > 1 && strcmp(argv[1], "--exhaustive") == 0;
+    test_integers();
+    test_pointers();
+    test_doubles();
+    test_floats(exhaustive);
+    return Test::finish("to_chars");
+}